@@ -1389,6 +1389,49 @@ function current_map:passable(object, direction) end
 ---@return Engine_Map_Object
 function current_map:colliding_object(object) end
 
+---@class (exact) Engine_Object_Filter
+---@field type? string
+---@field layer? string|Engine_Object_Layer
+---@field property? string
+---@field value? string # Required value of the property
+
+-- Objects whose center is within the radius, sorted by ID. Pass a table in
+-- results to reuse it instead of creating a new one
+---@param x number
+---@param y number
+---@param radius number
+---@param filter? Engine_Object_Filter
+---@param results? Engine_Map_Object[]
+---@return Engine_Map_Object[]
+function current_map:objects_in_radius(x, y, radius, filter, results) end
+
+-- Objects whose center is within the rectangle, sorted by ID
+---@param x number
+---@param y number
+---@param width number
+---@param height number
+---@param filter? Engine_Object_Filter
+---@param results? Engine_Map_Object[]
+---@return Engine_Map_Object[]
+function current_map:objects_in_rect(x, y, width, height, filter, results) end
+
+-- Objects within the radius with no blocking tiles between them and the center
+---@param x number
+---@param y number
+---@param radius number
+---@param filter? Engine_Object_Filter
+---@param results? Engine_Map_Object[]
+---@return Engine_Map_Object[]
+function current_map:objects_in_sight(x, y, radius, filter, results) end
+
+-- Are there no blocking tiles between the two points
+---@param x1 number
+---@param y1 number
+---@param x2 number
+---@param y2 number
+---@return boolean
+function current_map:line_of_sight(x1, y1, x2, y2) end
+
 ---@param name string
 ---@return string
 function current_map:get_property(name) end
@@ -1569,6 +1612,15 @@ function Engine_Audio_Player:load_map_config_sound(config_name, channel_count, p
 ---@return Engine_Music? # nil if filename is ''
 function Engine_Audio_Player:load_music(filename) end
 
+---Start loading music or ambient in the background, e.g. the next map's music
+---before changing maps, so playing it doesn't stall the game
+---@param filename string
+function Engine_Audio_Player:preload_music(filename) end
+
+---@param filename string
+---@return boolean # true if the music is being preloaded or ready to play
+function Engine_Audio_Player:is_music_preloaded(filename) end
+
 ---@overload fun(self : Engine_Audio_Player, music : Engine_Music, looping? : boolean) : Engine_Music?
 ---@overload fun(self : Engine_Audio_Player, filename : string, volume : number) : Engine_Music?
 ---@param filename string
@@ -1628,6 +1680,8 @@ function Engine_Environment:open_url(url, mode) end
 ---@field seconds number # readonly
 ---@field fps integer # readonly
 ---@field frame_count integer # readonly
+---@field gl_state_changes {issued: integer, elided: integer, uniform_uploads: integer} # readonly, last frame's GL state changes
+---@field profiler_enabled boolean? # nil unless built with OCB_ENABLE_PROFILER
 ---@field character_input string # readonly
 ---@field triggered_keys string[] # readonly
 ---@field gamepad_enabled boolean # readonly
@@ -1660,6 +1714,23 @@ function Engine_Environment:open_url(url, mode) end
 ---@field data_folder Engine_User_Data_Folder # readonly
 game = {}
 
+---@class (exact) Engine_Profile_Zone
+---@field name string
+---@field average_ms number # average time per frame
+---@field max_ms number # time in the worst frame
+---@field calls number # average calls per frame
+
+---Timings of the profiled zones over the last 120 frames, slowest first
+---(only available when built with OCB_ENABLE_PROFILER)
+---@return Engine_Profile_Zone[]
+function game:profiler_summary() end
+
+---Save the recorded zones in Chrome's trace format (relative to the user data folder)
+---(only available when built with OCB_ENABLE_PROFILER)
+---@param filename string
+---@return boolean success
+function game:save_profile(filename) end
+
 ---@param name string
 ---@return string
 function game:get_config(name) end
@@ -1723,15 +1794,20 @@ function game:stop_time() end
 
 function game:resume_time() end
 
+---Get the ID of a virtual key. Checking an ID is faster than checking the name
 ---@param key string
+---@return integer
+function game:action_id(key) end
+
+---@param key string|integer # Virtual key name or action ID
 ---@return boolean
 function game:triggered(key) end
 
----@param key string
+---@param key string|integer # Virtual key name or action ID
 ---@return boolean
 function game:triggered_once(key) end
 
----@param key string
+---@param key string|integer # Virtual key name or action ID
 ---@return boolean
 function game:pressed(key) end
 
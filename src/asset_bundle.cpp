@@ -0,0 +1,180 @@
+#include "asset_bundle.hpp"
+#include "configurations.hpp"
+#include "exceptions.hpp"
+#include "log.hpp"
+#include "utility/file.hpp"
+#include "utility/string.hpp"
+#include <cstring>
+#include <istream>
+#include <ostream>
+
+namespace detail {
+    static const char bundle_magic[] = { 'O', 'C', 'B', 'B' };
+
+    static std::unique_ptr<Asset_Bundle> game_bundle;
+    static bool game_bundle_loaded = false;
+
+    // Read a header value of a bundle stream
+    template<typename T>
+    static T read_bundle_value(std::istream& stream) {
+        T value;
+        if (!stream.read(reinterpret_cast<char*>(&value), sizeof(T))) {
+            throw bundle_exception("Unexpected end of asset bundle");
+        }
+        return value;
+    }
+
+    static std::string read_bundle_string(std::istream& stream) {
+        auto size = read_bundle_value<std::uint32_t>(stream);
+        std::string value(size, '\0');
+        if (!stream.read(value.data(), size)) {
+            throw bundle_exception("Unexpected end of asset bundle");
+        }
+        return value;
+    }
+}
+
+void Bundle_Reader::read_bytes(void* destination, std::size_t size) {
+    if (size > data.size() - position) {
+        throw bundle_exception("Unexpected end of bundle record");
+    }
+    std::memcpy(destination, data.data() + position, size);
+    position += size;
+}
+
+void Asset_Bundle::add(Record_Type type, std::string filename, std::string payload) {
+    string_utilities::normalize_slashes(filename);
+    auto size = static_cast<std::uint32_t>(payload.size());
+    records[std::make_pair(type, filename)] = Record{ 0, size, std::move(payload) };
+}
+
+bool Asset_Bundle::contains(Record_Type type, std::string filename) const {
+    string_utilities::normalize_slashes(filename);
+    return records.find(std::make_pair(type, filename)) != records.end();
+}
+
+std::optional<File_Buffer> Asset_Bundle::find(Record_Type type, std::string filename) const {
+    string_utilities::normalize_slashes(filename);
+    auto it = records.find(std::make_pair(type, filename));
+    if (it == records.end()) return std::nullopt;
+
+    auto& record = it->second;
+    auto buffer = File_Buffer::allocate(record.size);
+    if (!stream) {
+        std::memcpy(buffer.data(), record.payload.data(), record.size);
+        return buffer;
+    }
+
+    std::lock_guard<std::mutex> lock(stream_mutex);
+    stream->clear();
+    stream->seekg(static_cast<std::streamoff>(record.offset));
+    stream->read(buffer.data(), record.size);
+    if (static_cast<std::size_t>(stream->gcount()) != record.size) {
+        throw bundle_exception("Failed to read bundled " + filename);
+    }
+    return buffer;
+}
+
+std::vector<std::string> Asset_Bundle::filenames(Record_Type type) const {
+    std::vector<std::string> result;
+    for (auto it = records.lower_bound(std::make_pair(type, std::string{}));
+            it != records.end() && it->first.first == type; ++it) {
+        result.push_back(it->first.second);
+    }
+    return result;
+}
+
+void Asset_Bundle::save(std::ostream& stream) const {
+    Bundle_Writer header;
+    header.write(format_version);
+    header.write(static_cast<std::uint32_t>(records.size()));
+    stream.write(detail::bundle_magic, sizeof(detail::bundle_magic));
+    stream.write(header.get_data().data(), header.get_data().size());
+
+    for (auto& [key, record] : records) {
+        Bundle_Writer writer;
+        writer.write(key.first);
+        writer.write(key.second);
+        writer.write(record.size);
+        stream.write(writer.get_data().data(), writer.get_data().size());
+        auto payload = find(key.first, key.second);
+        stream.write(payload->data(), payload->size());
+    }
+}
+
+std::unique_ptr<Asset_Bundle> Asset_Bundle::load(std::unique_ptr<std::istream> stream) {
+    if (!stream || !*stream) {
+        throw bundle_exception("Invalid asset bundle stream");
+    }
+    stream->seekg(0, std::ios::end);
+    auto length = static_cast<std::uint64_t>(stream->tellg());
+    stream->seekg(0);
+
+    char magic[sizeof(detail::bundle_magic)];
+    if (!stream->read(magic, sizeof(magic))
+            || std::memcmp(magic, detail::bundle_magic, sizeof(magic)) != 0) {
+        throw bundle_exception("Invalid asset bundle header");
+    }
+
+    auto version = detail::read_bundle_value<std::uint32_t>(*stream);
+    if (version != format_version) {
+        throw bundle_exception("Asset bundle version " + std::to_string(version)
+            + " doesn't match expected version " + std::to_string(format_version));
+    }
+
+    // Only read the index, the payloads are skipped and read when needed
+    auto bundle = std::make_unique<Asset_Bundle>();
+    auto count = detail::read_bundle_value<std::uint32_t>(*stream);
+    for (std::uint32_t i = 0; i < count; ++i) {
+        auto type = detail::read_bundle_value<Record_Type>(*stream);
+        auto filename = detail::read_bundle_string(*stream);
+        auto size = detail::read_bundle_value<std::uint32_t>(*stream);
+        auto offset = static_cast<std::uint64_t>(stream->tellg());
+        if (size > length - offset) {
+            throw bundle_exception("Unexpected end of asset bundle");
+        }
+        stream->seekg(static_cast<std::streamoff>(offset + size));
+        bundle->records.emplace(std::make_pair(type, std::move(filename)), Record{ offset, size, {} });
+    }
+
+    if (static_cast<std::uint64_t>(stream->tellg()) != length) {
+        throw bundle_exception("Unexpected data at the end of the asset bundle");
+    }
+
+    bundle->stream = std::move(stream);
+    return bundle;
+}
+
+Asset_Bundle* Asset_Bundle::game_bundle() {
+    if (detail::game_bundle_loaded) {
+        return detail::game_bundle.get();
+    }
+    detail::game_bundle_loaded = true;
+
+    auto filename = Configurations::get<std::string>("game.asset-bundle");
+    auto fs = file_utilities::game_data_filesystem();
+    if (filename.empty() || !fs->exists(filename)) {
+        return nullptr;
+    }
+
+    try {
+        auto stream = fs->open_binary_ifstream(filename);
+        if (!stream || !*stream) {
+            throw file_loading_exception{ "Failed to open asset bundle " + filename };
+        }
+        detail::game_bundle = load(std::move(stream));
+        LOGGER_I << "Loaded asset bundle " << filename << " with "
+            << detail::game_bundle->size() << " records";
+    } catch (std::exception& ex) {
+        // An outdated bundle shouldn't prevent loading the source files
+        LOGGER_W << "Ignoring asset bundle " << filename << ": " << ex.what();
+        detail::game_bundle.reset();
+    }
+
+    return detail::game_bundle.get();
+}
+
+void Asset_Bundle::set_game_bundle(std::unique_ptr<Asset_Bundle> bundle) {
+    detail::game_bundle = std::move(bundle);
+    detail::game_bundle_loaded = true;
+}
@@ -0,0 +1,130 @@
+#ifndef HPP_ASSET_BUNDLE
+#define HPP_ASSET_BUNDLE
+
+#include "filesystem/file_buffer.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Values that can be copied byte by byte (glm types aren't trivially copyable)
+template<typename T>
+inline constexpr bool is_bundle_value_v = std::is_standard_layout_v<T>
+    && std::is_trivially_destructible_v<T> && !std::is_pointer_v<T>;
+
+// Appends binary values to an asset bundle record
+class Bundle_Writer {
+public:
+    template<typename T>
+    void write(const T& value) {
+        static_assert(is_bundle_value_v<T>, "Only plain values can be written directly");
+        data.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+    void write(const std::string& value) {
+        write(static_cast<std::uint32_t>(value.size()));
+        data.append(value);
+    }
+    void write(const char* value) {
+        write(std::string{value});
+    }
+    template<typename T>
+    void write(const std::vector<T>& values) {
+        static_assert(is_bundle_value_v<T>, "Only plain values can be written directly");
+        write(static_cast<std::uint32_t>(values.size()));
+        data.append(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T));
+    }
+    const std::string& get_data() const { return data; }
+private:
+    std::string data;
+};
+
+// Reads binary values from an asset bundle record
+class Bundle_Reader {
+public:
+    explicit Bundle_Reader(std::string_view data) : data(data), position(0) {}
+    explicit Bundle_Reader(const File_Buffer& buffer) : data(buffer.view()), position(0) {}
+    template<typename T>
+    T read() {
+        static_assert(is_bundle_value_v<T>, "Only plain values can be read directly");
+        T value;
+        read_bytes(&value, sizeof(T));
+        return value;
+    }
+    std::string read_string() {
+        auto size = read<std::uint32_t>();
+        std::string value(size, '\0');
+        read_bytes(value.data(), size);
+        return value;
+    }
+    template<typename T>
+    std::vector<T> read_vector() {
+        auto size = read<std::uint32_t>();
+        std::vector<T> values(size);
+        read_bytes(values.data(), size * sizeof(T));
+        return values;
+    }
+    bool at_end() const { return position == data.size(); }
+private:
+    // Throws a bundle_exception when reading past the end of the record
+    void read_bytes(void* destination, std::size_t size);
+    std::string_view data;
+    std::size_t position;
+};
+
+// Precompiled maps, tilesets, sprites, scripts and decoded images, produced
+// by the asset packer tool and keyed by their source filename
+class Asset_Bundle {
+public:
+    enum class Record_Type : std::uint8_t {
+        IMAGE = 1,
+        SPRITE = 2,
+        TILESET = 3,
+        MAP = 4,
+        // Lua bytecode, only used if it matches the engine's Lua version
+        SCRIPT = 5
+    };
+    // Increased whenever the layout of a record changes
+    static constexpr std::uint32_t format_version = 1;
+    // Add or replace a record
+    void add(Record_Type type, std::string filename, std::string payload);
+    bool contains(Record_Type type, std::string filename) const;
+    // Read the record payload, or nullopt if the bundle doesn't have it. Records
+    // of a loaded bundle are read from its stream on demand, so drop the buffer
+    // once the asset is built from it
+    std::optional<File_Buffer> find(Record_Type type, std::string filename) const;
+    // Get the filenames of all records of a type
+    std::vector<std::string> filenames(Record_Type type) const;
+    std::size_t size() const { return records.size(); }
+    // Write the bundle to a stream
+    void save(std::ostream& stream) const;
+    // Read the index of a bundle, throws a bundle_exception if it's invalid or
+    // outdated. The bundle keeps the (seekable) stream to read the records from
+    static std::unique_ptr<Asset_Bundle> load(std::unique_ptr<std::istream> stream);
+    // Get the bundle specified by game.asset-bundle, loaded on first use.
+    // Returns nullptr if the game doesn't have one
+    static Asset_Bundle* game_bundle();
+    // Override the game bundle (nullptr to only use source files)
+    static void set_game_bundle(std::unique_ptr<Asset_Bundle> bundle);
+private:
+    struct Record {
+        // Position of the payload in the stream, for records of a loaded bundle
+        std::uint64_t offset;
+        std::uint32_t size;
+        // Payload of records added in memory
+        std::string payload;
+    };
+    std::map<std::pair<Record_Type, std::string>, Record> records;
+    std::unique_ptr<std::istream> stream;
+    // Records can be read from loading threads
+    mutable std::mutex stream_mutex;
+};
+
+#endif
@@ -6,8 +6,14 @@
 #include "utility/file.hpp"
 #include "utility/string.hpp"
 #include "xd/audio.hpp"
+#include <algorithm>
 #include <stdexcept>
 
+namespace detail {
+    // Unplayed preloads hold an open stream each, keep only the latest few
+    static constexpr std::size_t max_preloaded_music = 4;
+}
+
 Audio_Player::Audio_Player(std::shared_ptr<xd::audio> audio)
         : audio(audio),
         audio_folder(Configurations::get<std::string>("audio.audio-folder")),
@@ -24,6 +30,15 @@ Audio_Player::Audio_Player(std::shared_ptr<xd::audio> audio)
     set_global_music_volume(Configurations::get<float>("audio.music-volume"));
     set_global_sound_volume(Configurations::get<float>("audio.sound-volume"));
 
+    // Voices used by sprite frame sounds
+    if (audio) {
+        auto& sound_bank = audio->get_sound_bank();
+        sound_bank.set_voice_count(static_cast<std::size_t>(
+            std::max(Configurations::get<int>("audio.sprite-voices"), 0)));
+        sound_bank.set_voices_per_sound(static_cast<std::size_t>(
+            std::max(Configurations::get<int>("audio.sprite-voices-per-sound"), 0)));
+    }
+
     // Cache default sounds
     load_global_config_sound("audio.choice-select-sfx", 3, false);
     load_global_config_sound("audio.choice-confirm-sfx", 3, false);
@@ -52,10 +67,54 @@ std::shared_ptr<xd::music> Audio_Player::load_music(Map& current_map, const std:
 }
 
 void Audio_Player::load_map_audio(Map& map) {
+    // Sounds only the previous map used aren't needed anymore
+    if (audio) {
+        audio->get_sound_bank().release_unused();
+    }
     load_audio_from_map_prop(map, "cached-music", true);
     load_audio_from_map_prop(map, "cached-sounds", false);
 }
 
+void Audio_Player::preload_music(const std::string& filename) {
+    if (!audio || filename.empty() || filename == "false" || is_music_preloaded(filename)) return;
+
+    if (preload_order.size() >= detail::max_preloaded_music) {
+        preloaded_music.erase(preload_order.front());
+        preload_order.pop_front();
+    }
+
+    LOGGER_D << "Preloading music file: " << filename;
+    auto fs = get_audio_filesystem();
+    auto full_name = audio_folder + filename;
+    // Opening the file and reading its loop tags happens on the worker,
+    // the audio handle and filesystems are thread safe
+    preloaded_music.emplace(filename, std::async(std::launch::async, [audio = audio, fs, full_name]() {
+        return std::make_shared<xd::music>(*audio, full_name, fs->open_binary_ifstream(full_name));
+    }));
+    preload_order.push_back(filename);
+}
+
+void Audio_Player::clear_preloaded_music() {
+    preloaded_music.clear();
+    preload_order.clear();
+}
+
+std::shared_ptr<xd::music> Audio_Player::open_music(const std::string& filename) {
+    auto preloaded = preloaded_music.find(filename);
+    if (preloaded != preloaded_music.end()) {
+        auto future = std::move(preloaded->second);
+        preloaded_music.erase(preloaded);
+        preload_order.erase(std::find(preload_order.begin(), preload_order.end(), filename));
+        LOGGER_D << "Using preloaded music file: " << filename;
+        // Waits if it's still loading, rethrows if loading failed
+        return future.get();
+    }
+
+    auto fs = get_audio_filesystem();
+    auto full_name = audio_folder + filename;
+    return std::make_shared<xd::music>(*audio, full_name, fs->open_binary_ifstream(full_name));
+}
+
 std::shared_ptr<xd::music> Audio_Player::play_music_or_ambient(bool is_music, Map& current_map, std::optional<float> volume) {
     std::string map_filename = is_music
         ? current_map.get_bg_music_filename()
@@ -99,10 +158,7 @@ std::shared_ptr<xd::music> Audio_Player::play_music_or_ambient(bool is_music, Ma
         new_music = load_music(current_map, filename);
         LOGGER_D << "Playing cached music file: " << filename;
     } else {
-        auto fs = get_audio_filesystem();
-        auto full_name = audio_folder + filename;
-        new_music = std::make_shared<xd::music>(*audio, full_name,
-            fs->open_binary_ifstream(full_name));
+        new_music = open_music(filename);
         LOGGER_D << "Playing non-cached music file: " << filename;
     }
 
@@ -253,9 +309,12 @@ std::shared_ptr<xd::sound> Audio_Player::load_sound(Audio_Cache& cache, const st
 
     auto full_name = audio_folder + filename;
     auto fs = get_audio_filesystem();
+    // Channels are instances of a single decoded sound, shared across maps
+    auto source = audio->get_sound_bank().load(full_name, [fs, &full_name]() {
+        return fs->open_binary_ifstream(full_name);
+    });
     for (unsigned int i = 0; i < channel_count - old_count; ++i) {
-        sounds.emplace_back(std::make_shared<xd::sound>(*audio, full_name,
-            fs->open_binary_ifstream(full_name), group_type));
+        sounds.emplace_back(std::make_shared<xd::sound>(*audio, *source, group_type));
     }
 
     return sounds.back();
@@ -267,10 +326,7 @@ std::shared_ptr<xd::music> Audio_Player::load_music(Audio_Cache& cache, const st
     auto& sounds = cache[filename];
     if (sounds.empty()) {
         LOGGER_D << "Loading music file: " << filename;
-        auto fs = get_audio_filesystem();
-        auto full_name = audio_folder + filename;
-        sounds.emplace_back(std::make_shared<xd::music>(*audio, full_name,
-            fs->open_binary_ifstream(full_name)));
+        sounds.emplace_back(open_music(filename));
     }
 
     return std::dynamic_pointer_cast<xd::music>(sounds.back());
@@ -2,6 +2,8 @@
 #define HPP_AUDIO_PLAYER
 
 #include <string>
+#include <deque>
+#include <future>
 #include <memory>
 #include <unordered_map>
 #include <vector>
@@ -20,6 +22,8 @@ namespace xd {
 
 class Audio_Player {
 public:
+    Audio_Player(const Audio_Player&) = delete;
+    Audio_Player& operator=(const Audio_Player&) = delete;
     Audio_Player(std::shared_ptr<xd::audio> audio);
     // Load a sound globally
     std::shared_ptr<xd::sound> load_global_sound(const std::string& filename,
@@ -39,6 +43,15 @@ public:
     std::shared_ptr<xd::music> load_music(Map& current_map, const std::string& filename);
     // Load and cache map audio
     void load_map_audio(Map& map);
+    // Start loading music or ambient in the background, e.g. the next map's music,
+    // so playing it later doesn't have to wait for the file to be opened
+    void preload_music(const std::string& filename);
+    // Is the music being preloaded or ready to play?
+    bool is_music_preloaded(const std::string& filename) const {
+        return preloaded_music.find(filename) != preloaded_music.end();
+    }
+    // Drop preloaded music that wasn't played
+    void clear_preloaded_music();
     // Get audio system pointer
     xd::audio* get_audio() { return audio.get(); }
     // Get the active channel group for sound effects
@@ -108,15 +121,21 @@ private:
     std::shared_ptr<xd::sound> load_sound(Audio_Cache& cache, const std::string& key,
         const std::string& filename, unsigned int channel_count = 1, bool pausable = true);
     std::shared_ptr<xd::music> load_music(Audio_Cache& cache, const std::string& filename);
+    // Open music on the calling thread, or take it from the preloaded music
+    std::shared_ptr<xd::music> open_music(const std::string& filename);
     void load_audio_from_map_prop(Map& current_map, const std::string& prop_name, bool is_music);
     std::shared_ptr<xd::music> play_music_or_ambient(bool is_music, Map& current_map, std::optional<float> volume);
     std::shared_ptr<xd::music> play_music_or_ambient(bool is_music, Map& current_map, const std::string& filename,
         bool looping, std::optional<float> volume);
     std::shared_ptr<xd::music> play_music_or_ambient(bool is_music, const std::shared_ptr<xd::music>& new_music, bool looping);
+    // Declared first so the audio system outlives the sounds below
+    std::shared_ptr<xd::audio> audio;
     std::shared_ptr<xd::music> music;
     std::shared_ptr<xd::music> ambient;
-    std::shared_ptr<xd::audio> audio;
     Audio_Cache global_cache;
+    // Music loading in the background, by filename, oldest first
+    std::unordered_map<std::string, std::future<std::shared_ptr<xd::music>>> preloaded_music;
+    std::deque<std::string> preload_order;
     std::string audio_folder;
     bool audio_folder_path_is_absolute;
     // was music already paused when game got paused?
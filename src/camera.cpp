@@ -5,10 +5,12 @@
 #include "log.hpp"
 #include "map/map.hpp"
 #include "map/map_object.hpp"
+#include "profiler.hpp"
 #include "sprite.hpp"
 #include "utility/color.hpp"
 #include "utility/file.hpp"
 #include "utility/math.hpp"
+#include "xd/graphics/gl_state.hpp"
 #include "xd/graphics/shaders.hpp"
 #include "xd/graphics/transform_geometry.hpp"
 #include "xd/graphics/vertex_batch.hpp"
@@ -28,7 +30,7 @@ struct Camera::Impl {
         , default_scale_mode(default_scale_mode) {}
     // Update OpenGL viewport
     void update_viewport(xd::rect viewport, xd::vec2 shake_offset = xd::vec2{0.0f}) const {
-        glViewport(static_cast<int>(viewport.x + shake_offset.x),
+        xd::gl_state::viewport(static_cast<int>(viewport.x + shake_offset.x),
             static_cast<int>(viewport.y + shake_offset.y),
             static_cast<int>(viewport.w),
             static_cast<int>(viewport.h));
@@ -50,16 +52,18 @@ struct Camera::Impl {
         float brightness, float contrast, float saturation);
     // Update OpenGL claer color
     void set_gl_clear_color(const xd::vec4& color) {
+        if (xd::gl_state::is_headless()) return;
         glClearColor(color.r, color.g, color.b, color.a);
     }
     // Setup OpenGL state
     void setup_opengl() {
+        if (xd::gl_state::is_headless()) return;
         set_gl_clear_color(default_clear_color);
-        glEnable(GL_ALPHA_TEST);
+        xd::gl_state::enable(GL_ALPHA_TEST);
         glAlphaFunc(GL_GREATER, 0.0f);
-        glEnable(GL_BLEND);
-        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-        glActiveTexture(GL_TEXTURE0);
+        xd::gl_state::enable(GL_BLEND);
+        xd::gl_state::blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        xd::gl_state::active_texture(GL_TEXTURE0);
     }
     // Draw a quad (for screen tint)
     struct quad_vertex {
@@ -165,6 +169,8 @@ void Camera::Impl::draw_quad(xd::mat4 mvp, xd::rect rect,
 Camera::Camera(Game& game, const std::string& default_scale_mode)
         : game(game)
         , position(0.0f, 0.0f)
+        , previous_position(0.0f, 0.0f)
+        , render_position(0.0f, 0.0f)
         , screen_tint(hex_to_color(Configurations::get<std::string>("startup.tint-color")))
         , brightness(Configurations::get<float>("graphics.brightness"))
         , contrast(Configurations::get<float>("graphics.contrast"))
@@ -196,7 +202,8 @@ void Camera::set_size(int width, int height, bool force) {
 }
 
 xd::rect Camera::calculate_viewport(int width, int height) {
-    auto scale_mode = Configurations::get<std::string>("graphics.scale-mode");
+    static const Configurations::Handle<std::string> configured_scale_mode("graphics.scale-mode");
+    auto scale_mode = configured_scale_mode.get();
     const auto screen_width = static_cast<float>(width);
     const auto screen_height = static_cast<float>(height);
     const auto game_width = static_cast<float>(game.game_width(false));
@@ -308,6 +315,15 @@ xd::vec2 Camera::get_bounded_position(xd::vec2 pos) const {
 
 void Camera::set_position(xd::vec2 pos) {
     position = get_bounded_position(pos);
+    previous_position = position;
+}
+
+void Camera::move(xd::vec2 offset) {
+    position = get_bounded_position(position + offset);
+}
+
+void Camera::update_render_position(float alpha) {
+    render_position = xd::round(lerp(previous_position, position, alpha));
 }
 
 void Camera::draw_rect(xd::rect rect, xd::vec4 color, bool fill) const {
@@ -326,15 +342,15 @@ void Camera::enable_scissor_test(xd::rect rect, xd::rect custom_viewport) {
     const xd::vec2 scale{custom_viewport.w / game_width,
                          custom_viewport.h / game_height};
 
-    glEnable(GL_SCISSOR_TEST);
-    glScissor(static_cast<int>(custom_viewport.x + rect.x * scale.x),
-             static_cast<int>(custom_viewport.y + y * scale.y),
-             static_cast<int>(rect.w * scale.x),
-             static_cast<int>(rect.h * scale.y));
+    xd::gl_state::enable(GL_SCISSOR_TEST);
+    xd::gl_state::scissor(static_cast<int>(custom_viewport.x + rect.x * scale.x),
+        static_cast<int>(custom_viewport.y + y * scale.y),
+        static_cast<int>(rect.w * scale.x),
+        static_cast<int>(rect.h * scale.y));
 }
 
 void Camera::disable_scissor_test() {
-    glDisable(GL_SCISSOR_TEST);
+    xd::gl_state::disable(GL_SCISSOR_TEST);
 }
 
 void Camera::set_shader(const std::string& vertex, const std::string& fragment) {
@@ -342,6 +358,7 @@ void Camera::set_shader(const std::string& vertex, const std::string& fragment)
 }
 
 void Camera::render_shader() {
+    PROFILE_ZONE("Camera::render_shader");
     pimpl->render_shader(game, viewport, geometry, brightness, contrast, saturation);
 }
 
@@ -372,12 +389,13 @@ void Camera::draw_map_tint() const {
     const auto width = static_cast<float>(game.game_width());
     const auto height = static_cast<float>(game.game_height());
 
-    auto cam_pos = get_pixel_position();
+    auto cam_pos = get_render_position();
     const xd::rect rect{cam_pos.x, cam_pos.y, width, height};
     draw_rect(rect, map_tint);
 }
 
 void Camera_Renderer::render(Camera& camera) {
+    PROFILE_ZONE("Camera_Renderer::render");
     camera.clear();
 
     const auto width = static_cast<float>(game.game_width());
@@ -388,7 +406,8 @@ void Camera_Renderer::render(Camera& camera) {
     geometry.projection().load(xd::ortho<float>(0, width, height, 0, -1, 1));
 
     geometry.model_view().identity();
-    const auto cam_pos = camera.get_pixel_position();
+    camera.update_render_position(game.interpolation_alpha());
+    const auto cam_pos = camera.get_render_position();
     geometry.model_view().translate(-cam_pos.x, -cam_pos.y, 0);
 
     if (camera.is_shaking()) {
@@ -425,8 +444,8 @@ Screen_Shaker::Screen_Shaker(xd::vec2 strength, xd::vec2 speed)
 
 void Screen_Shaker::change_settings(xd::vec2 new_strength, xd::vec2 new_speed) {
     strength = new_strength;
-    const auto logic_fps = Configurations::get<int>("graphics.logic-fps", "debug.logic-fps");
-    speed = new_speed * (60.0f / logic_fps);
+    static const Configurations::Handle<int> logic_fps("graphics.logic-fps", "debug.logic-fps");
+    speed = new_speed * (60.0f / logic_fps.get());
 
     // Prevents changing direction twice if offset was already over the strength limit
     offset.x = std::max(-strength.x * 2, std::min(strength.x * 2, offset.x));
@@ -46,8 +46,11 @@ public:
     xd::rect get_position_bounds() const;
     // Get position within camera bounds
     xd::vec2 get_bounded_position(xd::vec2 pos) const;
-    // Update position within map bounds
+    // Update position within map bounds. Setting the position directly
+    // teleports the camera, so it isn't interpolated
     void set_position(xd::vec2 pos);
+    // Move the camera by the given offset within map bounds
+    void move(xd::vec2 offset);
     // Draw a rectangle
     void draw_rect(xd::rect rect, xd::vec4 color, bool fill = true) const;
     // Tint the screen with the map tint color
@@ -75,6 +78,16 @@ public:
     xd::vec2 get_pixel_position() const {
         return xd::round(position);
     }
+    // Called at the start of every logic step
+    void store_previous_position() {
+        previous_position = position;
+    }
+    // Place the rendered camera between the previous and the current logic step
+    void update_render_position(float alpha);
+    // Rounded position used while rendering the current frame
+    xd::vec2 get_render_position() const {
+        return render_position;
+    }
     xd::rect get_viewport() const {
         return viewport;
     }
@@ -147,6 +160,10 @@ private:
     Game& game;
     // Camera position
     xd::vec2 position;
+    // Position before the current logic step
+    xd::vec2 previous_position;
+    // Interpolated position for the frame being rendered
+    xd::vec2 render_position;
     // Current viewport rectangle
     xd::rect viewport;
     // Last calculated viewport
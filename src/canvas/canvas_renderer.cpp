@@ -5,7 +5,9 @@
 #include "../configurations.hpp"
 #include "../game.hpp"
 #include "../map/map.hpp"
+#include "../profiler.hpp"
 #include "../utility/math.hpp"
+#include "../xd/graphics/gl_state.hpp"
 
 Canvas_Renderer::Canvas_Renderer(Game& game, Camera& camera)
     : game(game)
@@ -20,6 +22,7 @@ Canvas_Renderer::Canvas_Renderer(Game& game, Camera& camera)
 {}
 
 void Canvas_Renderer::render(Map& map) {
+    PROFILE_ZONE("Canvas_Renderer::render");
     camera.draw_map_tint();
 
     auto& canvases = map.get_canvases();
@@ -68,7 +71,7 @@ void Canvas_Renderer::setup_framebuffer(const Base_Canvas& canvas) {
     camera.clear_color_buffer();
     camera.set_clear_color(old_color);
 
-    glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA,
+    xd::gl_state::blend_func_separate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA,
         GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
 
     if (!has_scissor_box) return;
@@ -87,13 +90,13 @@ void Canvas_Renderer::render_framebuffer(const Base_Canvas& canvas, const Base_C
         camera.disable_scissor_test();
     }
 
-    glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+    xd::gl_state::blend_func(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
 
     float x = 0.0f, y = 0.0f;
     if (!canvas.is_camera_relative()) {
         // Since the camera might have moved since last draw, we need to update
         // the position of non-camera-relative canvases
-        auto camera_pos = camera.get_pixel_position();
+        auto camera_pos = camera.get_render_position();
         auto last_pos = canvas.get_last_camera_position();
         x = last_pos.x - camera_pos.x;
         y = camera_pos.y - last_pos.y;
@@ -113,7 +116,7 @@ void Canvas_Renderer::render_framebuffer(const Base_Canvas& canvas, const Base_C
 
     draw(geometry.mvp(), root);
 
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    xd::gl_state::blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 }
 
 void Canvas_Renderer::render_canvas(Base_Canvas& canvas, Base_Canvas* parent, Base_Canvas* root) {
@@ -142,7 +145,7 @@ void Canvas_Renderer::render_canvas(Base_Canvas& canvas, Base_Canvas* parent, Ba
     if (redraw) {
         if (using_fbo) {
             setup_framebuffer(canvas);
-            canvas.set_last_camera_position(camera.get_pixel_position());
+            canvas.set_last_camera_position(camera.get_render_position());
         }
 
         if (is_text && !batch.empty()) {
@@ -193,7 +196,7 @@ void Canvas_Renderer::render_background(Base_Canvas& canvas, Base_Canvas* parent
     }
 
     if (canvas.is_camera_relative()) {
-        auto camera_pos = camera.get_pixel_position();
+        auto camera_pos = camera.get_render_position();
         rect.x += camera_pos.x;
         rect.y += camera_pos.y;
     }
@@ -1,8 +1,10 @@
 #include "canvas_updater.hpp"
 #include "base_canvas.hpp"
 #include "../map/map.hpp"
+#include "../profiler.hpp"
 
 void Canvas_Updater::update(Map& map) {
+    PROFILE_ZONE("Canvas_Updater::update");
     auto& canvases = map.get_canvases();
     for (auto& weak_canvas : canvases) {
         auto canvas = weak_canvas.ptr.lock();
@@ -40,7 +40,7 @@ void Image_Canvas::set_image(std::string image_filename, xd::vec4 trans, xd::ass
 void Image_Canvas::render(Camera& camera, xd::sprite_batch& batch, Base_Canvas* parent) {
     xd::vec2 pos = get_position();
     if (is_camera_relative()) {
-        auto camera_pos = camera.get_pixel_position();
+        auto camera_pos = camera.get_render_position();
         pos += camera_pos;
     }
     if (parent) {
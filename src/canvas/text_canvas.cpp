@@ -90,7 +90,7 @@ void Text_Canvas::render(Camera& camera, xd::sprite_batch&, Base_Canvas* parent)
     style->color().a = get_opacity();
     auto& lines = get_lines();
     xd::vec2 pos = get_position();
-    auto camera_pos = camera.get_pixel_position();
+    auto camera_pos = camera.get_render_position();
 
     if (parent) {
         pos += parent->get_position();
@@ -1,13 +1,13 @@
 #include "clock.hpp"
 #include "game.hpp"
 
-Clock::Clock(Game& game) : game(game), start_time(game.ticks()), time_stop(false),
-    stop_start_time(0), total_stopped_time(0) {}
+Clock::Clock(Game& game) : game(game), start_time(game.game_time()), time_stop(false),
+    stop_start_time(0.0), total_stopped_time(0.0) {}
 
 void Clock::stop_time() {
     if (time_stop) return;
 
-    stop_start_time = game.ticks();
+    stop_start_time = game.game_time();
     time_stop = true;
 }
 
@@ -15,12 +15,12 @@ void Clock::resume_time() {
     if (!time_stop) return;
 
     time_stop = false;
-    total_stopped_time += game.ticks() - stop_start_time;
+    total_stopped_time += game.game_time() - stop_start_time;
 }
 
 float Clock::seconds() const {
-    auto ticks = game.ticks();
-    int stopped_time = total_stopped_time +
-        (time_stop ? ticks - stop_start_time : 0);
-    return (ticks - stopped_time - start_time) / 1000.0f;
+    auto time = game.game_time();
+    auto stopped_time = total_stopped_time +
+        (time_stop ? time - stop_start_time : 0.0);
+    return static_cast<float>(time - stopped_time - start_time);
 }
@@ -16,10 +16,11 @@ public:
     float seconds() const;
 private:
     Game& game;
-    int start_time;
+    // Game times in seconds
+    double start_time;
     bool time_stop;
-    int stop_start_time;
-    int total_stopped_time;
+    double stop_start_time;
+    double total_stopped_time;
 };
 
 #endif
@@ -6,7 +6,7 @@ class Map;
 class Command {
 public:
     Command() noexcept : stopped(false), force_stopped(false),
-        paused(false), map_ptr(nullptr) {}
+        paused(false), queued(false), map_ptr(nullptr) {}
     // Called while the command isn't completed
     virtual void execute() = 0;
     // Version with specific time
@@ -31,6 +31,9 @@ public:
     virtual void resume() { paused = false; }
     // Is the command paused
     virtual bool is_paused() const { return paused;  }
+    // Is the command waiting in a scripting interface to be executed
+    bool is_queued() const { return queued; }
+    void set_queued(bool queued) { this->queued = queued; }
     // Get the map associated with the command, if any
     const Map* get_map_ptr() const { return map_ptr; }
     // Virtual destructor
@@ -39,6 +42,7 @@ protected:
     bool stopped;
     bool force_stopped;
     bool paused;
+    bool queued;
     Map* map_ptr;
 };
 
@@ -0,0 +1,80 @@
+#ifndef HPP_COMMAND_ALLOCATOR
+#define HPP_COMMAND_ALLOCATOR
+
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Recycles the memory of destroyed commands through a free list per
+// allocated type, so scripts spawning many short commands don't keep
+// going back to the global allocator. The free lists aren't synchronized:
+// commands must be created and destroyed on the main thread (the one that
+// runs scripts), which debug builds assert
+template<typename T>
+class Command_Allocator {
+public:
+    typedef T value_type;
+    // Blocks kept around per type
+    static constexpr std::size_t max_free_blocks = 256;
+
+    Command_Allocator() noexcept = default;
+    template<typename U>
+    Command_Allocator(const Command_Allocator<U>&) noexcept {}
+
+    T* allocate(std::size_t count) {
+        check_thread();
+        auto& blocks = free_blocks();
+        if (count != 1 || blocks.empty()) {
+            return static_cast<T*>(::operator new(count * sizeof(T)));
+        }
+        auto block = blocks.back();
+        blocks.pop_back();
+        return static_cast<T*>(block);
+    }
+
+    void deallocate(T* pointer, std::size_t count) noexcept {
+        check_thread();
+        auto& blocks = free_blocks();
+        if (count != 1 || blocks.size() >= max_free_blocks) {
+            ::operator delete(pointer);
+            return;
+        }
+        blocks.push_back(pointer);
+    }
+
+    template<typename U>
+    bool operator==(const Command_Allocator<U>&) const noexcept { return true; }
+    template<typename U>
+    bool operator!=(const Command_Allocator<U>&) const noexcept { return false; }
+private:
+    // Fail loudly instead of corrupting the free list when a command is
+    // made or released off the thread that first used it
+    static void check_thread() noexcept {
+#ifndef NDEBUG
+        static const auto owner = std::this_thread::get_id();
+        assert(owner == std::this_thread::get_id() && "Commands must stay on the main thread");
+#endif
+    }
+
+    static std::vector<void*>& free_blocks() {
+        // Never destroyed, commands can outlive static destruction through Lua
+        static auto blocks = [] {
+            auto blocks = new std::vector<void*>();
+            blocks->reserve(max_free_blocks);
+            return blocks;
+        }();
+        return *blocks;
+    }
+};
+
+// Create a shared command whose memory (including the reference count) is recycled
+template<typename T, typename ... Args>
+std::shared_ptr<T> make_command(Args&& ... args) {
+    return std::allocate_shared<T>(Command_Allocator<T>(), std::forward<Args>(args)...);
+}
+
+#endif
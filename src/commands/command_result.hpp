@@ -18,6 +18,7 @@ public:
     void pause() { command->pause(); }
     void resume() { command->resume(); }
     bool is_paused() const { return command->is_paused(); }
+    const Command* get_command() const { return command.get(); }
 protected:
     std::shared_ptr<Command> command;
 };
@@ -28,8 +28,7 @@ void Move_Camera_Command::execute() {
     if (paused) return;
 
     do {
-        xd::vec2 new_position = camera.get_position() + direction * speed;
-        camera.set_position(new_position);
+        camera.move(direction * speed);
         pixels -= speed;
     } while (stopped && !is_complete());
 }
@@ -48,6 +48,12 @@ struct Show_Text_Command::Impl : Timed_Command {
     xd::vec2 screen_margins;
     // Is the typewriter effect done?
     int typewriter_done;
+    // Action IDs of the buttons used to navigate the text
+    int up_action;
+    int down_action;
+    int action_button;
+    int cancel_button;
+    int pause_button;
 
     explicit Impl(Game& game, Text_Options text_options) :
             Timed_Command(game, text_options.duration),
@@ -62,7 +68,12 @@ struct Show_Text_Command::Impl : Timed_Command {
             screen_margins(
                 static_cast<float>(Configurations::get<int>("text.screen-edge-margin-x")),
                 static_cast<float>(Configurations::get<int>("text.screen-edge-margin-y"))),
-            typewriter_done(false) {
+            typewriter_done(false),
+            up_action(game.action_id("up")),
+            down_action(game.action_id("down")),
+            action_button(game.action_id(Configurations::get<std::string>("controls.action-button"))),
+            cancel_button(game.action_id(Configurations::get<std::string>("controls.cancel-button"))),
+            pause_button(game.action_id(Configurations::get<std::string>("controls.pause-button"))) {
 
         // Load choice sound effects
         auto& audio_player = game.get_audio_player();
@@ -247,9 +258,9 @@ struct Show_Text_Command::Impl : Timed_Command {
         Direction dir = Direction::NONE;
         Direction pressed_dir = Direction::NONE;
 
-        if (game.pressed("down")) {
+        if (game.pressed(down_action)) {
             pressed_dir = Direction::DOWN;
-        } else if (game.pressed("up")) {
+        } else if (game.pressed(up_action)) {
             pressed_dir = Direction::UP;
         }
 
@@ -274,9 +285,9 @@ struct Show_Text_Command::Impl : Timed_Command {
             press_start = 0;
         }
 
-        if (game.triggered("down")) {
+        if (game.triggered(down_action)) {
             dir = Direction::DOWN;
-        } else if (game.triggered("up")) {
+        } else if (game.triggered(up_action)) {
             dir = Direction::UP;
         }
 
@@ -296,10 +307,8 @@ struct Show_Text_Command::Impl : Timed_Command {
 
     // Check if the cancel or pause button were pressed
     std::string cancel_action() {
-        static std::string cancel_button = Configurations::get<std::string>("controls.cancel-button");
         if (options.cancelable && game.triggered_once(cancel_button)) return "cancel";
 
-        static std::string pause_button = Configurations::get<std::string>("controls.pause-button");
         if (game.is_paused() && game.triggered_once(pause_button)) return "pause";
 
         return "";
@@ -350,8 +359,6 @@ struct Show_Text_Command::Impl : Timed_Command {
             return;
         }
 
-        static std::string action_button = Configurations::get<std::string>("controls.action-button");
-
         // Wait for the typewriter effect to finish
         if (options.typewriter_on && !canvas->typewriter_done()) {
             if (options.typewriter_skippable && !paused && game.triggered_once(action_button)) {
@@ -20,8 +20,11 @@ void Configurations::load_defaults() {
     defaults.emplace("game.scripts-folder", Configurations::Default{ std::string{}, false });
     defaults.emplace("game.store-url", Configurations::Default{ std::string{}, false });
     defaults.emplace("game.archive-path", Configurations::Default{ std::string{}, false });
+    defaults.emplace("game.asset-bundle", Configurations::Default{ std::string{"assets.bundle"}, false });
     defaults.emplace("game.icon_base_name", Configurations::Default{ std::string{}, false });
     defaults.emplace("game.icon_sizes", Configurations::Default{ std::string{}, false });
+    defaults.emplace("game.lua-gc-mode", Configurations::Default{ std::string{"incremental"}, false });
+    defaults.emplace("game.lua-gc-budget", Configurations::Default{ 1.0f, false });
 
     defaults.emplace("text.fade-in-duration", Configurations::Default{ 250 });
     defaults.emplace("text.fade-out-duration", Configurations::Default{ 250 });
@@ -48,6 +51,8 @@ void Configurations::load_defaults() {
     defaults.emplace("graphics.aspect-ratio-denominator", Configurations::Default{ -1 });
     defaults.emplace("graphics.maximized-window", Configurations::Default { false });
     defaults.emplace("graphics.logic-fps", Configurations::Default{ 60 });
+    defaults.emplace("graphics.max-logic-steps", Configurations::Default{ 5 });
+    defaults.emplace("graphics.interpolation", Configurations::Default{ true });
     defaults.emplace("graphics.canvas-fps", Configurations::Default{ 40 });
     defaults.emplace("graphics.fullscreen", Configurations::Default{ false });
     defaults.emplace("graphics.vsync", Configurations::Default{ false });
@@ -64,6 +69,8 @@ void Configurations::load_defaults() {
     defaults.emplace("graphics.use-fbo", Configurations::Default{ true });
     defaults.emplace("graphics.postprocessing-enabled", Configurations::Default{ true });
     defaults.emplace("graphics.magnification", Configurations::Default{ 1.0f });
+    defaults.emplace("graphics.atlas-page-size", Configurations::Default{ 1024, false });
+    defaults.emplace("graphics.atlas-max-image-size", Configurations::Default{ 256, false });
 
     defaults.emplace("audio.audio-folder", Configurations::Default{ std::string{}, false });
     defaults.emplace("audio.music-volume", Configurations::Default{ 1.0f });
@@ -73,6 +80,8 @@ void Configurations::load_defaults() {
     defaults.emplace("audio.choice-cancel-sfx", Configurations::Default{ std::string{} });
     defaults.emplace("audio.mute-on-pause", Configurations::Default{ true });
     defaults.emplace("audio.sound-attenuation-factor", Configurations::Default{ 50.0f });
+    defaults.emplace("audio.sprite-voices", Configurations::Default{ 32 });
+    defaults.emplace("audio.sprite-voices-per-sound", Configurations::Default{ 4 });
 
     defaults.emplace("font.default", Configurations::Default{ std::string{}, false });
     defaults.emplace("font.bold", Configurations::Default{ std::string{}, false });
@@ -104,6 +113,9 @@ void Configurations::load_defaults() {
     defaults.emplace("logging.mode", Configurations::Default{ std::string{"truncate"} });
     defaults.emplace("logging.file-count", Configurations::Default{ -1 });
     defaults.emplace("logging.max-file-size-kb", Configurations::Default{ -1 });
+    defaults.emplace("logging.compress-rotated", Configurations::Default{ false });
+    defaults.emplace("logging.queue-size", Configurations::Default{ 8192, false });
+    defaults.emplace("logging.overflow", Configurations::Default{ std::string{"block"}, false });
 
     defaults.emplace("debug.show-fps", Configurations::Default{ true });
     defaults.emplace("debug.show-time", Configurations::Default{ false });
@@ -111,6 +123,12 @@ void Configurations::load_defaults() {
     defaults.emplace("debug.seed-lua-rng", Configurations::Default{ true });
     defaults.emplace("debug.save-signature", Configurations::Default{ 0x7BEDEADu, false });
     defaults.emplace("debug.update-config-files", Configurations::Default{ true });
+    defaults.emplace("debug.headless", Configurations::Default{ false });
+    defaults.emplace("debug.headless-frames", Configurations::Default{ 0 });
+    defaults.emplace("debug.random-seed", Configurations::Default{ -1 });
+    defaults.emplace("debug.record-input", Configurations::Default{ std::string{} });
+    defaults.emplace("debug.replay-input", Configurations::Default{ std::string{} });
+    defaults.emplace("debug.dump-state", Configurations::Default{ std::string{} });
     // Deprecated configurations, use graphics.[config_name] instead
     defaults.emplace("debug.width", Configurations::Default{ 320 });
     defaults.emplace("debug.height", Configurations::Default{ 240 });
@@ -237,6 +255,7 @@ std::vector<std::string> Configurations::parse(std::istream& stream, bool is_def
         }
     }
 
+    ++generation;
     changed_since_save = false;
     if (values.empty()) {
         errors.push_back("Config file was completely empty or invalid");
@@ -7,6 +7,7 @@
 #include <stdexcept>
 #include <string>
 #include <tuple>
+#include <utility>
 #include <unordered_map>
 #include <variant>
 #include <vector>
@@ -52,6 +53,33 @@ public:
 
         return get<T>(name);
     }
+    // A typed option resolved once and then read through a pointer, for hot
+    // paths. It's resolved again only after options are added or changed
+    template<typename T>
+    class Handle {
+    public:
+        explicit Handle(std::string name, std::string fallback = "")
+            : name(std::move(name)), fallback(std::move(fallback)),
+            value(nullptr), generation(0) {}
+        const T& get() const {
+            if (generation != Configurations::generation) {
+                resolve();
+            }
+            return *value;
+        }
+        const std::string& get_name() const noexcept { return name; }
+    private:
+        void resolve() const {
+            auto& key = !has_value(name) && !fallback.empty() && has_value(fallback)
+                ? fallback : name;
+            value = &Configurations::get_reference<T>(key);
+            generation = Configurations::generation;
+        }
+        std::string name;
+        std::string fallback;
+        mutable const T* value;
+        mutable unsigned int generation;
+    };
     // Check if an option exists
     static bool has_value(const std::string& name) {
         return values.find(name) != values.end();
@@ -88,6 +116,7 @@ public:
         }
 
         values[name] = value;
+        ++generation;
 
         for (auto& pair : observers) {
             pair.second(name);
@@ -113,6 +142,7 @@ public:
         }
 
         values[name] = value;
+        ++generation;
 
         if (!exists(name)) {
             add_to_section_order(name);
@@ -129,6 +159,8 @@ private:
             : value(value), modifiable(modifiable) {}
     };
     inline static bool changed_since_save = false;
+    // Incremented whenever a value is written, so handles know to resolve again
+    inline static unsigned int generation = 1;
     // Variable map to store the options
     inline static value_map values;
     // Default values and their properties
@@ -139,6 +171,20 @@ private:
     inline static section_order_list section_order;
     // Observers to be called when the config changes
     inline static std::unordered_map<std::string, callback> observers;
+    // Get a reference to the stored option, like get
+    template<typename T>
+    static const T& get_reference(const std::string& name) {
+        auto value = values.find(name);
+        if (value != values.end()) {
+            return std::get<T>(value->second);
+        }
+        auto default_value = defaults.find(name);
+        if (default_value != defaults.end()) {
+            return std::get<T>(default_value->second.value);
+        }
+
+        throw config_exception(name + " is an invalid config value");
+    }
     // Add an ordered section/keys tuple
     static section_order_list::iterator add_section(const std::string& section, bool should_add) {
         if (!should_add) return section_order.end();
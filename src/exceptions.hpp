@@ -18,6 +18,12 @@ public:
     explicit tmx_exception(const std::string& error) : xml_exception(error) {}
 };
 
+// Invalid or outdated asset bundle
+class bundle_exception : public std::runtime_error {
+public:
+    explicit bundle_exception(const std::string& error) : std::runtime_error(error) {}
+};
+
 // Errors when opening files
 class file_loading_exception : public std::system_error {
 public:
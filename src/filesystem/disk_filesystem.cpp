@@ -35,13 +35,12 @@ std::unique_ptr<std::ostream> Disk_Filesystem::open_ofstream(std::string filenam
 }
 
 std::string Disk_Filesystem::read_file(std::string filename) {
-    auto stream = open_ifstream(filename);
-    if (!stream || !*stream) {
-        throw file_loading_exception("Couldn't open file for reading: " + filename);
-    }
+    return read_file_buffer(filename).str();
+}
 
-    return std::string((std::istreambuf_iterator<char>(*stream)),
-        std::istreambuf_iterator<char>());
+File_Buffer Disk_Filesystem::read_file_buffer(std::string filename) {
+    string_utilities::normalize_slashes(filename);
+    return File_Buffer::map_file(filename);
 }
 
 std::vector<std::string> Disk_Filesystem::directory_content_names(const std::string& path) {
@@ -9,6 +9,7 @@ class Disk_Filesystem : public Writable_Filesystem {
     virtual std::unique_ptr<std::istream> open_binary_ifstream(std::string filename) override;
     virtual std::unique_ptr<std::ostream> open_ofstream(std::string filename, std::ios_base::openmode mode) override;
     virtual std::string read_file(std::string filename) override;
+    virtual File_Buffer read_file_buffer(std::string filename) override;
     virtual std::vector<std::string> directory_content_names(const std::string& path) override;
     virtual std::vector<Path_Info> directory_content_details(const std::string& path) override;
     // Get the file names/details without checking for exceptions, used to implement the versions above
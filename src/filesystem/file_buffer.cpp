@@ -0,0 +1,188 @@
+#include "file_buffer.hpp"
+#include "../exceptions.hpp"
+#include <algorithm>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#ifdef _WIN32
+#include "../vendor/utf8conv.h"
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace detail {
+    // Keeps a few read buffers around so loading many files doesn't keep
+    // allocating (and page faulting) fresh memory
+    class Buffer_Pool {
+    public:
+        struct Buffer {
+            std::unique_ptr<char[]> memory;
+            std::size_t capacity;
+        };
+
+        Buffer acquire(std::size_t size) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                // Smallest free buffer that is big enough
+                auto best = free_buffers.end();
+                for (auto it = free_buffers.begin(); it != free_buffers.end(); ++it) {
+                    if (it->capacity >= size && (best == free_buffers.end() || it->capacity < best->capacity)) {
+                        best = it;
+                    }
+                }
+                if (best != free_buffers.end()) {
+                    auto buffer = std::move(*best);
+                    free_buffers.erase(best);
+                    return buffer;
+                }
+            }
+            return Buffer{ std::unique_ptr<char[]>(new char[size]), size };
+        }
+
+        void release(Buffer buffer) {
+            if (buffer.capacity > max_pooled_capacity) return;
+            std::lock_guard<std::mutex> lock(mutex);
+            if (free_buffers.size() < max_pooled_buffers) {
+                free_buffers.push_back(std::move(buffer));
+            }
+        }
+
+    private:
+        static constexpr std::size_t max_pooled_buffers = 8;
+        static constexpr std::size_t max_pooled_capacity = 16 * 1024 * 1024;
+        std::mutex mutex;
+        std::vector<Buffer> free_buffers;
+    };
+
+    static Buffer_Pool& buffer_pool() {
+        static Buffer_Pool pool;
+        return pool;
+    }
+
+#ifdef _WIN32
+    struct File_Handle {
+        explicit File_Handle(HANDLE handle) : handle(handle) {}
+        ~File_Handle() { if (handle != INVALID_HANDLE_VALUE) CloseHandle(handle); }
+        HANDLE handle;
+    };
+
+    static std::size_t page_size() {
+        SYSTEM_INFO info;
+        GetSystemInfo(&info);
+        return info.dwPageSize;
+    }
+#else
+    struct File_Handle {
+        explicit File_Handle(int handle) : handle(handle) {}
+        ~File_Handle() { if (handle >= 0) ::close(handle); }
+        int handle;
+    };
+
+    static std::size_t page_size() {
+        return static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+    }
+#endif
+
+    // Bytes past the end of the file are zero-filled up to the end of the page,
+    // which gives us the null terminator for free unless the file fills the page
+    static bool should_map(std::size_t size) {
+        return size >= File_Buffer::min_mapped_size && size % page_size() != 0;
+    }
+}
+
+File_Buffer::File_Buffer(char* content, std::size_t length, std::shared_ptr<void> owner, bool mapped)
+    : content(content), length(length), owner(std::move(owner)), mapped(mapped) {}
+
+File_Buffer File_Buffer::allocate(std::size_t size) {
+    auto buffer = detail::buffer_pool().acquire(size + 1);
+    auto memory = buffer.memory.release();
+    auto capacity = buffer.capacity;
+    std::shared_ptr<void> owner(memory, [capacity](void* memory) {
+        detail::buffer_pool().release(detail::Buffer_Pool::Buffer{
+            std::unique_ptr<char[]>(static_cast<char*>(memory)), capacity });
+    });
+    memory[size] = '\0';
+    return File_Buffer{memory, size, std::move(owner), false};
+}
+
+void File_Buffer::truncate(std::size_t size) {
+    if (size >= length) return;
+    length = size;
+    // Mapped pages are private, so this never modifies the file
+    content[length] = '\0';
+}
+
+#ifdef _WIN32
+File_Buffer File_Buffer::map_file(const std::string& path) {
+    detail::File_Handle file{CreateFileW(win32::Utf8ToUtf16(path).c_str(), GENERIC_READ,
+        FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr)};
+    LARGE_INTEGER file_size;
+    if (file.handle == INVALID_HANDLE_VALUE || !GetFileSizeEx(file.handle, &file_size)) {
+        throw file_loading_exception("Couldn't open file for reading: " + path);
+    }
+    auto size = static_cast<std::size_t>(file_size.QuadPart);
+
+    if (detail::should_map(size)) {
+        auto mapping = CreateFileMappingW(file.handle, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+        if (mapping) {
+            auto address = MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+            // The view keeps the mapping alive
+            CloseHandle(mapping);
+            if (address) {
+                std::shared_ptr<void> owner(address, [](void* address) { UnmapViewOfFile(address); });
+                return File_Buffer{static_cast<char*>(address), size, std::move(owner), true};
+            }
+        }
+    }
+
+    auto buffer = allocate(size);
+    std::size_t total = 0;
+    while (total < size) {
+        auto chunk = static_cast<DWORD>(std::min<std::size_t>(size - total, 1 << 30));
+        DWORD read = 0;
+        if (!ReadFile(file.handle, buffer.data() + total, chunk, &read, nullptr)) {
+            throw file_loading_exception("Error while reading file: " + path);
+        }
+        if (read == 0) break;
+        total += read;
+    }
+    buffer.truncate(total);
+    return buffer;
+}
+#else
+File_Buffer File_Buffer::map_file(const std::string& path) {
+    detail::File_Handle file{::open(path.c_str(), O_RDONLY | O_CLOEXEC)};
+    struct stat info;
+    if (file.handle < 0 || ::fstat(file.handle, &info) != 0) {
+        throw file_loading_exception("Couldn't open file for reading: " + path);
+    }
+    auto size = static_cast<std::size_t>(info.st_size);
+
+    if (detail::should_map(size)) {
+        auto address = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, file.handle, 0);
+        if (address != MAP_FAILED) {
+            std::shared_ptr<void> owner(address, [size](void* address) { ::munmap(address, size); });
+            return File_Buffer{static_cast<char*>(address), size, std::move(owner), true};
+        }
+    }
+
+    auto buffer = allocate(size);
+    std::size_t total = 0;
+    while (total < size) {
+        auto read = ::read(file.handle, buffer.data() + total, size - total);
+        if (read < 0) {
+            throw file_loading_exception("Error while reading file: " + path);
+        }
+        if (read == 0) break;
+        total += static_cast<std::size_t>(read);
+    }
+    buffer.truncate(total);
+    return buffer;
+}
+#endif
@@ -0,0 +1,42 @@
+#ifndef HPP_FILE_BUFFER
+#define HPP_FILE_BUFFER
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+
+// File content that is either memory-mapped or read into a pooled buffer.
+// The content is always followed by a null character, and can be modified
+// (mapped pages are copy-on-write), so parsers like rapidxml can use it in place
+class File_Buffer {
+public:
+    File_Buffer() : content(nullptr), length(0), mapped(false) {}
+    // Map the file with the given UTF8 disk path, or read it if it's too small to
+    // be worth mapping. Throws a file_loading_exception if the file can't be opened
+    static File_Buffer map_file(const std::string& path);
+    // Get a buffer from the pool with room for size bytes and the null terminator
+    static File_Buffer allocate(std::size_t size);
+
+    char* data() { return content; }
+    const char* data() const { return content; }
+    std::size_t size() const { return length; }
+    bool empty() const { return length == 0; }
+    bool is_mapped() const { return mapped; }
+    std::string_view view() const { return std::string_view{content, length}; }
+    std::string str() const { return std::string{content, length}; }
+    // Shrink the content, e.g. when fewer bytes than expected were read
+    void truncate(std::size_t size);
+
+    // Files smaller than this are read rather than mapped
+    static constexpr std::size_t min_mapped_size = 64 * 1024;
+private:
+    File_Buffer(char* content, std::size_t length, std::shared_ptr<void> owner, bool mapped);
+    char* content;
+    std::size_t length;
+    // Unmaps the file or returns the buffer to the pool once the last copy is gone
+    std::shared_ptr<void> owner;
+    bool mapped;
+};
+
+#endif
@@ -18,7 +18,7 @@ namespace detail {
 PhysFS_Filesystem::PhysFS_Filesystem(std::string_view arg, std::string_view archive_name) {
     PhysFS::init(std::string{ arg }.c_str());
 
-    auto base_dir = PhysFS::getBaseDir();
+    base_dir = PhysFS::getBaseDir();
     string_utilities::normalize_slashes(base_dir);
 
     if (string_utilities::ends_with(base_dir, "Debug/")
@@ -48,13 +48,41 @@ std::unique_ptr<std::istream> PhysFS_Filesystem::open_binary_ifstream(std::strin
 }
 
 std::string PhysFS_Filesystem::read_file(std::string filename) {
-    auto stream = open_binary_ifstream(filename);
-    if (!stream || !*stream) {
+    return read_file_buffer(filename).str();
+}
+
+File_Buffer PhysFS_Filesystem::read_file_buffer(std::string filename) {
+    auto clean = detail::clean_relative_path(filename);
+    auto real_dir = PHYSFS_getRealDir(clean.c_str());
+    if (!real_dir) {
         throw file_loading_exception("Couldn't open file for reading: " + filename);
     }
 
-    return std::string((std::istreambuf_iterator<char>(*stream)),
-        std::istreambuf_iterator<char>());
+    // Loose files next to the executable can be mapped directly
+    if (real_dir == base_dir) {
+        auto relative = string_utilities::starts_with(clean, "/") ? clean.substr(1) : clean;
+        return File_Buffer::map_file(base_dir + relative);
+    }
+
+    // Archive entries might be compressed, read the whole entry at once
+    auto file = PHYSFS_openRead(clean.c_str());
+    if (!file) {
+        throw file_loading_exception("Couldn't open file for reading: " + filename);
+    }
+    auto length = PHYSFS_fileLength(file);
+    if (length < 0) {
+        PHYSFS_close(file);
+        throw file_loading_exception("Couldn't get the size of file: " + filename);
+    }
+
+    auto buffer = File_Buffer::allocate(static_cast<std::size_t>(length));
+    auto read = PHYSFS_readBytes(file, buffer.data(), static_cast<PHYSFS_uint64>(length));
+    PHYSFS_close(file);
+    if (read < 0) {
+        throw file_loading_exception("Error while reading file: " + filename);
+    }
+    buffer.truncate(static_cast<std::size_t>(read));
+    return buffer;
 }
 
 bool PhysFS_Filesystem::exists(const std::string& path) {
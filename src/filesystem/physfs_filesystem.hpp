@@ -12,6 +12,7 @@ public:
     virtual std::unique_ptr<std::istream> open_ifstream(std::string filename, std::ios_base::openmode mode = std::ios_base::in) override;
     virtual std::unique_ptr<std::istream> open_binary_ifstream(std::string filename) override;
     virtual std::string read_file(std::string filename) override;
+    virtual File_Buffer read_file_buffer(std::string filename) override;
     virtual bool exists(const std::string& path) override;
     virtual bool is_regular_file(const std::string& path) override;
     virtual bool is_directory(const std::string& path) override;
@@ -23,6 +24,9 @@ public:
     virtual std::string extension(const std::string& path) override;
     virtual std::vector<std::string> directory_content_names(const std::string& path) override;
     virtual std::vector<Path_Info> directory_content_details(const std::string& path) override;
+private:
+    // The executable's folder, mounted after the archive
+    std::string base_dir;
 };
 
 #endif
@@ -1,6 +1,7 @@
 #ifndef HPP_READABLE_FILESYSTEM
 #define HPP_READABLE_FILESYSTEM
 
+#include "file_buffer.hpp"
 #include "path_info.hpp"
 #include <cstdint>
 #include <ctime>
@@ -22,6 +23,8 @@ public:
     virtual bool exists(const std::string& path) = 0;
     // Read file content into a string
     virtual std::string read_file(std::string filename) = 0;
+    // Read file content without extra copies (memory-mapped when possible)
+    virtual File_Buffer read_file_buffer(std::string filename) = 0;
     // Check if path is a regular file (not directory or any other type of file)
     virtual bool is_regular_file(const std::string& path) = 0;
     // Check if path is a directory
@@ -6,19 +6,31 @@
 #include "decorators/typewriter_decorator.hpp"
 #include "exceptions.hpp"
 #include "game.hpp"
+#include "input_replay.hpp"
 #include "key_binder.hpp"
 #include "map/map.hpp"
 #include "map/map_object.hpp"
 #include "player_controller.hpp"
+#include "profiler.hpp"
 #include "scripting/scripting_interface.hpp"
 #include "utility/color.hpp"
+#include "utility/direction.hpp"
 #include "utility/file.hpp"
 #include "utility/string.hpp"
 #include "xd/graphics/font.hpp"
+#include "xd/graphics/gl_state.hpp"
 #include "xd/graphics/image.hpp"
 #include "xd/graphics/stock_text_formatter.hpp"
 #include "xd/graphics/text_renderer.hpp"
 #include "xd/lua/virtual_machine.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <ctime>
+#include <iomanip>
+#include <limits>
+#include <map>
+#include <ostream>
+#include <sstream>
 #include <stdexcept>
 #include <unordered_set>
 
@@ -30,14 +42,16 @@ struct Game::Impl {
             audio_player(audio),
             environment(environment),
             editor_mode(editor_mode),
+            lua_gc_budget(Configurations::get<float>("game.lua-gc-budget")),
+            interpolation(Configurations::get<bool>("graphics.interpolation")),
             show_fps(Configurations::get<bool>("debug.show-fps")),
             show_time(Configurations::get<bool>("debug.show-time")),
             next_direction(Direction::DOWN),
             focus_pause(false),
             pause_unfocused(Configurations::get<bool>("game.pause-unfocused")),
             was_stopped(false),
-            pause_start_time(0),
-            total_paused_time(0),
+            pause_start_time(0.0),
+            total_paused_time(0.0),
             exit_requested(false),
             fullscreen_change_ticks(-1),
             fullscreen_update_delay(1),
@@ -46,7 +60,7 @@ struct Game::Impl {
             debug_style(xd::vec4(1.0f), Configurations::get<int>("font.size")),
             game_width(Configurations::get<int>("graphics.game-width", "debug.width")),
             game_height(Configurations::get<int>("graphics.game-height", "debug.height")),
-            pause_button(Configurations::get<std::string>("controls.pause-button")),
+            pause_button(-1),
             scripts_folder(Configurations::get<std::string>("game.scripts-folder")),
             reset_scripting(false),
             text_formatter(
@@ -56,7 +70,10 @@ struct Game::Impl {
                 xd::vec2{Configurations::get<float>("font.icon-offset-x"),
                     Configurations::get<float>("font.icon-offset-y")}),
             shake_decorator(game),
-            typewriter_decorator(game, audio_player) {
+            typewriter_decorator(game, audio_player),
+            headless(Configurations::get<bool>("debug.headless")),
+            headless_frames(Configurations::get<int>("debug.headless-frames")),
+            logic_frame(0) {
         // Register decorators
         text_formatter.register_decorator("shake", [=](xd::text_decorator& decorator,
                 const xd::formatted_text& text, const xd::text_decorator_args& args) {
@@ -67,6 +84,12 @@ struct Game::Impl {
             typewriter_decorator(decorator, text, args);
         });
 
+        // Lua garbage collector mode
+        auto gc_mode = Configurations::get<std::string>("game.lua-gc-mode");
+        if (gc_mode == "generational" && !vm.set_gc_mode(xd::lua::gc_mode::generational)) {
+            LOGGER_W << "Generational Lua garbage collection isn't supported by this Lua version";
+        }
+
         // Scripts folder
         if (!scripts_folder.empty() && scripts_folder.back() != '/') {
             scripts_folder += '/';
@@ -299,6 +322,79 @@ struct Game::Impl {
         windowed_size_check_ticks = ticks;
     }
 
+    // Resolve a debug file name relative to the user data folder
+    std::string debug_file_path(std::string filename) const {
+        auto data_folder = file_utilities::user_data_folder(environment);
+        if (!data_folder->get_filesystem().is_absolute_path(filename)) {
+            filename = data_folder->get_version_path() + filename;
+        }
+        return filename;
+    }
+
+    // Open the input replay and recording files, then seed the random number generators
+    void setup_input_replay(xd::window& window) {
+        auto seed = Configurations::get<int>("debug.random-seed");
+        if (seed >= 0) {
+            random_seed = static_cast<unsigned int>(seed);
+        }
+
+        auto data_folder = file_utilities::user_data_folder(environment);
+        auto& filesystem = data_folder->get_filesystem();
+
+        auto replay_file = Configurations::get<std::string>("debug.replay-input");
+        if (!replay_file.empty()) {
+            auto stream = filesystem.open_ifstream(debug_file_path(replay_file));
+            if (!stream || !*stream) {
+                throw std::runtime_error("Couldn't read input recording " + replay_file);
+            }
+            input_replay = std::make_unique<Input_Replay>(*stream);
+            // The recording's seed wins, the run has to match the recorded one
+            if (input_replay->get_seed()) {
+                random_seed = input_replay->get_seed();
+            }
+            LOGGER_I << "Replaying " << input_replay->get_events().size()
+                << " input events from " << replay_file;
+        }
+
+        auto record_file = Configurations::get<std::string>("debug.record-input");
+        if (!record_file.empty()) {
+            if (!random_seed) {
+                random_seed = static_cast<unsigned int>(std::time(nullptr));
+            }
+            input_record_stream = filesystem.open_ofstream(debug_file_path(record_file),
+                std::ios_base::out | std::ios_base::trunc);
+            if (!input_record_stream || !*input_record_stream) {
+                throw std::runtime_error("Couldn't write input recording " + record_file);
+            }
+            input_recorder = std::make_unique<Input_Recorder>(*input_record_stream, *random_seed);
+            input_recorder->attach(window);
+            LOGGER_I << "Recording input to " << record_file;
+        }
+
+        if (random_seed) {
+            LOGGER_I << "Using random seed " << *random_seed;
+            std::srand(*random_seed);
+        }
+    }
+
+    // Feed the recorded input of this logic frame and record the live one
+    void process_input_replay(xd::window& window) {
+        if (input_replay) {
+            input_replay->apply(window, logic_frame);
+        }
+        if (input_recorder) {
+            input_recorder->poll_axes(window);
+            input_recorder->end_frame(logic_frame);
+        }
+        ++logic_frame;
+    }
+
+    // Should a headless run stop?
+    bool headless_finished() const {
+        if (headless_frames > 0) return logic_frame >= headless_frames;
+        return input_replay && input_replay->finished();
+    }
+
     void set_icons(xd::window& window) {
         auto base_name = Configurations::get<std::string>("game.icon_base_name");
         auto sizes_string = Configurations::get<std::string>("game.icon_sizes");
@@ -339,6 +435,10 @@ struct Game::Impl {
     bool editor_mode;
     // The shared Lua virtual machine
     xd::lua::virtual_machine vm;
+    // Time spent collecting Lua garbage after each frame (in ms)
+    float lua_gc_budget;
+    // Render positions between logic steps?
+    bool interpolation;
     // Game-specific scripting interface
     std::unique_ptr<Scripting_Interface> scripting_interface;
     // Scripting interface used when the game is paused
@@ -359,9 +459,9 @@ struct Game::Impl {
     bool pause_unfocused;
     // Was time stopped when game got paused?
     bool was_stopped;
-    // Keep track of paused time
-    int pause_start_time;
-    int total_paused_time;
+    // Keep track of paused time (in seconds)
+    double pause_start_time;
+    double total_paused_time;
     // Information about a fullscreen change
     int fullscreen_change_ticks;
     int fullscreen_update_delay;
@@ -380,8 +480,8 @@ struct Game::Impl {
     std::unordered_set<std::string> config_changes;
     // Keymap file reader and binder
     std::unique_ptr<Key_Binder> key_binder;
-    // The button for pausing the game
-    std::string pause_button;
+    // Action ID of the button for pausing the game
+    int pause_button;
     // Base folder for startup and map scripts
     std::string scripts_folder;
     // Should the scripting interface be reset?
@@ -398,6 +498,19 @@ struct Game::Impl {
     Typewriter_Decorator typewriter_decorator;
     // Font cache
     std::unordered_map<std::string, std::shared_ptr<xd::font>> fonts;
+    // Run without rendering or audio output?
+    bool headless;
+    // Logic frames to run in headless mode, 0 runs until the replay (or the game) ends
+    int headless_frames;
+    // Number of logic frames run so far
+    int logic_frame;
+    // Fixed seed for the random number generators, if any
+    std::optional<unsigned int> random_seed;
+    // Input replayed from a recording
+    std::unique_ptr<Input_Replay> input_replay;
+    // Live input recording
+    std::unique_ptr<std::ostream> input_record_stream;
+    std::unique_ptr<Input_Recorder> input_recorder;
 };
 
 Game::Game(const std::vector<std::string>& args,
@@ -434,7 +547,8 @@ Game::Game(const std::vector<std::string>& args,
                 0, // stencil
                 0, // antialiasing
                 2, // GL major version
-                0))), // GL minor version
+                0, // GL minor version
+                Configurations::get<bool>("debug.headless")))),
         pimpl(std::make_unique<Impl>(*this, audio, environment, editor_mode)),
         paused(false),
         pausing_enabled(true),
@@ -499,6 +613,9 @@ void Game::init(const std::string& default_scale_mode) {
 
     window->set_gamma(Configurations::get<float>("graphics.gamma"));
 
+    // Before anything uses the random number generators
+    pimpl->setup_input_replay(*window);
+
     auto map_arg = command_line_args.size() > 1
         && string_utilities::ends_with(command_line_args[1], ".tmx");
     auto startup_map = map_arg
@@ -528,6 +645,7 @@ void Game::init(const std::string& default_scale_mode) {
 
     // Bind game keys
     pimpl->process_keymap(*this);
+    pimpl->pause_button = action_id(Configurations::get<std::string>("controls.pause-button"));
     // Setup Lua scripts
     pimpl->reset_scripting_interface(*this);
     // Script run when game is paused
@@ -542,7 +660,8 @@ void Game::init(const std::string& default_scale_mode) {
 
     // Set frame update function and frequency
     int logic_fps = Configurations::get<int>("graphics.logic-fps", "debug.logic-fps");
-    window->register_tick_handler(std::bind(&Game::frame_update, this), 1000 / logic_fps);
+    int max_logic_steps = Configurations::get<int>("graphics.max-logic-steps");
+    window->register_tick_handler(std::bind(&Game::frame_update, this), logic_fps, max_logic_steps);
     // Log errors
     window->register_error_handler([](int code, const char* description) {
         LOGGER_E << "GLFW error (" << code << "): " << description;
@@ -551,14 +670,46 @@ void Game::init(const std::string& default_scale_mode) {
     camera->set_shader(Configurations::get<std::string>("graphics.vertex-shader"),
         Configurations::get<std::string>("graphics.fragment-shader"));
     camera->update();
+    camera->store_previous_position();
 }
 
 void Game::run() {
+    // Collect Lua garbage in the time left after rendering instead of mid-frame
+    auto gc_budget = pimpl->lua_gc_budget;
+    pimpl->vm.set_gc_paced(gc_budget > 0.0f);
+    PROFILE_THREAD_NAME("Main thread");
+
     while (!pimpl->exit_requested) {
         window->update();
         if (window->closed())
             break;
-        render();
+        // Headless updates run a single logic step each, as fast as possible
+        if (!pimpl->headless) {
+            render();
+        }
+        if (gc_budget > 0.0f) {
+            PROFILE_ZONE("Lua GC");
+            pimpl->vm.step_gc(gc_budget);
+        }
+        PROFILE_FRAME_END();
+        if (pimpl->headless && pimpl->headless_finished())
+            break;
+    }
+
+    if (pimpl->headless) {
+        LOGGER_I << "Headless run finished after " << pimpl->logic_frame << " logic frames";
+        auto dump_file = Configurations::get<std::string>("debug.dump-state");
+        if (!dump_file.empty()) {
+            auto data_folder = file_utilities::user_data_folder(pimpl->environment);
+            auto stream = data_folder->get_filesystem().open_ofstream(pimpl->debug_file_path(dump_file),
+                std::ios_base::out | std::ios_base::trunc);
+            if (!stream || !*stream) {
+                throw std::runtime_error("Couldn't write state dump " + dump_file);
+            }
+            write_state(*stream);
+        }
+        // Automated runs shouldn't touch the user's config
+        return;
     }
 
     auto user_folder = file_utilities::user_data_folder(pimpl->environment);
@@ -566,6 +717,15 @@ void Game::run() {
 }
 
 void Game::frame_update() {
+    PROFILE_ZONE("Game::frame_update");
+    if (window) {
+        pimpl->process_input_replay(*window);
+    }
+
+    // Rendering interpolates from the state before this step
+    camera->store_previous_position();
+    map->store_previous_positions();
+
     pimpl->audio_player.update();
 
     // Toggle fullscreen when ALT+Enter is pressed
@@ -649,11 +809,22 @@ void Game::frame_update() {
 }
 
 void Game::render() {
+    PROFILE_ZONE("Game::render");
+    xd::gl_state::begin_frame();
+    // The editor shares its GL context, so the cached state can't be trusted
+    if (pimpl->editor_mode) {
+        xd::gl_state::invalidate();
+    }
+
     // Window size changes are asynchronous in X11 so we keep polling the size
     camera->set_size(framebuffer_width(), framebuffer_height());
     camera->render();
 
-    if (pimpl->editor_mode) return;
+    if (pimpl->editor_mode) {
+        // Leave no buffer bound for the editor's own drawing
+        xd::gl_state::bind_buffer(GL_ARRAY_BUFFER, 0);
+        return;
+    }
 
     // Draw FPS
     if (pimpl->show_fps) {
@@ -678,7 +849,7 @@ bool Game::in_editor_mode() const {
 
 void Game::pause() {
     paused = true;
-    pimpl->pause_start_time = window->ticks();
+    pimpl->pause_start_time = window->time();
     pimpl->was_stopped = clock->stopped();
     clock->stop_time();
 
@@ -698,7 +869,7 @@ void Game::pause() {
 
 void Game::resume(const std::string& script) {
     paused = false;
-    pimpl->total_paused_time += window->ticks() - pimpl->pause_start_time;
+    pimpl->total_paused_time += window->time() - pimpl->pause_start_time;
 
     if (!pimpl->was_stopped) clock->resume_time();
 
@@ -821,6 +992,64 @@ xd::lua::virtual_machine* Game::get_lua_vm() {
     return &pimpl->vm;
 }
 
+std::optional<unsigned int> Game::get_random_seed() const {
+    return pimpl->random_seed;
+}
+
+void Game::write_state(std::ostream& stream) {
+    auto flags = stream.flags();
+    auto precision = stream.precision();
+    stream << std::setprecision(std::numeric_limits<double>::max_digits10);
+
+    stream << "frame " << pimpl->logic_frame << '\n';
+    stream << "map " << (map ? map->get_filename() : "") << '\n';
+
+    if (map) {
+        std::vector<Map_Object*> objects;
+        for (auto& [id, object] : map->get_objects()) {
+            objects.push_back(object.get());
+        }
+        std::sort(objects.begin(), objects.end(), [](auto a, auto b) {
+            return a->get_id() < b->get_id();
+        });
+        for (auto object : objects) {
+            auto position = object->get_position();
+            stream << "object " << object->get_id() << ' ' << object->get_name()
+                << ' ' << position.x << ' ' << position.y
+                << ' ' << direction_to_string(object->get_direction())
+                << ' ' << object->get_state() << '\n';
+        }
+    }
+
+    // Only plain values, functions and tables can't be compared across runs
+    std::map<std::string, std::string> globals;
+    for (auto& [key, value] : pimpl->vm.lua_state().globals()) {
+        if (key.get_type() != sol::type::string) continue;
+        std::ostringstream value_stream;
+        value_stream << std::setprecision(std::numeric_limits<double>::max_digits10);
+        switch (value.get_type()) {
+        case sol::type::number:
+            value_stream << value.as<double>();
+            break;
+        case sol::type::string:
+            value_stream << '"' << value.as<std::string>() << '"';
+            break;
+        case sol::type::boolean:
+            value_stream << (value.as<bool>() ? "true" : "false");
+            break;
+        default:
+            continue;
+        }
+        globals[key.as<std::string>()] = value_stream.str();
+    }
+    for (auto& [key, value] : globals) {
+        stream << "global " << key << ' ' << value << '\n';
+    }
+
+    stream.flags(flags);
+    stream.precision(precision);
+}
+
 void Game::reset_scripting() {
     pimpl->scripting_interface->get_scheduler().pause();
     pimpl->reset_scripting = true;
@@ -895,11 +1124,23 @@ float Game::seconds() const {
 int Game::ticks() const {
     if (!window) return editor_ticks;
 
-    auto ticks = window->ticks();
-    int stopped_time = pimpl->total_paused_time + (paused ?
-        ticks - pimpl->pause_start_time : 0);
+    return static_cast<int>(game_time() * 1000.0);
+}
+
+float Game::interpolation_alpha() const {
+    if (!window || !pimpl->interpolation) return 1.0f;
+
+    return static_cast<float>(window->tick_timer().alpha());
+}
+
+double Game::game_time() const {
+    if (!window) return editor_ticks / 1000.0;
+
+    auto time = window->time();
+    auto stopped_time = pimpl->total_paused_time + (paused ?
+        time - pimpl->pause_start_time : 0.0);
 
-    return ticks - stopped_time;
+    return time - stopped_time;
 }
 
 std::string Game::get_scripts_directory() const {
@@ -908,6 +1149,8 @@ std::string Game::get_scripts_directory() const {
 
 void Game::load_next_map() {
     map = Map::load(*this, pimpl->next_map);
+    // The previous map's garbage is collected while the screen is changing anyway
+    pimpl->vm.full_gc();
     if (pimpl->editor_mode) return;
 
     // Reset the player's references
@@ -928,6 +1171,7 @@ void Game::load_next_map() {
     pimpl->setup_map(*map, player, *camera);
 
     camera->update();
+    camera->store_previous_position();
     pimpl->next_map = "";
 }
 
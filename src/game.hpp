@@ -9,6 +9,7 @@
 #include "xd/system/input.hpp"
 #include "xd/system/window.hpp"
 #include "xd/vendor/sol/forward.hpp"
+#include <iosfwd>
 #include <memory>
 #include <optional>
 #include <string>
@@ -136,6 +137,11 @@ public:
     int frame_count() const {
         return window->frame_count();
     }
+    // Get the ID of a virtual key, checking IDs skips the name lookup.
+    // There are no IDs (-1) in editor mode, which has no window
+    int action_id(const std::string& virtual_key) {
+        return window ? window->action_id(virtual_key) : -1;
+    }
     // Is key currently pressed
     bool pressed(const xd::key& key) const {
         return window->pressed(key);
@@ -143,6 +149,9 @@ public:
     bool pressed(const std::string& key) const {
         return window->pressed(key);
     }
+    bool pressed(int action) const {
+        return window ? window->pressed(action) : false;
+    }
     // Was any key triggered since last update?
     bool triggered() const {
         return window->triggered();
@@ -154,6 +163,9 @@ public:
     bool triggered(const std::string& key) const {
         return window->triggered(key);
     }
+    bool triggered(int action) const {
+        return window ? window->triggered(action) : false;
+    }
     // Was key triggered? (Un-trigger it if it was)
     bool triggered_once(const xd::key& key) {
         return window->triggered_once(key);
@@ -161,8 +173,15 @@ public:
     bool triggered_once(const std::string& key) {
         return window->triggered_once(key);
     }
+    bool triggered_once(int action) {
+        return window ? window->triggered_once(action) : false;
+    }
     // Get physical names of triggered keys
     std::vector<std::string> triggered_keys() const;
+    // Press or release a key without a device, it stays pressed until released
+    void inject_input(const xd::key& key, bool pressed) {
+        window->inject_input(key, pressed);
+    }
     // Bind physical key to virtual key name
     void bind_key(const std::string& physical_name, const std::string& virtual_name);
     void bind_key(const xd::key& physical_key, const std::string& virtual_key) {
@@ -201,6 +220,10 @@ public:
     }
     // Get the shared Lua virtual machine
     xd::lua::virtual_machine* get_lua_vm();
+    // Seed used for every random number generator, if it was fixed
+    std::optional<unsigned int> get_random_seed() const;
+    // Write the frame count, object states and plain Lua globals, to compare headless runs
+    void write_state(std::ostream& stream);
     // Reset the scripting interface and run startup scripts again
     void reset_scripting();
     // Is the Lua scheduler paused?
@@ -253,6 +276,10 @@ public:
     float seconds() const;
     // Time elapsed since game started (in ms) not including pauses
     int ticks() const;
+    // High resolution version of ticks (in seconds)
+    double game_time() const;
+    // How far rendering is between the previous and the current logic step (0 to 1)
+    float interpolation_alpha() const;
     // Manually set ticks
     void set_ticks(int ticks) {
         editor_ticks = ticks;
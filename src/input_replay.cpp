@@ -0,0 +1,175 @@
+#include "input_replay.hpp"
+#include "xd/system/window.hpp"
+#include <iomanip>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+namespace detail {
+    static constexpr int gamepad_axis_count = 6;
+
+    static bool parse_action(std::istream& stream, Input_Event& event) {
+        std::string action;
+        if (!(stream >> action)) return false;
+        if (action == "down") {
+            event.type = Input_Event_Type::PRESS;
+        } else if (action == "up") {
+            event.type = Input_Event_Type::RELEASE;
+        } else {
+            return false;
+        }
+        return true;
+    }
+
+    static bool parse_event(const std::string& line, Input_Event& event) {
+        std::istringstream stream(line);
+        std::string device;
+        if (!(stream >> event.frame >> device) || event.frame < 0) return false;
+
+        event.value = 0.0f;
+        bool valid = false;
+        if (device == "key" || device == "mouse") {
+            event.key.type = device == "key" ? xd::input_type::INPUT_KEYBOARD : xd::input_type::INPUT_MOUSE;
+            event.key.device_id = -1;
+            valid = static_cast<bool>(stream >> event.key.code) && parse_action(stream, event);
+        } else if (device == "gamepad") {
+            event.key.type = xd::input_type::INPUT_GAMEPAD;
+            valid = static_cast<bool>(stream >> event.key.device_id >> event.key.code)
+                && parse_action(stream, event);
+        } else if (device == "axis") {
+            event.type = Input_Event_Type::AXIS;
+            event.key.type = xd::input_type::INPUT_GAMEPAD;
+            valid = static_cast<bool>(stream >> event.key.device_id >> event.key.code >> event.value);
+        }
+
+        std::string rest;
+        return valid && !(stream >> rest);
+    }
+
+    static void write_event(std::ostream& stream, const Input_Event& event) {
+        stream << event.frame << ' ';
+        if (event.type == Input_Event_Type::AXIS) {
+            stream << "axis " << event.key.device_id << ' ' << event.key.code << ' ' << event.value << '\n';
+            return;
+        }
+
+        switch (event.key.type) {
+        case xd::input_type::INPUT_KEYBOARD:
+            stream << "key " << event.key.code;
+            break;
+        case xd::input_type::INPUT_MOUSE:
+            stream << "mouse " << event.key.code;
+            break;
+        case xd::input_type::INPUT_GAMEPAD:
+            stream << "gamepad " << event.key.device_id << ' ' << event.key.code;
+            break;
+        }
+        stream << (event.type == Input_Event_Type::PRESS ? " down\n" : " up\n");
+    }
+}
+
+Input_Replay::Input_Replay(std::istream& stream) : next_event(0) {
+    std::string line;
+    int line_number = 0;
+    while (std::getline(stream, line)) {
+        ++line_number;
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        auto start = line.find_first_not_of(" \t");
+        if (start == std::string::npos || line[start] == '#') continue;
+
+        if (line.compare(start, 5, "seed ") == 0) {
+            std::istringstream seed_stream(line.substr(start + 5));
+            unsigned int value;
+            if (!(seed_stream >> value)) {
+                throw std::runtime_error("Invalid seed on line " + std::to_string(line_number) + " of input recording");
+            }
+            seed = value;
+            continue;
+        }
+
+        Input_Event event;
+        if (!detail::parse_event(line, event)) {
+            throw std::runtime_error("Invalid event on line " + std::to_string(line_number)
+                + " of input recording: " + line);
+        }
+        if (!events.empty() && event.frame < events.back().frame) {
+            throw std::runtime_error("Out of order event on line " + std::to_string(line_number)
+                + " of input recording");
+        }
+        events.push_back(event);
+    }
+}
+
+std::vector<Input_Event> Input_Replay::frame_events(int frame) {
+    std::vector<Input_Event> result;
+    // Skip events of frames that were never requested
+    while (next_event < events.size() && events[next_event].frame < frame) {
+        ++next_event;
+    }
+    while (next_event < events.size() && events[next_event].frame == frame) {
+        result.push_back(events[next_event++]);
+    }
+    return result;
+}
+
+void Input_Replay::apply(xd::window& window, int frame) {
+    for (auto& event : frame_events(frame)) {
+        if (event.type == Input_Event_Type::AXIS) {
+            window.inject_axis(event.key.device_id, event.key.code, event.value);
+        } else {
+            window.inject_input(event.key, event.type == Input_Event_Type::PRESS);
+        }
+    }
+}
+
+Input_Recorder::Input_Recorder(std::ostream& stream, unsigned int seed) : stream(stream) {
+    // Axis values have to survive the round trip exactly
+    stream << std::setprecision(std::numeric_limits<float>::max_digits10);
+    stream << "seed " << seed << '\n';
+}
+
+void Input_Recorder::attach(xd::window& window) {
+    window.bind_input_event("key_down", [this](const xd::input_args& args) {
+        key_changed(args.physical_key, true);
+        return true;
+    }, xd::input_filter(), xd::event_placement::EVENT_PREPEND);
+    window.bind_input_event("key_up", [this](const xd::input_args& args) {
+        key_changed(args.physical_key, false);
+        return true;
+    }, xd::input_filter(), xd::event_placement::EVENT_PREPEND);
+}
+
+void Input_Recorder::key_changed(const xd::key& key, bool pressed) {
+    auto type = pressed ? Input_Event_Type::PRESS : Input_Event_Type::RELEASE;
+    pending.push_back(Input_Event{ 0, type, key, 0.0f });
+}
+
+void Input_Recorder::axis_changed(int joystick_id, int axis, float value) {
+    auto& previous = axis_values.try_emplace(joystick_id * detail::gamepad_axis_count + axis, 0.0f).first->second;
+    if (previous == value) return;
+    previous = value;
+    xd::key key{ xd::input_type::INPUT_GAMEPAD, axis, joystick_id };
+    pending.push_back(Input_Event{ 0, Input_Event_Type::AXIS, key, value });
+}
+
+void Input_Recorder::poll_axes(xd::window& window) {
+    auto joystick_id = window.active_joystick_id();
+    if (joystick_id == -1) return;
+    for (int axis = 0; axis < detail::gamepad_axis_count; ++axis) {
+        xd::key key{ xd::input_type::INPUT_GAMEPAD, axis, -1 };
+        axis_changed(joystick_id, axis, window.axis_value(key, joystick_id));
+    }
+}
+
+void Input_Recorder::end_frame(int frame) {
+    for (auto& event : pending) {
+        event.frame = frame;
+        detail::write_event(stream, event);
+    }
+    pending.clear();
+}
@@ -0,0 +1,75 @@
+#ifndef HPP_INPUT_REPLAY
+#define HPP_INPUT_REPLAY
+
+#include "xd/system/input.hpp"
+#include <cstddef>
+#include <iosfwd>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace xd {
+    class window;
+}
+
+enum class Input_Event_Type { PRESS, RELEASE, AXIS };
+
+// A change of input state, applied at the start of a logic frame
+struct Input_Event {
+    int frame;
+    Input_Event_Type type;
+    // For axes the code is the axis index and the device ID is the joystick
+    xd::key key;
+    float value;
+};
+
+// Recorded input files are plain text, one change per line:
+//   seed <random seed>
+//   <frame> key <code> down|up
+//   <frame> mouse <code> down|up
+//   <frame> gamepad <joystick> <button> down|up
+//   <frame> axis <joystick> <axis> <value>
+// Empty lines and lines starting with # are ignored
+
+// Feeds recorded input to the window, frame by frame
+class Input_Replay {
+public:
+    // Parse a recording, throws std::runtime_error on malformed lines
+    explicit Input_Replay(std::istream& stream);
+    // Seed the recording was made with, if any
+    std::optional<unsigned int> get_seed() const { return seed; }
+    const std::vector<Input_Event>& get_events() const { return events; }
+    // Events of the given frame, frames must be requested in increasing order
+    std::vector<Input_Event> frame_events(int frame);
+    // Inject the frame's events into the window
+    void apply(xd::window& window, int frame);
+    // Were all the events replayed?
+    bool finished() const { return next_event >= events.size(); }
+private:
+    std::vector<Input_Event> events;
+    std::optional<unsigned int> seed;
+    std::size_t next_event;
+};
+
+// Writes input changes in the format Input_Replay reads
+class Input_Recorder {
+public:
+    Input_Recorder(std::ostream& stream, unsigned int seed);
+    // Capture the window's key, mouse and gamepad button events
+    void attach(xd::window& window);
+    // A key, mouse or gamepad button changed
+    void key_changed(const xd::key& key, bool pressed);
+    // Axis value of a joystick, only changes are recorded
+    void axis_changed(int joystick_id, int axis, float value);
+    // Read the active joystick's axes from the window
+    void poll_axes(xd::window& window);
+    // Write the changes since the last call as happening in this frame
+    void end_frame(int frame);
+private:
+    std::ostream& stream;
+    std::vector<Input_Event> pending;
+    // Last recorded value of each axis, keyed by joystick * axis count + axis
+    std::unordered_map<int, float> axis_values;
+};
+
+#endif
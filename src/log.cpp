@@ -1,61 +1,60 @@
 #include "configurations.hpp"
 #include "environments/environment.hpp"
 #include "log.hpp"
+#include "log_rotation.hpp"
+#include "log_writer.hpp"
 #include "utility/file.hpp"
 #include "utility/string.hpp"
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <exception>
+#include <future>
 #include <iostream>
 
 namespace detail {
-    static void rotate_files(std::string filename, Writable_Filesystem& fs) {
-        int file_count = Configurations::get<int>("logging.file-count");
-        int max_size = Configurations::get<int>("logging.max-file-size-kb");
-
-        bool rolling = file_count > 1
-            && max_size > 0
-            && fs.exists(filename)
-            && fs.file_size(filename) / 1024 > max_size;
-        if (!rolling) return;
-
-        std::string folder{""};
-        const auto last_slash = filename.find_last_of('/');
-        if (last_slash != std::string::npos) {
-            folder = filename.substr(0, last_slash + 1);
-        }
-
-        const auto ext = fs.extension(filename);
-        const auto stem = fs.stem_component(filename);
-
-        const auto filename_prefix = folder + stem + "_";
-        // Copy each file to the next slot (e.g. file_3.log to file_4.log)
-        for (int i = file_count; i >= 2; --i) {
-            const auto source_file = filename_prefix + std::to_string(i) + ext;
-            if (!fs.exists(source_file)) continue;
-
-            const auto dest_file = filename_prefix + std::to_string(i + 1) + ext;
-            fs.copy(source_file, dest_file);
-        }
+    static std::terminate_handler previous_terminate = nullptr;
 
-        // Copy the main log file to slot 2 (e.g. file.log to file_2.log)
-        if (fs.copy(filename, filename_prefix + "2" + ext)) {
-            fs.remove(filename);
-        }
+    static void flush_on_signal(int signal) {
+        Log::flush_on_crash();
+        std::signal(signal, SIG_DFL);
+        std::raise(signal);
+    }
 
-        // Delete the oldest file past the max count (e.g. file_6.log is the count is 5)
-        const auto extra_file = filename_prefix + std::to_string(file_count + 1) + ext;
-        if (fs.exists(extra_file)) {
-            fs.remove(extra_file);
+    // Make sure queued messages reach the file when exiting or crashing
+    static void install_exit_handlers() {
+        static bool installed = false;
+        if (installed) return;
+        installed = true;
+
+        std::atexit(Log::shutdown);
+        previous_terminate = std::set_terminate([]() {
+            Log::flush_on_crash();
+            if (previous_terminate) {
+                previous_terminate();
+            }
+            std::abort();
+        });
+        for (auto signal : { SIGSEGV, SIGABRT, SIGFPE, SIGILL }) {
+            std::signal(signal, flush_on_signal);
         }
     }
 }
 
 Log_Level Log::reporting_level = Log_Level::debug;
 std::unique_ptr<std::ostream> Log::log_file;
+// Defined after the log file so it gets destroyed (and flushed) first
+std::unique_ptr<Log_Writer> Log::writer;
 std::ostream* Log::log_fallback = &std::cerr;
 bool Log::log_file_opened = false;
 bool Log::enabled = true;
 const Environment* Log::environment = nullptr;
 
 void Log::open_log_file() {
+    // The writer can't be replaced from its own thread (e.g. while rotating)
+    if (writer && writer->on_writer_thread()) return;
+
     if (enabled && Configurations::defaults_loaded()) {
         enabled = Configurations::get<bool>("logging.enabled");
     } else {
@@ -83,21 +82,83 @@ void Log::open_log_file() {
         }
     }
 
+    // Keep the filesystem alive for rotating files from the writer thread
+    auto disk_filesystem = data_folder ? nullptr : file_utilities::disk_filesystem();
     auto& filesystem = data_folder
         ? data_folder->get_filesystem()
-        : *file_utilities::disk_filesystem();
+        : *disk_filesystem;
+
+    Log_Rotation rotation;
+    rotation.file_count = Configurations::get<int>("logging.file-count");
+    rotation.max_size = static_cast<std::uintmax_t>(
+        std::max(Configurations::get<int>("logging.max-file-size-kb"), 0)) * 1024;
+    rotation.compress = Configurations::get<bool>("logging.compress-rotated");
+
+    // The old writer might still be writing into the previous file
+    if (writer) {
+        writer->stop();
+        writer.reset();
+    }
+    log_file.reset();
 
     auto config_mode = Configurations::get<std::string>("logging.mode");
     int mode = static_cast<int>(std::ios_base::out);
     if (config_mode == "append") {
         mode |= std::ios_base::app;
-        detail::rotate_files(filename, filesystem);
+        if (rotation.needed(filename, filesystem)) {
+            rotation.rotate(filename, filesystem);
+        }
     } else {
         mode |= std::ios_base::trunc;
     }
 
+    // Rotated files are compressed in the background so the writer thread
+    // only has to rename them. Starting here also picks up files that
+    // weren't compressed before the game last closed
+    auto compression = std::make_shared<std::future<void>>();
+    auto compress_rotated = [=]() {
+        if (!rotation.enabled() || !rotation.compress) return;
+        *compression = std::async(std::launch::async, [=]() {
+            auto& fs = data_folder ? data_folder->get_filesystem() : *disk_filesystem;
+            rotation.compress_rotated(filename, fs);
+        });
+    };
+
     log_file = filesystem.open_ofstream(filename, static_cast<std::ios_base::openmode>(mode));
     log_file_opened = static_cast<bool>(log_file);
+    if (log_file_opened) {
+        Log_Writer::Rotation writer_rotation;
+        if (rotation.enabled()) {
+            writer_rotation.max_size = rotation.max_size;
+            writer_rotation.initial_size = filesystem.file_size(filename);
+            writer_rotation.rotate = [=]() -> std::ostream* {
+                auto& fs = data_folder ? data_folder->get_filesystem() : *disk_filesystem;
+                // The previous compression might still be reading the files
+                // about to be moved, it has usually finished long before
+                if (compression->valid()) {
+                    compression->wait();
+                }
+                // Files can't be renamed while open on some platforms
+                log_file.reset();
+                rotation.rotate(filename, fs);
+                log_file = fs.open_ofstream(filename, std::ios_base::out | std::ios_base::trunc);
+                compress_rotated();
+                if (!log_file || !*log_file) {
+                    return log_fallback;
+                }
+                return log_file.get();
+            };
+        }
+
+        auto queue_size = Configurations::get<int>("logging.queue-size");
+        auto policy = Configurations::get<std::string>("logging.overflow");
+        writer = std::make_unique<Log_Writer>(*log_file,
+            static_cast<std::size_t>(std::max(queue_size, 2)),
+            Log_Writer::policy_from_string(policy),
+            std::move(writer_rotation));
+        detail::install_exit_handlers();
+        compress_rotated();
+    }
 
     std::string config_level = Configurations::get<std::string>("logging.level");
     string_utilities::capitalize(config_level);
@@ -116,3 +177,39 @@ void Log::open_log_file() {
 
     enabled = true;
 }
+
+void Log::write(Log_Level level, std::string message) {
+    auto now = std::chrono::system_clock::now();
+    if (log_file_opened && writer) {
+        writer->push(Log_Record{ level, now, std::move(message) });
+        // Errors are often followed by an exit, don't leave them in the queue
+        if (level == Log_Level::error) {
+            writer->flush();
+        }
+        if (writer->failed()) {
+            log_file_opened = false;
+        }
+        return;
+    }
+
+    *log_fallback << "- " << timestamp(std::chrono::system_clock::to_time_t(now)) << " "
+        << log_level_to_string(level) << ": " << message << std::endl;
+}
+
+void Log::flush() {
+    if (writer) {
+        writer->flush();
+    }
+}
+
+void Log::shutdown() {
+    if (writer) {
+        writer->stop();
+    }
+}
+
+void Log::flush_on_crash() noexcept {
+    if (writer) {
+        writer->drain(std::chrono::seconds(1));
+    }
+}
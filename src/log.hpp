@@ -14,6 +14,7 @@
 #pragma warning(disable: 4250)
 
 class Environment;
+class Log_Writer;
 
 // A simple logging class. Usage:
 // Log(level).lvalue() << stuff
@@ -31,24 +32,14 @@ public:
             open_log_file();
         }
     }
-    // Destructor: writes the message to file
+    // Destructor: queues the message to be written to file
     ~Log() {
         if (!enabled || current_level > Log::get_reporting_level()) return;
 
-        auto file = log_file_opened ? log_file.get() : log_fallback;
-
-        *file << "- " << timestamp() << " "
-            << log_level_to_string(current_level)
-            << ": " << this->str() << std::endl;
+        write(current_level, this->str());
 
         if (!environment) {
-            *file << "- " << timestamp()
-                << " ERROR: Logging without setting the environment!"
-                << std::endl;
-            log_file_opened = false;
-        }
-
-        if (log_file && !*log_file) {
+            write(Log_Level::error, "Logging without setting the environment!");
             log_file_opened = false;
         }
     }
@@ -90,9 +81,15 @@ public:
             return Log_Level::debug;
         return Log_Level::info;
     }
+    // Wait until every queued message is written to the log file
+    static void flush();
+    // Write the remaining messages and stop the background writer, anything
+    // logged afterwards is written synchronously
+    static void shutdown();
+    // Best-effort flush used when the game is crashing
+    static void flush_on_crash() noexcept;
     // Return timestamp in "YYYY-MM-DD HH:MM:SS" format
-    static std::string timestamp() {
-        const std::time_t seconds_time = std::time(0);
+    static std::string timestamp(std::time_t seconds_time = std::time(0)) {
         // Ignore unsafe function warning
 #pragma warning(push)
 #pragma warning(disable: 4996)
@@ -117,6 +114,8 @@ private:
     static Log_Level reporting_level;
     // The file to write into
     static std::unique_ptr<std::ostream> log_file;
+    // Writes queued messages to the log file in the background
+    static std::unique_ptr<Log_Writer> writer;
     // Fallback stream to write to (e.g. std::cerr)
     static std::ostream* log_fallback;
     // Whether the log file was explicitly opened
@@ -127,6 +126,8 @@ private:
     static const Environment* environment;
     // Open the log file for the first time
     static void open_log_file();
+    // Queue a message, or write it to the fallback stream
+    static void write(Log_Level level, std::string message);
 };
 
 #pragma warning(pop)
@@ -0,0 +1,97 @@
+#include "log_rotation.hpp"
+#include "filesystem/writable_filesystem.hpp"
+#include <ostream>
+#include <vector>
+#include <zlib.h>
+
+bool Log_Rotation::needed(const std::string& filename, Writable_Filesystem& fs) const {
+    return enabled() && fs.exists(filename) && fs.file_size(filename) > max_size;
+}
+
+std::string Log_Rotation::rotated_filename(const std::string& filename, Writable_Filesystem& fs,
+        int slot, bool compressed) const {
+    std::string folder{""};
+    const auto last_slash = filename.find_last_of('/');
+    if (last_slash != std::string::npos) {
+        folder = filename.substr(0, last_slash + 1);
+    }
+
+    auto result = folder + fs.stem_component(filename) + "_"
+        + std::to_string(slot) + fs.extension(filename);
+    if (compressed) {
+        result += ".gz";
+    }
+    return result;
+}
+
+bool Log_Rotation::rotate(const std::string& filename, Writable_Filesystem& fs) const {
+    if (!enabled() || !fs.exists(filename)) return false;
+
+    // Delete the oldest files (also cleans up after the file count is reduced)
+    for (int slot = file_count; ; ++slot) {
+        bool found = false;
+        for (bool compressed : { false, true }) {
+            auto oldest = rotated_filename(filename, fs, slot, compressed);
+            if (fs.exists(oldest)) {
+                fs.remove(oldest);
+                found = true;
+            }
+        }
+        if (!found && slot > file_count) break;
+    }
+
+    // Move each file to the next slot (e.g. file_3.log to file_4.log)
+    for (int slot = file_count - 1; slot >= 2; --slot) {
+        for (bool compressed : { false, true }) {
+            auto source = rotated_filename(filename, fs, slot, compressed);
+            if (!fs.exists(source)) continue;
+            fs.rename(source, rotated_filename(filename, fs, slot + 1, compressed));
+        }
+    }
+
+    // Move the main log file to slot 2 (e.g. file.log to file_2.log)
+    return fs.rename(filename, rotated_filename(filename, fs, 2, false));
+}
+
+void Log_Rotation::compress_rotated(const std::string& filename, Writable_Filesystem& fs) const {
+    if (!enabled() || !compress) return;
+
+    for (int slot = 2; slot <= file_count; ++slot) {
+        auto source = rotated_filename(filename, fs, slot, false);
+        if (!fs.exists(source)) continue;
+        // An existing .gz in the same slot is from an interrupted attempt
+        compress_file(source, rotated_filename(filename, fs, slot, true), fs);
+    }
+}
+
+bool Log_Rotation::compress_file(const std::string& source, const std::string& destination,
+        Writable_Filesystem& fs) {
+    auto content = fs.read_file(source);
+
+    z_stream stream{};
+    // 16 + MAX_WBITS writes a gzip header instead of a zlib one
+    if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 16 + MAX_WBITS,
+            8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        return false;
+    }
+
+    std::vector<unsigned char> compressed(deflateBound(&stream, static_cast<uLong>(content.size())));
+    stream.next_in = reinterpret_cast<Bytef*>(content.data());
+    stream.avail_in = static_cast<uInt>(content.size());
+    stream.next_out = compressed.data();
+    stream.avail_out = static_cast<uInt>(compressed.size());
+    auto result = deflate(&stream, Z_FINISH);
+    auto compressed_size = compressed.size() - stream.avail_out;
+    deflateEnd(&stream);
+    if (result != Z_STREAM_END) return false;
+
+    {
+        auto file = fs.open_ofstream(destination, std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+        if (!file || !*file) return false;
+        file->write(reinterpret_cast<const char*>(compressed.data()),
+            static_cast<std::streamsize>(compressed_size));
+        if (!*file) return false;
+    }
+
+    return fs.remove(source);
+}
@@ -0,0 +1,39 @@
+#ifndef HPP_LOG_ROTATION
+#define HPP_LOG_ROTATION
+
+#include <cstdint>
+#include <string>
+
+class Writable_Filesystem;
+
+// Rolls log files by renaming them: game.log becomes game_2.log,
+// game_2.log becomes game_3.log and so on until file_count is reached
+struct Log_Rotation {
+    // Maximum number of log files to keep, including the active one
+    int file_count = -1;
+    // The active log file is rotated when it grows past this (in bytes)
+    std::uintmax_t max_size = 0;
+    // Gzip rotated files (e.g. game_2.log.gz), see compress_rotated
+    bool compress = false;
+
+    // Is rotation configured?
+    bool enabled() const noexcept { return file_count > 1 && max_size > 0; }
+    // Does the given file need to be rotated before writing to it?
+    bool needed(const std::string& filename, Writable_Filesystem& fs) const;
+    // Name of the rotated log in the given slot (2 is the most recent one)
+    std::string rotated_filename(const std::string& filename, Writable_Filesystem& fs,
+        int slot, bool compressed) const;
+    // Shift the rotated files and move the log file to the first slot,
+    // the file must not be open. Returns false if the log couldn't be moved.
+    // Only renames files, compression is left to compress_rotated
+    bool rotate(const std::string& filename, Writable_Filesystem& fs) const;
+    // Gzip every rotated file that isn't compressed yet, including the ones
+    // left behind when the game closed before compressing them. Meant to run
+    // off the log writer thread, but not at the same time as rotate
+    void compress_rotated(const std::string& filename, Writable_Filesystem& fs) const;
+    // Gzip a file, removing the source on success
+    static bool compress_file(const std::string& source, const std::string& destination,
+        Writable_Filesystem& fs);
+};
+
+#endif
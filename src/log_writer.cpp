@@ -0,0 +1,272 @@
+#include "log_writer.hpp"
+#include "log.hpp"
+#include <utility>
+
+namespace detail {
+    static std::size_t round_up_to_power_of_two(std::size_t value) {
+        std::size_t result = 2;
+        while (result < value) {
+            result <<= 1;
+        }
+        return result;
+    }
+}
+
+Log_Writer::Log_Writer(std::ostream& stream, std::size_t capacity, Log_Overflow_Policy policy) :
+        Log_Writer(stream, capacity, policy, Rotation{}) {}
+
+Log_Writer::Log_Writer(std::ostream& stream, std::size_t capacity, Log_Overflow_Policy policy,
+        Rotation rotation) :
+        stream(&stream),
+        rotation(std::move(rotation)),
+        stream_size(this->rotation.initial_size),
+        capacity(detail::round_up_to_power_of_two(capacity)),
+        mask(this->capacity - 1),
+        policy(policy),
+        slots(new Slot[this->capacity]),
+        enqueue_position(0),
+        dequeue_position(0),
+        written(0),
+        dropped(0),
+        sleeping(false),
+        stopping(false),
+        finished(false),
+        stream_failed(false),
+        last_second(-1),
+        writer_id(std::thread::id{}) {
+    for (std::size_t i = 0; i < this->capacity; ++i) {
+        slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    thread = std::thread([this] { run(); });
+}
+
+Log_Writer::~Log_Writer() {
+    stop();
+}
+
+bool Log_Writer::push(Log_Record record) {
+    while (!finished.load(std::memory_order_acquire)) {
+        if (try_push(record)) {
+            // Make sure either stop() or this thread writes the record
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (finished.load(std::memory_order_relaxed)) {
+                std::lock_guard<std::mutex> lock(mutex);
+                write_batch();
+            } else {
+                wake();
+            }
+            return true;
+        }
+
+        if (policy == Log_Overflow_Policy::drop || on_writer_thread()) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        // Queue is full, let the writer catch up
+        wake();
+        std::this_thread::yield();
+    }
+
+    // Writer thread is gone, write synchronously
+    std::lock_guard<std::mutex> lock(mutex);
+    format(record);
+    write_buffer();
+    return true;
+}
+
+void Log_Writer::flush() {
+    if (finished.load(std::memory_order_acquire) || on_writer_thread()) return;
+
+    auto target = enqueue_position.load(std::memory_order_acquire);
+    std::unique_lock<std::mutex> lock(mutex);
+    wake_writer.notify_one();
+    batch_written.wait(lock, [this, target] {
+        return written.load(std::memory_order_acquire) >= target
+            || finished.load(std::memory_order_acquire);
+    });
+}
+
+bool Log_Writer::drain(std::chrono::milliseconds timeout) noexcept {
+    if (finished.load(std::memory_order_acquire)) return true;
+
+    auto target = enqueue_position.load(std::memory_order_acquire);
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (written.load(std::memory_order_acquire) < target) {
+        if (std::chrono::steady_clock::now() > deadline) return false;
+        std::this_thread::yield();
+    }
+    return true;
+}
+
+void Log_Writer::stop() {
+    if (stopping.exchange(true)) return;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        wake_writer.notify_one();
+    }
+    if (thread.joinable()) {
+        thread.join();
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    finished.store(true, std::memory_order_release);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    // Wait a little for producers that claimed a slot but didn't fill it yet
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(100);
+    while (true) {
+        write_batch();
+        auto claimed = enqueue_position.load(std::memory_order_acquire);
+        if (dequeue_position == claimed || std::chrono::steady_clock::now() > deadline) break;
+        std::this_thread::yield();
+    }
+    batch_written.notify_all();
+}
+
+Log_Overflow_Policy Log_Writer::policy_from_string(const std::string& policy) {
+    if (policy == "drop")
+        return Log_Overflow_Policy::drop;
+    return Log_Overflow_Policy::block;
+}
+
+bool Log_Writer::try_push(Log_Record& record) {
+    auto position = enqueue_position.load(std::memory_order_relaxed);
+    while (true) {
+        auto& slot = slots[position & mask];
+        auto sequence = slot.sequence.load(std::memory_order_acquire);
+        auto difference = static_cast<std::ptrdiff_t>(sequence - position);
+        if (difference == 0) {
+            if (enqueue_position.compare_exchange_weak(position, position + 1,
+                    std::memory_order_relaxed)) {
+                slot.record = std::move(record);
+                slot.sequence.store(position + 1, std::memory_order_release);
+                return true;
+            }
+        } else if (difference < 0) {
+            // The writer hasn't consumed this slot yet: full
+            return false;
+        } else {
+            position = enqueue_position.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+bool Log_Writer::try_pop(Log_Record& record) {
+    auto& slot = slots[dequeue_position & mask];
+    if (slot.sequence.load(std::memory_order_acquire) != dequeue_position + 1) {
+        return false;
+    }
+    record = std::move(slot.record);
+    slot.record.message.clear();
+    slot.sequence.store(dequeue_position + capacity, std::memory_order_release);
+    ++dequeue_position;
+    return true;
+}
+
+bool Log_Writer::has_ready_record() const {
+    auto& slot = slots[dequeue_position & mask];
+    return slot.sequence.load(std::memory_order_acquire) == dequeue_position + 1;
+}
+
+void Log_Writer::wake() {
+    // Only the first producer after the writer went to sleep pays for the lock
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleeping.load(std::memory_order_relaxed) && sleeping.exchange(false)) {
+        std::lock_guard<std::mutex> lock(mutex);
+        wake_writer.notify_one();
+    }
+}
+
+void Log_Writer::run() {
+    writer_id.store(std::this_thread::get_id());
+    while (true) {
+        if (write_batch()) continue;
+        if (stopping.load(std::memory_order_acquire)) break;
+
+        std::unique_lock<std::mutex> lock(mutex);
+        sleeping.store(true);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (!has_ready_record() && !stopping.load()) {
+            // The timeout covers producers that pushed without waking us
+            wake_writer.wait_for(lock, std::chrono::milliseconds(50));
+        }
+        sleeping.store(false);
+    }
+}
+
+bool Log_Writer::write_batch() {
+    // Flush at least once per queue length so a busy queue still reaches the disk
+    Log_Record record;
+    std::size_t count = 0;
+    while (count < capacity && try_pop(record)) {
+        format(record);
+        ++count;
+        if (buffer.size() >= 64 * 1024) {
+            write_buffer();
+        }
+    }
+
+    auto drops = dropped.exchange(0, std::memory_order_relaxed);
+    if (drops > 0) {
+        format(Log_Record{ Log_Level::warning, std::chrono::system_clock::now(),
+            "Log queue was full, dropped " + std::to_string(drops) + " messages" });
+    }
+
+    if (count == 0 && drops == 0) return false;
+
+    write_buffer();
+    written.store(dequeue_position, std::memory_order_release);
+    if (!finished.load(std::memory_order_relaxed)) {
+        std::lock_guard<std::mutex> lock(mutex);
+        batch_written.notify_all();
+    }
+    return true;
+}
+
+void Log_Writer::format(const Log_Record& record) {
+    auto seconds = std::chrono::system_clock::to_time_t(record.time);
+    if (seconds != last_second) {
+        last_second = seconds;
+        last_timestamp = Log::timestamp(seconds);
+    }
+    buffer += "- ";
+    buffer += last_timestamp;
+    buffer += ' ';
+    buffer += Log::log_level_to_string(record.level);
+    buffer += ": ";
+    buffer += record.message;
+    buffer += '\n';
+}
+
+void Log_Writer::write_buffer() {
+    if (!buffer.empty()) {
+        stream->write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        stream_size += buffer.size();
+        buffer.clear();
+    }
+    stream->flush();
+    if (!*stream) {
+        stream_failed.store(true, std::memory_order_release);
+    }
+    rotate_if_needed();
+}
+
+void Log_Writer::rotate_if_needed() {
+    // Only rotate from the writer thread, the callback might log
+    bool rotate = rotation.max_size > 0
+        && stream_size >= rotation.max_size
+        && rotation.rotate
+        && on_writer_thread();
+    if (!rotate) return;
+
+    auto next = rotation.rotate();
+    if (!next) {
+        // Keep writing into the current stream, don't retry on every batch
+        rotation.max_size = 0;
+        return;
+    }
+    stream = next;
+    stream_size = 0;
+    stream_failed.store(!*stream, std::memory_order_release);
+}
@@ -0,0 +1,123 @@
+#ifndef HPP_LOG_WRITER
+#define HPP_LOG_WRITER
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include "log_levels.hpp"
+
+// A single log message waiting to be written
+struct Log_Record {
+    Log_Level level = Log_Level::info;
+    std::chrono::system_clock::time_point time;
+    std::string message;
+};
+
+// What to do with new messages when the queue is full
+enum class Log_Overflow_Policy { block, drop };
+
+// Writes log records to a stream from a background thread. Messages are
+// pushed into a bounded lock-free multi-producer ring buffer, and the writer
+// thread formats, writes and flushes them in batches
+class Log_Writer {
+public:
+    // Switching to a new stream once the current one gets too big
+    struct Rotation {
+        // Rotate after the stream grows past this many bytes (0 disables rotation)
+        std::uintmax_t max_size = 0;
+        // Bytes that were already in the stream (e.g. when appending)
+        std::uintmax_t initial_size = 0;
+        // Called from the writer thread: close the current stream, roll the
+        // files and return the stream to continue writing into (or nullptr
+        // to keep writing into the current stream)
+        std::function<std::ostream*()> rotate;
+    };
+    // Capacity is rounded up to a power of two
+    Log_Writer(std::ostream& stream, std::size_t capacity = 8192,
+        Log_Overflow_Policy policy = Log_Overflow_Policy::block);
+    Log_Writer(std::ostream& stream, std::size_t capacity,
+        Log_Overflow_Policy policy, Rotation rotation);
+    ~Log_Writer();
+    Log_Writer(const Log_Writer&) = delete;
+    Log_Writer& operator=(const Log_Writer&) = delete;
+    // Queue a record, returns false if it was dropped. After the writer
+    // is stopped records are written synchronously. The writer thread itself
+    // (e.g. logging from the rotation callback) never blocks
+    bool push(Log_Record record);
+    // Wait until every record pushed before this call is written and flushed
+    // (does nothing on the writer thread)
+    void flush();
+    // Best-effort flush that doesn't take any locks, for crash handlers.
+    // Returns false if the queue couldn't be drained in time
+    bool drain(std::chrono::milliseconds timeout) noexcept;
+    // Write the remaining records and stop the writer thread
+    void stop();
+    bool stopped() const noexcept { return finished.load(std::memory_order_acquire); }
+    // Did writing to the stream fail?
+    bool failed() const noexcept { return stream_failed.load(std::memory_order_acquire); }
+    // Number of records dropped since the last report
+    std::size_t pending_drops() const noexcept { return dropped.load(std::memory_order_relaxed); }
+    // Is the caller the background writer thread?
+    bool on_writer_thread() const noexcept { return std::this_thread::get_id() == writer_id.load(); }
+    std::size_t get_capacity() const noexcept { return capacity; }
+    Log_Overflow_Policy get_policy() const noexcept { return policy; }
+    // Parse "block" or "drop"
+    static Log_Overflow_Policy policy_from_string(const std::string& policy);
+private:
+    struct Slot {
+        std::atomic<std::size_t> sequence;
+        Log_Record record;
+    };
+    std::ostream* stream;
+    Rotation rotation;
+    // Bytes written to the current stream
+    std::uintmax_t stream_size;
+    std::size_t capacity;
+    std::size_t mask;
+    Log_Overflow_Policy policy;
+    std::unique_ptr<Slot[]> slots;
+    // Producers claim slots by incrementing the enqueue position
+    alignas(64) std::atomic<std::size_t> enqueue_position;
+    // Only touched by the writer thread, or under the mutex once finished
+    alignas(64) std::size_t dequeue_position;
+    // Number of records written and flushed so far
+    std::atomic<std::size_t> written;
+    std::atomic<std::size_t> dropped;
+    std::atomic<bool> sleeping;
+    std::atomic<bool> stopping;
+    // Set once the writer thread is gone and the queue was drained
+    std::atomic<bool> finished;
+    std::atomic<bool> stream_failed;
+    // Used for waking up the writer and waiting for flushes, never on the push fast path
+    std::mutex mutex;
+    std::condition_variable wake_writer;
+    std::condition_variable batch_written;
+    // Formatting state, owned by whoever is writing
+    std::string buffer;
+    std::time_t last_second;
+    std::string last_timestamp;
+    std::thread thread;
+    std::atomic<std::thread::id> writer_id;
+
+    bool try_push(Log_Record& record);
+    bool try_pop(Log_Record& record);
+    bool has_ready_record() const;
+    void wake();
+    void run();
+    // Write everything currently in the queue, returns true if something was written
+    bool write_batch();
+    void format(const Log_Record& record);
+    void write_buffer();
+    void rotate_if_needed();
+};
+
+#endif
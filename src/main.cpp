@@ -8,6 +8,7 @@
 #endif
 #include "utility/file.hpp"
 #include "xd/audio/audio.hpp"
+#include "xd/audio/detail/null_audio_handle.hpp"
 #include <string>
 #include <variant>
 #include <vector>
@@ -92,8 +93,18 @@ int main(int argc, char* argv[]) {
         }
 
         // Initialize the audio system
-        LOGGER_I << "Initializing the audio system";
-        auto audio = std::make_shared<xd::audio>();
+        std::shared_ptr<xd::audio> audio;
+        if (Configurations::get<bool>("debug.headless")) {
+            // Simulate playback in step with the logic frames so sounds
+            // finish at the same frame on every run
+            LOGGER_I << "Initializing the null audio system";
+            auto logic_fps = Configurations::get<int>("graphics.logic-fps", "debug.logic-fps");
+            audio = std::make_shared<xd::audio>(std::make_unique<xd::detail::null_audio_handle>(
+                logic_fps > 0 ? 1.0f / logic_fps : 0.0f));
+        } else {
+            LOGGER_I << "Initializing the audio system";
+            audio = std::make_shared<xd::audio>();
+        }
 
         auto preferred_configs = environment->get_preferred_configs();
         std::string default_scale_mode;
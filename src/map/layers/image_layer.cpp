@@ -1,6 +1,7 @@
 #include "image_layer.hpp"
 #include "image_layer_renderer.hpp"
 #include "image_layer_updater.hpp"
+#include "../../asset_bundle.hpp"
 #include "../../audio_player.hpp"
 #include "../../configurations.hpp"
 #include "../../exceptions.hpp"
@@ -10,15 +11,18 @@
 #include "../../utility/file.hpp"
 #include "../../utility/math.hpp"
 #include "../../utility/string.hpp"
+#include "../../utility/texture.hpp"
 #include "../../utility/xml.hpp"
 #include "../../xd/asset_manager.hpp"
+#include "../../xd/graphics/image.hpp"
 #include <istream>
 
 void Image_Layer::set_sprite(Game& game, xd::asset_manager& asset_manager,
         const std::string& filename, const std::string& pose_name) {
     auto audio = game.get_audio_player().get_audio();
     auto channel_group = game.get_sound_group_type();
-    auto sprite_data = Sprite_Data::load(filename, asset_manager, audio, channel_group);
+    // Repeating layers tile the whole texture, so like images they can't use an atlas page
+    auto sprite_data = Sprite_Data::load(filename, asset_manager, audio, channel_group, !repeat);
     sprite = std::make_unique<Sprite>(game, sprite_data);
 
     set_pose(pose_name, "", Direction::NONE, true);
@@ -29,25 +33,39 @@ void Image_Layer::set_image(std::string filename, xd::asset_manager& asset_manag
     if (asset_manager.contains_key<xd::texture>(filename)) {
         image_source = filename;
         image_texture = asset_manager.get<xd::texture>(filename);
+        image_rect = xd::rect(0, 0, image_texture->width(), image_texture->height());
         return;
     }
 
     auto fs = file_utilities::game_data_filesystem();
-    if (!fs->exists(filename)) {
+    auto bundle = Asset_Bundle::game_bundle();
+    auto bundled = bundle && bundle->contains(Asset_Bundle::Record_Type::IMAGE, filename);
+    if (!bundled && !fs->exists(filename)) {
         throw std::runtime_error("Tried to set image for layer "
             + get_name() + " to nonexistent file " + filename);
     }
 
-    auto stream = fs->open_binary_ifstream(image_source);
-    if (!stream || !*stream) {
+    if (!repeat) {
+        // Only non-repeating images can share an atlas page
+        auto region = texture_utilities::load_image(asset_manager, filename, image_trans_color);
+        image_source = filename;
+        image_texture = region.texture;
+        image_rect = region.rectangle;
+        return;
+    }
+
+    std::unique_ptr<xd::image> image;
+    try {
+        image = texture_utilities::decode_image(filename, image_trans_color);
+    } catch (const file_loading_exception&) {
         throw file_loading_exception("Failed to load image " + filename
             + " for layer " + get_name());
     }
 
     image_source = filename;
-    auto wrap_mode = repeat ? GL_REPEAT : GL_CLAMP_TO_EDGE;
     image_texture = asset_manager.load<xd::texture>(image_source,
-        image_source, *stream, image_trans_color, wrap_mode, wrap_mode);
+        *image, GL_REPEAT, GL_REPEAT);
+    image_rect = xd::rect(0, 0, image_texture->width(), image_texture->height());
 }
 
 rapidxml::xml_node<>* Image_Layer::save(rapidxml::xml_document<>& doc) {
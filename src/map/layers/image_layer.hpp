@@ -55,6 +55,8 @@ public:
         image_color = new_color;
     }
     std::shared_ptr<xd::texture> get_texture() const { return image_texture; }
+    // Part of the texture holding the image (texture may be a shared atlas page)
+    xd::rect get_texture_rect() const { return image_rect; }
     // Save as XML
     rapidxml::xml_node<>* save(rapidxml::xml_document<>& doc) override;
     // Load from XML
@@ -77,6 +79,8 @@ private:
     xd::vec4 image_color;
     // Image texture
     std::shared_ptr<xd::texture> image_texture;
+    // Image position and size inside the texture
+    xd::rect image_rect;
     // Optional sprite
     std::unique_ptr<Sprite> sprite;
 };
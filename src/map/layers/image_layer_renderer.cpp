@@ -2,14 +2,16 @@
 #include "image_layer_renderer.hpp"
 #include "../../camera.hpp"
 #include "../../game.hpp"
+#include "../../profiler.hpp"
 #include "../../sprite.hpp"
 
 void Image_Layer_Renderer::render(Map& map) {
+    PROFILE_ZONE("Image_Layer_Renderer::render");
     batch.clear();
     auto& image_layer = static_cast<const Image_Layer&>(layer);
     xd::vec2 pos;
     if (image_layer.is_fixed()) {
-        pos = camera.get_pixel_position();
+        pos = camera.get_render_position();
     }
 
     auto sprite = image_layer.get_sprite();
@@ -25,7 +27,7 @@ void Image_Layer_Renderer::render(Map& map) {
             xd::rect src(-image_layer.get_position(), tex_size);
             batch.add(texture, src, pos.x, pos.y, 0.0f, 1.0f, color);
         } else {
-            batch.add(texture, pos.x, pos.y, color);
+            batch.add(texture, image_layer.get_texture_rect(), pos.x, pos.y, color);
         }
     }
 
@@ -3,8 +3,10 @@
 #include "image_layer_updater.hpp"
 #include "../map.hpp"
 #include "../../game.hpp"
+#include "../../profiler.hpp"
 
 void Image_Layer_Updater::update(Map& map) {
+    PROFILE_ZONE("Image_Layer_Updater::update");
     auto& image_layer = static_cast<Image_Layer&>(layer);
     auto sprite = image_layer.get_sprite();
     if (sprite) {
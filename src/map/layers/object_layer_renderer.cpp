@@ -5,6 +5,7 @@
 #include "../../camera.hpp"
 #include "../../configurations.hpp"
 #include "../../game.hpp"
+#include "../../profiler.hpp"
 #include "../../utility/color.hpp"
 #include "../../utility/math.hpp"
 #include <algorithm>
@@ -18,6 +19,7 @@ Object_Layer_Renderer::Object_Layer_Renderer(const Layer& layer, const Camera& c
 }
 
 void Object_Layer_Renderer::render(Map& map) {
+    PROFILE_ZONE("Object_Layer_Renderer::render");
     batch.clear();
 
     // Casting the const away is fine since we're only sorting
@@ -46,10 +46,26 @@ rapidxml::xml_node<>* Tile_Layer::save(rapidxml::xml_document<>& doc) {
     return node;
 }
 
-std::unique_ptr<Layer> Tile_Layer::load(rapidxml::xml_node<>& node, Camera& camera) {
+std::unique_ptr<Layer> Tile_Layer::load(rapidxml::xml_node<>& node, Camera& camera,
+        const std::vector<unsigned int>* decoded_tiles) {
     auto layer_ptr = std::make_unique<Tile_Layer>();
     layer_ptr->Layer::load(node);
 
+    int num_tiles = layer_ptr->width * layer_ptr->height;
+    if (decoded_tiles) {
+        if (decoded_tiles->size() != static_cast<std::size_t>(num_tiles))
+            throw tmx_exception("Pre-decoded tile count doesn't match layer " + layer_ptr->get_name());
+        layer_ptr->tiles = *decoded_tiles;
+    } else {
+        layer_ptr->tiles = decode_tiles(node, num_tiles);
+    }
+
+    layer_ptr->renderer = std::make_unique<Tile_Layer_Renderer>(*layer_ptr, camera);
+
+    return layer_ptr;
+}
+
+std::vector<unsigned int> Tile_Layer::decode_tiles(rapidxml::xml_node<>& node, int num_tiles) {
     // Layer data
     auto data_node = node.first_node("data");
     if (!data_node)
@@ -69,7 +85,6 @@ std::unique_ptr<Layer> Tile_Layer::load(rapidxml::xml_node<>& node, Camera& came
 
     // Decode and compress layer data
     std::string decoded_data = base64_decode(raw_data);
-    int num_tiles = layer_ptr->width * layer_ptr->height;
     uLongf size = num_tiles * 4;
     const auto tile_array = std::make_unique<unsigned int[]>(num_tiles);
     auto result = uncompress((Bytef*) tile_array.get(), &size,
@@ -95,9 +110,5 @@ std::unique_ptr<Layer> Tile_Layer::load(rapidxml::xml_node<>& node, Camera& came
     }
 
     // Put decopressed and decoded  data in the tiles vector
-    layer_ptr->tiles = std::vector<unsigned int>(tile_array.get(), tile_array.get() + num_tiles);
-
-    layer_ptr->renderer = std::make_unique<Tile_Layer_Renderer>(*layer_ptr, camera);
-
-    return layer_ptr;
+    return std::vector<unsigned int>(tile_array.get(), tile_array.get() + num_tiles);
 }
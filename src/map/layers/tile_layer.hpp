@@ -16,7 +16,11 @@ public:
     void resize(xd::ivec2 new_size) override;
     // Save and load the tile layer TMX data
     rapidxml::xml_node<>* save(rapidxml::xml_document<>& doc) override;
-    static std::unique_ptr<Layer> load(rapidxml::xml_node<>& node, Camera& camera);
+    // Pre-decoded tiles (e.g. from an asset bundle) skip decoding the layer data
+    static std::unique_ptr<Layer> load(rapidxml::xml_node<>& node, Camera& camera,
+        const std::vector<unsigned int>* decoded_tiles = nullptr);
+    // Decode the base64 and zlib encoded tiles of a layer node
+    static std::vector<unsigned int> decode_tiles(rapidxml::xml_node<>& node, int num_tiles);
 private:
     // List of tiles
     std::vector<unsigned int> tiles;
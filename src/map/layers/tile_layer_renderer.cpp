@@ -2,8 +2,10 @@
 #include "tile_layer.hpp"
 #include "../map.hpp"
 #include "../../camera.hpp"
+#include "../../profiler.hpp"
 
 void Tile_Layer_Renderer::render(Map& map) {
+    PROFILE_ZONE("Tile_Layer_Renderer::render");
     if (needs_redraw) {
         batch.clear();
         auto& tiles = static_cast<const Tile_Layer&>(layer).get_tiles();
@@ -6,6 +6,7 @@
 #include "layers/tile_layer.hpp"
 #include "map_object.hpp"
 #include "tileset.hpp"
+#include "../asset_bundle.hpp"
 #include "../canvas/base_canvas.hpp"
 #include "../canvas/canvas_renderer.hpp"
 #include "../canvas/canvas_updater.hpp"
@@ -13,6 +14,7 @@
 #include "../exceptions.hpp"
 #include "../game.hpp"
 #include "../log.hpp"
+#include "../profiler.hpp"
 #include "../scripting/scripting_interface.hpp"
 #include "../utility/color.hpp"
 #include "../utility/direction.hpp"
@@ -22,7 +24,9 @@
 #include "../vendor/rapidxml_print.hpp"
 #include "../xd/vendor/sol/sol.hpp"
 #include <algorithm>
+#include <cmath>
 #include <fstream>
+#include <iterator>
 #include <limits>
 #include <unordered_set>
 #include <utility>
@@ -316,10 +320,94 @@ bool Map::tile_passable(int x, int y) const noexcept {
     return tiles[tile_index] - collision_tileset->first_id <= 1;
 }
 
+bool Map::line_of_sight(xd::vec2 from, xd::vec2 to) const noexcept {
+    if (!collision_layer || !collision_tileset) return true;
+
+    // Walk the tiles crossed by the line, one tile boundary at a time
+    const xd::vec2 start{from.x / tile_width, from.y / tile_height};
+    const xd::vec2 end{to.x / tile_width, to.y / tile_height};
+    const auto delta = end - start;
+    int x = static_cast<int>(std::floor(start.x));
+    int y = static_cast<int>(std::floor(start.y));
+    const int end_x = static_cast<int>(std::floor(end.x));
+    const int end_y = static_cast<int>(std::floor(end.y));
+    const int step_x = delta.x > 0.0f ? 1 : -1;
+    const int step_y = delta.y > 0.0f ? 1 : -1;
+
+    constexpr auto infinity = std::numeric_limits<float>::infinity();
+    const float step_distance_x = delta.x != 0.0f ? std::abs(1.0f / delta.x) : infinity;
+    const float step_distance_y = delta.y != 0.0f ? std::abs(1.0f / delta.y) : infinity;
+    float next_x = delta.x != 0.0f
+        ? (delta.x > 0.0f ? x + 1 - start.x : start.x - x) * step_distance_x
+        : infinity;
+    float next_y = delta.y != 0.0f
+        ? (delta.y > 0.0f ? y + 1 - start.y : start.y - y) * step_distance_y
+        : infinity;
+
+    int steps = std::abs(end_x - x) + std::abs(end_y - y);
+    for (int i = 0; i < steps - 1; ++i) {
+        if (next_x < next_y) {
+            x += step_x;
+            next_x += step_distance_x;
+        } else {
+            y += step_y;
+            next_y += step_distance_y;
+        }
+        if (!tile_passable(x, y)) return false;
+    }
+    return true;
+}
+
+template<typename Predicate>
+void Map::find_objects(const Object_Filter& filter, std::vector<Map_Object*>& results,
+        Predicate predicate) const {
+    results.clear();
+    for (auto& [id, object] : objects) {
+        if (filter.matches(*object) && predicate(object->get_centered_position())) {
+            results.push_back(object.get());
+        }
+    }
+    std::sort(results.begin(), results.end(), [](Map_Object* a, Map_Object* b) {
+        return a->get_id() < b->get_id();
+    });
+}
+
+void Map::find_objects_in_radius(xd::vec2 center, float radius,
+        const Object_Filter& filter, std::vector<Map_Object*>& results) const {
+    const auto radius_squared = radius * radius;
+    find_objects(filter, results, [&](xd::vec2 position) {
+        auto offset = position - center;
+        return offset.x * offset.x + offset.y * offset.y <= radius_squared;
+    });
+}
+
+void Map::find_objects_in_rect(const xd::rect& rect,
+        const Object_Filter& filter, std::vector<Map_Object*>& results) const {
+    find_objects(filter, results, [&](xd::vec2 position) {
+        return rect.contains(position);
+    });
+}
+
+void Map::find_objects_in_sight(xd::vec2 center, float radius,
+        const Object_Filter& filter, std::vector<Map_Object*>& results) const {
+    const auto radius_squared = radius * radius;
+    find_objects(filter, results, [&](xd::vec2 position) {
+        auto offset = position - center;
+        return offset.x * offset.x + offset.y * offset.y <= radius_squared
+            && line_of_sight(center, position);
+    });
+}
+
 int Map::object_count() const noexcept {
     return objects.size();
 }
 
+void Map::store_previous_positions() {
+    for (auto& [id, object] : objects) {
+        object->store_previous_position();
+    }
+}
+
 Map_Object* Map::add_object(const std::shared_ptr<Map_Object>& object, Object_Layer* layer) {
     // Update ID counter for new objects
     int id = object->get_id();
@@ -693,11 +781,55 @@ rapidxml::xml_node<>* Map::save(rapidxml::xml_document<>& doc) {
     return node;
 }
 
+void Map::save(Bundle_Writer& writer, rapidxml::xml_document<>& doc) {
+    auto map_node = doc.first_node("map");
+    if (!map_node) {
+        throw tmx_exception("Invalid TMX file. Missing map node");
+    }
+
+    std::vector<std::vector<unsigned int>> layer_tiles;
+    for (auto layer_node = map_node->first_node("layer");
+            layer_node; layer_node = layer_node->next_sibling("layer")) {
+        auto width = std::stoi(layer_node->first_attribute("width")->value());
+        auto height = std::stoi(layer_node->first_attribute("height")->value());
+        layer_tiles.push_back(Tile_Layer::decode_tiles(*layer_node, width * height));
+        if (auto data_node = layer_node->first_node("data")) {
+            layer_node->remove_node(data_node);
+        }
+    }
+
+    std::string content;
+    rapidxml::print(std::back_inserter(content), doc, rapidxml::print_no_indenting);
+    writer.write(content);
+    writer.write(static_cast<std::uint32_t>(layer_tiles.size()));
+    for (auto& tiles : layer_tiles) {
+        writer.write(tiles);
+    }
+}
+
 std::unique_ptr<Map> Map::load(Game& game, const std::string& filename) {
     LOGGER_I << "Loading map " << filename;
     auto doc = std::make_unique< rapidxml::xml_document<>>();
     auto fs = file_utilities::game_data_filesystem();
-    char* content = doc->allocate_string(fs->read_file(filename).c_str());
+
+    // The document is parsed in place, so the content must outlive it
+    std::vector<std::vector<unsigned int>> layer_tiles;
+    std::string bundled_content;
+    File_Buffer file_content;
+    char* content = nullptr;
+    auto bundle = Asset_Bundle::game_bundle();
+    if (auto record = bundle ? bundle->find(Asset_Bundle::Record_Type::MAP, filename) : std::nullopt) {
+        Bundle_Reader reader{*record};
+        bundled_content = reader.read_string();
+        content = bundled_content.data();
+        auto layer_count = reader.read<std::uint32_t>();
+        for (std::uint32_t i = 0; i < layer_count; ++i) {
+            layer_tiles.push_back(reader.read_vector<unsigned int>());
+        }
+    } else {
+        file_content = fs->read_file_buffer(filename);
+        content = file_content.data();
+    }
     doc->parse<0>(content);
 
     auto map_node = doc->first_node("map");
@@ -705,7 +837,7 @@ std::unique_ptr<Map> Map::load(Game& game, const std::string& filename) {
         throw tmx_exception("Invalid TMX file. Missing map node");
     }
 
-    auto map = load(game, *map_node);
+    auto map = load(game, *map_node, layer_tiles.empty() ? nullptr : &layer_tiles);
 
     map->filename = filename;
     string_utilities::normalize_slashes(map->filename);
@@ -714,7 +846,8 @@ std::unique_ptr<Map> Map::load(Game& game, const std::string& filename) {
     return map;
 }
 
-std::unique_ptr<Map> Map::load(Game& game, rapidxml::xml_node<>& node) {
+std::unique_ptr<Map> Map::load(Game& game, rapidxml::xml_node<>& node,
+        const std::vector<std::vector<unsigned int>>* layer_tiles) {
     auto map_ptr = std::make_unique<Map>(game);
 
     if (node.first_attribute("orientation")->value() != std::string("orthogonal")) {
@@ -813,12 +946,20 @@ std::unique_ptr<Map> Map::load(Game& game, rapidxml::xml_node<>& node) {
     }
 
     // Layers
+    std::size_t tile_layer_index = 0;
     rapidxml::xml_node<>* layer_node = node.first_node();
     while (layer_node) {
         std::shared_ptr<Layer> layer;
         std::string node_name(layer_node->name());
         if (node_name == "layer") {
-            layer = std::shared_ptr<Layer>(Tile_Layer::load(*layer_node, *game.get_camera()));
+            const std::vector<unsigned int>* decoded_tiles = nullptr;
+            if (layer_tiles) {
+                if (tile_layer_index >= layer_tiles->size()) {
+                    throw tmx_exception("Missing pre-decoded tiles for tile layer");
+                }
+                decoded_tiles = &(*layer_tiles)[tile_layer_index++];
+            }
+            layer = std::shared_ptr<Layer>(Tile_Layer::load(*layer_node, *game.get_camera(), decoded_tiles));
             if (layer->get_name() == "collision") {
                 layer->set_visible(false);
                 map_ptr->collision_layer = static_cast<Tile_Layer*>(layer.get());
@@ -855,6 +996,7 @@ std::unique_ptr<Map> Map::load(Game& game, rapidxml::xml_node<>& node) {
 }
 
 void Map_Renderer::render(Map& map) {
+    PROFILE_ZONE("Map_Renderer::render");
     for (auto& layer : map.layers) {
         auto renderer = layer->get_renderer();
         if (!renderer) continue;
@@ -873,6 +1015,7 @@ void Map_Renderer::render(Map& map) {
 
 void Map_Updater::update(Map& map) {
     if (map.get_game().is_paused()) return;
+    PROFILE_ZONE("Map_Updater::update");
 
     map.game.set_current_scripting_interface(map.scripting_interface.get());
     map.scripting_interface->update();
@@ -884,3 +1027,13 @@ void Map_Updater::update(Map& map) {
         }
     }
 }
+
+bool Object_Filter::matches(const Map_Object& object) const {
+    if (type && object.get_type() != *type) return false;
+    if (layer && object.get_layer() != *layer) return false;
+    if (property) {
+        if (!object.has_property(*property)) return false;
+        if (value && object.get_property(*property) != *value) return false;
+    }
+    return true;
+}
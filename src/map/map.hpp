@@ -7,10 +7,12 @@
 #include "../vendor/rapidxml.hpp"
 #include "../xd/asset_manager.hpp"
 #include "../xd/entity.hpp"
+#include "../xd/graphics/types.hpp"
 #include "../xd/vendor/sol/forward.hpp"
 #include "collision_check_options.hpp"
 #include "collision_record.hpp"
 #include "layers/layer_types.hpp"
+#include "object_filter.hpp"
 #include "tileset.hpp"
 #include "tmx_properties.hpp"
 #include <memory>
@@ -22,6 +24,7 @@
 namespace xd {
     class sound;
 }
+class Bundle_Writer;
 class Game;
 class Map_Object;
 class Base_Canvas;
@@ -76,6 +79,18 @@ public:
     Collision_Record passable(Collision_Check_Options options) const;
     // Check if a particular tile is passable
     bool tile_passable(int x, int y) const noexcept;
+    // Check that no blocking tile lies between the two points
+    // (the tiles containing the points themselves aren't checked)
+    bool line_of_sight(xd::vec2 from, xd::vec2 to) const noexcept;
+    // Find the objects whose center is inside the circle, sorted by ID
+    void find_objects_in_radius(xd::vec2 center, float radius,
+        const Object_Filter& filter, std::vector<Map_Object*>& results) const;
+    // Find the objects whose center is inside the rectangle, sorted by ID
+    void find_objects_in_rect(const xd::rect& rect,
+        const Object_Filter& filter, std::vector<Map_Object*>& results) const;
+    // Find the objects in the radius that are in line of sight of the center
+    void find_objects_in_sight(xd::vec2 center, float radius,
+        const Object_Filter& filter, std::vector<Map_Object*>& results) const;
     // Get number of objects
     int object_count() const noexcept;
     // Add an object to object layer (or center object layer if no layer)
@@ -93,6 +108,8 @@ public:
     Map_Object* get_object(std::string name) const;
     // Get object by ID
     Map_Object* get_object(int id) const;
+    // Remember every object's position before the logic step moves them
+    void store_previous_positions();
     // Get all objects
     std::unordered_map<int, std::shared_ptr<Map_Object>>& get_objects() {
         return objects;
@@ -141,10 +158,14 @@ public:
     void save(std::string filename);
     // Save map to XML document
     rapidxml::xml_node<>* save(rapidxml::xml_document<>& doc);
-    // Load map from a TMX file
+    // Load map from a TMX file, or its asset bundle record if there's one
     static std::unique_ptr<Map> load(Game& game, const std::string& filename);
-    // Load map from a TMX map node
-    static std::unique_ptr<Map> load(Game& game, rapidxml::xml_node<>& node);
+    // Load map from a TMX map node, optionally with pre-decoded tiles for each tile layer
+    static std::unique_ptr<Map> load(Game& game, rapidxml::xml_node<>& node,
+        const std::vector<std::vector<unsigned int>>* layer_tiles = nullptr);
+    // Write a TMX map node as an asset bundle record. The tile layer data is
+    // decoded and stored separately, and removed from the node
+    static void save(Bundle_Writer& writer, rapidxml::xml_document<>& doc);
     // Getters and setters
     Game& get_game() {
         return game;
@@ -311,6 +332,10 @@ private:
     Audio_Cache audio_cache;
     // Used to uniquely identify typewriter text effects
     int last_typewriter_slot;
+    // Collect the matching objects whose center passes the predicate
+    template<typename Predicate>
+    void find_objects(const Object_Filter& filter, std::vector<Map_Object*>& results,
+        Predicate predicate) const;
     // Remove object from ID and name hash tables
     void erase_object_references(const Map_Object* object);
     void run_script_impl(const std::string& script_or_filename, bool is_filename);
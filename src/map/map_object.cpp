@@ -21,6 +21,7 @@ Map_Object::Map_Object(Game& game, xd::asset_manager& asset_manager,
         , id(-1)
         , name(name)
         , position(pos)
+        , previous_position(pos)
         , color(1.0f)
         , magnification(1.0f)
         , outline_conditions(get_default_outline_conditions())
@@ -197,6 +198,10 @@ void  Map_Object::set_leave_script(const std::string& script) {
     leave_script = prepare_script(script);
 }
 
+xd::vec2 Map_Object::get_interpolated_position(float alpha) const {
+    return lerp(previous_position, position, alpha);
+}
+
 xd::vec2 Map_Object::get_sprite_magnification() const {
     if (sprite)
         return sprite->get_frame().magnification;
@@ -323,13 +328,13 @@ void Map_Object::set_angle(int angle) {
 }
 
 float Map_Object::get_movement_speed() const {
-    auto logic_fps = Configurations::get<int>("graphics.logic-fps", "debug.logic-fps");
-    return speed * logic_fps / 60.0f;
+    static const Configurations::Handle<int> logic_fps("graphics.logic-fps", "debug.logic-fps");
+    return speed * logic_fps.get() / 60.0f;
 }
 
 void Map_Object::set_movement_speed(float new_speed) {
-    auto logic_fps = Configurations::get<int>("graphics.logic-fps", "debug.logic-fps");
-    speed = new_speed * 60.0f / logic_fps;
+    static const Configurations::Handle<int> logic_fps("graphics.logic-fps", "debug.logic-fps");
+    speed = new_speed * 60.0f / logic_fps.get();
 }
 
 float Map_Object::get_animation_speed() const {
@@ -479,14 +484,14 @@ std::unique_ptr<Map_Object> Map_Object::load(rapidxml::xml_node<>& node, Game& g
     }
 
     if (auto x_node = node.first_attribute("x")) {
-        object_ptr->position.x = std::stof(x_node->value());
+        object_ptr->set_x(std::stof(x_node->value()));
     } else {
         throw tmx_exception("Missing X coordinate for object with ID "
             + std::to_string(object_ptr->id));
     }
 
     if (auto y_node = node.first_attribute("y")) {
-        object_ptr->position.y = std::stof(y_node->value());
+        object_ptr->set_y(std::stof(y_node->value()));
     } else {
         throw tmx_exception("Missing Y coordinate for object with ID "
             + std::to_string(object_ptr->id));
@@ -52,6 +52,9 @@ public:
     Object_Layer* get_layer() {
         return layer;
     }
+    const Object_Layer* get_layer() const {
+        return layer;
+    }
     void set_layer(Object_Layer* new_layer) {
         layer = new_layer;
     }
@@ -74,21 +77,35 @@ public:
     xd::vec2 get_position() const {
         return position;
     }
+    // Setting the position directly teleports the object, so it isn't interpolated
     void set_position(xd::vec2 new_position) {
         position = new_position;
+        previous_position = new_position;
     }
     float get_x() const {
         return position.x;
     }
     void set_x(float x) {
         position.x = x;
+        previous_position.x = x;
     }
     float get_y() const {
         return position.y;
     }
     void set_y(float y) {
         position.y = y;
+        previous_position.y = y;
+    }
+    // Position before the current logic step
+    xd::vec2 get_previous_position() const {
+        return previous_position;
+    }
+    // Called at the start of every logic step
+    void store_previous_position() {
+        previous_position = position;
     }
+    // Position between the previous and the current logic step, used for rendering
+    xd::vec2 get_interpolated_position(float alpha) const;
     xd::vec2 get_text_position() const;
     xd::vec2 get_size() const;
     void set_size(xd::vec2 new_size);
@@ -415,6 +432,8 @@ private:
     std::string type;
     // Object's position
     xd::vec2 position;
+    // Position before the current logic step
+    xd::vec2 previous_position;
     // Object's size
     xd::vec2 size;
     // Object's tint color
@@ -0,0 +1,22 @@
+#ifndef HPP_OBJECT_FILTER
+#define HPP_OBJECT_FILTER
+
+#include <optional>
+#include <string>
+
+class Map_Object;
+class Object_Layer;
+
+// Filter for map object queries, unset fields match any object
+struct Object_Filter {
+    std::optional<std::string> type;
+    // A null layer matches nothing (e.g. an unknown layer name)
+    std::optional<const Object_Layer*> layer;
+    std::optional<std::string> property;
+    // If set, the property must have this value
+    std::optional<std::string> value;
+
+    bool matches(const Map_Object& object) const;
+};
+
+#endif
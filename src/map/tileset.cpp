@@ -1,10 +1,12 @@
 #include "tileset.hpp"
+#include "../asset_bundle.hpp"
 #include "../exceptions.hpp"
 #include "../utility/color.hpp"
 #include "../utility/file.hpp"
 #include "../utility/string.hpp"
+#include "../utility/texture.hpp"
 #include "../utility/xml.hpp"
-#include <istream>
+#include "../xd/graphics/image.hpp"
 
 rapidxml::xml_node<>* Tileset::save(rapidxml::xml_document<>& doc) {
     auto node = xml_node(doc, "tileset");
@@ -36,11 +38,33 @@ rapidxml::xml_node<>* Tileset::save(rapidxml::xml_document<>& doc) {
     return node;
 }
 
+void Tileset::save(Bundle_Writer& writer) const {
+    writer.write(static_cast<std::int32_t>(first_id));
+    writer.write(name);
+    writer.write(filename);
+    writer.write(static_cast<std::int32_t>(tile_width));
+    writer.write(static_cast<std::int32_t>(tile_height));
+    properties.save(writer);
+    writer.write(image_source);
+    writer.write(image_trans_color);
+    writer.write(static_cast<std::uint32_t>(tiles.size()));
+    for (auto& tile : tiles) {
+        writer.write(static_cast<std::int32_t>(tile.id));
+        tile.properties.save(writer);
+    }
+}
+
 std::unique_ptr<Tileset> Tileset::load(const std::string& filename) {
+    auto bundle = Asset_Bundle::game_bundle();
+    if (auto record = bundle ? bundle->find(Asset_Bundle::Record_Type::TILESET, filename) : std::nullopt) {
+        Bundle_Reader reader{*record};
+        return load(reader);
+    }
+
     auto doc = std::make_unique<rapidxml::xml_document<>>();
     auto fs = file_utilities::game_data_filesystem();
-    auto content = doc->allocate_string(fs->read_file(filename).c_str());
-    doc->parse<0>(content);
+    auto content = fs->read_file_buffer(filename);
+    doc->parse<0>(content.data());
     auto tileset_node = doc->first_node("tileset");
     if (!tileset_node)
         throw tmx_exception("Invalid external tileset TMX file. Missing tileset node");
@@ -52,38 +76,51 @@ std::unique_ptr<Tileset> Tileset::load(const std::string& filename) {
 
 std::unique_ptr<Tileset> Tileset::load(rapidxml::xml_node<>& node) {
     auto tileset_ptr = std::make_unique<Tileset>();
-    int first_id = 1;
+    tileset_ptr->read(node);
+    tileset_ptr->load_texture();
+    return tileset_ptr;
+}
+
+std::unique_ptr<Tileset> Tileset::load(Bundle_Reader& reader) {
+    auto tileset_ptr = std::make_unique<Tileset>();
+    tileset_ptr->first_id = reader.read<std::int32_t>();
+    tileset_ptr->name = reader.read_string();
+    tileset_ptr->filename = reader.read_string();
+    tileset_ptr->tile_width = reader.read<std::int32_t>();
+    tileset_ptr->tile_height = reader.read<std::int32_t>();
+    tileset_ptr->properties.read(reader);
+    tileset_ptr->image_source = reader.read_string();
+    tileset_ptr->image_trans_color = reader.read<xd::vec4>();
+    auto tile_count = reader.read<std::uint32_t>();
+    for (std::uint32_t i = 0; i < tile_count; ++i) {
+        Tile tile;
+        tile.id = reader.read<std::int32_t>();
+        tile.properties.read(reader);
+        tileset_ptr->tiles.push_back(tile);
+    }
+
+    tileset_ptr->load_texture();
+    return tileset_ptr;
+}
+
+void Tileset::read(rapidxml::xml_node<>& node) {
+    first_id = 1;
     if (auto first_id_attr = node.first_attribute("firstgid"))
         first_id = std::stoi(first_id_attr->value());
-    tileset_ptr->first_id = first_id;
-    tileset_ptr->name = node.first_attribute("name")->value();
-    tileset_ptr->tile_width = std::stoi(
-        node.first_attribute("tilewidth")->value());
-    tileset_ptr->tile_height = std::stoi(
-        node.first_attribute("tileheight")->value());
+    name = node.first_attribute("name")->value();
+    tile_width = std::stoi(node.first_attribute("tilewidth")->value());
+    tile_height = std::stoi(node.first_attribute("tileheight")->value());
 
     // Tileset properties
-    tileset_ptr->properties.read(node);
+    properties.read(node);
 
     // Image
     if (auto image_node = node.first_node("image")) {
-        tileset_ptr->image_source = image_node->first_attribute("source")->value();
-        string_utilities::normalize_slashes(tileset_ptr->image_source);
+        image_source = image_node->first_attribute("source")->value();
+        string_utilities::normalize_slashes(image_source);
         if (auto trans_attr = image_node->first_attribute("trans")) {
-            tileset_ptr->image_trans_color = hex_to_color(trans_attr->value());
-        }
-
-        auto fs = file_utilities::game_data_filesystem();
-        auto stream = fs->open_binary_ifstream(tileset_ptr->image_source);
-        if (!stream || !*stream) {
-            throw file_loading_exception{ "Failed to load tileset image " + tileset_ptr->image_source };
+            image_trans_color = hex_to_color(trans_attr->value());
         }
-
-        // Load the texture
-        tileset_ptr->image_texture = std::make_shared<xd::texture>(
-            tileset_ptr->image_source,
-            *stream,
-            tileset_ptr->image_trans_color);
     }
 
     // Tiles
@@ -92,10 +129,19 @@ std::unique_ptr<Tileset> Tileset::load(rapidxml::xml_node<>& node) {
         Tile tile;
         tile.id = std::stoi(tile_node->first_attribute("id")->value());
         tile.properties.read(*tile_node);
-        tileset_ptr->tiles.push_back(tile);
+        tiles.push_back(tile);
     }
+}
 
-    return tileset_ptr;
+void Tileset::load_texture() {
+    if (image_source.empty()) return;
+
+    try {
+        auto image = texture_utilities::decode_image(image_source, image_trans_color);
+        image_texture = std::make_shared<xd::texture>(*image);
+    } catch (const file_loading_exception&) {
+        throw file_loading_exception{ "Failed to load tileset image " + image_source };
+    }
 }
 
 xd::rect Tileset::tile_source_rect(int tile_index) const {
@@ -9,6 +9,9 @@
 #include <string>
 #include <vector>
 
+class Bundle_Reader;
+class Bundle_Writer;
+
 struct Tileset : public Tmx_Object {
     struct Tile {
         int id;
@@ -37,8 +40,15 @@ struct Tileset : public Tmx_Object {
     Tileset() : first_id(0), tile_width(1), tile_height(1) {}
 
     rapidxml::xml_node<>* save(rapidxml::xml_document<>& doc);
+    void save(Bundle_Writer& writer) const;
+    // Load from a TSX file, or its asset bundle record if there's one
     static std::unique_ptr<Tileset> load(const std::string& filename);
     static std::unique_ptr<Tileset> load(rapidxml::xml_node<>& node);
+    static std::unique_ptr<Tileset> load(Bundle_Reader& reader);
+    // Read the TMX/TSX data without loading the image
+    void read(rapidxml::xml_node<>& node);
+    // Load the texture from image_source
+    void load_texture();
     xd::rect tile_source_rect(int tile_index) const;
 };
 
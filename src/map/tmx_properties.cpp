@@ -1,4 +1,5 @@
 #include "tmx_properties.hpp"
+#include "../asset_bundle.hpp"
 #include "../utility/xml.hpp"
 #include "../utility/string.hpp"
 
@@ -29,6 +30,23 @@ void Tmx_Properties::save(rapidxml::xml_document<>& doc, rapidxml::xml_node<>& n
     }
 }
 
+void Tmx_Properties::read(Bundle_Reader& reader) {
+    auto count = reader.read<std::uint32_t>();
+    for (std::uint32_t i = 0; i < count; ++i) {
+        auto name = reader.read_string();
+        properties[name] = reader.read_string();
+        ordered_keys.push_back(name);
+    }
+}
+
+void Tmx_Properties::save(Bundle_Writer& writer) const {
+    writer.write(static_cast<std::uint32_t>(ordered_keys.size()));
+    for (auto& key : ordered_keys) {
+        writer.write(key);
+        writer.write(properties.at(key));
+    }
+}
+
 void Tmx_Object::set_editor_property(const std::string& prop_name, const std::string& value, const std::string& default_value, bool capitalize_value) {
     auto old_value = string_utilities::capitalize(get_property(prop_name));
     auto cap_value = string_utilities::capitalize(value);
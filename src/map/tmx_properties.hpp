@@ -7,6 +7,9 @@
 #include <unordered_map>
 #include <vector>
 
+class Bundle_Reader;
+class Bundle_Writer;
+
 class Tmx_Properties {
 public:
     bool contains(const std::string& key) const {
@@ -34,6 +37,8 @@ public:
     std::unordered_map<std::string, std::string>::const_iterator cend() const { return properties.cend(); }
     void read(rapidxml::xml_node<>& parent_node);
     void save(rapidxml::xml_document<>& doc, rapidxml::xml_node<>& node);
+    void read(Bundle_Reader& reader);
+    void save(Bundle_Writer& writer) const;
 private:
     std::unordered_map<std::string, std::string> properties;
     std::vector<std::string> ordered_keys;
@@ -54,7 +54,11 @@ namespace {
 
 Player_Controller::Player_Controller(Game& game)
     : game(game),
-    action_button(Configurations::get<std::string>("controls.action-button")),
+    up_action(game.action_id("up")),
+    down_action(game.action_id("down")),
+    left_action(game.action_id("left")),
+    right_action(game.action_id("right")),
+    action_button(game.action_id(Configurations::get<std::string>("controls.action-button"))),
     last_collision_check(game.ticks()),
     last_action_press(-1),
     last_action_direction(Direction::NONE),
@@ -66,10 +70,10 @@ void Player_Controller::update(Map_Object& object) {
 
     auto check_input = !object.is_disabled();
     if (check_input) {
-        if (game.pressed("up")) direction = direction | Direction::UP;
-        if (game.pressed("down")) direction = direction | Direction::DOWN;
-        if (game.pressed("right")) direction = direction | Direction::RIGHT;
-        if (game.pressed("left")) direction = direction | Direction::LEFT;
+        if (game.pressed(up_action)) direction = direction | Direction::UP;
+        if (game.pressed(down_action)) direction = direction | Direction::DOWN;
+        if (game.pressed(right_action)) direction = direction | Direction::RIGHT;
+        if (game.pressed(left_action)) direction = direction | Direction::LEFT;
     }
 
     auto ticks = game.ticks();
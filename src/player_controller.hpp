@@ -13,7 +13,12 @@ public:
     void update(Map_Object& object);
 private:
     Game& game;
-    std::string action_button;
+    // Action IDs of the movement and action buttons
+    int up_action;
+    int down_action;
+    int left_action;
+    int right_action;
+    int action_button;
     int last_collision_check;
     int last_action_press;
     Direction last_action_direction;
@@ -0,0 +1,291 @@
+#include "profiler.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <unordered_map>
+
+namespace detail {
+    // Events recorded by a single thread, overwriting the oldest ones once full
+    struct Profile_Thread_Buffer {
+        // Only contended while summarizing or exporting
+        std::mutex mutex;
+        std::vector<Profile_Event> events;
+        std::uint64_t written = 0;
+        std::uint64_t summarized = 0;
+        int id = 0;
+        std::string name;
+        // Only touched by the owning thread
+        int depth = 0;
+        std::vector<Profile_Event> batch;
+
+        // Move the batched events to the ring buffer
+        void publish() {
+            if (batch.empty()) return;
+            std::lock_guard<std::mutex> lock(mutex);
+            for (auto& event : batch) {
+                if (events.size() < Profiler::events_per_thread) {
+                    // Grow up to the full size, threads that record little don't pay for it
+                    events.push_back(event);
+                } else {
+                    events[static_cast<std::size_t>(written % Profiler::events_per_thread)] = event;
+                }
+                ++written;
+            }
+            batch.clear();
+        }
+
+        std::uint64_t first_available() const {
+            auto capacity = static_cast<std::uint64_t>(Profiler::events_per_thread);
+            return written > capacity ? written - capacity : 0;
+        }
+        const Profile_Event& at(std::uint64_t index) const {
+            return events[static_cast<std::size_t>(index % Profiler::events_per_thread)];
+        }
+    };
+
+    struct Profile_Zone_History {
+        std::array<double, Profiler::summary_frames> ms{};
+        std::array<int, Profiler::summary_frames> calls{};
+    };
+
+    struct Profiler_State {
+        // Guards the buffer list and the summary
+        std::mutex mutex;
+        std::vector<std::unique_ptr<Profile_Thread_Buffer>> buffers;
+        std::unordered_map<std::string, Profile_Zone_History> history;
+        int frames = 0;
+        std::atomic<bool> enabled{true};
+    };
+
+    static const auto profiler_epoch = std::chrono::steady_clock::now();
+
+    static Profiler_State& profiler_state() {
+        // Never destroyed, other threads might still record during static destruction
+        static auto state = new Profiler_State();
+        return *state;
+    }
+
+    // Publishes the last batch when the thread exits, the buffer itself is
+    // owned by the (never destroyed) profiler state
+    struct Profile_Thread_Owner {
+        Profile_Thread_Buffer* buffer = nullptr;
+        ~Profile_Thread_Owner() {
+            if (buffer) {
+                buffer->publish();
+            }
+        }
+    };
+
+    static Profile_Thread_Buffer& thread_buffer() {
+        thread_local Profile_Thread_Owner owner;
+        if (!owner.buffer) {
+            auto& state = profiler_state();
+            std::lock_guard<std::mutex> lock(state.mutex);
+            state.buffers.push_back(std::make_unique<Profile_Thread_Buffer>());
+            owner.buffer = state.buffers.back().get();
+            owner.buffer->id = static_cast<int>(state.buffers.size());
+            owner.buffer->name = "Thread " + std::to_string(owner.buffer->id);
+            owner.buffer->batch.reserve(Profiler::events_per_batch);
+        }
+        return *owner.buffer;
+    }
+
+    static void write_json_string(std::ostream& stream, const std::string& text) {
+        stream << '"';
+        for (auto c : text) {
+            switch (c) {
+            case '"':
+                stream << "\\\"";
+                break;
+            case '\\':
+                stream << "\\\\";
+                break;
+            case '\n':
+                stream << "\\n";
+                break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    stream << "\\u" << std::hex << std::setw(4) << std::setfill('0')
+                        << static_cast<int>(c) << std::dec << std::setfill(' ');
+                } else {
+                    stream << c;
+                }
+            }
+        }
+        stream << '"';
+    }
+}
+
+bool Profiler::is_enabled() noexcept {
+    return detail::profiler_state().enabled.load(std::memory_order_relaxed);
+}
+
+void Profiler::set_enabled(bool enabled) noexcept {
+    detail::profiler_state().enabled.store(enabled, std::memory_order_relaxed);
+}
+
+std::int64_t Profiler::now() noexcept {
+    auto elapsed = std::chrono::steady_clock::now() - detail::profiler_epoch;
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+}
+
+void Profiler::set_thread_name(const std::string& name) {
+    auto& buffer = detail::thread_buffer();
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    buffer.name = name;
+}
+
+void Profiler::end_frame() {
+    detail::thread_buffer().publish();
+    auto& state = detail::profiler_state();
+    std::lock_guard<std::mutex> lock(state.mutex);
+
+    struct Frame_Total {
+        std::int64_t duration = 0;
+        int calls = 0;
+    };
+    std::unordered_map<std::string, Frame_Total> totals;
+    for (auto& buffer : state.buffers) {
+        std::lock_guard<std::mutex> buffer_lock(buffer->mutex);
+        auto first = std::max(buffer->summarized, buffer->first_available());
+        for (auto i = first; i < buffer->written; ++i) {
+            auto& event = buffer->at(i);
+            auto& total = totals[event.name];
+            total.duration += event.end - event.start;
+            ++total.calls;
+        }
+        buffer->summarized = buffer->written;
+    }
+
+    auto slot = state.frames % summary_frames;
+    for (auto& [name, history] : state.history) {
+        history.ms[slot] = 0.0;
+        history.calls[slot] = 0;
+    }
+    for (auto& [name, total] : totals) {
+        auto& history = state.history[name];
+        history.ms[slot] = total.duration / 1000000.0;
+        history.calls[slot] = total.calls;
+    }
+    ++state.frames;
+}
+
+std::vector<Profile_Zone_Summary> Profiler::summary() {
+    auto& state = detail::profiler_state();
+    std::lock_guard<std::mutex> lock(state.mutex);
+
+    std::vector<Profile_Zone_Summary> result;
+    auto frames = std::min(state.frames, summary_frames);
+    if (frames == 0) return result;
+
+    for (auto& [name, history] : state.history) {
+        Profile_Zone_Summary zone{ name, 0.0, 0.0, 0.0 };
+        for (int i = 0; i < frames; ++i) {
+            zone.average_ms += history.ms[i];
+            zone.max_ms = std::max(zone.max_ms, history.ms[i]);
+            zone.calls += history.calls[i];
+        }
+        zone.average_ms /= frames;
+        zone.calls /= frames;
+        result.push_back(zone);
+    }
+
+    std::sort(result.begin(), result.end(), [](auto& a, auto& b) {
+        return a.average_ms > b.average_ms || (a.average_ms == b.average_ms && a.name < b.name);
+    });
+    return result;
+}
+
+std::vector<Profile_Event> Profiler::thread_events() {
+    auto& buffer = detail::thread_buffer();
+    buffer.publish();
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    std::vector<Profile_Event> result;
+    for (auto i = buffer.first_available(); i < buffer.written; ++i) {
+        result.push_back(buffer.at(i));
+    }
+    return result;
+}
+
+void Profiler::write_chrome_trace(std::ostream& stream) {
+    detail::thread_buffer().publish();
+    auto& state = detail::profiler_state();
+    std::lock_guard<std::mutex> lock(state.mutex);
+
+    auto flags = stream.flags();
+    auto precision = stream.precision();
+    stream << std::fixed << std::setprecision(3);
+
+    stream << "{\"traceEvents\":[";
+    bool first = true;
+    for (auto& buffer : state.buffers) {
+        std::lock_guard<std::mutex> buffer_lock(buffer->mutex);
+        stream << (first ? "\n" : ",\n");
+        first = false;
+        stream << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":"
+            << buffer->id << ",\"args\":{\"name\":";
+        detail::write_json_string(stream, buffer->name);
+        stream << "}}";
+
+        for (auto i = buffer->first_available(); i < buffer->written; ++i) {
+            auto& event = buffer->at(i);
+            stream << ",\n{\"name\":";
+            detail::write_json_string(stream, event.name);
+            stream << ",\"cat\":\"engine\",\"ph\":\"X\",\"ts\":" << event.start / 1000.0
+                << ",\"dur\":" << (event.end - event.start) / 1000.0
+                << ",\"pid\":1,\"tid\":" << buffer->id
+                << ",\"args\":{\"depth\":" << event.depth << "}}";
+        }
+    }
+    stream << "\n],\"displayTimeUnit\":\"ms\"}\n";
+
+    stream.flags(flags);
+    stream.precision(precision);
+}
+
+void Profiler::clear() {
+    detail::thread_buffer().batch.clear();
+    auto& state = detail::profiler_state();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    for (auto& buffer : state.buffers) {
+        std::lock_guard<std::mutex> buffer_lock(buffer->mutex);
+        buffer->events.clear();
+        buffer->written = 0;
+        buffer->summarized = 0;
+    }
+    state.history.clear();
+    state.frames = 0;
+}
+
+int Profiler::enter_zone() noexcept {
+    return detail::thread_buffer().depth++;
+}
+
+void Profiler::leave_zone(const char* name, std::int64_t start, int depth) noexcept {
+    auto end = now();
+    auto& buffer = detail::thread_buffer();
+    --buffer.depth;
+
+    buffer.batch.push_back(Profile_Event{ name, start, end, depth });
+    if (buffer.batch.size() >= events_per_batch) {
+        buffer.publish();
+    }
+}
+
+Profile_Zone::Profile_Zone(const char* name) noexcept : name(nullptr), start(0), depth(0) {
+    if (!Profiler::is_enabled()) return;
+    this->name = name;
+    depth = Profiler::enter_zone();
+    start = Profiler::now();
+}
+
+Profile_Zone::~Profile_Zone() {
+    if (name) {
+        Profiler::leave_zone(name, start, depth);
+    }
+}
@@ -0,0 +1,97 @@
+#ifndef HPP_PROFILER
+#define HPP_PROFILER
+
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+// A finished profiling zone. Times are in nanoseconds since the profiler started
+struct Profile_Event {
+    const char* name;
+    std::int64_t start;
+    std::int64_t end;
+    // Number of zones this one is nested in
+    int depth;
+};
+
+// Timings of a zone over the last frames
+struct Profile_Zone_Summary {
+    std::string name;
+    // Average time spent in the zone per frame
+    double average_ms;
+    // Time spent in the zone during the worst frame
+    double max_ms;
+    // Average number of times the zone was entered per frame
+    double calls;
+};
+
+// Records scoped zones (see PROFILE_ZONE) into a ring buffer per thread.
+// Zones are batched without locking and published to the ring buffer once
+// the batch is full, when the thread exits, or when the recording thread
+// calls end_frame, thread_events or write_chrome_trace. The summary covers
+// the last summary_frames frames, and the whole buffer can be exported in
+// Chrome's trace format (chrome://tracing or Perfetto)
+class Profiler {
+public:
+    // Events kept per thread
+    static constexpr std::size_t events_per_thread = 1 << 14;
+    // Events a thread batches before publishing them
+    static constexpr std::size_t events_per_batch = 256;
+    // Number of frames in the rolling summary
+    static constexpr int summary_frames = 120;
+
+    // Recording can be paused at runtime
+    static bool is_enabled() noexcept;
+    static void set_enabled(bool enabled) noexcept;
+    // Nanoseconds since the profiler started
+    static std::int64_t now() noexcept;
+    // Name the calling thread in exported traces
+    static void set_thread_name(const std::string& name);
+    // Mark the end of a frame, adding the zones recorded since the last call to the summary
+    static void end_frame();
+    // Per-zone timings over the last frames, sorted by average time
+    static std::vector<Profile_Zone_Summary> summary();
+    // Events recorded by the calling thread, oldest first
+    static std::vector<Profile_Event> thread_events();
+    // Write every recorded event as Chrome trace event JSON
+    static void write_chrome_trace(std::ostream& stream);
+    // Forget all the recorded events and the summary (batches other threads
+    // haven't published yet are kept)
+    static void clear();
+private:
+    friend class Profile_Zone;
+    // Returns the depth of the new zone
+    static int enter_zone() noexcept;
+    static void leave_zone(const char* name, std::int64_t start, int depth) noexcept;
+};
+
+// Records the time between its construction and destruction
+class Profile_Zone {
+public:
+    // The name should be a string literal (or otherwise outlive the profiler)
+    explicit Profile_Zone(const char* name) noexcept;
+    ~Profile_Zone();
+    Profile_Zone(const Profile_Zone&) = delete;
+    Profile_Zone& operator=(const Profile_Zone&) = delete;
+private:
+    const char* name;
+    std::int64_t start;
+    int depth;
+};
+
+// Zones, thread names and frame ends are only compiled in when
+// OCB_ENABLE_PROFILER is defined
+#ifdef OCB_ENABLE_PROFILER
+#define PROFILE_ZONE_CONCAT_IMPL(a, b) a##b
+#define PROFILE_ZONE_CONCAT(a, b) PROFILE_ZONE_CONCAT_IMPL(a, b)
+#define PROFILE_ZONE(name) Profile_Zone PROFILE_ZONE_CONCAT(profile_zone_, __LINE__)(name)
+#define PROFILE_THREAD_NAME(name) Profiler::set_thread_name(name)
+#define PROFILE_FRAME_END() Profiler::end_frame()
+#else
+#define PROFILE_ZONE(name) do {} while (false)
+#define PROFILE_THREAD_NAME(name) do {} while (false)
+#define PROFILE_FRAME_END() do {} while (false)
+#endif
+
+#endif
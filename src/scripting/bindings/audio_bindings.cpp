@@ -20,8 +20,11 @@ namespace detail {
             ? audio_player.get_sound_group_type(pausable.value())
             : game.get_sound_group_type();
         auto full_name = audio_player.get_audio_folder() + filename;
-        return std::make_unique<xd::sound>(*audio_player.get_audio(), full_name,
-            fs->open_binary_ifstream(full_name), group_type);
+        auto& audio = *audio_player.get_audio();
+        auto source = audio.get_sound_bank().load(full_name, [fs, &full_name]() {
+            return fs->open_binary_ifstream(full_name);
+        });
+        return std::make_unique<xd::sound>(audio, *source, group_type);
     }
 }
 
@@ -54,7 +57,7 @@ void bind_audio_types(sol::state& lua, Game& game) {
     auto music = lua.new_usertype<xd::music>("Music",
         sol::call_constructor, sol::factories(
             [&](const std::string& filename) {
-                auto audio_player = game.get_audio_player();
+                auto& audio_player = game.get_audio_player();
                 auto full_name = audio_player.get_audio_folder() + filename;
                 auto fs = file_utilities::game_data_filesystem();
                 return std::make_shared<xd::music>(*audio_player.get_audio(), full_name,
@@ -108,6 +111,9 @@ void bind_audio_types(sol::state& lua, Game& game) {
         return audio_player.load_map_config_sound(map, config_name, channel_count.value_or(1), pausable.value_or(true));
     };
 
+    audio_player["preload_music"] = &Audio_Player::preload_music;
+    audio_player["is_music_preloaded"] = &Audio_Player::is_music_preloaded;
+
     audio_player["load_music"] = [&game](Audio_Player& audio_player, const std::string& filename) {
         auto& map = *game.get_map();
         return audio_player.load_music(map, filename);
@@ -5,14 +5,18 @@
 #include "../../configurations.hpp"
 #include "../../environments/environment.hpp"
 #include "../../game.hpp"
+#include "../../profiler.hpp"
 #include "../../save_file.hpp"
 #include "../../utility/file.hpp"
+#include "../../xd/graphics/gl_state.hpp"
+#include "../../xd/lua/chunk_cache.hpp"
 #include "../../xd/vendor/sol/sol.hpp"
 #include <memory>
 #include <optional>
 #include <stdexcept>
 #include <string>
 #include <tuple>
+#include <unordered_map>
 
 void bind_game_types(sol::state& lua) {
     // Input type
@@ -41,6 +45,14 @@ void bind_game_types(sol::state& lua) {
     game_type["window_ticks"] = sol::property(&Game::window_ticks);
     game_type["fps"] = sol::property(&Game::fps);
     game_type["frame_count"] = sol::property(&Game::frame_count);
+    game_type["gl_state_changes"] = sol::property([](Game&) {
+        auto stats = xd::gl_state::frame_stats();
+        return sol::as_table(std::unordered_map<std::string, int>{
+            {"issued", stats.issued},
+            {"elided", stats.elided},
+            {"uniform_uploads", stats.uniform_uploads}
+        });
+    });
     game_type["stopped"] = sol::property(&Game::stopped);
     game_type["seconds"] = sol::property(&Game::seconds);
     game_type["paused"] = sol::property(&Game::is_paused);
@@ -97,16 +109,20 @@ void bind_game_types(sol::state& lua) {
         game->resume(script.value_or(""));
     };
 
-    game_type["pressed"] = [](Game* game, const std::string& key) {
-        return game->pressed(key);
-    };
+    game_type["action_id"] = &Game::action_id;
+    game_type["pressed"] = sol::overload(
+        [](Game* game, int action) { return game->pressed(action); },
+        [](Game* game, const std::string& key) { return game->pressed(key); }
+    );
     game_type["triggered"] = sol::overload(
         [](Game* game) { return game->triggered(); },
+        [](Game* game, int action) { return game->triggered(action); },
         [](Game* game, const std::string& key) { return game->triggered(key); }
     );
-    game_type["triggered_once"] = [](Game* game, const std::string& key) {
-        return game->triggered_once(key);
-    };
+    game_type["triggered_once"] = sol::overload(
+        [](Game* game, int action) { return game->triggered_once(action); },
+        [](Game* game, const std::string& key) { return game->triggered_once(key); }
+    );
     game_type["bind_key"] = sol::resolve<void(const std::string&, const std::string&)>(&Game::bind_key);
     game_type["unbind_physical_key"] = sol::resolve<void(const std::string&)>(&Game::unbind_physical_key);
     game_type["unbind_virtual_key"] = &Game::unbind_virtual_key;
@@ -119,6 +135,36 @@ void bind_game_types(sol::state& lua) {
     game_type["get_gamepad_name"] = &Game::get_gamepad_name;
     game_type["get_gamepad_guid"] = &Game::get_gamepad_guid;
 
+#ifdef OCB_ENABLE_PROFILER
+    game_type["profiler_enabled"] = sol::property(
+        [](Game&) { return Profiler::is_enabled(); },
+        [](Game&, bool enabled) { Profiler::set_enabled(enabled); }
+    );
+    game_type["profiler_summary"] = [](Game&, sol::this_state state) {
+        sol::state_view lua{state};
+        auto zones = lua.create_table();
+        for (auto& zone : Profiler::summary()) {
+            zones.add(lua.create_table_with(
+                "name", zone.name,
+                "average_ms", zone.average_ms,
+                "max_ms", zone.max_ms,
+                "calls", zone.calls));
+        }
+        return zones;
+    };
+    game_type["save_profile"] = [](Game& game, std::string filename) {
+        auto data_folder = file_utilities::user_data_folder(game.get_environment());
+        auto& filesystem = data_folder->get_filesystem();
+        if (!filesystem.is_absolute_path(filename)) {
+            filename = data_folder->get_version_path() + filename;
+        }
+        auto stream = filesystem.open_ofstream(filename, std::ios_base::out | std::ios_base::trunc);
+        if (!stream || !*stream) return false;
+        Profiler::write_chrome_trace(*stream);
+        return static_cast<bool>(*stream);
+    };
+#endif
+
     game_type["run_script"] = &Game::run_script;
     game_type["run_script_file"] = &Game::run_script_file;
     game_type["run_function"] = &Game::run_function;
@@ -186,8 +232,9 @@ void bind_game_types(sol::state& lua) {
     game_type["wait_for_input"] = sol::yielding(sol::overload(
         [](Game* game, const std::string& key) {
             auto& scheduler = game->get_current_scripting_interface()->get_scheduler();
-            scheduler.yield([game, key]() {
-                return game->triggered(key);
+            auto action = game->action_id(key);
+            scheduler.yield([game, action]() {
+                return game->triggered(action);
                 });
         },
         [](Game* game) {
@@ -207,16 +254,15 @@ void bind_game_types(sol::state& lua) {
         if (!filesystem->exists(filename)) {
             throw std::runtime_error{ "File was not found while trying to load Lua file: " + filename };
         }
-        auto script = filesystem->read_file(filename);
+        auto script = filesystem->read_file_buffer(filename);
 
         // The @ indicates a filename for debugging and printing the stack trace
-        sol::load_result result = lua.load(script, "@" + filename);
-        if (!result.valid()) {
-            throw std::runtime_error("Error loading " + filename + ": " + result.get<std::string>());
+        auto state = lua.lua_state();
+        if (xd::lua::chunk_cache::shared().load(state, script.data(), script.size(), "@" + filename) != LUA_OK) {
+            throw std::runtime_error("Error loading " + filename + ": " + sol::stack::pop<std::string>(state));
         }
 
-        sol::protected_function f = result;
-        return f;
+        return sol::stack::pop<sol::protected_function>(state);
     };
 
     game_type["open_url"] = [](Game&, const std::string& url) {
@@ -6,7 +6,65 @@
 #include "../../map/map_object.hpp"
 #include "../../utility/file.hpp"
 #include "../../xd/vendor/sol/sol.hpp"
+#include <deque>
 #include <string>
+#include <vector>
+
+namespace detail {
+    // Read an object query filter from a Lua table such as
+    // { type = "npc", layer = "objects", property = "hostile", value = "true" }
+    static Object_Filter read_object_filter(Map& map, const sol::optional<sol::table>& table) {
+        Object_Filter filter;
+        if (!table) return filter;
+
+        filter.type = table->get<std::optional<std::string>>("type");
+        filter.property = table->get<std::optional<std::string>>("property");
+        filter.value = table->get<std::optional<std::string>>("value");
+        sol::object layer = (*table)["layer"];
+        if (layer.is<Object_Layer*>()) {
+            filter.layer = layer.as<Object_Layer*>();
+        } else if (layer.is<std::string>()) {
+            filter.layer = map.get_object_layer_by_name(layer.as<std::string>());
+        }
+        return filter;
+    }
+
+    // Store the objects in the given table (or a new one), clearing any leftover entries
+    static sol::table to_object_table(sol::this_state state, const std::vector<Map_Object*>& objects,
+            const sol::optional<sol::table>& table) {
+        sol::table result = table ? *table : sol::state_view(state).create_table(static_cast<int>(objects.size()));
+        std::size_t index = 1;
+        for (auto object : objects) {
+            result.raw_set(index++, object);
+        }
+        while (result.raw_get<sol::object>(index) != sol::lua_nil) {
+            result.raw_set(index++, sol::lua_nil);
+        }
+        return result;
+    }
+
+    // Result buffers reused between queries. A query can run while another
+    // is still building its table (e.g. from a __gc metamethod triggered by
+    // the allocation), so every nesting level gets a buffer of its own
+    static std::deque<std::vector<Map_Object*>> query_buffers;
+    static std::size_t query_depth = 0;
+
+    struct Query_Results {
+        std::vector<Map_Object*>& objects;
+        Query_Results() : objects(acquire()) {}
+        ~Query_Results() { --query_depth; }
+        Query_Results(const Query_Results&) = delete;
+        Query_Results& operator=(const Query_Results&) = delete;
+    private:
+        static std::vector<Map_Object*>& acquire() {
+            // Growing a deque doesn't move the buffers in use
+            if (query_depth == query_buffers.size()) {
+                query_buffers.emplace_back();
+            }
+            return query_buffers[query_depth++];
+        }
+    };
+}
 
 void bind_map_types(sol::state& lua) {
     // A data bag for defining custom properties on maps/canvases
@@ -51,6 +109,31 @@ void bind_map_types(sol::state& lua) {
         &Map::get_object_layer_by_id,
         &Map::get_object_layer_by_name
     );
+    // Native object queries, optionally filling an existing table to avoid allocations
+    map_type["objects_in_radius"] = [](Map& map, float x, float y, float radius,
+            sol::optional<sol::table> filter, sol::optional<sol::table> results, sol::this_state state) {
+        detail::Query_Results query;
+        map.find_objects_in_radius(xd::vec2{x, y}, radius,
+            detail::read_object_filter(map, filter), query.objects);
+        return detail::to_object_table(state, query.objects, results);
+    };
+    map_type["objects_in_rect"] = [](Map& map, float x, float y, float width, float height,
+            sol::optional<sol::table> filter, sol::optional<sol::table> results, sol::this_state state) {
+        detail::Query_Results query;
+        map.find_objects_in_rect(xd::rect{x, y, width, height},
+            detail::read_object_filter(map, filter), query.objects);
+        return detail::to_object_table(state, query.objects, results);
+    };
+    map_type["objects_in_sight"] = [](Map& map, float x, float y, float radius,
+            sol::optional<sol::table> filter, sol::optional<sol::table> results, sol::this_state state) {
+        detail::Query_Results query;
+        map.find_objects_in_sight(xd::vec2{x, y}, radius,
+            detail::read_object_filter(map, filter), query.objects);
+        return detail::to_object_table(state, query.objects, results);
+    };
+    map_type["line_of_sight"] = [](Map& map, float x1, float y1, float x2, float y2) {
+        return map.line_of_sight(xd::vec2{x1, y1}, xd::vec2{x2, y2});
+    };
     map_type["run_script"] = &Map::run_script;
     map_type["run_script_file"] = &Map::run_script_file;
     map_type["run_function"] = &Map::run_function;
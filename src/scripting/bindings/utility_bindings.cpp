@@ -18,13 +18,7 @@
 void bind_utility_types(sol::state& lua, Game& game) {
     // Waiting for duration / function result
     auto wait = [](Game& game, int duration) {
-        bool was_paused = game.is_paused();
-        int old_time = was_paused ? game.window_ticks() : game.ticks();
-        auto& scheduler = game.get_current_scripting_interface()->get_scheduler();
-        scheduler.yield([&game, was_paused, old_time, duration]() {
-            int new_time = was_paused ? game.window_ticks() : game.ticks();
-            return new_time - old_time >= duration;
-        });
+        game.get_current_scripting_interface()->wait_ticks(duration);
     };
 
     auto wait_func = [](Game& game, const sol::protected_function& func) {
@@ -101,8 +95,7 @@ void bind_utility_types(sol::state& lua, Game& game) {
 
     // Wait for a command result
     auto result_wait = [&game](Command_Result* cmd) {
-        auto& scheduler = game.get_current_scripting_interface()->get_scheduler();
-        scheduler.yield(*cmd);
+        game.get_current_scripting_interface()->wait_for_command(*cmd);
     };
 
     // Returned from commands that allow yielding
@@ -131,14 +124,14 @@ void bind_utility_types(sol::state& lua, Game& game) {
 
     // A generic command for waiting (used in NPC scheduling)
     lua["Wait_Command"] = [&](int duration, int start_time) {
-        return std::make_unique<Command_Result>(std::make_shared<Wait_Command>(
+        return Command_Result(make_command<Wait_Command>(
             game,
             duration,
             start_time));
     };
     // A command for moving an object (used in NPC scheduling)
     lua["Move_To_Command"] = [&](Map_Object* obj, float x, float y, bool keep_trying, bool tile_only) {
-        return std::make_unique<Command_Result>(std::make_shared<Move_Object_To_Command>(
+        return Command_Result(make_command<Move_Object_To_Command>(
             *game.get_map(),
             *obj,
             x,
@@ -149,12 +142,12 @@ void bind_utility_types(sol::state& lua, Game& game) {
     // A command for showing text (used in NPC scheduling)
     lua["Text_Command"] = sol::overload(
         [&](Text_Options options, long start_time) {
-            auto command = std::make_shared<Show_Text_Command>(game, options);
+            auto command = make_command<Show_Text_Command>(game, options);
 
             if (start_time >= 0) {
                 command->set_start_time(start_time);
             }
-            return std::make_unique<Command_Result>(command);
+            return Command_Result(command);
         },
         [&](Map_Object* object, const std::string& text, long duration, long start_time) {
             Text_Options options(object);
@@ -162,19 +155,19 @@ void bind_utility_types(sol::state& lua, Game& game) {
                 .set_duration(duration)
                 .set_position_type(Text_Position_Type::CENTERED_X | Text_Position_Type::BOTTOM_Y);
 
-            auto command = std::make_shared<Show_Text_Command>(game, options);
+            auto command = make_command<Show_Text_Command>(game, options);
 
             if (start_time >= 0) {
                 command->set_start_time(start_time);
             }
-            return std::make_unique<Command_Result>(command);
+            return Command_Result(command);
         }
     );
     // A command to show an object's pose (used in NPC scheduling)
     lua["Pose_Command"] = [&](Map_Object* object, const std::string& pose, const std::string& state, Direction direction) {
         auto holder_type = Show_Pose_Command::Holder_Type::MAP_OBJECT;
         Show_Pose_Command::Holder_Info holder_info{ holder_type, object->get_id() };
-        return std::make_unique<Command_Result>(std::make_shared<Show_Pose_Command>(
+        return Command_Result(make_command<Show_Pose_Command>(
             *game.get_map(), holder_info, pose, state, direction));
     };
 }
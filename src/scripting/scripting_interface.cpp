@@ -1,17 +1,22 @@
 #include "scripting_interface.hpp"
 #include "script_bindings.hpp"
+#include "../asset_bundle.hpp"
 #include "../camera.hpp"
 #include "../commands/command.hpp"
+#include "../commands/command_result.hpp"
 #include "../configurations.hpp"
 #include "../direction.hpp"
 #include "../game.hpp"
 #include "../log.hpp"
 #include "../map/map.hpp"
 #include "../map/map_object.hpp"
+#include "../profiler.hpp"
 #include "../utility/file.hpp"
 #include "../utility/string.hpp"
+#include "../xd/lua/chunk_cache.hpp"
 #include "../xd/lua/virtual_machine.hpp"
 #include "../xd/vendor/sol/sol.hpp"
+#include <algorithm>
 
 namespace detail {
     static int require_lua_file(lua_State* state) {
@@ -29,31 +34,63 @@ namespace detail {
         }
 
         try {
-            auto script = filesystem->read_file(filename);
+            auto script = filesystem->read_file_buffer(filename);
             // Load and push the code (or error message) to the stack, and return the index
-            luaL_loadbuffer(state, script.data(), script.size(), ("@" + filename).c_str());
+            xd::lua::chunk_cache::shared().load(state, script.data(), script.size(), "@" + filename);
         } catch (std::exception& ex) {
             sol::stack::push(state, " error while reading " + filename + ": " + ex.what());
         }
 
         return 1;
     }
+
+    // Seed the chunk cache with the bytecode compiled by the asset packer
+    static void preload_bundled_scripts() {
+        auto bundle = Asset_Bundle::game_bundle();
+        if (!bundle) return;
+
+        auto& cache = xd::lua::chunk_cache::shared();
+        for (auto& filename : bundle->filenames(Asset_Bundle::Record_Type::SCRIPT)) {
+            auto record = bundle->find(Asset_Bundle::Record_Type::SCRIPT, filename);
+            Bundle_Reader reader{*record};
+            auto source_hash = reader.read<std::uint64_t>();
+            auto bytecode = reader.read_string();
+            cache.add("@" + filename, source_hash, std::move(bytecode));
+        }
+    }
 }
 
 Game* Scripting_Interface::game = nullptr;
+std::vector<Scripting_Interface*> Scripting_Interface::interfaces;
 
 Scripting_Interface::Scripting_Interface(Game& game) : scheduler(*game.get_lua_vm()) {
+    game_clock = scheduler.add_clock([&game]() { return game.ticks(); });
+    window_clock = scheduler.add_clock([&game]() { return game.window_ticks(); });
+    interfaces.push_back(this);
+
     if (!Scripting_Interface::game) {
         Scripting_Interface::game = &game;
         setup_scripts();
     }
 }
 
+Scripting_Interface::~Scripting_Interface() {
+    interfaces.erase(std::remove(interfaces.begin(), interfaces.end(), this), interfaces.end());
+    // Scripts in other interfaces waiting on these commands go back to polling them
+    for (auto& command : commands) {
+        command->set_queued(false);
+        notify_command(command.get());
+    }
+}
+
 void Scripting_Interface::update() {
-    // Execute pending commands
+    PROFILE_ZONE("Scripting_Interface::update");
+    // Execute pending commands, compacting the remaining ones in the same
+    // pass so that removing many finished commands stays linear
     auto current_map = game->get_map();
-    for (auto i = commands.begin(); i < commands.end();) {
-        auto& command = *i;
+    std::size_t kept = 0;
+    for (std::size_t i = 0; i < commands.size(); ++i) {
+        auto command = commands[i].get();
 
         // Don't execute commands if they belong to a different map
         auto command_map = command->get_map_ptr();
@@ -70,13 +107,53 @@ void Scripting_Interface::update() {
                 // results waiting on it know that it's done
                 command->force_stop();
             }
-            i = commands.erase(i);
+            command->set_queued(false);
+            notify_command(command);
+            commands[i].reset();
             continue;
         }
-        ++i;
+        if (kept != i) {
+            commands[kept] = std::move(commands[i]);
+        }
+        ++kept;
     }
-    if (scheduler.pending_tasks() > 0)
+    commands.resize(kept);
+    if (scheduler.pending_tasks() > 0) {
+        PROFILE_ZONE("Scheduler::run");
         scheduler.run();
+    }
+}
+
+void Scripting_Interface::wait_ticks(int duration) {
+    // Game time doesn't advance while paused, so use real time instead
+    auto paused = game->is_paused();
+    auto now = paused ? game->window_ticks() : game->ticks();
+    scheduler.yield_until(paused ? window_clock : game_clock, now + duration);
+}
+
+void Scripting_Interface::wait_for_command(const Command_Result& result) {
+    auto command = result.get_command();
+    if (!command->is_complete() && is_command_pending(command)) {
+        // Only checked again once update removes the command
+        scheduler.yield_for_signal(command, std::make_shared<xd::lua::callback_task>(result));
+    } else {
+        scheduler.yield(result);
+    }
+}
+
+void Scripting_Interface::notify_command(const Command* command) {
+    for (auto scripting_interface : interfaces) {
+        scripting_interface->scheduler.notify(command);
+    }
+}
+
+bool Scripting_Interface::is_command_pending(const Command* command) {
+    return command->is_queued();
+}
+
+void Scripting_Interface::queue_command(std::shared_ptr<Command> command) {
+    command->set_queued(true);
+    commands.push_back(std::move(command));
 }
 
 void Scripting_Interface::schedule_code(const std::string& script, const std::string& context) {
@@ -119,12 +196,17 @@ sol::state& Scripting_Interface::lua_state() {
 void Scripting_Interface::setup_scripts() {
     auto& vm = *game->get_lua_vm();
 
-    if (Configurations::get<bool>("debug.seed-lua-rng")) {
+    auto seed = game->get_random_seed();
+    if (seed) {
+        scheduler.start("math.randomseed(" + std::to_string(*seed) + ")", "");
+    } else if (Configurations::get<bool>("debug.seed-lua-rng")) {
         scheduler.start("math.randomseed(os.time())", "");
     }
 
     auto& lua = vm.lua_state();
 
+    detail::preload_bundled_scripts();
+
     // Use custom searcher for require
     lua["package"]["searchers"] = lua.create_table_with(1, detail::require_lua_file);
 
@@ -1,22 +1,23 @@
 #ifndef HPP_SCRIPTING_INTERFACE
 #define HPP_SCRIPTING_INTERFACE
 
+#include "../commands/command_allocator.hpp"
+#include "../commands/command_result.hpp"
 #include "../xd/lua/scheduler.hpp"
+#include <cstddef>
 #include <memory>
 #include <string>
 #include <utility>
 #include <vector>
 
 class Game;
-class Command;
-class Command_Result;
-class Choice_Result;
 
 class Scripting_Interface {
 public:
     Scripting_Interface(const Scripting_Interface&) = delete;
     Scripting_Interface& operator=(const Scripting_Interface&) = delete;
     explicit Scripting_Interface(Game& game);
+    ~Scripting_Interface();
     void update();
     void schedule_code(const std::string& script, const std::string& context = "");
     void schedule_file(const std::string& filename, const std::string& context = "");
@@ -27,23 +28,38 @@ public:
     }
     void set_globals();
     xd::lua::scheduler& get_scheduler() noexcept { return scheduler; }
+    // Yield the current script for a number of ticks
+    void wait_ticks(int duration);
+    // Yield the current script until the command completes
+    void wait_for_command(const Command_Result& result);
     template<typename T, typename ... Args>
-    std::unique_ptr<Command_Result> register_command(Args&& ... args) {
-        auto command = std::make_shared<T>(std::forward<Args>(args)...);
-        commands.push_back(command);
-        return std::make_unique<Command_Result>(command);
+    Command_Result register_command(Args&& ... args) {
+        auto command = make_command<T>(std::forward<Args>(args)...);
+        queue_command(command);
+        return Command_Result(std::move(command));
     }
     template<typename T, typename ... Args>
-    std::unique_ptr<Choice_Result> register_choice_command(Args&& ... args) {
-        auto command = std::make_shared<T>(std::forward<Args>(args)...);
-        commands.push_back(command);
-        return std::make_unique<Choice_Result>(command);
+    Choice_Result register_choice_command(Args&& ... args) {
+        auto command = make_command<T>(std::forward<Args>(args)...);
+        queue_command(command);
+        return Choice_Result(std::move(command));
     }
+    // Number of commands waiting to complete
+    std::size_t pending_commands() const noexcept { return commands.size(); }
     sol::state& lua_state();
 private:
     void setup_scripts();
+    void queue_command(std::shared_ptr<Command> command);
+    // Wake up the scripts waiting for the command in every interface
+    static void notify_command(const Command* command);
+    static bool is_command_pending(const Command* command);
     static Game* game;
+    // All live interfaces, scripts can wait on commands of another interface
+    static std::vector<Scripting_Interface*> interfaces;
     xd::lua::scheduler scheduler;
+    // Scheduler clocks for game time and real time (used while the game is paused)
+    int game_clock;
+    int window_clock;
     std::vector<std::shared_ptr<Command>> commands;
 };
 
@@ -55,6 +55,14 @@ struct Sprite::Impl {
     int frame_count;
     // Is animation in a tween frame
     bool tweening;
+    // Tween values before the current logic step
+    struct Tween_State {
+        int frame_index;
+        xd::vec2 magnification;
+        float angle;
+        float opacity;
+    };
+    std::optional<Tween_State> previous_tween;
     // Default color
     const static xd::vec4 default_color;
     // Is the pose completed
@@ -69,6 +77,9 @@ struct Sprite::Impl {
     long pause_start;
     // Last frame where sound was played
     int last_sound_frame;
+    // Voice playing the last frame sound and the frame's sound volume
+    xd::voice_handle sound_voice;
+    float sound_voice_volume;
     // Animation speed modifier
     float speed;
     // Volume of the sprite's sound effects
@@ -92,6 +103,7 @@ struct Sprite::Impl {
         paused(false),
         pause_start(-1),
         last_sound_frame(-1),
+        sound_voice_volume(1.0f),
         speed(1.0f),
         sfx_volume(1.0f),
         sound_attenuation_factor(Configurations::get<float>("audio.sound-attenuation-factor")) {
@@ -112,13 +124,27 @@ struct Sprite::Impl {
             // Sprite's src rectangle position is ignored
             src.x = -repeat_pos->x;
             src.y = -repeat_pos->y;
+        } else {
+            src.x += frame.atlas_offset.x;
+            src.y += frame.atlas_offset.y;
+        }
+
+        auto frame_magnification = frame.magnification;
+        auto frame_angle = static_cast<float>(frame.angle);
+        auto frame_opacity = frame.opacity;
+        if (tweening && previous_tween && previous_tween->frame_index == frame_index) {
+            // Tween between the last two logic steps
+            auto alpha = game.interpolation_alpha();
+            frame_magnification = lerp(previous_tween->magnification, frame.magnification, alpha);
+            frame_angle = lerp(previous_tween->angle, frame_angle, alpha);
+            frame_opacity = lerp(previous_tween->opacity, frame.opacity, alpha);
         }
 
-        color.a *= opacity * frame.opacity;
+        color.a *= opacity * frame_opacity;
         batch.add(image, src,
             pos.x, pos.y,
-            xd::radians(angle.value_or(static_cast<float>(frame.angle))),
-            frame.magnification * mag,
+            xd::radians(angle.value_or(frame_angle)),
+            frame_magnification * mag,
             color,
             origin.value_or(pose->origin));
     }
@@ -127,21 +153,31 @@ struct Sprite::Impl {
         if (frame_count == 0 || stop_updating) return;
 
         auto current_frame = &pose->frames[frame_index];
+        if (tweening) {
+            previous_tween = Tween_State{ frame_index, current_frame->magnification,
+                static_cast<float>(current_frame->angle), current_frame->opacity };
+        } else {
+            previous_tween.reset();
+        }
 
         if (frame_duration < 0) {
             frame_duration = get_frame_time(*current_frame);
         }
 
+        // A frame's sound only repeats after it finished on its own, not
+        // when its voice was stolen or no voice was available
         auto& sound_file = current_frame->sound_file;
         auto play_sfx = audio && sound_file
-            && (last_sound_frame != frame_index || sound_file->stopped());
+            && (last_sound_frame != frame_index
+                || (sound_voice.valid() && !sound_voice.playing()));
         if (play_sfx) {
-            if (object_pos) {
-                update_sound_attenuation(*object_pos, true);
-            } else {
-                sound_file->set_volume(current_frame->sound_volume * sfx_volume);
-            }
-            sound_file->play();
+            // Nearer (louder) sounds are less likely to lose their voice
+            sound_voice_volume = current_frame->sound_volume;
+            auto volume = object_pos
+                ? attenuated_volume(sound_voice_volume, *object_pos)
+                : sound_voice_volume;
+            sound_voice = audio->get_sound_bank().play(sound_file, current_frame->sound_channel_group,
+                volume * sfx_volume, current_frame->sound_pitch.value_or(1.0f), volume);
             last_sound_frame = frame_index;
         }
 
@@ -220,6 +256,7 @@ struct Sprite::Impl {
         passed_markers.clear();
         stop_updating = false;
         tweening = false;
+        previous_tween.reset();
         if (!pose || reset_current_frame) {
             frame_index = 0;
             old_time = game.ticks();
@@ -381,21 +418,22 @@ struct Sprite::Impl {
         }
     }
 
-    void update_sound_attenuation(xd::vec2 object_pos, bool force = false) {
-        auto current_frame = &pose->frames[frame_index];
-        auto& sound_file = current_frame->sound_file;
-        auto skip = !sound_file || (!force && !sound_file->playing());
-        if (skip) return;
-
-        auto original_volume = current_frame->sound_volume;
+    float attenuated_volume(float original_volume, xd::vec2 object_pos) const {
         const auto player = game.get_player();
         auto distance = xd::length(object_pos - player->get_centered_position());
 
         // Volume is at original level within [factor] pixels,
         // then falls off based on distance
-        auto volume = std::min(original_volume,
+        return std::min(original_volume,
             original_volume * sound_attenuation_factor / distance);
-        sound_file->set_volume(volume * sfx_volume);
+    }
+
+    void update_sound_attenuation(xd::vec2 object_pos) {
+        if (!sound_voice.playing()) return;
+
+        auto volume = attenuated_volume(sound_voice_volume, object_pos);
+        sound_voice.set_volume(volume * sfx_volume);
+        sound_voice.set_priority(volume);
     }
 };
 
@@ -417,7 +455,7 @@ void Sprite::render(Map_Object& object) {
         ? object.get_color() * layer->get_color()
         : object.get_color();
 
-    pimpl->render(batch, object.get_position(),
+    pimpl->render(batch, object.get_interpolated_position(pimpl->game.interpolation_alpha()),
         layer->get_opacity() * object.get_opacity(),
         object.get_magnification(),
         color);
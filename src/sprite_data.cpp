@@ -1,51 +1,53 @@
+#include "asset_bundle.hpp"
 #include "exceptions.hpp"
 #include "sprite_data.hpp"
 #include "utility/color.hpp"
 #include "utility/direction.hpp"
 #include "utility/file.hpp"
 #include "utility/string.hpp"
+#include "utility/texture.hpp"
 #include "xd/asset_manager.hpp"
 #include "xd/audio.hpp"
+#include <cstdint>
 #include <iostream>
 #include <optional>
 
 namespace detail {
-    static std::shared_ptr<xd::texture> load_sprite_texture(xd::asset_manager& manager, const std::string& filename, xd::vec4 transparent_color) {
-        if (manager.contains_key<xd::texture>(filename)) {
-            return manager.get<xd::texture>(filename);
-        }
-        auto fs = file_utilities::game_data_filesystem();
-        auto stream = fs->open_binary_ifstream(filename);
-        if (!stream || !*stream) {
-            throw file_loading_exception{ "Failed to load sprite image " + filename };
-        }
-
-        return manager.load<xd::texture>(filename, filename, *stream, transparent_color);
+    // Sprites loaded without the atlas are cached apart from the packed ones
+    static std::string sprite_cache_key(const std::string& filename, bool allow_atlas) {
+        return allow_atlas ? filename : filename + "#no-atlas";
     }
 }
 
 Sprite_Data::Sprite_Data(const std::string& filename)
-    : filename(filename), has_diagonal_directions(false) {}
+    : filename(filename), allow_atlas(true), has_diagonal_directions(false) {}
 
 std::shared_ptr<Sprite_Data> Sprite_Data::load(std::string filename, xd::asset_manager& manager,
-        xd::audio* audio, channel_group_type channel_group) {
+        xd::audio* audio, channel_group_type channel_group, bool allow_atlas) {
     try {
         string_utilities::normalize_slashes(filename);
-        if (manager.contains_key<Sprite_Data>(filename)) {
-            return manager.get<Sprite_Data>(filename);
+        auto key = detail::sprite_cache_key(filename, allow_atlas);
+        if (manager.contains_key<Sprite_Data>(key)) {
+            return manager.get<Sprite_Data>(key);
+        }
+
+        auto bundle = Asset_Bundle::game_bundle();
+        if (auto record = bundle ? bundle->find(Asset_Bundle::Record_Type::SPRITE, filename) : std::nullopt) {
+            Bundle_Reader reader{*record};
+            return load(reader, filename, manager, audio, channel_group, allow_atlas);
         }
 
         auto doc = std::make_unique<rapidxml::xml_document<>>();
         auto fs = file_utilities::game_data_filesystem();
-        auto content = doc->allocate_string(fs->read_file(filename).c_str());
-        doc->parse<0>(content);
+        auto content = fs->read_file_buffer(filename);
+        doc->parse<0>(content.data());
 
         auto sprite_node = doc->first_node("Sprite");
         if (!sprite_node) {
             throw xml_exception("Missing Sprite node.");
         }
 
-        auto sprite_data = load(*sprite_node, filename, manager, audio, channel_group);
+        auto sprite_data = load(*sprite_node, filename, manager, audio, channel_group, allow_atlas);
 
         return sprite_data;
     } catch (std::exception& ex) {
@@ -55,31 +57,51 @@ std::shared_ptr<Sprite_Data> Sprite_Data::load(std::string filename, xd::asset_m
 
 std::shared_ptr<Sprite_Data> Sprite_Data::load(rapidxml::xml_node<>& node,
         const std::string& filename, xd::asset_manager& manager,
-        xd::audio* audio, channel_group_type channel_group) {
+        xd::audio* audio, channel_group_type channel_group, bool allow_atlas) {
+
+    auto sprite_ptr = manager.load<Sprite_Data>(detail::sprite_cache_key(filename, allow_atlas), filename);
+    sprite_ptr->read(node);
+    sprite_ptr->allow_atlas = sprite_ptr->allow_atlas && allow_atlas;
+    sprite_ptr->load_assets(manager, audio, channel_group);
+    return sprite_ptr;
+}
+
+std::shared_ptr<Sprite_Data> Sprite_Data::load(Bundle_Reader& reader,
+        const std::string& filename, xd::asset_manager& manager,
+        xd::audio* audio, channel_group_type channel_group, bool allow_atlas) {
+    auto sprite_ptr = manager.load<Sprite_Data>(detail::sprite_cache_key(filename, allow_atlas), filename);
+    sprite_ptr->read(reader);
+    sprite_ptr->allow_atlas = sprite_ptr->allow_atlas && allow_atlas;
+    sprite_ptr->load_assets(manager, audio, channel_group);
+    return sprite_ptr;
+}
 
-    auto sprite_ptr = manager.load<Sprite_Data>(filename, filename);
+void Sprite_Data::read(rapidxml::xml_node<>& node) {
     // Image and transparent color
     bool image_loaded = false;
     bool pose_images_loaded = true;
     bool frame_images_loaded = true;
 
-    std::optional<xd::vec4> transparent_color;
+    // Sprites can opt out of atlas packing, e.g. when drawn by repeating image layers
+    if (auto attr = node.first_attribute("Atlas")) {
+        allow_atlas = string_utilities::string_to_bool(attr->value());
+    }
+
+    std::optional<xd::vec4> last_transparent_color;
     if (auto attr = node.first_attribute("Transparent-Color")) {
-        transparent_color = hex_to_color(attr->value());
-        sprite_ptr->transparent_color = transparent_color.value();
+        last_transparent_color = hex_to_color(attr->value());
+        transparent_color = last_transparent_color.value();
     }
 
     if (auto attr = node.first_attribute("Image")) {
-        std::string image_file = attr->value();
-        sprite_ptr->image = detail::load_sprite_texture(manager, image_file,
-            sprite_ptr->transparent_color);
+        image_source = attr->value();
         image_loaded = true;
     }
 
     // Default sprite pose
     if (auto default_attr = node.first_attribute("Default-Pose")) {
-        sprite_ptr->default_pose = default_attr->value();
-        string_utilities::capitalize(sprite_ptr->default_pose);
+        default_pose = default_attr->value();
+        string_utilities::capitalize(default_pose);
     }
 
     bool default_pose_found = false;
@@ -132,16 +154,14 @@ std::shared_ptr<Sprite_Data> Sprite_Data::load(rapidxml::xml_node<>& node,
 
         // Pose image and transparent color
         if (auto attr = pose_node->first_attribute("Transparent-Color")) {
-            transparent_color = hex_to_color(attr->value());
-            pose.transparent_color = transparent_color.value();
-        } else if (transparent_color) {
-            pose.transparent_color = transparent_color.value();
+            last_transparent_color = hex_to_color(attr->value());
+            pose.transparent_color = last_transparent_color.value();
+        } else if (last_transparent_color) {
+            pose.transparent_color = last_transparent_color.value();
         }
 
         if (auto attr = pose_node->first_attribute("Image")) {
-            std::string pose_image_file = attr->value();
-            pose.image = detail::load_sprite_texture(manager, pose_image_file,
-                pose.transparent_color);
+            pose.image_source = attr->value();
         } else {
             pose_images_loaded = false;
         }
@@ -196,52 +216,40 @@ std::shared_ptr<Sprite_Data> Sprite_Data::load(rapidxml::xml_node<>& node,
 
             // Frame image and transparent color
             if (auto attr = frame_node->first_attribute("Transparent-Color")) {
-                transparent_color = hex_to_color(attr->value());
-                frame.transparent_color = transparent_color.value();
-            } else if (transparent_color) {
-                frame.transparent_color = transparent_color.value();
+                last_transparent_color = hex_to_color(attr->value());
+                frame.transparent_color = last_transparent_color.value();
+            } else if (last_transparent_color) {
+                frame.transparent_color = last_transparent_color.value();
             }
 
             if (auto attr = frame_node->first_attribute("Image")) {
-                std::string frame_image_file = attr->value();
-                frame.image = detail::load_sprite_texture(manager, frame_image_file,
-                    frame.transparent_color);
+                frame.image_source = attr->value();
             } else {
                 frame_images_loaded = false;
             }
 
             // Sound effect
-            if (audio) {
-                auto fs = file_utilities::game_data_filesystem();
-                if (auto sound_file_attr = frame_node->first_attribute("Sound")) {
-                    auto sound_filename = std::string{ sound_file_attr->value() };
-                    frame.sound_file = std::make_shared<xd::sound>(*audio, sound_filename,
-                        fs->open_binary_ifstream(sound_filename), channel_group);
-                }
+            if (auto sound_file_attr = frame_node->first_attribute("Sound")) {
+                frame.sound_source = sound_file_attr->value();
+            }
 
-                if (auto sound_node = frame_node->first_node("Sound")) {
-                    if (frame.sound_file) {
-                        throw xml_exception("Both frame sound attribute and node are defined for " + frame.sound_file->get_filename());
-                    }
+            if (auto sound_node = frame_node->first_node("Sound")) {
+                if (!frame.sound_source.empty()) {
+                    throw xml_exception("Both frame sound attribute and node are defined for " + frame.sound_source);
+                }
 
-                    if (auto sound_file_attr = sound_node->first_attribute("Filename")) {
-                        auto sound_filename = std::string{ sound_file_attr->value() };
-                        frame.sound_file = std::make_shared<xd::sound>(*audio, sound_filename,
-                            fs->open_binary_ifstream(sound_filename), channel_group);
-                    } else {
-                        throw xml_exception("Frame has a sound node but the filename is missing");
-                    }
+                if (auto sound_file_attr = sound_node->first_attribute("Filename")) {
+                    frame.sound_source = sound_file_attr->value();
+                } else {
+                    throw xml_exception("Frame has a sound node but the filename is missing");
+                }
 
-                    if (auto pitch_attr = sound_node->first_attribute("Pitch")) {
-                        auto pitch = std::stof(pitch_attr->value());
-                        frame.sound_file->set_pitch(pitch);
-                    }
+                if (auto pitch_attr = sound_node->first_attribute("Pitch")) {
+                    frame.sound_pitch = std::stof(pitch_attr->value());
+                }
 
-                    if (auto volume_attr = sound_node->first_attribute("Volume")) {
-                        auto volume = std::stof(volume_attr->value());
-                        frame.sound_file->set_volume(volume);
-                        frame.sound_volume = volume;
-                    }
+                if (auto volume_attr = sound_node->first_attribute("Volume")) {
+                    frame.sound_volume = std::stof(volume_attr->value());
                 }
             }
 
@@ -278,8 +286,8 @@ std::shared_ptr<Sprite_Data> Sprite_Data::load(rapidxml::xml_node<>& node,
             }
         }
 
-        sprite_ptr->poses.push_back(pose);
-        int pose_index = sprite_ptr->poses.size() - 1;
+        poses.push_back(pose);
+        int pose_index = poses.size() - 1;
 
         // Pose tags
         std::string name, state, direction;
@@ -312,36 +320,173 @@ std::shared_ptr<Sprite_Data> Sprite_Data::load(rapidxml::xml_node<>& node,
 
         if (!name.empty()) {
             string_utilities::capitalize(name);
-            sprite_ptr->poses[pose_index].name = name;
-            if (name == sprite_ptr->default_pose) {
+            poses[pose_index].name = name;
+            if (name == default_pose) {
                 default_pose_found = true;
             }
         }
         if (!state.empty()) {
             string_utilities::capitalize(state);
-            sprite_ptr->poses[pose_index].state = state;
+            poses[pose_index].state = state;
         }
         if (!direction.empty()) {;
             auto dir = string_to_direction(direction);
-            sprite_ptr->poses[pose_index].direction = dir;
-            if (!sprite_ptr->has_diagonal_directions) {
-                sprite_ptr->has_diagonal_directions = is_diagonal(dir);
+            poses[pose_index].direction = dir;
+            if (!has_diagonal_directions) {
+                has_diagonal_directions = is_diagonal(dir);
             }
         }
     }
 
-    if (!default_pose_found && sprite_ptr->default_pose != "") {
-        throw tmx_exception("Could not find default pose " + sprite_ptr->default_pose +
-            " when loading " + sprite_ptr->filename);
+    if (!default_pose_found && default_pose != "") {
+        throw tmx_exception("Could not find default pose " + default_pose +
+            " when loading " + filename);
     }
 
-    if (sprite_ptr->poses.empty()) {
+    if (poses.empty()) {
         throw xml_exception("Invalid sprite data file. Missing poses.");
     }
 
     if (!image_loaded && !pose_images_loaded && !frame_images_loaded) {
         throw xml_exception("Invalid sprite data file. Missing image.");
     }
+}
 
-    return sprite_ptr;
+void Sprite_Data::save(Bundle_Writer& writer) const {
+    writer.write(image_source);
+    writer.write(allow_atlas);
+    writer.write(transparent_color);
+    writer.write(default_pose);
+    writer.write(has_diagonal_directions);
+    writer.write(static_cast<std::uint32_t>(poses.size()));
+    for (auto& pose : poses) {
+        writer.write(pose.bounding_box);
+        writer.write(pose.bounding_circle.has_value());
+        writer.write(pose.bounding_circle.value_or(xd::circle{}));
+        writer.write(static_cast<std::int32_t>(pose.duration));
+        writer.write(static_cast<std::int32_t>(pose.repeats));
+        writer.write(pose.require_completion);
+        writer.write(pose.completion_frames.has_value());
+        writer.write(pose.completion_frames.value_or(std::vector<int>{}));
+        writer.write(pose.origin);
+        writer.write(pose.image_source);
+        writer.write(pose.transparent_color);
+        writer.write(pose.name);
+        writer.write(pose.state);
+        writer.write(pose.direction);
+        writer.write(static_cast<std::uint32_t>(pose.frames.size()));
+        for (auto& frame : pose.frames) {
+            writer.write(static_cast<std::int32_t>(frame.duration));
+            writer.write(static_cast<std::int32_t>(frame.max_duration));
+            writer.write(frame.marker);
+            writer.write(frame.rectangle);
+            writer.write(frame.magnification);
+            writer.write(static_cast<std::int32_t>(frame.angle));
+            writer.write(frame.opacity);
+            writer.write(frame.tween_frame);
+            writer.write(frame.image_source);
+            writer.write(frame.transparent_color);
+            writer.write(frame.sound_source);
+            writer.write(frame.sound_pitch.has_value());
+            writer.write(frame.sound_pitch.value_or(1.0f));
+            writer.write(frame.sound_volume);
+        }
+    }
+}
+
+void Sprite_Data::read(Bundle_Reader& reader) {
+    image_source = reader.read_string();
+    allow_atlas = reader.read<bool>();
+    transparent_color = reader.read<xd::vec4>();
+    default_pose = reader.read_string();
+    has_diagonal_directions = reader.read<bool>();
+    auto pose_count = reader.read<std::uint32_t>();
+    poses.resize(pose_count);
+    for (auto& pose : poses) {
+        pose.bounding_box = reader.read<xd::rect>();
+        auto has_circle = reader.read<bool>();
+        auto circle = reader.read<xd::circle>();
+        if (has_circle) {
+            pose.bounding_circle = circle;
+        }
+        pose.duration = reader.read<std::int32_t>();
+        pose.repeats = reader.read<std::int32_t>();
+        pose.require_completion = reader.read<bool>();
+        auto has_completion_frames = reader.read<bool>();
+        auto completion_frames = reader.read_vector<int>();
+        if (has_completion_frames) {
+            pose.completion_frames = completion_frames;
+        }
+        pose.origin = reader.read<xd::vec2>();
+        pose.image_source = reader.read_string();
+        pose.transparent_color = reader.read<xd::vec4>();
+        pose.name = reader.read_string();
+        pose.state = reader.read_string();
+        pose.direction = reader.read<Direction>();
+        auto frame_count = reader.read<std::uint32_t>();
+        pose.frames.resize(frame_count);
+        for (auto& frame : pose.frames) {
+            frame.duration = reader.read<std::int32_t>();
+            frame.max_duration = reader.read<std::int32_t>();
+            frame.marker = reader.read_string();
+            frame.rectangle = reader.read<xd::rect>();
+            frame.magnification = reader.read<xd::vec2>();
+            frame.angle = reader.read<std::int32_t>();
+            frame.opacity = reader.read<float>();
+            frame.tween_frame = reader.read<bool>();
+            frame.image_source = reader.read_string();
+            frame.transparent_color = reader.read<xd::vec4>();
+            frame.sound_source = reader.read_string();
+            auto has_pitch = reader.read<bool>();
+            auto pitch = reader.read<float>();
+            if (has_pitch) {
+                frame.sound_pitch = pitch;
+            }
+            frame.sound_volume = reader.read<float>();
+        }
+    }
+}
+
+void Sprite_Data::load_assets(xd::asset_manager& manager, xd::audio* audio,
+        channel_group_type channel_group) {
+    std::optional<xd::atlas_region> sprite_region;
+    if (!image_source.empty()) {
+        sprite_region = texture_utilities::load_image(manager, image_source,
+            transparent_color, allow_atlas);
+        image = sprite_region->texture;
+    }
+
+    for (auto& pose : poses) {
+        std::optional<xd::atlas_region> pose_region;
+        if (!pose.image_source.empty()) {
+            pose_region = texture_utilities::load_image(manager, pose.image_source,
+                pose.transparent_color, allow_atlas);
+            pose.image = pose_region->texture;
+        }
+
+        for (auto& frame : pose.frames) {
+            std::optional<xd::atlas_region> frame_region;
+            if (!frame.image_source.empty()) {
+                frame_region = texture_utilities::load_image(manager, frame.image_source,
+                    frame.transparent_color, allow_atlas);
+                frame.image = frame_region->texture;
+            }
+
+            // Move the source rectangle into the space of the image the frame uses
+            auto& region = frame_region ? frame_region
+                : (pose_region ? pose_region : sprite_region);
+            if (region) {
+                frame.atlas_offset = xd::vec2(region->rectangle.x, region->rectangle.y);
+            }
+
+            // Sound effect, played on a voice of the sound bank
+            if (audio && !frame.sound_source.empty()) {
+                frame.sound_file = audio->get_sound_bank().load(frame.sound_source, [&frame]() {
+                    auto fs = file_utilities::game_data_filesystem();
+                    return fs->open_binary_ifstream(frame.sound_source);
+                });
+                frame.sound_channel_group = channel_group;
+            }
+        }
+    }
 }
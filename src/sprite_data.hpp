@@ -16,6 +16,8 @@ namespace xd {
     class audio;
     class sound;
 }
+class Bundle_Reader;
+class Bundle_Writer;
 
 struct Frame {
     // Frame duration in milliseconds
@@ -36,15 +38,27 @@ struct Frame {
     bool tween_frame;
     // Frame image
     std::shared_ptr<xd::texture> image;
+    // Frame image file, if it has its own image
+    std::string image_source;
+    // Position of the frame's image inside its texture (non-zero for atlas pages),
+    // added to the source rectangle when rendering
+    xd::vec2 atlas_offset;
     // Transparent color
     xd::vec4 transparent_color;
-    // Frame sound effect
+    // Frame sound effect, decoded once and shared through the sound bank
     std::shared_ptr<xd::sound> sound_file;
+    // Channel group the sound effect plays in
+    channel_group_type sound_channel_group;
+    // Sound effect file
+    std::string sound_source;
+    // Sound effect pitch, if specified
+    std::optional<float> sound_pitch;
     // Original sound file volume (before attenuation)
     float sound_volume;
 
     Frame() noexcept : duration(-1), max_duration(-1), magnification(1.0f, 1.0f),
-        angle(0), opacity(1.0f), tween_frame(false), sound_volume(1.0f) {}
+        angle(0), opacity(1.0f), tween_frame(false),
+        sound_channel_group(channel_group_type::sound), sound_volume(1.0f) {}
 };
 
 struct Pose {
@@ -64,6 +78,8 @@ struct Pose {
     xd::vec2 origin;
     // Pose image
     std::shared_ptr<xd::texture> image;
+    // Pose image file, if it has its own image
+    std::string image_source;
     // Transparent color
     xd::vec4 transparent_color;
     // Name for specifying the pose
@@ -83,6 +99,10 @@ struct Sprite_Data {
     std::string filename;
     // Sprite texture
     std::shared_ptr<xd::texture> image;
+    // Sprite image file
+    std::string image_source;
+    // Can the images be packed into the shared texture atlas?
+    bool allow_atlas;
     // Transparent color for image
     xd::vec4 transparent_color;
     // Default pose when no pose is specified or matches
@@ -94,10 +114,23 @@ struct Sprite_Data {
 
     explicit Sprite_Data(const std::string& filename);
 
+    // Passing allow_atlas = false loads a separate copy whose images all get
+    // their own textures, e.g. for sprites drawn by repeating image layers
     static std::shared_ptr<Sprite_Data> load(std::string filename, xd::asset_manager& manager,
-        xd::audio* audio, channel_group_type channel_group);
+        xd::audio* audio, channel_group_type channel_group, bool allow_atlas = true);
     static std::shared_ptr<Sprite_Data> load(rapidxml::xml_node<>& node, const std::string& filename,
-        xd::asset_manager& manager, xd::audio* audio, channel_group_type channel_group);
+        xd::asset_manager& manager, xd::audio* audio, channel_group_type channel_group,
+        bool allow_atlas = true);
+    static std::shared_ptr<Sprite_Data> load(Bundle_Reader& reader, const std::string& filename,
+        xd::asset_manager& manager, xd::audio* audio, channel_group_type channel_group,
+        bool allow_atlas = true);
+    // Read the sprite definition without loading any images or sounds
+    void read(rapidxml::xml_node<>& node);
+    void read(Bundle_Reader& reader);
+    // Write the sprite definition as an asset bundle record
+    void save(Bundle_Writer& writer) const;
+    // Load the images and sounds referenced by the definition
+    void load_assets(xd::asset_manager& manager, xd::audio* audio, channel_group_type channel_group);
 };
 
 #endif
@@ -0,0 +1,182 @@
+#include "game_fixture.hpp"
+#include "../asset_bundle.hpp"
+#include "../exceptions.hpp"
+#include "../map/map.hpp"
+#include "../map/tileset.hpp"
+#include "../map/layers/tile_layer.hpp"
+#include "../sprite_data.hpp"
+#include "../utility/file.hpp"
+#include "../vendor/rapidxml.hpp"
+#include <boost/test/unit_test.hpp>
+#include <memory>
+#include <sstream>
+
+BOOST_AUTO_TEST_SUITE(asset_bundle_tests)
+
+BOOST_AUTO_TEST_CASE(asset_bundle_round_trip) {
+    Bundle_Writer writer;
+    writer.write(42);
+    writer.write(std::string{"text"});
+    writer.write(std::vector<unsigned int>{1, 2, 3});
+
+    Asset_Bundle bundle;
+    bundle.add(Asset_Bundle::Record_Type::MAP, "maps\\test.tmx", writer.get_data());
+    auto stream = std::make_unique<std::stringstream>();
+    bundle.save(*stream);
+
+    auto loaded = Asset_Bundle::load(std::move(stream));
+    BOOST_CHECK_EQUAL(loaded->size(), 1u);
+    BOOST_CHECK(!loaded->find(Asset_Bundle::Record_Type::TILESET, "maps/test.tmx"));
+    auto record = loaded->find(Asset_Bundle::Record_Type::MAP, "maps/test.tmx");
+    BOOST_REQUIRE(record);
+
+    Bundle_Reader reader{*record};
+    BOOST_CHECK_EQUAL(reader.read<int>(), 42);
+    BOOST_CHECK_EQUAL(reader.read_string(), "text");
+    auto values = reader.read_vector<unsigned int>();
+    BOOST_CHECK_EQUAL(values.size(), 3u);
+    BOOST_CHECK_EQUAL(values[2], 3u);
+    BOOST_CHECK(reader.at_end());
+    BOOST_CHECK_THROW(reader.read<int>(), bundle_exception);
+}
+
+BOOST_AUTO_TEST_CASE(asset_bundle_rejects_invalid_data) {
+    BOOST_CHECK_THROW(Asset_Bundle::load(std::make_unique<std::stringstream>("NOPE")), bundle_exception);
+
+    Bundle_Writer writer;
+    writer.write(Asset_Bundle::format_version + 1);
+    writer.write(std::uint32_t{0});
+    auto bad_version = std::make_unique<std::stringstream>("OCBB" + writer.get_data());
+    BOOST_CHECK_THROW(Asset_Bundle::load(std::move(bad_version)), bundle_exception);
+
+    // A record that claims more data than the bundle has
+    Asset_Bundle bundle;
+    bundle.add(Asset_Bundle::Record_Type::SCRIPT, "script.lua", std::string(100, 'x'));
+    std::stringstream stream;
+    bundle.save(stream);
+    auto truncated = std::make_unique<std::stringstream>(stream.str().substr(0, stream.str().size() - 10));
+    BOOST_CHECK_THROW(Asset_Bundle::load(std::move(truncated)), bundle_exception);
+}
+
+BOOST_AUTO_TEST_CASE(asset_bundle_reads_records_on_demand) {
+    Asset_Bundle bundle;
+    bundle.add(Asset_Bundle::Record_Type::IMAGE, "a.png", std::string(1000, 'a'));
+    bundle.add(Asset_Bundle::Record_Type::IMAGE, "b.png", std::string(2000, 'b'));
+    bundle.add(Asset_Bundle::Record_Type::SCRIPT, "b.lua", "bytecode");
+    auto stream = std::make_unique<std::stringstream>();
+    bundle.save(*stream);
+    auto saved = stream->str();
+    auto source = stream.get();
+
+    // Loading only reads the index, the payloads are skipped
+    auto loaded = Asset_Bundle::load(std::move(stream));
+    BOOST_CHECK_EQUAL(loaded->size(), 3u);
+    BOOST_CHECK(loaded->contains(Asset_Bundle::Record_Type::IMAGE, "b.png"));
+    BOOST_CHECK(!loaded->contains(Asset_Bundle::Record_Type::SCRIPT, "a.png"));
+
+    // Records are read from the stream when asked for, in any order
+    auto b = loaded->find(Asset_Bundle::Record_Type::IMAGE, "b.png");
+    source->seekp(static_cast<std::streamoff>(saved.find(std::string(1000, 'a'))));
+    source->write(std::string(1000, 'z').data(), 1000);
+    auto a = loaded->find(Asset_Bundle::Record_Type::IMAGE, "a.png");
+    auto script = loaded->find(Asset_Bundle::Record_Type::SCRIPT, "b.lua");
+    BOOST_REQUIRE(a && b && script);
+    BOOST_CHECK(a->view() == std::string(1000, 'z'));
+    BOOST_CHECK(b->view() == std::string(2000, 'b'));
+    BOOST_CHECK(script->view() == "bytecode");
+    BOOST_CHECK(!loaded->find(Asset_Bundle::Record_Type::SCRIPT, "a.lua"));
+
+    // Saving a loaded bundle copies the records from its stream
+    std::stringstream copy;
+    loaded->save(copy);
+    BOOST_CHECK(copy.str() == source->str());
+}
+
+BOOST_AUTO_TEST_CASE(asset_bundle_sprite_round_trip) {
+    auto doc = std::make_unique<rapidxml::xml_document<>>();
+    auto fs = file_utilities::game_data_filesystem();
+    doc->parse<0>(doc->allocate_string(fs->read_file("sprite.spr").c_str()));
+    auto node = doc->first_node("Sprite");
+    BOOST_REQUIRE(node);
+
+    Sprite_Data original{"sprite.spr"};
+    original.read(*node);
+    Bundle_Writer writer;
+    original.save(writer);
+
+    Sprite_Data loaded{"sprite.spr"};
+    Bundle_Reader reader{writer.get_data()};
+    loaded.read(reader);
+    BOOST_CHECK(reader.at_end());
+
+    BOOST_CHECK_EQUAL(loaded.image_source, original.image_source);
+    BOOST_REQUIRE_EQUAL(loaded.poses.size(), original.poses.size());
+    for (std::size_t i = 0; i < original.poses.size(); ++i) {
+        auto& pose = original.poses[i];
+        auto& loaded_pose = loaded.poses[i];
+        BOOST_CHECK_EQUAL(loaded_pose.name, pose.name);
+        BOOST_CHECK_EQUAL(loaded_pose.duration, pose.duration);
+        BOOST_CHECK_EQUAL(loaded_pose.repeats, pose.repeats);
+        BOOST_REQUIRE_EQUAL(loaded_pose.frames.size(), pose.frames.size());
+        for (std::size_t j = 0; j < pose.frames.size(); ++j) {
+            auto& frame = pose.frames[j];
+            auto& loaded_frame = loaded_pose.frames[j];
+            BOOST_CHECK_EQUAL(loaded_frame.duration, frame.duration);
+            BOOST_CHECK_EQUAL(loaded_frame.rectangle.x, frame.rectangle.x);
+            BOOST_CHECK_EQUAL(loaded_frame.rectangle.w, frame.rectangle.w);
+            BOOST_CHECK_EQUAL(loaded_frame.tween_frame, frame.tween_frame);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(asset_bundle_tileset_round_trip) {
+    auto doc = std::make_unique<rapidxml::xml_document<>>();
+    auto fs = file_utilities::game_data_filesystem();
+    doc->parse<0>(doc->allocate_string(fs->read_file("test_sheet.tsx").c_str()));
+    auto node = doc->first_node("tileset");
+    BOOST_REQUIRE(node);
+
+    Tileset original;
+    original.read(*node);
+    Bundle_Writer writer;
+    original.save(writer);
+
+    Bundle_Reader reader{writer.get_data()};
+    auto loaded = Tileset::load(reader);
+    BOOST_CHECK(reader.at_end());
+    BOOST_CHECK_EQUAL(loaded->name, original.name);
+    BOOST_CHECK_EQUAL(loaded->tile_width, original.tile_width);
+    BOOST_CHECK_EQUAL(loaded->tile_height, original.tile_height);
+    BOOST_CHECK_EQUAL(loaded->image_source, original.image_source);
+    BOOST_CHECK_EQUAL(loaded->tiles.size(), original.tiles.size());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_FIXTURE_TEST_SUITE(asset_bundle_map_tests, Game_Fixture)
+
+BOOST_AUTO_TEST_CASE(asset_bundle_map_round_trip) {
+    auto source_map = Map::load(*game, "test_tiled.tmx");
+
+    auto doc = std::make_unique<rapidxml::xml_document<>>();
+    auto fs = file_utilities::game_data_filesystem();
+    doc->parse<0>(doc->allocate_string(fs->read_file("test_tiled.tmx").c_str()));
+    Bundle_Writer writer;
+    Map::save(writer, *doc);
+
+    auto bundle = std::make_unique<Asset_Bundle>();
+    bundle->add(Asset_Bundle::Record_Type::MAP, "test_tiled.tmx", writer.get_data());
+    Asset_Bundle::set_game_bundle(std::move(bundle));
+    auto bundled_map = Map::load(*game, "test_tiled.tmx");
+    Asset_Bundle::set_game_bundle(nullptr);
+
+    BOOST_CHECK_EQUAL(bundled_map->get_width(), source_map->get_width());
+    BOOST_CHECK_EQUAL(bundled_map->get_height(), source_map->get_height());
+    BOOST_CHECK_EQUAL(bundled_map->get_tileset(0).name, source_map->get_tileset(0).name);
+    auto source_layer = static_cast<Tile_Layer*>(source_map->get_layer_by_index(1));
+    auto bundled_layer = static_cast<Tile_Layer*>(bundled_map->get_layer_by_index(1));
+    BOOST_CHECK_EQUAL(bundled_layer->get_name(), source_layer->get_name());
+    BOOST_CHECK(bundled_layer->get_tiles() == source_layer->get_tiles());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,448 @@
+#include "../audio_player.hpp"
+#include "../commands/fade_music_command.hpp"
+#include "../configurations.hpp"
+#include "../map/map.hpp"
+#include "../xd/audio.hpp"
+#include "../xd/audio/exceptions.hpp"
+#include "../xd/audio/detail/read_ahead_stream.hpp"
+#include "../xd/audio/detail/recording_audio_handle.hpp"
+#include "game_fixture.hpp"
+#include <boost/test/unit_test.hpp>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace detail {
+    static std::string test_data(std::size_t size) {
+        std::string data(size, '\0');
+        for (std::size_t i = 0; i < size; ++i) {
+            data[i] = static_cast<char>('a' + (i * 7) % 26);
+        }
+        return data;
+    }
+
+    static std::string read(std::istream& stream, std::size_t count) {
+        std::string result(count, '\0');
+        stream.read(&result[0], static_cast<std::streamsize>(count));
+        result.resize(static_cast<std::size_t>(stream.gcount()));
+        return result;
+    }
+
+    // Audio_Player loads the choice sounds from the config, use the test data ones
+    static std::unique_ptr<Audio_Player> make_audio_player(std::shared_ptr<xd::audio> audio) {
+        Configurations::override_value("audio.choice-select-sfx", std::string{"as3sfxr_menu_click.wav"});
+        Configurations::override_value("audio.choice-confirm-sfx", std::string{"as3sfxr_menu_select.wav"});
+        Configurations::override_value("audio.choice-cancel-sfx", std::string{"as3sfxr_menu_cancel.wav"});
+        return std::make_unique<Audio_Player>(audio);
+    }
+}
+
+using xd::detail::audio_call;
+
+BOOST_AUTO_TEST_SUITE(audio_tests)
+
+BOOST_AUTO_TEST_CASE(read_ahead_stream_reads_and_seeks) {
+    auto data = detail::test_data(10000);
+    // Small chunks so reads and seeks cross chunk boundaries
+    xd::detail::read_ahead_stream stream(std::make_unique<std::istringstream>(data), 256, 3);
+    BOOST_CHECK_EQUAL(stream.buffer().size(), 10000);
+
+    BOOST_CHECK(detail::read(stream, 1000) == data.substr(0, 1000));
+    BOOST_CHECK_EQUAL(stream.tellg(), 1000);
+
+    // Backwards, forwards within the read ahead, and far forwards
+    stream.seekg(100);
+    BOOST_CHECK(detail::read(stream, 50) == data.substr(100, 50));
+    stream.seekg(300, std::ios::cur);
+    BOOST_CHECK_EQUAL(stream.tellg(), 450);
+    BOOST_CHECK(detail::read(stream, 600) == data.substr(450, 600));
+    stream.seekg(9000);
+    BOOST_CHECK(detail::read(stream, 300) == data.substr(9000, 300));
+
+    // Seeking relative to the end, like decoders looking for trailing tags
+    stream.seekg(-128, std::ios::end);
+    BOOST_CHECK(detail::read(stream, 1000) == data.substr(10000 - 128));
+    BOOST_CHECK(stream.eof());
+    stream.clear();
+    stream.seekg(0, std::ios::end);
+    BOOST_CHECK_EQUAL(stream.tellg(), 10000);
+
+    stream.clear();
+    stream.seekg(0);
+    BOOST_CHECK(detail::read(stream, 20000) == data);
+    BOOST_CHECK(stream.buffer().chunks_read() > 0);
+}
+
+BOOST_AUTO_TEST_CASE(read_ahead_stream_missing_source) {
+    xd::detail::read_ahead_stream stream(nullptr);
+    BOOST_CHECK(detail::read(stream, 10).empty());
+    BOOST_CHECK(stream.eof());
+}
+
+BOOST_AUTO_TEST_CASE(music_loop_tags_are_cached) {
+    auto handle = std::make_unique<xd::detail::recording_audio_handle>();
+    auto recording = handle.get();
+    xd::audio audio(std::move(handle));
+    recording->set_loop_tags("song.ogg", xd::detail::tag_loop_info{ 100, 900, 1000 });
+
+    auto data = detail::test_data(1000);
+    xd::music first(audio, "song.ogg", std::make_unique<std::istringstream>(data));
+    xd::music second(audio, "song.ogg", std::make_unique<std::istringstream>(data));
+
+    BOOST_CHECK_EQUAL(recording->count(audio_call::open, "song.ogg"), 2);
+    BOOST_CHECK_EQUAL(recording->count(audio_call::read_loop_tags, "song.ogg"), 1);
+    BOOST_CHECK_EQUAL(recording->count(audio_call::set_loop_points, "song.ogg"), 2);
+    BOOST_CHECK(second.get_loop_points() == std::make_pair(100u, 900u));
+
+    // Seeking streamed music seeks its stream
+    second.set_offset(500);
+    auto records = recording->get_records();
+    BOOST_REQUIRE(!records.empty());
+    BOOST_CHECK(records.back().call == audio_call::seek);
+    BOOST_CHECK_EQUAL(records.back().first, 500);
+
+    BOOST_CHECK_THROW(xd::music(audio, "missing.ogg", nullptr), xd::audio_file_load_failed);
+}
+
+BOOST_FIXTURE_TEST_CASE(audio_player_preloads_music, Game_Fixture) {
+    auto handle = std::make_unique<xd::detail::recording_audio_handle>();
+    auto recording = handle.get();
+    auto player_ptr = detail::make_audio_player(std::make_shared<xd::audio>(std::move(handle)));
+    auto& player = *player_ptr;
+    auto& map = *game->get_map();
+
+    player.preload_music("music.ogg");
+    BOOST_CHECK(player.is_music_preloaded("music.ogg"));
+    auto music = player.play_music(map, "music.ogg");
+    BOOST_REQUIRE(music);
+    BOOST_CHECK(music->playing());
+    BOOST_CHECK(!player.is_music_preloaded("music.ogg"));
+    BOOST_CHECK_EQUAL(recording->count(audio_call::open, "music.ogg"), 1);
+
+    // Playing it again opens a new stream but doesn't read the tags again
+    player.play_music(map, "false");
+    BOOST_CHECK(!music->playing());
+    player.play_music(map, "music.ogg");
+    BOOST_CHECK_EQUAL(recording->count(audio_call::open, "music.ogg"), 2);
+    BOOST_CHECK_EQUAL(recording->count(audio_call::read_loop_tags, "music.ogg"), 1);
+
+    // Unplayed preloads are dropped
+    player.preload_music("music.ogg");
+    player.clear_preloaded_music();
+    BOOST_CHECK(!player.is_music_preloaded("music.ogg"));
+}
+
+BOOST_AUTO_TEST_CASE(null_audio_simulates_playback) {
+    // Each update is a quarter of a second
+    auto handle = std::make_unique<xd::detail::null_audio_handle>(0.25f);
+    auto null_audio = handle.get();
+    xd::audio audio(std::move(handle));
+    const auto rate = xd::detail::null_audio_handle::sample_rate;
+
+    // One second long
+    xd::sound sound(audio, "sound.wav", std::make_unique<std::istringstream>(detail::test_data(rate)),
+        channel_group_type::sound);
+    sound.play();
+    audio.update();
+    BOOST_CHECK(sound.playing());
+    BOOST_CHECK_EQUAL(sound.get_offset(), rate / 4);
+    BOOST_CHECK_EQUAL(null_audio->get_playing_count(), 1);
+
+    // Paused groups don't advance, a higher pitch plays faster
+    audio.pause_sounds();
+    audio.update();
+    BOOST_CHECK_EQUAL(sound.get_offset(), rate / 4);
+    audio.resume_sounds();
+    sound.set_pitch(2.0f);
+    audio.update();
+    BOOST_CHECK_EQUAL(sound.get_offset(), rate * 3 / 4);
+
+    // Sounds stop at the end unless looping
+    audio.update();
+    BOOST_CHECK(sound.stopped());
+    BOOST_CHECK_EQUAL(null_audio->get_playing_count(), 0);
+    BOOST_CHECK_CLOSE(null_audio->get_time(), 1.0, 0.001);
+
+    xd::music music(audio, "music.ogg", std::make_unique<std::istringstream>(detail::test_data(rate)));
+    music.set_loop_points(rate / 2, rate - 1);
+    music.play();
+    null_audio->advance(1.25f);
+    BOOST_CHECK(music.playing());
+    BOOST_CHECK_EQUAL(music.get_offset(), rate * 3 / 4);
+    BOOST_CHECK_EQUAL(null_audio->get_playing_count(channel_group_type::music), 1);
+    BOOST_CHECK_EQUAL(null_audio->get_sound_count(), 2);
+}
+
+BOOST_FIXTURE_TEST_CASE(audio_player_fades_music, Game_Fixture) {
+    auto handle = std::make_unique<xd::detail::recording_audio_handle>(0.5f);
+    auto recording = handle.get();
+    auto player = detail::make_audio_player(std::make_shared<xd::audio>(std::move(handle)));
+    auto& map = *game->get_map();
+
+    auto music = player->play_music(map, "music.ogg", true, 0.8f);
+    BOOST_REQUIRE(music);
+    auto filename = music->get_filename();
+    BOOST_CHECK_EQUAL(recording->count(audio_call::set_looping, filename), 1);
+    BOOST_CHECK_EQUAL(recording->get_playing_count(channel_group_type::music), 1);
+
+    // A long fade barely changes the volume at first, stopping it jumps to the end
+    Fade_Music_Command fade(*game, music, 0.2f, 100000);
+    fade.execute();
+    BOOST_CHECK(!fade.is_complete());
+    BOOST_CHECK_CLOSE(music->get_volume(), 0.8f, 1.0f);
+    player->update();
+    fade.stop();
+    fade.execute();
+    BOOST_CHECK(fade.is_complete());
+
+    auto volumes = recording->get_records(audio_call::set_volume, filename);
+    BOOST_REQUIRE_EQUAL(volumes.size(), 3);
+    BOOST_CHECK_CLOSE(volumes.front().value, 0.8f, 0.001f);
+    BOOST_CHECK_CLOSE(volumes.back().value, 0.2f, 0.001f);
+    BOOST_CHECK_CLOSE(volumes.back().time, 0.5, 0.001);
+    BOOST_CHECK(music->playing());
+    BOOST_CHECK_EQUAL(music->get_offset(), xd::detail::null_audio_handle::sample_rate / 2);
+
+    // Global volume goes to the channel group
+    player->set_global_music_volume(0.5f);
+    auto group_volumes = recording->get_records(audio_call::set_group_volume);
+    BOOST_REQUIRE(!group_volumes.empty());
+    BOOST_CHECK_EQUAL(group_volumes.back().first, static_cast<unsigned int>(channel_group_type::music));
+    BOOST_CHECK_CLOSE(group_volumes.back().value, 0.5f, 0.001f);
+
+    player->play_music(map, "false");
+    BOOST_CHECK_EQUAL(recording->count(audio_call::stop, filename), 1);
+    BOOST_CHECK_EQUAL(recording->get_playing_count(), 0);
+}
+
+BOOST_FIXTURE_TEST_CASE(audio_player_reuses_sound_channels, Game_Fixture) {
+    // Each update is a tenth of a second, the sound is about 0.7 seconds long
+    auto handle = std::make_unique<xd::detail::recording_audio_handle>(0.1f);
+    auto recording = handle.get();
+    auto player = detail::make_audio_player(std::make_shared<xd::audio>(std::move(handle)));
+    const std::string filename = "as3sfxr_menu_cancel.wav";
+    auto sound_count = recording->get_sound_count();
+    recording->clear_records();
+
+    // Overlapping plays each get a channel
+    for (int i = 0; i < 3; ++i) {
+        player->play_sound(*game, filename, 1.0f + i * 0.1f, 0.5f);
+    }
+    BOOST_CHECK_EQUAL(recording->count(audio_call::open, filename), 3);
+    BOOST_CHECK_EQUAL(recording->get_peak_playing_count(), 3);
+    auto pitches = recording->get_records(audio_call::set_pitch, filename);
+    BOOST_REQUIRE_EQUAL(pitches.size(), 3);
+    BOOST_CHECK_CLOSE(pitches.back().value, 1.2f, 0.001f);
+
+    // Once they're done playing the channels are reused
+    for (int i = 0; i < 10; ++i) {
+        player->update();
+    }
+    BOOST_CHECK_EQUAL(recording->get_playing_count(), 0);
+    player->play_sound(*game, filename);
+    player->play_sound(*game, filename);
+    BOOST_CHECK_EQUAL(recording->count(audio_call::open, filename), 3);
+    BOOST_CHECK_EQUAL(recording->get_playing_count(), 2);
+    BOOST_CHECK_EQUAL(recording->get_peak_playing_count(), 3);
+    BOOST_CHECK_CLOSE(recording->get_records(audio_call::play).back().time, 1.0, 0.001);
+
+    // Map sounds must not outlive the audio system
+    game->get_map()->get_audio_cache().erase(filename);
+    BOOST_CHECK_EQUAL(recording->get_sound_count(), sound_count);
+}
+
+BOOST_AUTO_TEST_CASE(sound_bank_shares_decoded_sounds) {
+    auto handle = std::make_unique<xd::detail::recording_audio_handle>();
+    auto recording = handle.get();
+    xd::audio audio(std::move(handle));
+    auto& bank = audio.get_sound_bank();
+    const auto rate = xd::detail::null_audio_handle::sample_rate;
+
+    int open_count = 0;
+    auto open = [&]() -> std::unique_ptr<std::istream> {
+        ++open_count;
+        return std::make_unique<std::istringstream>(detail::test_data(rate / 10));
+    };
+    auto source = bank.load("step.wav", open);
+    BOOST_CHECK(bank.load("step.wav", open) == source);
+    BOOST_CHECK(bank.is_loaded("step.wav"));
+    BOOST_CHECK_EQUAL(open_count, 1);
+
+    // Voices and instances share the decoded sound
+    xd::sound instance(audio, *source, channel_group_type::non_pausable_sound);
+    instance.set_volume(0.5f);
+    auto first = bank.play(source, channel_group_type::sound, 0.8f);
+    auto second = bank.play(source, channel_group_type::sound, 0.9f);
+    BOOST_CHECK(first.playing());
+    BOOST_CHECK(second.playing());
+    BOOST_CHECK_EQUAL(bank.get_playing_count("step.wav"), 2);
+    BOOST_CHECK_EQUAL(recording->count(audio_call::open, "step.wav"), 1);
+    BOOST_CHECK_EQUAL(recording->count(audio_call::share, "step.wav"), 3);
+    BOOST_CHECK_CLOSE(source->get_volume(), 1.0f, 0.001f);
+    BOOST_CHECK_CLOSE(instance.get_volume(), 0.5f, 0.001f);
+
+    // Finished voices are reused without making new instances
+    recording->advance(0.2f);
+    BOOST_CHECK(!first.playing());
+    BOOST_CHECK_EQUAL(bank.get_playing_count(), 0);
+    auto third = bank.play(source, channel_group_type::sound);
+    BOOST_CHECK(third.playing());
+    BOOST_CHECK(!first.valid());
+    BOOST_CHECK_EQUAL(recording->count(audio_call::share, "step.wav"), 3);
+
+    BOOST_CHECK_THROW(xd::sound(audio, xd::music(audio, "music.ogg",
+        std::make_unique<std::istringstream>(detail::test_data(100))), channel_group_type::sound),
+        xd::audio_file_load_failed);
+}
+
+BOOST_AUTO_TEST_CASE(sound_bank_releases_unused_sounds) {
+    auto handle = std::make_unique<xd::detail::recording_audio_handle>();
+    auto recording = handle.get();
+    xd::audio audio(std::move(handle));
+    auto& bank = audio.get_sound_bank();
+    const auto rate = xd::detail::null_audio_handle::sample_rate;
+
+    auto open = [&]() -> std::unique_ptr<std::istream> {
+        return std::make_unique<std::istringstream>(detail::test_data(rate / 10));
+    };
+    auto step = bank.load("step.wav", open);
+    auto door = bank.load("door.wav", open);
+    auto voice = bank.play(step, channel_group_type::sound);
+    bank.play(door, channel_group_type::sound);
+    BOOST_CHECK_EQUAL(bank.get_loaded_count(), 2);
+
+    // Sounds still referred to or playing are kept
+    step.reset();
+    door.reset();
+    BOOST_CHECK_EQUAL(bank.release_unused(), 0);
+    BOOST_CHECK_EQUAL(bank.get_loaded_count(), 2);
+
+    // Once they finish, only the bank holds them
+    recording->advance(0.2f);
+    door = bank.load("door.wav", open);
+    BOOST_CHECK_EQUAL(bank.release_unused(), 1);
+    BOOST_CHECK_EQUAL(bank.get_loaded_count(), 1);
+    BOOST_CHECK(!bank.is_loaded("step.wav"));
+    BOOST_CHECK(bank.is_loaded("door.wav"));
+    BOOST_CHECK(!voice.valid());
+
+    door.reset();
+    BOOST_CHECK_EQUAL(bank.release_unused(), 1);
+    BOOST_CHECK_EQUAL(bank.get_loaded_count(), 0);
+    BOOST_CHECK_EQUAL(recording->get_sound_count(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(sound_instances_loop_independently) {
+    auto handle = std::make_unique<xd::detail::null_audio_handle>();
+    auto null_audio = handle.get();
+    xd::audio audio(std::move(handle));
+    const auto rate = xd::detail::null_audio_handle::sample_rate;
+
+    // Like FMOD channels, looping belongs to the instance and not to the
+    // decoded sound it shares
+    xd::sound source(audio, "engine.wav", std::make_unique<std::istringstream>(detail::test_data(rate)),
+        channel_group_type::sound);
+    xd::sound looping(audio, source, channel_group_type::sound);
+    xd::sound once(audio, source, channel_group_type::sound);
+    looping.set_looping(true);
+    looping.set_loop_points(rate / 2, rate - 1);
+    BOOST_CHECK(looping.looping());
+    BOOST_CHECK(!once.looping());
+    BOOST_CHECK(!source.looping());
+    BOOST_CHECK_EQUAL(once.get_loop_points().first, 0u);
+
+    looping.play();
+    once.play();
+    null_audio->advance(1.25f);
+    BOOST_CHECK(looping.playing());
+    BOOST_CHECK_EQUAL(looping.get_offset(), rate * 3 / 4);
+    BOOST_CHECK(once.stopped());
+}
+
+BOOST_AUTO_TEST_CASE(sound_bank_refuses_equal_priority) {
+    auto handle = std::make_unique<xd::detail::recording_audio_handle>();
+    auto recording = handle.get();
+    xd::audio audio(std::move(handle));
+    auto& bank = audio.get_sound_bank();
+    const std::size_t voice_count = 3;
+    bank.set_voice_count(voice_count);
+    bank.set_voices_per_sound(0);
+
+    const auto rate = xd::detail::null_audio_handle::sample_rate;
+    auto open = [&]() -> std::unique_ptr<std::istream> {
+        return std::make_unique<std::istringstream>(detail::test_data(rate / 10));
+    };
+    auto step = bank.load("step.wav", open);
+
+    // One play more than there are voices, all at the same priority
+    std::vector<xd::voice_handle> voices;
+    for (std::size_t i = 0; i <= voice_count; ++i) {
+        voices.push_back(bank.play(step, channel_group_type::sound, 1.0f, 1.0f, 0.5f));
+    }
+    BOOST_CHECK(!voices.back().valid());
+    for (std::size_t i = 0; i < voice_count; ++i) {
+        BOOST_CHECK(voices[i].playing());
+    }
+    BOOST_CHECK_EQUAL(recording->count(audio_call::stop, "step.wav"), 0);
+
+    // Voices that finished on their own keep a valid handle, unlike the
+    // refused play, which is how sprites know when to repeat a frame's sound
+    recording->advance(0.2f);
+    BOOST_CHECK(voices[0].valid());
+    BOOST_CHECK(!voices[0].playing());
+    BOOST_CHECK(!voices.back().valid());
+}
+
+BOOST_AUTO_TEST_CASE(sound_bank_steals_voices) {
+    auto handle = std::make_unique<xd::detail::recording_audio_handle>();
+    auto recording = handle.get();
+    xd::audio audio(std::move(handle));
+    auto& bank = audio.get_sound_bank();
+    bank.set_voice_count(3);
+    bank.set_voices_per_sound(2);
+
+    auto open = []() -> std::unique_ptr<std::istream> {
+        return std::make_unique<std::istringstream>(detail::test_data(10000));
+    };
+    auto step = bank.load("step.wav", open);
+    auto door = bank.load("door.wav", open);
+
+    // Over the per-sound limit the quietest voice of the sound is stolen...
+    auto far_step = bank.play(step, channel_group_type::sound, 0.5f, 1.0f, 0.5f);
+    auto near_step = bank.play(step, channel_group_type::sound, 0.8f, 1.0f, 0.8f);
+    BOOST_CHECK(!bank.play(step, channel_group_type::sound, 0.2f, 1.0f, 0.2f));
+    auto nearest_step = bank.play(step, channel_group_type::sound, 0.9f, 1.0f, 0.9f);
+    BOOST_CHECK(nearest_step);
+    BOOST_CHECK(!far_step.valid());
+    BOOST_CHECK(near_step.playing());
+    BOOST_CHECK_EQUAL(bank.get_playing_count("step.wav"), 2);
+    BOOST_CHECK_EQUAL(recording->count(audio_call::stop, "step.wav"), 1);
+
+    // ...and so is the quietest voice overall once all of them are busy
+    auto far_door = bank.play(door, channel_group_type::sound, 0.1f, 1.0f, 0.1f);
+    BOOST_CHECK(far_door.playing());
+    BOOST_CHECK(!bank.play(door, channel_group_type::sound, 0.05f, 1.0f, 0.05f));
+    near_step.set_priority(0.05f);
+    auto near_door = bank.play(door, channel_group_type::sound, 0.3f, 1.0f, 0.3f);
+    BOOST_CHECK(near_door.playing());
+    BOOST_CHECK(!near_step.valid());
+    BOOST_CHECK(far_door.playing());
+    BOOST_CHECK_EQUAL(bank.get_playing_count(), 3);
+    BOOST_CHECK_EQUAL(recording->get_peak_playing_count(), 3);
+
+    // Stale handles don't touch the voice's new sound
+    auto volume_count = recording->count(audio_call::set_volume);
+    far_step.set_volume(0.0f);
+    near_step.stop();
+    BOOST_CHECK_EQUAL(recording->count(audio_call::set_volume), volume_count);
+    BOOST_CHECK_EQUAL(bank.get_playing_count(), 3);
+
+    // Shrinking the pool stops the voices and invalidates their handles
+    bank.set_voice_count(1);
+    BOOST_CHECK_EQUAL(bank.get_playing_count(), 0);
+    BOOST_CHECK(!nearest_step.valid());
+    BOOST_CHECK(bank.play(door, channel_group_type::sound));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
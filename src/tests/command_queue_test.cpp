@@ -0,0 +1,121 @@
+#include "game_fixture.hpp"
+#include "../commands/command.hpp"
+#include "../commands/command_result.hpp"
+#include "../scripting/scripting_interface.hpp"
+#include <boost/test/unit_test.hpp>
+#include <algorithm>
+#include <set>
+#include <vector>
+
+namespace detail {
+    // Completes after executing a number of times, logging when it does
+    class Countdown_Command : public Command {
+    public:
+        Countdown_Command(int id, int steps, std::vector<int>& completed)
+            : id(id), steps(steps), completed(completed) {}
+        void execute() override {
+            if (steps > 0 && --steps == 0) {
+                completed.push_back(id);
+            }
+        }
+        bool is_complete() const override { return steps == 0 || force_stopped; }
+    private:
+        int id;
+        int steps;
+        std::vector<int>& completed;
+    };
+
+    static int steps_for(int id) {
+        return 1 + id * 7 % 5;
+    }
+}
+
+BOOST_FIXTURE_TEST_SUITE(command_queue_tests, Game_Fixture)
+
+BOOST_AUTO_TEST_CASE(command_queue_completion_order) {
+    Scripting_Interface scripting_interface(*game);
+    std::vector<int> completed;
+    std::vector<Command_Result> results;
+    const int count = 500;
+    for (int i = 0; i < count; ++i) {
+        results.push_back(scripting_interface.register_command<detail::Countdown_Command>(
+            i, detail::steps_for(i), completed));
+    }
+    BOOST_CHECK_EQUAL(scripting_interface.pending_commands(), static_cast<std::size_t>(count));
+
+    for (int update = 0; update < 10 && scripting_interface.pending_commands() > 0; ++update) {
+        scripting_interface.update();
+    }
+    BOOST_CHECK_EQUAL(scripting_interface.pending_commands(), 0u);
+
+    // Commands finishing in the same update complete in the order they were registered
+    std::vector<int> expected(count);
+    for (int i = 0; i < count; ++i) {
+        expected[i] = i;
+    }
+    std::stable_sort(expected.begin(), expected.end(), [](int a, int b) {
+        return detail::steps_for(a) < detail::steps_for(b);
+    });
+    BOOST_CHECK_EQUAL_COLLECTIONS(completed.begin(), completed.end(), expected.begin(), expected.end());
+
+    for (auto& result : results) {
+        BOOST_CHECK(result.is_complete());
+        BOOST_CHECK(!result.get_command()->is_queued());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(command_queue_handles_survive_mass_removal) {
+    Scripting_Interface scripting_interface(*game);
+    std::vector<int> completed;
+    std::vector<Command_Result> results;
+    const int count = 1000;
+    for (int i = 0; i < count; ++i) {
+        results.push_back(scripting_interface.register_command<detail::Countdown_Command>(
+            i, i % 10 == 0 ? 3 : 1, completed));
+    }
+
+    scripting_interface.update();
+    BOOST_CHECK_EQUAL(completed.size(), 900u);
+    BOOST_CHECK_EQUAL(scripting_interface.pending_commands(), 100u);
+    for (int i = 0; i < count; ++i) {
+        auto& result = results[i];
+        if (i % 10 == 0) {
+            BOOST_CHECK(!result.is_complete());
+            BOOST_CHECK(result.get_command()->is_queued());
+        } else {
+            BOOST_CHECK(result.is_complete());
+            BOOST_CHECK(!result.get_command()->is_queued());
+        }
+    }
+
+    // Memory of commands that still have handles is never handed out again
+    std::set<const Command*> held;
+    for (auto& result : results) {
+        held.insert(result.get_command());
+    }
+    std::vector<int> ignored;
+    for (int i = 0; i < 100; ++i) {
+        auto result = scripting_interface.register_command<detail::Countdown_Command>(i, 1, ignored);
+        BOOST_CHECK(held.find(result.get_command()) == held.end());
+    }
+
+    // Once the handles are dropped, finished commands are recycled
+    results.erase(std::remove_if(results.begin(), results.end(),
+        [](const Command_Result& result) { return result.is_complete(); }), results.end());
+    std::set<const Command*> remaining;
+    for (auto& result : results) {
+        remaining.insert(result.get_command());
+    }
+    auto recycled = scripting_interface.register_command<detail::Countdown_Command>(0, 1, ignored);
+    BOOST_CHECK(held.find(recycled.get_command()) != held.end());
+    BOOST_CHECK(remaining.find(recycled.get_command()) == remaining.end());
+
+    scripting_interface.update();
+    scripting_interface.update();
+    BOOST_CHECK_EQUAL(scripting_interface.pending_commands(), 0u);
+    for (auto& result : results) {
+        BOOST_CHECK(result.is_complete());
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
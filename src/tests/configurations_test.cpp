@@ -0,0 +1,94 @@
+#include "../configurations.hpp"
+#include <boost/test/unit_test.hpp>
+#include <chrono>
+#include <sstream>
+#include <string>
+
+namespace detail {
+    static void ensure_defaults() {
+        if (!Configurations::defaults_loaded()) {
+            Configurations::load_defaults();
+        }
+    }
+}
+
+BOOST_AUTO_TEST_SUITE(configurations_tests)
+
+BOOST_AUTO_TEST_CASE(configurations_handle_sees_set) {
+    detail::ensure_defaults();
+    Configurations::set("handle-test.speed", 5, false);
+    Configurations::Handle<int> speed("handle-test.speed");
+    BOOST_CHECK_EQUAL(speed.get(), 5);
+
+    Configurations::set("handle-test.speed", 7, false);
+    BOOST_CHECK_EQUAL(speed.get(), 7);
+
+    // Adding other options doesn't break existing handles
+    for (int i = 0; i < 100; ++i) {
+        Configurations::set("handle-test.other" + std::to_string(i), i, false);
+    }
+    BOOST_CHECK_EQUAL(speed.get(), 7);
+    Configurations::override_value("handle-test.speed", 9);
+    BOOST_CHECK_EQUAL(speed.get(), 9);
+
+    Configurations::Handle<std::string> name("handle-test.name");
+    BOOST_CHECK_THROW(name.get(), config_exception);
+    Configurations::set("handle-test.name", std::string{"first"}, false);
+    BOOST_CHECK_EQUAL(name.get(), "first");
+}
+
+BOOST_AUTO_TEST_CASE(configurations_handle_fallback) {
+    detail::ensure_defaults();
+    Configurations::set("handle-test.fallback", 3, false);
+    Configurations::Handle<int> value("handle-test.primary", "handle-test.fallback");
+    BOOST_CHECK_EQUAL(value.get(), 3);
+    BOOST_CHECK_EQUAL(value.get(), Configurations::get<int>("handle-test.primary", "handle-test.fallback"));
+
+    Configurations::set("handle-test.primary", 4, false);
+    BOOST_CHECK_EQUAL(value.get(), 4);
+    BOOST_CHECK_EQUAL(value.get(), Configurations::get<int>("handle-test.primary", "handle-test.fallback"));
+}
+
+BOOST_AUTO_TEST_CASE(configurations_handle_observers_still_fire) {
+    detail::ensure_defaults();
+    Configurations::Handle<float> volume("handle-test.volume");
+    Configurations::set("handle-test.volume", 0.5f, false);
+    int notifications = 0;
+    float observed = 0.0f;
+    Configurations::add_observer("handle-test", [&](const std::string& key) {
+        if (key != "handle-test.volume") return;
+        ++notifications;
+        observed = volume.get();
+    });
+
+    Configurations::set("handle-test.volume", 0.25f, false);
+    Configurations::remove_observer("handle-test");
+    BOOST_CHECK_EQUAL(notifications, 1);
+    BOOST_CHECK_EQUAL(observed, 0.25f);
+}
+
+BOOST_AUTO_TEST_CASE(configurations_handle_benchmark) {
+    detail::ensure_defaults();
+    const int iterations = 1000000;
+    Configurations::Handle<int> logic_fps("graphics.logic-fps", "debug.logic-fps");
+
+    auto start = std::chrono::steady_clock::now();
+    long long lookup_sum = 0;
+    for (int i = 0; i < iterations; ++i) {
+        lookup_sum += Configurations::get<int>("graphics.logic-fps", "debug.logic-fps");
+    }
+    std::chrono::duration<double, std::nano> lookup_time = std::chrono::steady_clock::now() - start;
+
+    start = std::chrono::steady_clock::now();
+    long long handle_sum = 0;
+    for (int i = 0; i < iterations; ++i) {
+        handle_sum += logic_fps.get();
+    }
+    std::chrono::duration<double, std::nano> handle_time = std::chrono::steady_clock::now() - start;
+
+    BOOST_TEST_MESSAGE("Configurations::get: " << lookup_time.count() / iterations
+        << " ns per call, handle: " << handle_time.count() / iterations << " ns per call");
+    BOOST_CHECK_EQUAL(lookup_sum, handle_sum);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
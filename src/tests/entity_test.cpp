@@ -0,0 +1,259 @@
+#include "../xd/entity.hpp"
+#include <boost/test/unit_test.hpp>
+#include <any>
+#include <chrono>
+#include <list>
+#include <map>
+#include <memory>
+#include <string>
+#include <typeinfo>
+#include <unordered_map>
+#include <vector>
+
+namespace detail {
+    struct Test_Entity : public xd::entity<Test_Entity> {
+        std::vector<std::string> calls;
+        int counter = 0;
+    };
+
+    class Recording_Updater : public xd::logic_component<Test_Entity> {
+    public:
+        explicit Recording_Updater(std::string name) : name(std::move(name)) {}
+        void update(Test_Entity& entity) override { entity.calls.push_back(name); }
+    private:
+        std::string name;
+    };
+
+    class Recording_Renderer : public xd::render_component<Test_Entity> {
+    public:
+        explicit Recording_Renderer(std::string name) : name(std::move(name)) {}
+        void render(Test_Entity& entity) override { entity.calls.push_back(name); }
+    private:
+        std::string name;
+    };
+
+    class Recording_Component : public xd::component<Test_Entity> {
+    public:
+        void update(Test_Entity& entity) override { entity.calls.push_back("update"); }
+        void render(Test_Entity& entity) override { entity.calls.push_back("render"); }
+    };
+
+    // Removes itself and adds a replacement the first time it's updated
+    class Self_Removing_Updater : public xd::logic_component<Test_Entity> {
+    public:
+        void update(Test_Entity& entity) override {
+            entity.calls.push_back("self");
+            entity.del_component(handle);
+            entity.add_component(std::make_shared<Recording_Updater>("added"));
+        }
+        xd::component_handle handle = xd::invalid_component_handle;
+    };
+
+    class Counting_Updater : public xd::logic_component<Test_Entity> {
+    public:
+        void update(Test_Entity& entity) override { ++entity.counter; }
+    };
+
+    // Same work as Counting_Updater, called through the old list storage
+    class List_Updater {
+    public:
+        virtual ~List_Updater() {}
+        virtual void update(Test_Entity& entity) { ++entity.counter; }
+    };
+
+    struct Position {
+        float x = 0.0f;
+        float y = 0.0f;
+    };
+
+    // The previous storage layout, kept for comparison in the benchmark
+    struct List_Entity {
+        std::map<int, std::list<std::shared_ptr<List_Updater>>> components;
+        std::unordered_map<std::size_t, std::any> data;
+        template <typename T>
+        T& get() {
+            std::size_t hash = typeid(T).hash_code();
+            auto i = data.find(hash);
+            if (i == data.end())
+                i = data.emplace(hash, T()).first;
+            return *std::any_cast<T>(&i->second);
+        }
+    };
+}
+
+BOOST_AUTO_TEST_SUITE(entity_tests)
+
+BOOST_AUTO_TEST_CASE(entity_components_run_in_priority_order) {
+    detail::Test_Entity entity;
+    entity.add_component(std::make_shared<detail::Recording_Updater>("b"), 1);
+    entity.add_component(std::make_shared<detail::Recording_Updater>("c"), 1);
+    entity.add_component(std::make_shared<detail::Recording_Updater>("a"), -5);
+    entity.add_component(std::make_shared<detail::Recording_Updater>("d"), 10);
+    entity.add_component(std::make_shared<detail::Recording_Renderer>("render"));
+
+    entity.update();
+    std::vector<std::string> expected{"a", "b", "c", "d"};
+    BOOST_CHECK_EQUAL_COLLECTIONS(entity.calls.begin(), entity.calls.end(), expected.begin(), expected.end());
+
+    entity.calls.clear();
+    entity.render();
+    BOOST_REQUIRE_EQUAL(entity.calls.size(), 1);
+    BOOST_CHECK_EQUAL(entity.calls[0], "render");
+}
+
+BOOST_AUTO_TEST_CASE(entity_component_add_and_remove) {
+    detail::Test_Entity entity;
+    auto first = std::make_shared<detail::Recording_Updater>("first");
+    auto second = std::make_shared<detail::Recording_Updater>("second");
+    auto both = std::make_shared<detail::Recording_Component>();
+    auto first_handle = entity.add_component(first);
+    auto second_handle = entity.add_component(second, 2);
+    auto both_handle = entity.add_component(both);
+    BOOST_CHECK(first_handle != second_handle);
+    BOOST_CHECK(first_handle != xd::invalid_component_handle);
+
+    // Handles stay valid when other components are removed
+    entity.del_component(first);
+    BOOST_CHECK(!entity.has_component(first_handle));
+    BOOST_CHECK(entity.has_component(second_handle));
+    // Removing with the wrong priority does nothing
+    entity.del_component(second, 0);
+    BOOST_CHECK(entity.has_component(second_handle));
+
+    entity.update();
+    entity.render();
+    std::vector<std::string> expected{"update", "second", "render"};
+    BOOST_CHECK_EQUAL_COLLECTIONS(entity.calls.begin(), entity.calls.end(), expected.begin(), expected.end());
+
+    // A full component is removed from both update and render
+    BOOST_CHECK(entity.del_component(both_handle));
+    BOOST_CHECK(!entity.del_component(both_handle));
+    entity.calls.clear();
+    entity.update();
+    entity.render();
+    BOOST_REQUIRE_EQUAL(entity.calls.size(), 1);
+    BOOST_CHECK_EQUAL(entity.calls[0], "second");
+
+    entity.clear_components();
+    BOOST_CHECK(!entity.has_component(second_handle));
+}
+
+BOOST_AUTO_TEST_CASE(entity_component_changes_while_updating) {
+    detail::Test_Entity entity;
+    auto self_removing = std::make_shared<detail::Self_Removing_Updater>();
+    entity.add_component(std::make_shared<detail::Recording_Updater>("before"), -1);
+    self_removing->handle = entity.add_component(self_removing);
+    entity.add_component(std::make_shared<detail::Recording_Updater>("after"), 1);
+
+    // The component added during the update only runs from the next update
+    entity.update();
+    std::vector<std::string> expected{"before", "self", "after"};
+    BOOST_CHECK_EQUAL_COLLECTIONS(entity.calls.begin(), entity.calls.end(), expected.begin(), expected.end());
+
+    entity.calls.clear();
+    entity.update();
+    expected = {"before", "added", "after"};
+    BOOST_CHECK_EQUAL_COLLECTIONS(entity.calls.begin(), entity.calls.end(), expected.begin(), expected.end());
+}
+
+BOOST_AUTO_TEST_CASE(entity_typed_data) {
+    detail::Test_Entity entity;
+    BOOST_CHECK(!entity.has<detail::Position>());
+    entity.get<detail::Position>().x = 3.0f;
+    BOOST_CHECK(entity.has<detail::Position>());
+    BOOST_CHECK_EQUAL(entity.get<detail::Position>().x, 3.0f);
+    BOOST_CHECK(!entity.has<int>());
+    entity.get<int>() = 5;
+    BOOST_CHECK_EQUAL(entity.get<int>(), 5);
+    BOOST_CHECK_EQUAL(entity.get<detail::Position>().x, 3.0f);
+
+    // Data is per entity
+    detail::Test_Entity other;
+    BOOST_CHECK(!other.has<detail::Position>());
+    BOOST_CHECK_EQUAL(other.get<detail::Position>().x, 0.0f);
+
+    entity.get<std::string>("name") = "test";
+    BOOST_CHECK(entity.has<std::string>("name"));
+    BOOST_CHECK_EQUAL(entity.get<std::string>("name"), "test");
+}
+
+// Compares the flat per-entity storage with the previous layout. Only the
+// lists are flattened, each component is still its own allocation called
+// through a virtual function, so both numbers are reported without a verdict
+BOOST_AUTO_TEST_CASE(entity_storage_benchmark) {
+    const int entity_count = 5000;
+    const int components_per_entity = 3;
+    const int frames = 50;
+
+    std::vector<std::unique_ptr<detail::Test_Entity>> entities;
+    std::vector<detail::List_Entity> list_entities(entity_count);
+    for (int i = 0; i < entity_count; ++i) {
+        entities.push_back(std::make_unique<detail::Test_Entity>());
+        for (int j = 0; j < components_per_entity; ++j) {
+            entities.back()->add_component(std::make_shared<detail::Counting_Updater>(), j);
+        }
+    }
+    // Components get added over the course of a game, not all at once,
+    // so the old storage's nodes are scattered around the heap
+    for (int j = 0; j < components_per_entity; ++j) {
+        for (int i = 0; i < entity_count; ++i) {
+            int scattered = (i * 7919) % entity_count;
+            list_entities[scattered].components[j].push_back(std::make_shared<detail::List_Updater>());
+        }
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (int frame = 0; frame < frames; ++frame) {
+        for (auto& entity : entities) {
+            entity->update();
+        }
+    }
+    std::chrono::duration<double, std::nano> update_time = std::chrono::steady_clock::now() - start;
+
+    detail::Test_Entity list_target;
+    start = std::chrono::steady_clock::now();
+    for (int frame = 0; frame < frames; ++frame) {
+        for (auto& entity : list_entities) {
+            for (auto& [priority, list] : entity.components) {
+                for (auto& component : list) {
+                    component->update(list_target);
+                }
+            }
+        }
+    }
+    std::chrono::duration<double, std::nano> list_update_time = std::chrono::steady_clock::now() - start;
+
+    long long total = 0;
+    for (auto& entity : entities) {
+        total += entity->counter;
+    }
+    BOOST_CHECK_EQUAL(total, static_cast<long long>(entity_count) * components_per_entity * frames);
+    BOOST_CHECK_EQUAL(total, list_target.counter);
+
+    start = std::chrono::steady_clock::now();
+    float slot_sum = 0.0f;
+    for (int frame = 0; frame < frames; ++frame) {
+        for (auto& entity : entities) {
+            slot_sum += entity->get<detail::Position>().x += 1.0f;
+        }
+    }
+    std::chrono::duration<double, std::nano> slot_time = std::chrono::steady_clock::now() - start;
+
+    start = std::chrono::steady_clock::now();
+    float any_sum = 0.0f;
+    for (int frame = 0; frame < frames; ++frame) {
+        for (auto& entity : list_entities) {
+            any_sum += entity.get<detail::Position>().x += 1.0f;
+        }
+    }
+    std::chrono::duration<double, std::nano> any_time = std::chrono::steady_clock::now() - start;
+
+    const double updates = static_cast<double>(entity_count) * frames;
+    BOOST_TEST_MESSAGE("entity update: " << update_time.count() / updates
+        << " ns per entity, list storage: " << list_update_time.count() / updates << " ns per entity");
+    BOOST_TEST_MESSAGE("entity data slot: " << slot_time.count() / updates
+        << " ns per get, typeid map: " << any_time.count() / updates << " ns per get");
+    BOOST_CHECK_EQUAL(slot_sum, any_sum);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,131 @@
+#include "../xd/event_bus.hpp"
+#include "../xd/entity.hpp"
+#include <boost/test/unit_test.hpp>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace detail {
+    struct Test_Args {
+        int value;
+    };
+
+    struct Event_Entity : public xd::entity<Event_Entity> {};
+}
+
+BOOST_AUTO_TEST_SUITE(event_bus_tests)
+
+BOOST_AUTO_TEST_CASE(event_bus_interned_ids) {
+    xd::event_bus<detail::Test_Args> bus;
+    auto first = bus.id("first");
+    auto second = bus.id("second");
+    BOOST_CHECK(first != second);
+    BOOST_CHECK_EQUAL(bus.id("first"), first);
+
+    int sum = 0;
+    bus["first"].add([&sum](const detail::Test_Args& args) { sum += args.value; return true; });
+    // Names and IDs refer to the same event
+    bus[first](detail::Test_Args{2});
+    bus["first"](detail::Test_Args{3});
+    bus[second](detail::Test_Args{100});
+    BOOST_CHECK_EQUAL(sum, 5);
+    BOOST_CHECK_THROW(bus[second + 1], std::out_of_range);
+}
+
+BOOST_AUTO_TEST_CASE(event_bus_order_and_propagation) {
+    xd::event_bus<detail::Test_Args> bus;
+    std::vector<std::string> calls;
+    auto& event = bus["event"];
+    event.add([&calls](const detail::Test_Args&) { calls.push_back("appended"); return true; },
+        xd::event_placement::EVENT_APPEND);
+    event.add([&calls](const detail::Test_Args&) { calls.push_back("prepended"); return true; });
+    event.add([&calls](const detail::Test_Args&) { calls.push_back("filtered"); return true; },
+        [](const detail::Test_Args& args) { return args.value > 0; });
+
+    event(detail::Test_Args{0});
+    std::vector<std::string> expected{"prepended", "appended"};
+    BOOST_CHECK_EQUAL_COLLECTIONS(calls.begin(), calls.end(), expected.begin(), expected.end());
+
+    // Returning false stops the other callbacks
+    event.add([&calls](const detail::Test_Args&) { calls.push_back("stop"); return false; });
+    calls.clear();
+    event(detail::Test_Args{1});
+    BOOST_REQUIRE_EQUAL(calls.size(), 1);
+    BOOST_CHECK_EQUAL(calls[0], "stop");
+}
+
+BOOST_AUTO_TEST_CASE(event_bus_unsubscribe_during_dispatch) {
+    xd::event_bus<detail::Test_Args> bus;
+    auto& event = bus["event"];
+    std::vector<std::string> calls;
+    xd::event_link self_link = 0;
+    xd::event_link later_link = 0;
+
+    self_link = event.add([&](const detail::Test_Args&) {
+        calls.push_back("self");
+        event.remove(self_link);
+        // The later callback is skipped right away
+        event.remove(later_link);
+        event.add([&calls](const detail::Test_Args&) { calls.push_back("added"); return true; },
+            xd::event_placement::EVENT_APPEND);
+        return true;
+    }, xd::event_placement::EVENT_APPEND);
+    event.add([&calls](const detail::Test_Args&) { calls.push_back("kept"); return true; },
+        xd::event_placement::EVENT_APPEND);
+    later_link = event.add([&calls](const detail::Test_Args&) { calls.push_back("later"); return true; },
+        xd::event_placement::EVENT_APPEND);
+
+    event(detail::Test_Args{0});
+    std::vector<std::string> expected{"self", "kept"};
+    BOOST_CHECK_EQUAL_COLLECTIONS(calls.begin(), calls.end(), expected.begin(), expected.end());
+
+    // Callbacks added while dispatching run from the next dispatch
+    calls.clear();
+    event(detail::Test_Args{0});
+    expected = {"kept", "added"};
+    BOOST_CHECK_EQUAL_COLLECTIONS(calls.begin(), calls.end(), expected.begin(), expected.end());
+
+    BOOST_CHECK_THROW(event.remove(self_link), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(event_bus_entity_events) {
+    detail::Event_Entity entity;
+    int sum = 0;
+    entity.on<detail::Test_Args>("hit", [&sum](const detail::Test_Args& args) { sum += args.value; return true; });
+    auto hit = entity.get_event_id<detail::Test_Args>("hit");
+    entity.trigger(hit, detail::Test_Args{4});
+    entity.trigger("hit", detail::Test_Args{5});
+    BOOST_CHECK_EQUAL(sum, 9);
+}
+
+BOOST_AUTO_TEST_CASE(event_bus_dispatch_benchmark) {
+    const int iterations = 1000000;
+    xd::event_bus<detail::Test_Args> bus;
+    long long sum = 0;
+    for (int i = 0; i < 4; ++i) {
+        bus["key_down"].add([&sum](const detail::Test_Args& args) { sum += args.value; return true; });
+    }
+    auto key_down = bus.id("key_down");
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        bus["key_down"](detail::Test_Args{1});
+    }
+    std::chrono::duration<double, std::nano> name_time = std::chrono::steady_clock::now() - start;
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        bus[key_down](detail::Test_Args{1});
+    }
+    std::chrono::duration<double, std::nano> id_time = std::chrono::steady_clock::now() - start;
+
+    BOOST_TEST_MESSAGE("event dispatch by name: " << name_time.count() / iterations
+        << " ns, by ID: " << id_time.count() / iterations << " ns");
+    BOOST_CHECK_EQUAL(sum, 8LL * iterations);
+    // Both lookups reach the same event, and the name keeps its ID
+    BOOST_CHECK_EQUAL(bus.id("key_down"), key_down);
+    BOOST_CHECK_EQUAL(&bus["key_down"], &bus[key_down]);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
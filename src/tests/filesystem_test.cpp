@@ -0,0 +1,235 @@
+#include "../exceptions.hpp"
+#include "../filesystem/file_buffer.hpp"
+#include "../filesystem/readable_filesystem.hpp"
+#include "../filesystem/writable_filesystem.hpp"
+#include "../utility/file.hpp"
+#include "../vendor/physfs.hpp"
+#include <boost/crc.hpp>
+#include <boost/test/unit_test.hpp>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <istream>
+#include <iterator>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace detail {
+    static std::string read_stream(Readable_Filesystem& fs, const std::string& filename) {
+        auto stream = fs.open_binary_ifstream(filename);
+        BOOST_REQUIRE(stream && *stream);
+        return std::string((std::istreambuf_iterator<char>(*stream)),
+            std::istreambuf_iterator<char>());
+    }
+
+    static std::string make_content(std::size_t size) {
+        std::string content(size, '\0');
+        for (std::size_t i = 0; i < size; ++i) {
+            content[i] = static_cast<char>((i * 31 + i / 7) & 0xFF);
+        }
+        return content;
+    }
+
+    static void write_file(Writable_Filesystem& fs, const std::string& filename, const std::string& content) {
+        auto stream = fs.open_ofstream(filename, std::ios_base::out | std::ios_base::binary);
+        BOOST_REQUIRE(stream && *stream);
+        stream->write(content.data(), content.size());
+    }
+
+    struct Zip_Entry {
+        std::string name;
+        std::string content;
+        // Size written to the headers, 0 for the size of the content
+        std::uint32_t declared_size;
+    };
+
+    static void put_le(std::string& out, std::uint32_t value, int bytes) {
+        for (int i = 0; i < bytes; ++i) {
+            out += static_cast<char>((value >> (8 * i)) & 0xFF);
+        }
+    }
+
+    // Build a zip archive with uncompressed (stored) entries
+    static std::string make_stored_zip(const std::vector<Zip_Entry>& entries) {
+        std::string archive, directory;
+        for (auto& entry : entries) {
+            boost::crc_32_type crc;
+            crc.process_bytes(entry.content.data(), entry.content.size());
+            auto size = entry.declared_size ? entry.declared_size
+                : static_cast<std::uint32_t>(entry.content.size());
+            auto name_length = static_cast<std::uint32_t>(entry.name.size());
+            auto offset = static_cast<std::uint32_t>(archive.size());
+
+            put_le(archive, 0x04034b50, 4);
+            put_le(archive, 10, 2);                 // version needed
+            put_le(archive, 0, 2);                  // flags
+            put_le(archive, 0, 2);                  // stored
+            put_le(archive, 0, 4);                  // time and date
+            put_le(archive, crc.checksum(), 4);
+            put_le(archive, size, 4);
+            put_le(archive, size, 4);
+            put_le(archive, name_length, 2);
+            put_le(archive, 0, 2);                  // extra field
+            archive += entry.name;
+            archive += entry.content;
+
+            put_le(directory, 0x02014b50, 4);
+            put_le(directory, 20, 2);               // version made by
+            put_le(directory, 10, 2);
+            put_le(directory, 0, 2);
+            put_le(directory, 0, 2);
+            put_le(directory, 0, 4);
+            put_le(directory, crc.checksum(), 4);
+            put_le(directory, size, 4);
+            put_le(directory, size, 4);
+            put_le(directory, name_length, 2);
+            put_le(directory, 0, 2);                // extra field
+            put_le(directory, 0, 2);                // comment
+            put_le(directory, 0, 2);                // disk
+            put_le(directory, 0, 2);                // internal attributes
+            put_le(directory, 0, 4);                // external attributes
+            put_le(directory, offset, 4);
+            directory += entry.name;
+        }
+
+        auto directory_offset = static_cast<std::uint32_t>(archive.size());
+        archive += directory;
+        put_le(archive, 0x06054b50, 4);
+        put_le(archive, 0, 2);
+        put_le(archive, 0, 2);
+        put_le(archive, static_cast<std::uint32_t>(entries.size()), 2);
+        put_le(archive, static_cast<std::uint32_t>(entries.size()), 2);
+        put_le(archive, static_cast<std::uint32_t>(directory.size()), 4);
+        put_le(archive, directory_offset, 4);
+        put_le(archive, 0, 2);                      // comment
+        return archive;
+    }
+
+    static double seconds_since(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+BOOST_AUTO_TEST_SUITE(filesystem_tests)
+
+BOOST_AUTO_TEST_CASE(file_buffer_matches_across_filesystems) {
+    // The disk filesystem is the Standard or Boost one, depending on the build
+    auto disk_fs = file_utilities::disk_filesystem();
+    auto virtual_fs = file_utilities::virtual_filesystem();
+    Readable_Filesystem* filesystems[] = { disk_fs.get(), virtual_fs.get() };
+    const char* filenames[] = { "config.ini", "sprite.spr", "test_sheet.tsx", "test_tiled.tmx" };
+
+    for (auto filename : filenames) {
+        auto expected = detail::read_stream(*disk_fs, filename);
+        for (auto fs : filesystems) {
+            auto buffer = fs->read_file_buffer(filename);
+            BOOST_CHECK_EQUAL(buffer.size(), expected.size());
+            BOOST_CHECK(buffer.view() == expected);
+            BOOST_CHECK_EQUAL(buffer.data()[buffer.size()], '\0');
+            BOOST_CHECK(fs->read_file(filename) == expected);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(file_buffer_maps_large_files) {
+    auto fs = file_utilities::disk_filesystem();
+    // One size ends mid-page and gets mapped, the other fills whole pages
+    // and has to be read to make room for the null terminator
+    std::size_t sizes[] = { 8 * 1024 * 1024 + 123, 4 * 1024 * 1024 };
+
+    for (auto size : sizes) {
+        std::string filename = "file_buffer_test.bin";
+        auto content = detail::make_content(size);
+        detail::write_file(*fs, filename, content);
+
+        auto start = std::chrono::steady_clock::now();
+        auto streamed = detail::read_stream(*fs, filename);
+        auto stream_seconds = detail::seconds_since(start);
+
+        start = std::chrono::steady_clock::now();
+        auto buffer = fs->read_file_buffer(filename);
+        auto buffer_seconds = detail::seconds_since(start);
+
+        BOOST_CHECK(streamed == content);
+        BOOST_CHECK(buffer.view() == content);
+        BOOST_CHECK_EQUAL(buffer.data()[buffer.size()], '\0');
+        BOOST_CHECK_EQUAL(buffer.is_mapped(), size == sizes[0]);
+
+        auto megabytes = size / (1024.0 * 1024.0);
+        BOOST_TEST_MESSAGE("Read " << megabytes << " MB: stream " << megabytes / stream_seconds
+            << " MB/s, buffer " << megabytes / buffer_seconds << " MB/s"
+            << (buffer.is_mapped() ? " (mapped)" : ""));
+
+        buffer = File_Buffer{};
+        fs->remove(filename);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(file_buffer_reads_physfs_archives) {
+    // Make sure PhysFS is initialized
+    auto virtual_fs = file_utilities::virtual_filesystem();
+    // The executable's folder might not be writable
+    auto temp_dir = std::filesystem::temp_directory_path();
+
+    auto small = detail::make_content(1000);
+    auto large = detail::make_content(File_Buffer::min_mapped_size * 2 + 5);
+    auto archive_path = temp_dir / "octopus_file_buffer_test.zip";
+    {
+        std::ofstream archive(archive_path, std::ios::binary);
+        archive << detail::make_stored_zip({
+            { "small.bin", small, 0 },
+            { "large.bin", large, 0 }
+        });
+    }
+
+    // An entry that claims more data than the archive has, so reading it comes up short
+    auto partial = detail::make_content(64);
+    auto short_path = temp_dir / "octopus_file_buffer_short_test.zip";
+    {
+        std::ofstream archive(short_path, std::ios::binary);
+        archive << detail::make_stored_zip({ { "short.bin", partial, 64 * 1024 } });
+    }
+
+    BOOST_REQUIRE(PHYSFS_mount(archive_path.u8string().c_str(), "file_buffer_archive", 1));
+    BOOST_REQUIRE(PHYSFS_mount(short_path.u8string().c_str(), "file_buffer_short", 1));
+
+    // Archive entries are read into pooled buffers, never mapped
+    for (auto& [filename, content] : { std::make_pair("file_buffer_archive/small.bin", small),
+            std::make_pair("file_buffer_archive/large.bin", large) }) {
+        auto buffer = virtual_fs->read_file_buffer(filename);
+        BOOST_CHECK(!buffer.is_mapped());
+        BOOST_CHECK_EQUAL(buffer.size(), content.size());
+        BOOST_CHECK(buffer.view() == content);
+        BOOST_CHECK_EQUAL(buffer.data()[buffer.size()], '\0');
+        BOOST_CHECK(detail::read_stream(*virtual_fs, filename) == content);
+    }
+
+    // The buffer is truncated to what could be read, and stays null terminated
+    auto buffer = virtual_fs->read_file_buffer("file_buffer_short/short.bin");
+    BOOST_CHECK_LT(buffer.size(), 64u * 1024u);
+    BOOST_CHECK_EQUAL(buffer.data()[buffer.size()], '\0');
+
+    BOOST_CHECK_THROW(virtual_fs->read_file_buffer("file_buffer_archive/missing.bin"), file_loading_exception);
+
+    buffer = File_Buffer{};
+    PHYSFS_unmount(archive_path.u8string().c_str());
+    PHYSFS_unmount(short_path.u8string().c_str());
+    std::filesystem::remove(archive_path);
+    std::filesystem::remove(short_path);
+}
+
+BOOST_AUTO_TEST_CASE(file_buffer_allocate_terminates_content) {
+    auto buffer = File_Buffer::allocate(16);
+    BOOST_CHECK_EQUAL(buffer.size(), 16u);
+    BOOST_CHECK_EQUAL(buffer.data()[16], '\0');
+    buffer.truncate(4);
+    BOOST_CHECK_EQUAL(buffer.size(), 4u);
+    BOOST_CHECK_EQUAL(buffer.data()[4], '\0');
+    buffer.truncate(10);
+    BOOST_CHECK_EQUAL(buffer.size(), 4u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
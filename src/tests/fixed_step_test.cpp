@@ -0,0 +1,132 @@
+#include "../xd/system/fixed_step_timer.hpp"
+#include <boost/test/unit_test.hpp>
+#include <cstdint>
+
+namespace detail {
+    // Stands in for the window's timer, the loop only sees elapsed time
+    struct Fake_Clock {
+        std::int64_t now = 0;
+        std::int64_t last = 0;
+
+        void wait(std::int64_t nanoseconds) { now += nanoseconds; }
+        std::int64_t elapsed() {
+            auto result = now - last;
+            last = now;
+            return result;
+        }
+    };
+
+    static constexpr std::int64_t millisecond = 1000000;
+    static constexpr std::int64_t second = xd::fixed_step_timer::nanoseconds_per_second;
+
+    // Run the loop for the given number of frames, returning the total steps
+    static int run_frames(xd::fixed_step_timer& timer, Fake_Clock& clock,
+            int frames, std::int64_t frame_time, int* max_per_frame = nullptr) {
+        int total = 0;
+        for (int i = 0; i < frames; ++i) {
+            clock.wait(frame_time);
+            int steps = timer.advance(clock.elapsed());
+            if (max_per_frame && steps > *max_per_frame) *max_per_frame = steps;
+            total += steps;
+        }
+        return total;
+    }
+}
+
+BOOST_AUTO_TEST_SUITE(fixed_step_tests)
+
+BOOST_AUTO_TEST_CASE(fixed_step_doesnt_drift) {
+    // An hour of 144 Hz frames (the clock rounds every frame to whole nanoseconds)
+    xd::fixed_step_timer timer(60, 5);
+    detail::Fake_Clock clock;
+    int steps = 0;
+    const int frames = 144 * 3600;
+    std::int64_t previous = 0;
+    for (int i = 1; i <= frames; ++i) {
+        auto target = detail::second * i / 144;
+        clock.wait(target - previous);
+        previous = target;
+        steps += timer.advance(clock.elapsed());
+    }
+    BOOST_CHECK_EQUAL(steps, 60 * 3600);
+    BOOST_CHECK_EQUAL(timer.dropped_steps(), 0u);
+
+    // 16 ms ticks used to run 62.5 steps per second instead of 60. A thousand
+    // 16 ms frames are 16 simulated seconds
+    xd::fixed_step_timer exact(60, 0);
+    detail::Fake_Clock frame_clock;
+    BOOST_CHECK_EQUAL(detail::run_frames(exact, frame_clock, 1000, 16 * detail::millisecond), 60 * 16);
+}
+
+BOOST_AUTO_TEST_CASE(fixed_step_caps_catch_up_after_stall) {
+    xd::fixed_step_timer timer(60, 5);
+    detail::Fake_Clock clock;
+    int max_per_frame = 0;
+    detail::run_frames(timer, clock, 60, detail::second / 60, &max_per_frame);
+    BOOST_CHECK_EQUAL(max_per_frame, 1);
+
+    // A two second hitch only runs the capped number of steps
+    clock.wait(2 * detail::second);
+    BOOST_CHECK_EQUAL(timer.advance(clock.elapsed()), 5);
+    BOOST_CHECK_EQUAL(timer.dropped_steps(), 115u);
+
+    // The dropped time isn't made up later
+    max_per_frame = 0;
+    int steps = detail::run_frames(timer, clock, 60, detail::second / 60, &max_per_frame);
+    BOOST_CHECK_LE(max_per_frame, 2);
+    BOOST_CHECK(steps >= 59 && steps <= 61);
+    BOOST_CHECK_GE(timer.alpha(), 0.0);
+    BOOST_CHECK_LT(timer.alpha(), 1.0);
+}
+
+BOOST_AUTO_TEST_CASE(fixed_step_uncapped_catches_up) {
+    xd::fixed_step_timer timer(60, 0);
+    detail::Fake_Clock clock;
+    clock.wait(2 * detail::second);
+    BOOST_CHECK_EQUAL(timer.advance(clock.elapsed()), 120);
+    BOOST_CHECK_EQUAL(timer.dropped_steps(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(fixed_step_repeated_stalls) {
+    // Every frame takes 250 ms: each frame runs the cap instead of spiraling
+    xd::fixed_step_timer timer(60, 4);
+    detail::Fake_Clock clock;
+    int max_per_frame = 0;
+    int steps = detail::run_frames(timer, clock, 20, 250 * detail::millisecond, &max_per_frame);
+    BOOST_CHECK_EQUAL(max_per_frame, 4);
+    BOOST_CHECK_EQUAL(steps, 80);
+    BOOST_CHECK_EQUAL(timer.dropped_steps(), 300u - 80u);
+
+    // Slow frames below the cap don't lose time
+    xd::fixed_step_timer slow(60, 4);
+    detail::Fake_Clock slow_clock;
+    steps = detail::run_frames(slow, slow_clock, 30, 50 * detail::millisecond, &max_per_frame);
+    BOOST_CHECK_EQUAL(steps, 90);
+    BOOST_CHECK_EQUAL(slow.dropped_steps(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(fixed_step_keeps_fraction_on_rate_change) {
+    xd::fixed_step_timer timer(60, 0);
+    BOOST_CHECK_EQUAL(timer.advance(detail::second / 120), 0);
+    BOOST_CHECK_CLOSE(timer.alpha(), 0.5, 0.001);
+    timer.set_steps_per_second(30);
+    BOOST_CHECK_CLOSE(timer.alpha(), 0.5, 0.001);
+    BOOST_CHECK_EQUAL(timer.advance(detail::second / 30), 1);
+    BOOST_CHECK_CLOSE(timer.alpha(), 0.5, 0.001);
+}
+
+BOOST_AUTO_TEST_CASE(fixed_step_virtual_clock) {
+    // Advancing by time_to_next_step always runs exactly one step, like headless mode
+    xd::fixed_step_timer timer(60, 5);
+    std::int64_t total = 0;
+    for (int i = 0; i < 600; ++i) {
+        auto elapsed = timer.time_to_next_step();
+        total += elapsed;
+        BOOST_REQUIRE_EQUAL(timer.advance(elapsed), 1);
+    }
+    // The rounded up steps don't add up to more than a nanosecond per step
+    BOOST_CHECK_GE(total, 10 * detail::second);
+    BOOST_CHECK_LE(total, 10 * detail::second + 600);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
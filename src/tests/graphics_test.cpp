@@ -0,0 +1,320 @@
+#include "../xd/graphics/detail/atlas.hpp"
+#include "../xd/graphics/detail/gl_state_cache.hpp"
+#include "../xd/graphics/detail/uniform_cache.hpp"
+#include "../xd/graphics/gl_state.hpp"
+#include "../xd/graphics/shaders.hpp"
+#include "../xd/graphics/sprite_batch.hpp"
+#include "../xd/graphics/texture.hpp"
+#include "../xd/graphics/uniform.hpp"
+#include "../xd/glm.hpp"
+#include <boost/test/unit_test.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace detail {
+    // a solid RGBA test image with a distinct color per pixel
+    struct fixture_image {
+        int width;
+        int height;
+        std::vector<std::uint8_t> pixels;
+
+        fixture_image(int width, int height, std::uint8_t seed)
+            : width(width), height(height), pixels(width * height * 4) {
+            for (int i = 0; i < width * height; ++i) {
+                pixels[i * 4] = seed;
+                pixels[i * 4 + 1] = static_cast<std::uint8_t>(i % 256);
+                pixels[i * 4 + 2] = static_cast<std::uint8_t>(i / 256);
+                pixels[i * 4 + 3] = 255;
+            }
+        }
+
+        const std::uint8_t* pixel(int x, int y) const {
+            return &pixels[(y * width + x) * 4];
+        }
+    };
+}
+
+BOOST_AUTO_TEST_SUITE(graphics_tests)
+
+BOOST_AUTO_TEST_CASE(uniform_handles_are_interned) {
+    xd::uniform<xd::mat4> mvp("mvpMatrix");
+    xd::uniform<xd::mat4> same_mvp("mvpMatrix");
+    xd::uniform<xd::vec4> color("vColor");
+    BOOST_CHECK(mvp.valid());
+    BOOST_CHECK_EQUAL(mvp.id(), same_mvp.id());
+    BOOST_CHECK_NE(mvp.id(), color.id());
+    BOOST_CHECK_EQUAL(mvp.name(), "mvpMatrix");
+    BOOST_CHECK_EQUAL(color.name(), "vColor");
+    BOOST_CHECK_EQUAL(xd::uniform<float>(color.id()).name(), "vColor");
+    BOOST_CHECK(!xd::uniform<float>().valid());
+}
+
+BOOST_AUTO_TEST_CASE(uniform_cache_skips_unchanged_values) {
+    xd::detail::uniform_cache cache;
+    cache.reset(2);
+    BOOST_CHECK(cache.update(0, xd::vec4(1.0f)));
+    BOOST_CHECK(!cache.update(0, xd::vec4(1.0f)));
+    BOOST_CHECK(cache.update(0, xd::vec4(0.5f)));
+    // a different type in the same slot is always uploaded
+    BOOST_CHECK(cache.update(1, 1));
+    BOOST_CHECK(cache.update(1, 1.0f));
+    BOOST_CHECK(!cache.update(1, 1.0f));
+    BOOST_CHECK_EQUAL(cache.issued(), 4);
+    BOOST_CHECK_EQUAL(cache.elided(), 2);
+
+    // relinking forgets the shadowed values
+    cache.reset(2);
+    BOOST_CHECK(cache.update(0, xd::vec4(0.5f)));
+    cache.reset_counters();
+    BOOST_CHECK_EQUAL(cache.issued(), 0);
+    BOOST_CHECK_EQUAL(cache.elided(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(uniform_cache_sprite_draw_calls) {
+    // no context here, glUniform calls are only counted
+    auto was_headless = xd::gl_state::is_headless();
+    xd::gl_state::set_headless(true);
+
+    {
+        auto texture = std::make_shared<xd::texture>(128, 256, nullptr, xd::vec4(1.0f, 0.0f, 1.0f, 1.0f));
+        xd::sprite_shader shader;
+        xd::sprite_batch batch;
+        batch.set_uniform("vBrightness", 0.5f);
+        const int sprite_count = 100;
+        const xd::vec4 tint(1.0f, 0.5f, 0.5f, 1.0f);
+        for (int i = 0; i < sprite_count; ++i) {
+            batch.add(texture, i * 16.0f, 0.0f, tint);
+        }
+
+        // the first sprite uploads everything, the rest only their positions
+        xd::gl_state::begin_frame();
+        batch.draw(shader, xd::mat4());
+        xd::gl_state::begin_frame();
+        const int expected_uploads = 3 + 4 + (sprite_count - 1);
+        BOOST_CHECK_EQUAL(xd::gl_state::frame_stats().uniform_uploads, expected_uploads);
+        BOOST_CHECK_EQUAL(shader.issued_uniform_updates(), expected_uploads);
+        BOOST_CHECK_EQUAL(shader.elided_uniform_updates(), (sprite_count - 1) * 3);
+
+        // redrawing the same frame only uploads the changing positions
+        batch.draw(shader, xd::mat4());
+        xd::gl_state::begin_frame();
+        BOOST_CHECK_EQUAL(xd::gl_state::frame_stats().uniform_uploads, sprite_count);
+
+        // values are cached per program
+        xd::sprite_shader other_shader;
+        batch.draw(other_shader, xd::mat4());
+        xd::gl_state::begin_frame();
+        BOOST_CHECK_EQUAL(xd::gl_state::frame_stats().uniform_uploads, expected_uploads);
+    }
+
+    // after the GL objects are gone, they would be deleted for real
+    xd::gl_state::set_headless(was_headless);
+}
+
+BOOST_AUTO_TEST_CASE(gl_state_cache_elides_redundant_changes) {
+    xd::detail::gl_state_cache cache;
+    const GLuint program = 3, texture = 7, buffer = 9;
+
+    // a frame drawing many sprites from the same sheet
+    const int sprite_count = 50;
+    cache.blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    cache.set_capability(GL_BLEND, true);
+    cache.viewport(xd::ivec4(0, 0, 320, 240));
+    for (int i = 0; i < sprite_count; ++i) {
+        cache.use_program(program);
+        cache.active_texture(GL_TEXTURE0);
+        cache.bind_texture(texture);
+        cache.bind_buffer(GL_ARRAY_BUFFER, buffer);
+    }
+    auto stats = cache.stats();
+    BOOST_CHECK_EQUAL(stats.issued, 3 + 4);
+    BOOST_CHECK_EQUAL(stats.elided, (sprite_count - 1) * 4);
+
+    cache.reset_stats();
+    BOOST_CHECK(!cache.blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA));
+    BOOST_CHECK(cache.blend_func(GL_ONE, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA));
+    BOOST_CHECK(cache.set_capability(GL_SCISSOR_TEST, true));
+    BOOST_CHECK(cache.scissor(xd::ivec4(1, 2, 3, 4)));
+    BOOST_CHECK(!cache.scissor(xd::ivec4(1, 2, 3, 4)));
+    BOOST_CHECK(cache.set_capability(GL_SCISSOR_TEST, false));
+    BOOST_CHECK(!cache.set_capability(GL_SCISSOR_TEST, false));
+    BOOST_CHECK(!cache.viewport(xd::ivec4(0, 0, 320, 240)));
+    BOOST_CHECK_EQUAL(cache.stats().issued, 4);
+    BOOST_CHECK_EQUAL(cache.stats().elided, 4);
+}
+
+BOOST_AUTO_TEST_CASE(gl_state_cache_texture_units) {
+    xd::detail::gl_state_cache cache;
+    // unknown active unit always binds
+    BOOST_CHECK(cache.bind_texture(1));
+    BOOST_CHECK(cache.bind_texture(1));
+
+    cache.active_texture(GL_TEXTURE0);
+    BOOST_CHECK(cache.bind_texture(1));
+    BOOST_CHECK(!cache.bind_texture(1));
+    cache.active_texture(GL_TEXTURE1);
+    BOOST_CHECK(cache.bind_texture(1));
+    BOOST_CHECK(cache.bind_texture(2));
+    BOOST_CHECK(!cache.active_texture(GL_TEXTURE1));
+    BOOST_CHECK(cache.active_texture(GL_TEXTURE0));
+    BOOST_CHECK(!cache.bind_texture(1));
+}
+
+BOOST_AUTO_TEST_CASE(gl_state_cache_deleted_objects) {
+    xd::detail::gl_state_cache cache;
+    cache.active_texture(GL_TEXTURE0);
+    cache.bind_texture(5);
+    cache.use_program(2);
+    cache.bind_buffer(GL_ARRAY_BUFFER, 4);
+
+    // deleting unbinds, so a reused name has to be bound again
+    cache.forget_texture(5);
+    cache.forget_program(2);
+    cache.forget_buffer(4);
+    BOOST_CHECK(cache.bind_texture(5));
+    BOOST_CHECK(cache.use_program(2));
+    BOOST_CHECK(cache.bind_buffer(GL_ARRAY_BUFFER, 4));
+    // the default objects are known to be bound after deletion
+    cache.forget_texture(5);
+    BOOST_CHECK(!cache.bind_texture(0));
+
+    cache.invalidate();
+    BOOST_CHECK(cache.use_program(2));
+    BOOST_CHECK(cache.active_texture(GL_TEXTURE0));
+}
+
+BOOST_AUTO_TEST_CASE(atlas_packer_places_without_overlap) {
+    const int page_size = 64, padding = 1;
+    xd::detail::atlas_packer packer(page_size, padding);
+    std::vector<std::pair<xd::detail::atlas_packer::placement, xd::ivec2>> placed;
+    const xd::ivec2 sizes[] = { {16, 16}, {30, 8}, {8, 30}, {20, 20}, {12, 5},
+        {40, 10}, {16, 16}, {5, 5}, {62, 62}, {24, 24} };
+    for (auto size : sizes) {
+        auto placement = packer.insert(size.x, size.y);
+        BOOST_REQUIRE(placement);
+        placed.emplace_back(*placement, size);
+    }
+    BOOST_CHECK_GT(packer.page_count(), 1);
+
+    for (std::size_t i = 0; i < placed.size(); ++i) {
+        auto& [a, a_size] = placed[i];
+        // padding stays inside the page
+        BOOST_CHECK_GE(a.x - padding, 0);
+        BOOST_CHECK_GE(a.y - padding, 0);
+        BOOST_CHECK_LE(a.x + a_size.x + padding, page_size);
+        BOOST_CHECK_LE(a.y + a_size.y + padding, page_size);
+        for (std::size_t j = i + 1; j < placed.size(); ++j) {
+            auto& [b, b_size] = placed[j];
+            if (a.page != b.page) continue;
+            // padded rectangles never overlap
+            bool separate = a.x + a_size.x + padding <= b.x - padding
+                || b.x + b_size.x + padding <= a.x - padding
+                || a.y + a_size.y + padding <= b.y - padding
+                || b.y + b_size.y + padding <= a.y - padding;
+            BOOST_CHECK(separate);
+        }
+    }
+
+    // too large once padded
+    BOOST_CHECK(!packer.insert(63, 10));
+    BOOST_CHECK(!packer.insert(0, 10));
+}
+
+BOOST_AUTO_TEST_CASE(atlas_pad_image_extrudes_edges) {
+    detail::fixture_image image(3, 2, 7);
+    const int padding = 2;
+    auto padded = xd::detail::pad_image(image.pixels.data(),
+        image.width, image.height, padding, xd::vec4(0));
+    const int padded_width = image.width + padding * 2;
+    const int padded_height = image.height + padding * 2;
+    BOOST_REQUIRE_EQUAL(padded.size(), static_cast<std::size_t>(padded_width * padded_height * 4));
+
+    auto padded_pixel = [&](int x, int y) { return &padded[(y * padded_width + x) * 4]; };
+    for (int y = 0; y < padded_height; ++y) {
+        for (int x = 0; x < padded_width; ++x) {
+            // every texel repeats the closest image texel
+            int src_x = std::min(std::max(x - padding, 0), image.width - 1);
+            int src_y = std::min(std::max(y - padding, 0), image.height - 1);
+            auto expected = image.pixel(src_x, src_y);
+            BOOST_CHECK(std::equal(expected, expected + 4, padded_pixel(x, y)));
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(atlas_pad_image_bakes_color_key) {
+    detail::fixture_image image(4, 4, 255);
+    // magenta border around an opaque center
+    for (int y = 0; y < 4; ++y) {
+        for (int x = 0; x < 4; ++x) {
+            if (x == 0 || y == 0 || x == 3 || y == 3) {
+                auto p = &image.pixels[(y * 4 + x) * 4];
+                p[0] = 255; p[1] = 0; p[2] = 255; p[3] = 255;
+            }
+        }
+    }
+
+    const xd::vec4 magenta(1.0f, 0.0f, 1.0f, 1.0f);
+    auto padded = xd::detail::pad_image(image.pixels.data(), 4, 4, 1, magenta);
+    auto alpha = [&](int x, int y) { return padded[(y * 6 + x) * 4 + 3]; };
+    // keyed texels and the padding extruded from them are transparent
+    BOOST_CHECK_EQUAL(alpha(0, 0), 0);
+    BOOST_CHECK_EQUAL(alpha(1, 1), 0);
+    BOOST_CHECK_EQUAL(alpha(5, 3), 0);
+    BOOST_CHECK_EQUAL(alpha(2, 2), 255);
+    BOOST_CHECK_EQUAL(alpha(3, 3), 255);
+
+    // without a key alpha is kept
+    auto unkeyed = xd::detail::pad_image(image.pixels.data(), 4, 4, 1, xd::vec4(0));
+    BOOST_CHECK_EQUAL(unkeyed[3], 255);
+}
+
+BOOST_AUTO_TEST_CASE(atlas_pages_hold_fixture_images) {
+    // pack fixture images into CPU pages the same way texture_atlas uploads them
+    const int page_size = 32, padding = 1;
+    xd::detail::atlas_packer packer(page_size, padding);
+    std::vector<std::vector<std::uint8_t>> pages;
+    std::vector<detail::fixture_image> images;
+    for (int i = 0; i < 6; ++i) {
+        images.emplace_back(6 + i, 9 - i, static_cast<std::uint8_t>(i * 40));
+    }
+
+    std::vector<xd::detail::atlas_packer::placement> placements;
+    for (auto& image : images) {
+        auto placement = packer.insert(image.width, image.height);
+        BOOST_REQUIRE(placement);
+        if (placement->page == static_cast<int>(pages.size())) {
+            pages.emplace_back(page_size * page_size * 4, 0);
+        }
+        auto padded = xd::detail::pad_image(image.pixels.data(),
+            image.width, image.height, padding, xd::vec4(0));
+        int padded_width = image.width + padding * 2;
+        auto& page = pages[placement->page];
+        for (int y = 0; y < image.height + padding * 2; ++y) {
+            auto src = &padded[y * padded_width * 4];
+            auto dest = &page[((placement->y - padding + y) * page_size + placement->x - padding) * 4];
+            std::copy(src, src + padded_width * 4, dest);
+        }
+        placements.push_back(*placement);
+    }
+
+    // every image reads back intact from its region, so no neighbour overwrote it
+    for (std::size_t i = 0; i < images.size(); ++i) {
+        auto& image = images[i];
+        auto& placement = placements[i];
+        auto& page = pages[placement.page];
+        for (int y = -padding; y < image.height + padding; ++y) {
+            for (int x = -padding; x < image.width + padding; ++x) {
+                int src_x = std::min(std::max(x, 0), image.width - 1);
+                int src_y = std::min(std::max(y, 0), image.height - 1);
+                auto expected = image.pixel(src_x, src_y);
+                auto actual = &page[((placement.y + y) * page_size + placement.x + x) * 4];
+                BOOST_CHECK(std::equal(expected, expected + 4, actual));
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,69 @@
+#include "../input_replay.hpp"
+#include <boost/test/unit_test.hpp>
+#include <sstream>
+#include <stdexcept>
+
+BOOST_AUTO_TEST_SUITE(input_replay_tests)
+
+BOOST_AUTO_TEST_CASE(input_replay_round_trip) {
+    std::stringstream stream;
+    Input_Recorder recorder(stream, 1234);
+
+    xd::key key{ xd::input_type::INPUT_KEYBOARD, 65, -1 };
+    xd::key button{ xd::input_type::INPUT_GAMEPAD, 3, 1 };
+    recorder.key_changed(key, true);
+    recorder.end_frame(0);
+    // Nothing happened in frame 1
+    recorder.end_frame(1);
+    recorder.key_changed(button, true);
+    recorder.axis_changed(1, 0, 0.123456789f);
+    recorder.end_frame(2);
+    // Unchanged axes aren't recorded again
+    recorder.axis_changed(1, 0, 0.123456789f);
+    recorder.key_changed(key, false);
+    recorder.key_changed(button, false);
+    recorder.end_frame(3);
+
+    Input_Replay replay(stream);
+    BOOST_CHECK(replay.get_seed() == 1234u);
+    BOOST_CHECK_EQUAL(replay.get_events().size(), 5);
+
+    auto frame = replay.frame_events(0);
+    BOOST_REQUIRE_EQUAL(frame.size(), 1);
+    BOOST_CHECK(frame[0].key == key);
+    BOOST_CHECK(frame[0].type == Input_Event_Type::PRESS);
+    BOOST_CHECK(replay.frame_events(1).empty());
+
+    frame = replay.frame_events(2);
+    BOOST_REQUIRE_EQUAL(frame.size(), 2);
+    BOOST_CHECK(frame[0].key == button);
+    BOOST_CHECK(frame[1].type == Input_Event_Type::AXIS);
+    BOOST_CHECK_EQUAL(frame[1].key.device_id, 1);
+    BOOST_CHECK_EQUAL(frame[1].key.code, 0);
+    // Axis values survive exactly, or replays would drift
+    BOOST_CHECK_EQUAL(frame[1].value, 0.123456789f);
+    BOOST_CHECK(!replay.finished());
+
+    frame = replay.frame_events(3);
+    BOOST_REQUIRE_EQUAL(frame.size(), 2);
+    BOOST_CHECK(frame[0].type == Input_Event_Type::RELEASE);
+    BOOST_CHECK(frame[1].key == button);
+    BOOST_CHECK(replay.finished());
+}
+
+BOOST_AUTO_TEST_CASE(input_replay_rejects_bad_lines) {
+    std::istringstream comments("# recorded by hand\r\n\r\n5 mouse 0 down\r\n");
+    Input_Replay replay(comments);
+    BOOST_CHECK(!replay.get_seed());
+    BOOST_REQUIRE_EQUAL(replay.get_events().size(), 1);
+    BOOST_CHECK(replay.get_events()[0].key.type == xd::input_type::INPUT_MOUSE);
+
+    std::istringstream unknown_device("0 wheel 1 down\n");
+    BOOST_CHECK_THROW(Input_Replay{ unknown_device }, std::runtime_error);
+    std::istringstream bad_action("0 key 65 held\n");
+    BOOST_CHECK_THROW(Input_Replay{ bad_action }, std::runtime_error);
+    std::istringstream out_of_order("3 key 65 down\n2 key 65 up\n");
+    BOOST_CHECK_THROW(Input_Replay{ out_of_order }, std::runtime_error);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
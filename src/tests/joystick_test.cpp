@@ -0,0 +1,174 @@
+#include "../xd/system/joystick.hpp"
+#include "../xd/system/input.hpp"
+#include <boost/test/unit_test.hpp>
+#include <array>
+#include <memory>
+#include <tuple>
+#include <vector>
+
+namespace detail {
+    struct Fake_Joystick {
+        bool present = false;
+        std::array<unsigned char, 15> buttons{};
+        std::array<float, 6> axes{};
+        mutable int reads = 0;
+    };
+
+    class Fake_Joystick_Source : public xd::joystick_source {
+    public:
+        explicit Fake_Joystick_Source(std::array<Fake_Joystick, xd::max_joysticks>& joysticks)
+            : joysticks(joysticks) {}
+        bool present(int id) const override { return joysticks[id].present; }
+        bool is_gamepad(int) const override { return true; }
+        std::string guid(int id) const override { return "guid" + std::to_string(id); }
+        std::string name(int id) const override { return "Fake " + std::to_string(id); }
+        void read(int id, bool, xd::joystick_state& state) const override {
+            auto& joystick = joysticks[id];
+            ++joystick.reads;
+            for (int button = 0; button < 15; ++button) {
+                state.buttons[button] = joystick.buttons[button];
+            }
+            for (int axis = 0; axis < 6; ++axis) {
+                state.axes[axis] = joystick.axes[axis];
+            }
+        }
+    private:
+        std::array<Fake_Joystick, xd::max_joysticks>& joysticks;
+    };
+
+    typedef std::tuple<int, int, bool> Button_Event;
+
+    struct Poller_Fixture {
+        Poller_Fixture() {
+            poller.set_source(std::make_unique<Fake_Joystick_Source>(joysticks));
+        }
+        void poll(int active_id, std::int64_t now = 0) {
+            poller.poll(active_id, now, [this](int id, int button, bool pressed) {
+                events.emplace_back(id, button, pressed);
+            });
+        }
+        std::array<Fake_Joystick, xd::max_joysticks> joysticks;
+        xd::joystick_poller poller;
+        std::vector<Button_Event> events;
+    };
+}
+
+BOOST_FIXTURE_TEST_SUITE(joystick_tests, detail::Poller_Fixture)
+
+BOOST_AUTO_TEST_CASE(joystick_events_only_on_change) {
+    joysticks[0].present = true;
+    BOOST_CHECK(poller.connect(0));
+    BOOST_CHECK(!poller.connect(1));
+    BOOST_CHECK_EQUAL(poller.guid(0), "guid0");
+
+    poll(0);
+    BOOST_CHECK(events.empty());
+
+    joysticks[0].buttons[2] = 1;
+    poll(0);
+    BOOST_REQUIRE_EQUAL(events.size(), 1);
+    BOOST_CHECK(events[0] == detail::Button_Event(0, 2, true));
+
+    // Holding the button doesn't repeat the event
+    poll(0);
+    poll(0);
+    BOOST_CHECK_EQUAL(events.size(), 1);
+    BOOST_CHECK_EQUAL(poller.state(0).buttons[2], 1);
+
+    joysticks[0].buttons[2] = 0;
+    poll(0);
+    BOOST_REQUIRE_EQUAL(events.size(), 2);
+    BOOST_CHECK(events[1] == detail::Button_Event(0, 2, false));
+}
+
+BOOST_AUTO_TEST_CASE(joystick_triggers_as_buttons) {
+    joysticks[0].present = true;
+    poller.connect(0);
+    poller.set_trigger_sensitivity(0.5f);
+
+    joysticks[0].axes[4] = 0.4f;
+    poll(0);
+    BOOST_CHECK(events.empty());
+
+    joysticks[0].axes[4] = 0.8f;
+    joysticks[0].axes[5] = 1.0f;
+    poll(0);
+    BOOST_REQUIRE_EQUAL(events.size(), 2);
+    BOOST_CHECK(events[0] == detail::Button_Event(0, xd::GAMEPAD_BUTTON_LEFT_TRIGGER_INDEX, true));
+    BOOST_CHECK(events[1] == detail::Button_Event(0, xd::GAMEPAD_BUTTON_RIGHT_TRIGGER_INDEX, true));
+    BOOST_CHECK_CLOSE(poller.state(0).axes[4], 0.8f, 0.001f);
+}
+
+BOOST_AUTO_TEST_CASE(joystick_idle_devices_polled_less) {
+    joysticks[0].present = true;
+    joysticks[1].present = true;
+    joysticks[2].present = true;
+    poller.connect(0);
+    poller.connect(1);
+    poller.connect(2);
+
+    // Past the grace period of the freshly connected joysticks
+    const std::int64_t later = xd::joystick_poller::recent_use_duration + 1;
+    const int polls = xd::joystick_poller::idle_poll_interval * 4;
+    for (int i = 0; i < polls; ++i) {
+        poll(0, later);
+    }
+
+    BOOST_CHECK_EQUAL(joysticks[0].reads, polls);
+    // The two idle joysticks share one read every idle_poll_interval polls
+    BOOST_CHECK_EQUAL(joysticks[1].reads, 2);
+    BOOST_CHECK_EQUAL(joysticks[2].reads, 2);
+    BOOST_CHECK_EQUAL(poller.read_count(1), 2u);
+
+    // Pressing a button on an idle joystick makes it recently used
+    joysticks[1].buttons[0] = 1;
+    for (int i = 0; i < xd::joystick_poller::idle_poll_interval; ++i) {
+        poll(0, later);
+    }
+    BOOST_REQUIRE_EQUAL(events.size(), 1);
+    BOOST_CHECK(events[0] == detail::Button_Event(1, 0, true));
+    auto reads = joysticks[1].reads;
+    poll(0, later + 1);
+    poll(0, later + 2);
+    BOOST_CHECK_EQUAL(joysticks[1].reads, reads + 2);
+}
+
+BOOST_AUTO_TEST_CASE(joystick_hot_plug) {
+    poll(-1);
+    BOOST_CHECK(!poller.connected(3));
+
+    joysticks[3].present = true;
+    BOOST_CHECK(poller.connect(3));
+    BOOST_CHECK(poller.connected(3));
+    BOOST_CHECK_EQUAL(poller.name(3), "Fake 3");
+
+    // A freshly connected joystick is read right away
+    joysticks[3].buttons[1] = 1;
+    poll(-1);
+    BOOST_REQUIRE_EQUAL(events.size(), 1);
+    BOOST_CHECK(events[0] == detail::Button_Event(3, 1, true));
+
+    joysticks[3].present = false;
+    poller.disconnect(3);
+    BOOST_CHECK(!poller.connected(3));
+    BOOST_CHECK(poller.guid(3).empty());
+    auto reads = joysticks[3].reads;
+    poll(3);
+    BOOST_CHECK_EQUAL(joysticks[3].reads, reads);
+
+    // Reconnecting starts from a blank state
+    joysticks[3].present = true;
+    poller.connect(3);
+    BOOST_CHECK_EQUAL(poller.state(3).buttons[1], 0);
+    BOOST_CHECK_EQUAL(poller.read_count(3), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(joystick_virtual_not_read) {
+    poller.connect_virtual(5);
+    BOOST_CHECK(poller.connected(5));
+    BOOST_CHECK(poller.is_gamepad(5));
+    poll(5);
+    BOOST_CHECK_EQUAL(joysticks[5].reads, 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,124 @@
+#include "game_fixture.hpp"
+#include "../key_binder.hpp"
+#include <boost/test/unit_test.hpp>
+#include <chrono>
+#include <sstream>
+#include <string>
+
+BOOST_FIXTURE_TEST_SUITE(key_binder_tests, Game_Fixture)
+
+BOOST_AUTO_TEST_CASE(key_binder_action_ids_are_stable) {
+    auto up = game->action_id("up");
+    BOOST_CHECK_EQUAL(game->action_id("up"), up);
+    BOOST_CHECK_NE(game->action_id("down"), up);
+
+    // Names get an ID before anything is bound to them
+    auto unbound = game->action_id("key-binder-test-unbound");
+    BOOST_CHECK_GE(unbound, 0);
+    BOOST_CHECK(!game->pressed(unbound));
+    BOOST_CHECK(!game->triggered(unbound));
+    BOOST_CHECK(!game->pressed(-1));
+    BOOST_CHECK(!game->pressed(unbound + 1000));
+}
+
+BOOST_AUTO_TEST_CASE(key_binder_rebinding_updates_action_state) {
+    const std::string name = "key-binder-test-dash";
+    auto dash = game->action_id(name);
+    Key_Binder binder(*game);
+
+    std::istringstream keymap(name + " = F9\n");
+    binder.process_keymap_file(keymap);
+    game->inject_input(xd::KEY_F9, true);
+    BOOST_CHECK(game->pressed(dash));
+    BOOST_CHECK(game->pressed(name));
+    BOOST_CHECK(game->triggered(dash));
+    game->inject_input(xd::KEY_F9, false);
+    BOOST_CHECK(!game->pressed(dash));
+
+    // Rebinding keeps the ID and moves the state to the new key
+    std::istringstream rebind(name + " = F10\n");
+    binder.process_keymap_file(rebind);
+    BOOST_CHECK_EQUAL(game->action_id(name), dash);
+    game->inject_input(xd::KEY_F9, true);
+    BOOST_CHECK(!game->pressed(dash));
+    game->inject_input(xd::KEY_F10, true);
+    BOOST_CHECK(game->pressed(dash));
+    BOOST_CHECK(game->pressed(name));
+
+    // Unbinding the physical key clears the state right away
+    binder.unbind_key("F10");
+    BOOST_CHECK(!game->pressed(dash));
+
+    game->inject_input(xd::KEY_F9, false);
+    game->inject_input(xd::KEY_F10, false);
+}
+
+BOOST_AUTO_TEST_CASE(key_binder_triggered_once_consumes_each_key) {
+    const std::string name = "key-binder-test-jump";
+    auto jump = game->action_id(name);
+    Key_Binder binder(*game);
+    binder.bind_key("F9", name);
+    binder.bind_key("F11", name);
+
+    game->inject_input(xd::KEY_F9, true);
+    game->inject_input(xd::KEY_F11, true);
+    BOOST_CHECK(game->triggered_once(jump));
+    BOOST_CHECK(game->triggered(jump));
+    BOOST_CHECK(game->triggered_once(name));
+    BOOST_CHECK(!game->triggered(jump));
+    BOOST_CHECK(!game->triggered_once(jump));
+    // Consuming the trigger doesn't release the keys
+    BOOST_CHECK(game->pressed(jump));
+
+    game->inject_input(xd::KEY_F9, false);
+    game->inject_input(xd::KEY_F11, false);
+    game->unbind_virtual_key(name);
+}
+
+BOOST_AUTO_TEST_CASE(key_binder_action_id_benchmark) {
+    const int iterations = 1000000;
+    auto up = game->action_id("up");
+    auto& binder = game->get_key_binder();
+
+    // What checking a virtual name used to cost: every bound physical key
+    std::vector<xd::key> keys;
+    for (auto& name : binder.get_bound_keys("up")) {
+        for (auto& key : binder.get_keys(name)) {
+            keys.push_back(key);
+        }
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    int key_count = 0;
+    for (int i = 0; i < iterations; ++i) {
+        for (auto& key : keys) {
+            if (game->pressed(key)) {
+                ++key_count;
+                break;
+            }
+        }
+    }
+    std::chrono::duration<double, std::nano> key_time = std::chrono::steady_clock::now() - start;
+
+    start = std::chrono::steady_clock::now();
+    int name_count = 0;
+    for (int i = 0; i < iterations; ++i) {
+        name_count += game->pressed("up");
+    }
+    std::chrono::duration<double, std::nano> name_time = std::chrono::steady_clock::now() - start;
+
+    start = std::chrono::steady_clock::now();
+    int id_count = 0;
+    for (int i = 0; i < iterations; ++i) {
+        id_count += game->pressed(up);
+    }
+    std::chrono::duration<double, std::nano> id_time = std::chrono::steady_clock::now() - start;
+
+    BOOST_TEST_MESSAGE("Pressed by physical keys: " << key_time.count() / iterations
+        << " ns per call, by name: " << name_time.count() / iterations
+        << " ns per call, by ID: " << id_time.count() / iterations << " ns per call");
+    BOOST_CHECK_EQUAL(key_count, id_count);
+    BOOST_CHECK_EQUAL(name_count, id_count);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
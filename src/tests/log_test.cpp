@@ -0,0 +1,304 @@
+#include "../filesystem/writable_filesystem.hpp"
+#include "../log_rotation.hpp"
+#include "../log_writer.hpp"
+#include "../utility/file.hpp"
+#include <boost/test/unit_test.hpp>
+#include <chrono>
+#include <filesystem>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <zlib.h>
+
+namespace detail {
+    static Log_Record make_record(const std::string& message) {
+        return Log_Record{ Log_Level::info, std::chrono::system_clock::now(), message };
+    }
+
+    static std::vector<std::string> messages(const std::string& output) {
+        std::vector<std::string> result;
+        std::istringstream stream(output);
+        std::string line;
+        while (std::getline(stream, line)) {
+            auto start = line.find("INFO: ");
+            if (start != std::string::npos) {
+                result.push_back(line.substr(start + 6));
+            }
+        }
+        return result;
+    }
+
+    // An empty directory for rotation tests, deleted afterwards
+    struct Temp_Folder {
+        std::string path;
+        explicit Temp_Folder(const std::string& name) {
+            auto folder = std::filesystem::temp_directory_path() / ("octopus_" + name);
+            std::filesystem::remove_all(folder);
+            std::filesystem::create_directories(folder);
+            path = folder.generic_u8string() + "/";
+        }
+        ~Temp_Folder() {
+            std::error_code error;
+            std::filesystem::remove_all(std::filesystem::u8path(path), error);
+        }
+    };
+
+    static void write_file(Writable_Filesystem& fs, const std::string& filename, const std::string& content) {
+        auto stream = fs.open_ofstream(filename, std::ios_base::out | std::ios_base::trunc);
+        BOOST_REQUIRE(stream && *stream);
+        *stream << content;
+    }
+
+    static std::string gunzip(const std::string& compressed) {
+        z_stream stream{};
+        BOOST_REQUIRE_EQUAL(inflateInit2(&stream, 16 + MAX_WBITS), Z_OK);
+        std::string result;
+        char chunk[4096];
+        stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(compressed.data()));
+        stream.avail_in = static_cast<uInt>(compressed.size());
+        int status = Z_OK;
+        while (status == Z_OK) {
+            stream.next_out = reinterpret_cast<Bytef*>(chunk);
+            stream.avail_out = sizeof(chunk);
+            status = inflate(&stream, Z_NO_FLUSH);
+            result.append(chunk, sizeof(chunk) - stream.avail_out);
+        }
+        inflateEnd(&stream);
+        BOOST_REQUIRE_EQUAL(status, Z_STREAM_END);
+        return result;
+    }
+}
+
+BOOST_AUTO_TEST_SUITE(log_tests)
+
+BOOST_AUTO_TEST_CASE(log_writer_keeps_order) {
+    std::ostringstream output;
+    Log_Writer writer(output, 64);
+    const int count = 10000;
+    for (int i = 0; i < count; ++i) {
+        writer.push(detail::make_record(std::to_string(i)));
+    }
+    writer.flush();
+
+    auto lines = detail::messages(output.str());
+    BOOST_REQUIRE_EQUAL(lines.size(), static_cast<std::size_t>(count));
+    for (int i = 0; i < count; ++i) {
+        BOOST_CHECK_EQUAL(lines[i], std::to_string(i));
+    }
+    BOOST_CHECK_EQUAL(output.str().substr(0, 2), "- ");
+}
+
+BOOST_AUTO_TEST_CASE(log_writer_loses_nothing_under_load) {
+    std::ostringstream output;
+    Log_Writer writer(output, 128, Log_Overflow_Policy::block);
+    const int thread_count = 8;
+    const int per_thread = 20000;
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < thread_count; ++t) {
+        threads.emplace_back([&writer, t] {
+            for (int i = 0; i < per_thread; ++i) {
+                writer.push(detail::make_record(std::to_string(t) + " " + std::to_string(i)));
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    writer.flush();
+
+    auto lines = detail::messages(output.str());
+    BOOST_REQUIRE_EQUAL(lines.size(), static_cast<std::size_t>(thread_count * per_thread));
+
+    // Messages from the same thread stay in order
+    std::vector<int> next(thread_count, 0);
+    for (auto& line : lines) {
+        std::istringstream stream(line);
+        int t, i;
+        stream >> t >> i;
+        BOOST_REQUIRE(t >= 0 && t < thread_count);
+        BOOST_REQUIRE_EQUAL(i, next[t]);
+        ++next[t];
+    }
+}
+
+BOOST_AUTO_TEST_CASE(log_writer_drop_policy_reports_drops) {
+    std::ostringstream output;
+    Log_Writer writer(output, 4, Log_Overflow_Policy::drop);
+    const int count = 50000;
+    int accepted = 0;
+    for (int i = 0; i < count; ++i) {
+        if (writer.push(detail::make_record(std::to_string(i)))) {
+            ++accepted;
+        }
+    }
+    writer.stop();
+
+    auto lines = detail::messages(output.str());
+    BOOST_CHECK_EQUAL(lines.size(), static_cast<std::size_t>(accepted));
+
+    // Every dropped message is accounted for in the warnings
+    std::size_t reported = 0;
+    std::istringstream stream(output.str());
+    std::string line;
+    const std::string marker = "dropped ";
+    while (std::getline(stream, line)) {
+        auto start = line.find(marker);
+        if (start != std::string::npos) {
+            reported += std::stoul(line.substr(start + marker.size()));
+        }
+    }
+    BOOST_CHECK_EQUAL(reported + accepted, static_cast<std::size_t>(count));
+}
+
+BOOST_AUTO_TEST_CASE(log_writer_flushes_on_shutdown) {
+    std::ostringstream output;
+    {
+        Log_Writer writer(output, 1024);
+        for (int i = 0; i < 500; ++i) {
+            writer.push(detail::make_record(std::to_string(i)));
+        }
+        // No explicit flush, destroying the writer must write everything
+    }
+    BOOST_CHECK_EQUAL(detail::messages(output.str()).size(), 500u);
+
+    std::ostringstream late_output;
+    Log_Writer writer(late_output);
+    writer.push(detail::make_record("before"));
+    writer.stop();
+    BOOST_CHECK(writer.stopped());
+    writer.push(detail::make_record("after"));
+    auto lines = detail::messages(late_output.str());
+    BOOST_REQUIRE_EQUAL(lines.size(), 2u);
+    BOOST_CHECK_EQUAL(lines[0], "before");
+    BOOST_CHECK_EQUAL(lines[1], "after");
+}
+
+BOOST_AUTO_TEST_CASE(log_writer_drain_without_locks) {
+    std::ostringstream output;
+    Log_Writer writer(output);
+    for (int i = 0; i < 100; ++i) {
+        writer.push(detail::make_record(std::to_string(i)));
+    }
+    BOOST_CHECK(writer.drain(std::chrono::seconds(5)));
+    BOOST_CHECK_EQUAL(detail::messages(output.str()).size(), 100u);
+}
+
+BOOST_AUTO_TEST_CASE(log_rotation_keeps_file_count) {
+    detail::Temp_Folder folder("log_rotation_count");
+    auto fs = file_utilities::disk_filesystem();
+    auto filename = folder.path + "game.log";
+    Log_Rotation rotation;
+    rotation.file_count = 3;
+    rotation.max_size = 1;
+
+    detail::write_file(*fs, filename, "1");
+    BOOST_CHECK(!rotation.needed(filename, *fs));
+    detail::write_file(*fs, filename, "12");
+    BOOST_CHECK(rotation.needed(filename, *fs));
+
+    for (int i = 1; i <= 5; ++i) {
+        detail::write_file(*fs, filename, std::to_string(i));
+        BOOST_CHECK(rotation.rotate(filename, *fs));
+        BOOST_CHECK(!fs->exists(filename));
+    }
+
+    BOOST_CHECK_EQUAL(rotation.rotated_filename(filename, *fs, 2, false), folder.path + "game_2.log");
+    BOOST_CHECK_EQUAL(fs->read_file(folder.path + "game_2.log"), "5");
+    BOOST_CHECK_EQUAL(fs->read_file(folder.path + "game_3.log"), "4");
+    BOOST_CHECK(!fs->exists(folder.path + "game_4.log"));
+    BOOST_CHECK_EQUAL(fs->directory_content_names(folder.path).size(), 2u);
+
+    // Lowering the file count cleans up the extra files
+    rotation.file_count = 2;
+    detail::write_file(*fs, filename, "6");
+    BOOST_CHECK(rotation.rotate(filename, *fs));
+    BOOST_CHECK_EQUAL(fs->read_file(folder.path + "game_2.log"), "6");
+    BOOST_CHECK(!fs->exists(folder.path + "game_3.log"));
+}
+
+BOOST_AUTO_TEST_CASE(log_rotation_compresses_rotated_files) {
+    detail::Temp_Folder folder("log_rotation_compress");
+    auto fs = file_utilities::disk_filesystem();
+    auto filename = folder.path + "game.log";
+    Log_Rotation rotation;
+    rotation.file_count = 4;
+    rotation.max_size = 1;
+    rotation.compress = true;
+
+    std::string content;
+    for (int i = 0; i < 1000; ++i) {
+        content += "- 2024-01-01 00:00:00 DEBUG: message " + std::to_string(i) + "\n";
+    }
+    detail::write_file(*fs, filename, content);
+    BOOST_CHECK(rotation.rotate(filename, *fs));
+    // Rotating only renames, the writer thread doesn't wait for compression
+    BOOST_CHECK(fs->exists(folder.path + "game_2.log"));
+    BOOST_CHECK(!fs->exists(folder.path + "game_2.log.gz"));
+    rotation.compress_rotated(filename, *fs);
+    detail::write_file(*fs, filename, "second");
+    BOOST_CHECK(rotation.rotate(filename, *fs));
+    // Files left uncompressed (e.g. the game closed first) are picked up later
+    BOOST_CHECK(fs->exists(folder.path + "game_2.log"));
+    rotation.compress_rotated(filename, *fs);
+
+    BOOST_CHECK(!fs->exists(folder.path + "game_2.log"));
+    BOOST_REQUIRE(fs->exists(folder.path + "game_3.log.gz"));
+    auto compressed = fs->read_file(folder.path + "game_3.log.gz");
+    BOOST_CHECK_LT(compressed.size(), content.size());
+    BOOST_CHECK(detail::gunzip(compressed) == content);
+    BOOST_CHECK_EQUAL(detail::gunzip(fs->read_file(folder.path + "game_2.log.gz")), "second");
+}
+
+BOOST_AUTO_TEST_CASE(log_writer_rotates_without_losing_messages) {
+    detail::Temp_Folder folder("log_rotation_writer");
+    auto fs = file_utilities::disk_filesystem();
+    auto filename = folder.path + "game.log";
+    Log_Rotation rotation;
+    rotation.file_count = 1000;
+    rotation.max_size = 4 * 1024;
+
+    auto file = fs->open_ofstream(filename, std::ios_base::out | std::ios_base::trunc);
+    Log_Writer::Rotation writer_rotation;
+    writer_rotation.max_size = rotation.max_size;
+    int rotations = 0;
+    writer_rotation.rotate = [&]() -> std::ostream* {
+        file.reset();
+        rotation.rotate(filename, *fs);
+        file = fs->open_ofstream(filename, std::ios_base::out | std::ios_base::trunc);
+        ++rotations;
+        return file.get();
+    };
+
+    const int count = 5000;
+    {
+        Log_Writer writer(*file, 256, Log_Overflow_Policy::block, std::move(writer_rotation));
+        for (int i = 0; i < count; ++i) {
+            writer.push(detail::make_record(std::to_string(i)));
+        }
+    }
+    file.reset();
+    BOOST_CHECK_GT(rotations, 1);
+
+    // Read the files from oldest to newest
+    std::vector<std::string> lines;
+    for (int slot = rotations + 1; slot >= 2; --slot) {
+        auto rotated = rotation.rotated_filename(filename, *fs, slot, false);
+        BOOST_REQUIRE(fs->exists(rotated));
+        auto content = fs->read_file(rotated);
+        BOOST_CHECK_LE(content.size(), rotation.max_size + 64 * 1024);
+        auto file_lines = detail::messages(content);
+        lines.insert(lines.end(), file_lines.begin(), file_lines.end());
+    }
+    auto current = detail::messages(fs->read_file(filename));
+    lines.insert(lines.end(), current.begin(), current.end());
+
+    BOOST_REQUIRE_EQUAL(lines.size(), static_cast<std::size_t>(count));
+    for (int i = 0; i < count; ++i) {
+        BOOST_CHECK_EQUAL(lines[i], std::to_string(i));
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,101 @@
+#include "../xd/lua/chunk_cache.hpp"
+#include "../xd/lua/exceptions.hpp"
+#include "../xd/lua/virtual_machine.hpp"
+#include "../xd/vendor/sol/sol.hpp"
+#include <boost/test/unit_test.hpp>
+#include <string>
+
+namespace detail {
+    // Load the code with luaL_loadbuffer or the cache and run it,
+    // returning the result or the error message
+    static std::string run_chunk(lua_State* state, xd::lua::chunk_cache* cache,
+            const std::string& code, const std::string& chunk_name) {
+        auto status = cache
+            ? cache->load(state, code, chunk_name)
+            : luaL_loadbuffer(state, code.data(), code.size(), chunk_name.c_str());
+        if (status != LUA_OK) {
+            return "load error: " + sol::stack::pop<std::string>(state);
+        }
+        auto function = sol::stack::pop<sol::protected_function>(state);
+        sol::protected_function_result result = function();
+        if (!result.valid()) {
+            sol::error err = result;
+            return std::string{"runtime error: "} + err.what();
+        }
+        return result.get<std::string>();
+    }
+}
+
+BOOST_AUTO_TEST_SUITE(lua_chunk_cache_tests)
+
+BOOST_AUTO_TEST_CASE(chunk_cache_reuses_bytecode) {
+    xd::lua::virtual_machine vm;
+    xd::lua::chunk_cache cache;
+    auto state = vm.lua_state().lua_state();
+
+    std::string code = "return tostring(1 + 2)";
+    BOOST_CHECK_EQUAL(detail::run_chunk(state, &cache, code, "@a.lua"), "3");
+    BOOST_CHECK_EQUAL(detail::run_chunk(state, &cache, code, "@a.lua"), "3");
+    BOOST_CHECK_EQUAL(cache.misses(), 1);
+    BOOST_CHECK_EQUAL(cache.hits(), 1);
+
+    // Unnamed chunks are cached by content
+    BOOST_CHECK_EQUAL(detail::run_chunk(state, &cache, code, ""), "3");
+    BOOST_CHECK_EQUAL(detail::run_chunk(state, &cache, code, ""), "3");
+    BOOST_CHECK_EQUAL(cache.misses(), 2);
+    BOOST_CHECK_EQUAL(cache.hits(), 2);
+    BOOST_CHECK_EQUAL(cache.size(), 2u);
+}
+
+BOOST_AUTO_TEST_CASE(chunk_cache_invalidates_changed_source) {
+    xd::lua::virtual_machine vm;
+    xd::lua::chunk_cache cache;
+    auto state = vm.lua_state().lua_state();
+
+    BOOST_CHECK_EQUAL(detail::run_chunk(state, &cache, "return 'old'", "@scripts/b.lua"), "old");
+    BOOST_CHECK_EQUAL(detail::run_chunk(state, &cache, "return 'new'", "@scripts\\b.lua"), "new");
+    BOOST_CHECK_EQUAL(detail::run_chunk(state, &cache, "return 'new'", "@scripts/b.lua"), "new");
+    BOOST_CHECK_EQUAL(cache.misses(), 2);
+    BOOST_CHECK_EQUAL(cache.hits(), 1);
+    BOOST_CHECK_EQUAL(cache.size(), 1u);
+}
+
+BOOST_AUTO_TEST_CASE(chunk_cache_matches_source_loading) {
+    xd::lua::virtual_machine vm;
+    xd::lua::chunk_cache cache;
+    auto state = vm.lua_state().lua_state();
+
+    const char* scripts[] = {
+        "local t = {}\nfor i = 1, 5 do t[#t + 1] = i * i end\nreturn table.concat(t, ',')",
+        "local x = 1\nerror('boom')",
+        "return (",
+    };
+    for (std::string code : scripts) {
+        auto expected = detail::run_chunk(state, nullptr, code, "@c.lua");
+        // Compare both the first (compiling) and second (cached) loads
+        BOOST_CHECK_EQUAL(detail::run_chunk(state, &cache, code, "@c.lua"), expected);
+        BOOST_CHECK_EQUAL(detail::run_chunk(state, &cache, code, "@c.lua"), expected);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(chunk_cache_uses_precompiled_bytecode) {
+    xd::lua::virtual_machine vm;
+    xd::lua::chunk_cache cache;
+    auto state = vm.lua_state().lua_state();
+
+    std::string code = "return 'precompiled'";
+    cache.add("@d.lua", xd::lua::chunk_cache::hash(code.data(), code.size()),
+        xd::lua::chunk_cache::compile(code.data(), code.size(), "@d.lua"));
+    BOOST_CHECK_EQUAL(detail::run_chunk(state, &cache, code, "@d.lua"), "precompiled");
+    BOOST_CHECK_EQUAL(cache.hits(), 1);
+    BOOST_CHECK_EQUAL(cache.misses(), 0);
+
+    // Bytecode that doesn't load falls back to the source
+    cache.add("@e.lua", xd::lua::chunk_cache::hash(code.data(), code.size()), "not bytecode");
+    BOOST_CHECK_EQUAL(detail::run_chunk(state, &cache, code, "@e.lua"), "precompiled");
+    BOOST_CHECK_EQUAL(cache.misses(), 1);
+
+    BOOST_CHECK_THROW(xd::lua::chunk_cache::compile("return (", 8, "@f.lua"), xd::lua::script_load_failed);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,108 @@
+#include "../xd/lua/virtual_machine.hpp"
+#include <boost/test/unit_test.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+
+namespace detail {
+    struct Frame_Stats {
+        std::size_t peak_memory = 0;
+        int overruns = 0;
+        double max_gc_time = 0.0;
+        // Steps that freed memory
+        int collections = 0;
+    };
+
+    // Run a script that creates lots of short lived tables and strings every
+    // frame, stepping the collector after each one like the game loop does
+    // (unless the budget is 0)
+    static Frame_Stats run_frames(xd::lua::virtual_machine& vm, int frames, double budget) {
+        sol::protected_function frame = vm.lua_state().script(R"(
+            keep = {}
+            return function()
+                for i = 1, 2000 do
+                    keep[i % 500 + 1] = { i, tostring(i) .. "garbage" }
+                end
+            end
+        )");
+        Frame_Stats stats;
+        for (int i = 0; i < frames; ++i) {
+            auto result = frame();
+            BOOST_REQUIRE(result.valid());
+            stats.peak_memory = std::max(stats.peak_memory, vm.memory_usage());
+            if (budget <= 0.0) continue;
+
+            auto before = vm.memory_usage();
+            auto start = std::chrono::steady_clock::now();
+            vm.step_gc(budget);
+            std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+            if (vm.memory_usage() < before) {
+                ++stats.collections;
+            }
+            stats.max_gc_time = std::max(stats.max_gc_time, elapsed.count());
+            // A little slack for the step that crosses the deadline
+            if (elapsed.count() > budget + 0.5) {
+                ++stats.overruns;
+            }
+        }
+        return stats;
+    }
+
+    const std::size_t memory_bound = 8 * 1024 * 1024;
+}
+
+BOOST_AUTO_TEST_SUITE(lua_gc_tests)
+
+BOOST_AUTO_TEST_CASE(lua_gc_unpaced_memory_grows) {
+    // What happens if nothing collects: the reference for the bounds below
+    xd::lua::virtual_machine vm;
+    vm.set_gc_paced(true);
+    auto stats = detail::run_frames(vm, 100, 0.0);
+    BOOST_CHECK_GT(stats.peak_memory, detail::memory_bound);
+}
+
+BOOST_AUTO_TEST_CASE(lua_gc_incremental_stays_bounded) {
+    xd::lua::virtual_machine vm;
+    BOOST_CHECK(vm.set_gc_mode(xd::lua::gc_mode::incremental));
+    vm.set_gc_paced(true);
+    const int frames = 600;
+    auto stats = detail::run_frames(vm, frames, 1.0);
+    BOOST_TEST_MESSAGE("Incremental: peak " << stats.peak_memory << " bytes, slowest step "
+        << stats.max_gc_time << " ms, " << stats.overruns << " overruns");
+    BOOST_CHECK_LT(stats.peak_memory, detail::memory_bound);
+    BOOST_CHECK_LE(stats.overruns, frames / 20);
+}
+
+BOOST_AUTO_TEST_CASE(lua_gc_generational_stays_bounded) {
+    xd::lua::virtual_machine vm;
+#ifdef LUA_GCGEN
+    BOOST_REQUIRE(vm.set_gc_mode(xd::lua::gc_mode::generational));
+#else
+    // Lua 5.3 has no generational mode
+    BOOST_CHECK(!vm.set_gc_mode(xd::lua::gc_mode::generational));
+    return;
+#endif
+    BOOST_CHECK(vm.get_gc_mode() == xd::lua::gc_mode::generational);
+    vm.set_gc_paced(true);
+    const int frames = 600;
+    auto stats = detail::run_frames(vm, frames, 1.0);
+    // Generational collections can't be split up, so only the memory is bounded
+    BOOST_TEST_MESSAGE("Generational: peak " << stats.peak_memory << " bytes, slowest step "
+        << stats.max_gc_time << " ms, " << stats.collections << " collections");
+    BOOST_CHECK_LT(stats.peak_memory, detail::memory_bound);
+    // Collections wait for garbage to pile up instead of running every frame
+    BOOST_CHECK_GT(stats.collections, 0);
+    BOOST_CHECK_LT(stats.collections, frames);
+}
+
+BOOST_AUTO_TEST_CASE(lua_gc_full_collection) {
+    xd::lua::virtual_machine vm;
+    vm.set_gc_paced(true);
+    vm.lua_state().script("local t = {} for i = 1, 100000 do t[i] = { i } end");
+    auto before = vm.memory_usage();
+    vm.full_gc();
+    BOOST_CHECK_LT(vm.memory_usage() * 4, before);
+    BOOST_CHECK(vm.is_gc_paced());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
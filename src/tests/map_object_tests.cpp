@@ -3,8 +3,11 @@
 #include "../utility/direction.hpp"
 #include "../utility/color.hpp"
 #include "../xd/asset_manager.hpp"
+#include "../xd/system/fixed_step_timer.hpp"
 #include "../vendor/rapidxml.hpp"
 #include <boost/test/unit_test.hpp>
+#include <cstdint>
+#include <optional>
 
 BOOST_FIXTURE_TEST_SUITE(map_tests, Game_Fixture)
 
@@ -105,4 +108,43 @@ BOOST_AUTO_TEST_CASE(map_object_load) {
     BOOST_CHECK_EQUAL(object->is_sound_attenuation_enabled(), true);
 }
 
+BOOST_AUTO_TEST_CASE(map_object_interpolated_position) {
+    xd::asset_manager manager;
+    Map_Object object(*game, manager, "mover", "", xd::vec2(10.0f, 20.0f));
+
+    // Logic moves 2 pixels per step at 60 steps per second, rendering runs at 144 FPS
+    xd::fixed_step_timer timer(60, 0);
+    const std::int64_t frame_time = xd::fixed_step_timer::nanoseconds_per_second / 144;
+    const float expected_step = 2.0f * 60.0f / 144.0f;
+    int total_steps = 0;
+    std::optional<float> last_x;
+    for (int frame = 0; frame < 144; ++frame) {
+        auto steps = timer.advance(frame_time);
+        for (int i = 0; i < steps; ++i) {
+            object.store_previous_position();
+            object.move(Direction::RIGHT, 2.0f, Collision_Check_Type::NONE);
+        }
+        total_steps += steps;
+        if (total_steps == 0) continue;
+
+        auto alpha = static_cast<float>(timer.alpha());
+        auto rendered = object.get_interpolated_position(alpha);
+        // Rendering trails the logic by one step
+        BOOST_CHECK_CLOSE(rendered.x, 10.0f + 2.0f * (total_steps - 1 + alpha), 0.01f);
+        BOOST_CHECK_EQUAL(rendered.y, 20.0f);
+        // The object moves the same distance every frame instead of jumping between steps
+        if (last_x) {
+            BOOST_CHECK_CLOSE(rendered.x - *last_x, expected_step, 0.1f);
+        }
+        last_x = rendered.x;
+    }
+    BOOST_CHECK_EQUAL(total_steps, 59);
+    BOOST_CHECK_CLOSE(object.get_x(), 10.0f + 2.0f * 59, 0.001f);
+
+    // Teleporting isn't interpolated
+    object.set_position(xd::vec2(200.0f, 300.0f));
+    BOOST_CHECK(object.get_interpolated_position(0.0f) == xd::vec2(200.0f, 300.0f));
+    BOOST_CHECK(object.get_interpolated_position(0.5f) == xd::vec2(200.0f, 300.0f));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,176 @@
+#include "game_fixture.hpp"
+#include "../map/map.hpp"
+#include "../map/map_object.hpp"
+#include "../xd/lua/virtual_machine.hpp"
+#include "../xd/vendor/sol/sol.hpp"
+#include <boost/test/unit_test.hpp>
+#include <cmath>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace detail {
+    // Add objects with varying positions, types and properties
+    static void populate_map(Map& map, int count) {
+        const char* types[] = { "npc", "enemy", "item" };
+        for (int i = 0; i < count; ++i) {
+            xd::vec2 position{ static_cast<float>(i * 7919 % 400), static_cast<float>(i * 104729 % 320) };
+            auto object = map.add_new_object("query" + std::to_string(i), std::nullopt, position);
+            object->set_type(types[i % 3]);
+            if (i % 4 == 0) {
+                object->set_property("hostile", i % 8 == 0 ? "yes" : "no");
+            }
+        }
+    }
+
+    // Reference line of sight: sample the segment densely and check the tiles in between
+    static bool sampled_line_of_sight(const Map& map, xd::vec2 from, xd::vec2 to) {
+        auto tile_of = [&map](xd::vec2 point) {
+            return std::make_pair(static_cast<int>(std::floor(point.x / map.get_tile_width())),
+                static_cast<int>(std::floor(point.y / map.get_tile_height())));
+        };
+        auto start = tile_of(from);
+        auto end = tile_of(to);
+        const int samples = 20000;
+        for (int i = 0; i <= samples; ++i) {
+            auto tile = tile_of(from + (to - from) * (static_cast<float>(i) / samples));
+            if (tile == start || tile == end) continue;
+            if (!map.tile_passable(tile.first, tile.second)) return false;
+        }
+        return true;
+    }
+}
+
+BOOST_FIXTURE_TEST_SUITE(map_query_tests, Game_Fixture)
+
+BOOST_AUTO_TEST_CASE(map_query_matches_lua_filtering) {
+    auto map = Map::load(*game, "test_tiled.tmx");
+    detail::populate_map(*map, 300);
+    auto& lua = game->get_lua_vm()->lua_state();
+    lua["query_map"] = map.get();
+
+    // Compares the native queries with filtering map.objects in Lua, returns
+    // the number of mismatches and the total number of matched objects
+    sol::protected_function compare = lua.script(R"(
+        local function ids(objects)
+            local result = {}
+            for _, object in ipairs(objects) do result[#result + 1] = object.id end
+            return result
+        end
+        local function brute_force(filter, inside)
+            local result = {}
+            for id, object in pairs(query_map.objects) do
+                local matches = (not filter.type or object.type == filter.type)
+                    and (not filter.layer or (object.layer and object.layer.name == filter.layer))
+                    and (not filter.property or object:get_property(filter.property) ~= "")
+                    and (not filter.value or object:get_property(filter.property) == filter.value)
+                if matches and inside(object.centered_position) then
+                    result[#result + 1] = id
+                end
+            end
+            table.sort(result)
+            return result
+        end
+        local function same(a, b)
+            if #a ~= #b then return false end
+            for i = 1, #a do
+                if a[i] ~= b[i] then return false end
+            end
+            return true
+        end
+
+        local filters = {
+            {}, { type = "npc" }, { type = "enemy", property = "hostile" },
+            { property = "hostile", value = "yes" }, { layer = "objects" }, { layer = "missing" }
+        }
+        local reused = {}
+        local mismatches, total = 0, 0
+        for i = 0, 19 do
+            local x, y, r = (i * 37) % 400, (i * 53) % 320, 20 + (i * 11) % 120
+            for _, filter in ipairs(filters) do
+                local expected = brute_force(filter, function(p)
+                    return (p.x - x) ^ 2 + (p.y - y) ^ 2 <= r * r
+                end)
+                if not same(ids(query_map:objects_in_radius(x, y, r, filter)), expected) then
+                    mismatches = mismatches + 1
+                end
+                -- filling a table with leftover entries
+                reused = query_map:objects_in_radius(x, y, r, filter, reused)
+                if not same(ids(reused), expected) then mismatches = mismatches + 1 end
+                total = total + #expected
+
+                local w, h = r * 2, r
+                expected = brute_force(filter, function(p)
+                    return p.x >= x and p.x <= x + w and p.y >= y and p.y <= y + h
+                end)
+                if not same(ids(query_map:objects_in_rect(x, y, w, h, filter)), expected) then
+                    mismatches = mismatches + 1
+                end
+                total = total + #expected
+
+                expected = brute_force(filter, function(p)
+                    return (p.x - x) ^ 2 + (p.y - y) ^ 2 <= r * r
+                        and query_map:line_of_sight(x, y, p.x, p.y)
+                end)
+                if not same(ids(query_map:objects_in_sight(x, y, r, filter)), expected) then
+                    mismatches = mismatches + 1
+                end
+            end
+        end
+        return mismatches, total
+    )");
+    auto result = compare();
+    BOOST_REQUIRE(result.valid());
+    std::pair<int, int> counts = result;
+    BOOST_CHECK_EQUAL(counts.first, 0);
+    BOOST_CHECK_GT(counts.second, 0);
+    lua["query_map"] = sol::lua_nil;
+}
+
+BOOST_AUTO_TEST_CASE(map_query_line_of_sight) {
+    auto map = Map::load(*game, "test_tiled.tmx");
+    int blocked = 0;
+    for (int i = 0; i < 500; ++i) {
+        xd::vec2 from{ (i * 7919 % 3989) / 10.0f + 0.3f, (i * 6271 % 3187) / 10.0f + 0.7f };
+        xd::vec2 to{ (i * 104729 % 3991) / 10.0f + 0.1f, (i * 15485863 % 3181) / 10.0f + 0.9f };
+        auto in_sight = map->line_of_sight(from, to);
+        BOOST_CHECK_EQUAL(in_sight, detail::sampled_line_of_sight(*map, from, to));
+        BOOST_CHECK_EQUAL(in_sight, map->line_of_sight(to, from));
+        if (!in_sight) ++blocked;
+    }
+    BOOST_CHECK_GT(blocked, 0);
+    BOOST_CHECK_LT(blocked, 500);
+}
+
+BOOST_AUTO_TEST_CASE(map_query_filters) {
+    auto map = Map::load(*game, "test_tiled.tmx");
+    detail::populate_map(*map, 40);
+    std::vector<Map_Object*> results;
+    xd::vec2 center{ 200.0f, 160.0f };
+
+    Object_Filter everything;
+    map->find_objects_in_radius(center, 1000.0f, everything, results);
+    BOOST_CHECK_EQUAL(results.size(), static_cast<std::size_t>(map->object_count()));
+    for (std::size_t i = 1; i < results.size(); ++i) {
+        BOOST_CHECK_LT(results[i - 1]->get_id(), results[i]->get_id());
+    }
+
+    Object_Filter hostile;
+    hostile.type = "npc";
+    hostile.property = "hostile";
+    hostile.value = "yes";
+    map->find_objects_in_radius(center, 1000.0f, hostile, results);
+    BOOST_CHECK(!results.empty());
+    for (auto object : results) {
+        BOOST_CHECK_EQUAL(object->get_type(), "npc");
+        BOOST_CHECK_EQUAL(object->get_property("hostile"), "yes");
+    }
+
+    Object_Filter no_layer;
+    no_layer.layer = nullptr;
+    map->find_objects_in_rect(xd::rect{ 0.0f, 0.0f, 400.0f, 320.0f }, no_layer, results);
+    BOOST_CHECK(results.empty());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
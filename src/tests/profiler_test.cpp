@@ -0,0 +1,144 @@
+#include "../profiler.hpp"
+#include <boost/property_tree/json_parser.hpp>
+#include <boost/property_tree/ptree.hpp>
+#include <boost/test/unit_test.hpp>
+#include <chrono>
+#include <sstream>
+#include <string>
+#include <thread>
+
+namespace detail {
+    static void busy_wait(std::chrono::microseconds duration) {
+        auto end = std::chrono::steady_clock::now() + duration;
+        while (std::chrono::steady_clock::now() < end) {}
+    }
+
+    static void record_frame() {
+        Profile_Zone frame("frame");
+        {
+            Profile_Zone update("update");
+            busy_wait(std::chrono::microseconds(200));
+            {
+                Profile_Zone scripts("scripts");
+                busy_wait(std::chrono::microseconds(100));
+            }
+        }
+        Profile_Zone render("render");
+        busy_wait(std::chrono::microseconds(100));
+    }
+}
+
+BOOST_AUTO_TEST_SUITE(profiler_tests)
+
+BOOST_AUTO_TEST_CASE(profiler_zones_nest) {
+    Profiler::clear();
+    detail::record_frame();
+
+    // Zones are recorded when they close, children first
+    auto events = Profiler::thread_events();
+    BOOST_REQUIRE_EQUAL(events.size(), 4u);
+    BOOST_CHECK_EQUAL(std::string(events[0].name), "scripts");
+    BOOST_CHECK_EQUAL(std::string(events[1].name), "update");
+    BOOST_CHECK_EQUAL(std::string(events[2].name), "render");
+    BOOST_CHECK_EQUAL(std::string(events[3].name), "frame");
+    BOOST_CHECK_EQUAL(events[0].depth, 2);
+    BOOST_CHECK_EQUAL(events[1].depth, 1);
+    BOOST_CHECK_EQUAL(events[2].depth, 1);
+    BOOST_CHECK_EQUAL(events[3].depth, 0);
+
+    auto contains = [](const Profile_Event& parent, const Profile_Event& child) {
+        return parent.start <= child.start && child.end <= parent.end;
+    };
+    BOOST_CHECK(contains(events[1], events[0]));
+    BOOST_CHECK(contains(events[3], events[1]));
+    BOOST_CHECK(contains(events[3], events[2]));
+    BOOST_CHECK_LE(events[1].end, events[2].start);
+    BOOST_CHECK_GE(events[1].end - events[1].start, 300000);
+}
+
+BOOST_AUTO_TEST_CASE(profiler_disabled_records_nothing) {
+    Profiler::clear();
+    Profiler::set_enabled(false);
+    detail::record_frame();
+    Profiler::set_enabled(true);
+    BOOST_CHECK(Profiler::thread_events().empty());
+}
+
+BOOST_AUTO_TEST_CASE(profiler_summary_averages_frames) {
+    Profiler::clear();
+    for (int i = 0; i < 3; ++i) {
+        detail::record_frame();
+        Profiler::end_frame();
+    }
+    // A frame without zones still counts
+    Profiler::end_frame();
+
+    auto summary = Profiler::summary();
+    BOOST_REQUIRE_EQUAL(summary.size(), 4u);
+    BOOST_CHECK_EQUAL(summary[0].name, "frame");
+    for (auto& zone : summary) {
+        BOOST_CHECK_CLOSE(zone.calls, 0.75, 0.001);
+        BOOST_CHECK_GT(zone.max_ms, 0.0);
+        BOOST_CHECK_LT(zone.average_ms, zone.max_ms);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(profiler_merges_thread_batches_at_frame_end) {
+    Profiler::clear();
+    const int zones = static_cast<int>(Profiler::events_per_batch) * 2 + 1;
+    std::thread worker([zones] {
+        for (int i = 0; i < zones; ++i) {
+            Profile_Zone zone("worker zone");
+        }
+    });
+    worker.join();
+    Profiler::end_frame();
+
+    // Full batches and the one left when the thread exited are all merged
+    auto summary = Profiler::summary();
+    BOOST_REQUIRE_EQUAL(summary.size(), 1u);
+    BOOST_CHECK_EQUAL(summary[0].name, "worker zone");
+    BOOST_CHECK_CLOSE(summary[0].calls, static_cast<double>(zones), 0.001);
+}
+
+BOOST_AUTO_TEST_CASE(profiler_exports_chrome_trace) {
+    Profiler::clear();
+    Profiler::set_thread_name("Test \"main\" thread");
+    detail::record_frame();
+    std::thread worker([] {
+        Profiler::set_thread_name("Worker");
+        Profile_Zone zone("worker zone");
+    });
+    worker.join();
+
+    std::stringstream trace;
+    Profiler::write_chrome_trace(trace);
+
+    boost::property_tree::ptree root;
+    BOOST_REQUIRE_NO_THROW(boost::property_tree::read_json(trace, root));
+    BOOST_CHECK_EQUAL(root.get<std::string>("displayTimeUnit"), "ms");
+
+    int complete_events = 0;
+    bool found_names[2] = { false, false };
+    for (auto& [key, event] : root.get_child("traceEvents")) {
+        auto phase = event.get<std::string>("ph");
+        BOOST_CHECK_EQUAL(event.get<int>("pid"), 1);
+        BOOST_CHECK_GE(event.get<int>("tid"), 1);
+        if (phase == "M") {
+            auto name = event.get<std::string>("args.name");
+            if (name == "Test \"main\" thread") found_names[0] = true;
+            if (name == "Worker") found_names[1] = true;
+            continue;
+        }
+        BOOST_CHECK_EQUAL(phase, "X");
+        BOOST_CHECK_GE(event.get<double>("ts"), 0.0);
+        BOOST_CHECK_GE(event.get<double>("dur"), 0.0);
+        event.get<std::string>("name");
+        ++complete_events;
+    }
+    BOOST_CHECK_EQUAL(complete_events, 5);
+    BOOST_CHECK(found_names[0]);
+    BOOST_CHECK(found_names[1]);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,231 @@
+#include "../xd/lua/chunk_cache.hpp"
+#include "../xd/lua/exceptions.hpp"
+#include "../xd/lua/scheduler.hpp"
+#include "../xd/lua/scheduler_task.hpp"
+#include "../xd/lua/virtual_machine.hpp"
+#include <boost/test/unit_test.hpp>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace detail {
+    // Start many coroutines that sleep twice and record when they resume,
+    // sleeping either on scheduler timers or on polled tasks
+    static std::vector<std::pair<int, int>> run_sleepers(bool use_timers, int count) {
+        xd::lua::virtual_machine vm;
+        xd::lua::scheduler scheduler(vm);
+        int now = 0;
+        auto clock = scheduler.add_clock([&now]() { return now; });
+        std::vector<std::pair<int, int>> resumed;
+
+        if (use_timers) {
+            scheduler.register_function("sleep", [&](int duration) {
+                scheduler.yield_until(clock, now + duration);
+            });
+        } else {
+            scheduler.register_function("sleep", [&](int duration) {
+                int start = now;
+                scheduler.yield([&now, start, duration]() { return now - start >= duration; });
+            });
+        }
+        vm.lua_state()["record"] = [&](int id) { resumed.emplace_back(id, now); };
+
+        for (int i = 0; i < count; ++i) {
+            auto id = std::to_string(i);
+            auto first = std::to_string((i * 7919) % 37);
+            auto second = std::to_string((i * 104729) % 23);
+            scheduler.start("sleep(" + first + ") record(" + id + ") sleep(" + second + ") record(" + id + ")", "");
+        }
+        BOOST_CHECK_EQUAL(scheduler.pending_tasks(), count);
+
+        for (now = 0; now <= 60; ++now) {
+            scheduler.run();
+        }
+        BOOST_CHECK_EQUAL(scheduler.pending_tasks(), 0);
+        return resumed;
+    }
+
+    // counts the allocations made by a lua state
+    struct Allocation_Counter {
+        explicit Allocation_Counter(lua_State* state) : state(state), allocations(0) {
+            original = lua_getallocf(state, &original_data);
+            lua_setallocf(state, &Allocation_Counter::allocate, this);
+        }
+        ~Allocation_Counter() {
+            lua_setallocf(state, original, original_data);
+        }
+        static void* allocate(void* data, void* ptr, size_t old_size, size_t new_size) {
+            auto counter = static_cast<Allocation_Counter*>(data);
+            if (new_size > 0 && (!ptr || new_size > old_size)) {
+                ++counter->allocations;
+            }
+            return counter->original(counter->original_data, ptr, old_size, new_size);
+        }
+        lua_State* state;
+        lua_Alloc original;
+        void* original_data;
+        int allocations;
+    };
+
+    struct Counting_Task : xd::lua::scheduler_task {
+        Counting_Task() : checks(0) {}
+        bool is_complete() override {
+            ++checks;
+            return true;
+        }
+        int checks;
+    };
+}
+
+BOOST_AUTO_TEST_SUITE(scheduler_tests)
+
+BOOST_AUTO_TEST_CASE(scheduler_timers_match_polling) {
+    auto polled = detail::run_sleepers(false, 2000);
+    auto timed = detail::run_sleepers(true, 2000);
+    BOOST_CHECK_EQUAL(polled.size(), 4000u);
+    BOOST_CHECK(polled == timed);
+}
+
+BOOST_AUTO_TEST_CASE(scheduler_signal_wakes_waiting_threads) {
+    xd::lua::virtual_machine vm;
+    xd::lua::scheduler scheduler(vm);
+    int key = 0;
+    auto task = std::make_shared<detail::Counting_Task>();
+    int resumed = 0;
+
+    scheduler.register_function("wait_signal", [&]() { scheduler.yield_for_signal(&key, task); });
+    vm.lua_state()["resumed"] = [&]() { ++resumed; };
+    scheduler.start("wait_signal() resumed()", "");
+
+    for (int i = 0; i < 10; ++i) {
+        scheduler.run();
+    }
+    // Waiting threads aren't polled
+    BOOST_CHECK_EQUAL(task->checks, 0);
+    BOOST_CHECK_EQUAL(resumed, 0);
+    BOOST_CHECK_EQUAL(scheduler.pending_tasks(), 1);
+
+    scheduler.notify(&key);
+    scheduler.run();
+    BOOST_CHECK_EQUAL(task->checks, 1);
+    BOOST_CHECK_EQUAL(resumed, 1);
+    BOOST_CHECK_EQUAL(scheduler.pending_tasks(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(scheduler_paused_timers_wait) {
+    xd::lua::virtual_machine vm;
+    xd::lua::scheduler scheduler(vm);
+    int now = 0;
+    auto clock = scheduler.add_clock([&now]() { return now; });
+    int resumed = 0;
+
+    scheduler.register_function("sleep", [&](int duration) { scheduler.yield_until(clock, now + duration); });
+    vm.lua_state()["resumed"] = [&]() { ++resumed; };
+    scheduler.start("sleep(5) resumed()", "");
+
+    now = 10;
+    scheduler.pause();
+    scheduler.run();
+    BOOST_CHECK_EQUAL(resumed, 0);
+    scheduler.resume();
+    scheduler.run();
+    BOOST_CHECK_EQUAL(resumed, 1);
+}
+
+BOOST_AUTO_TEST_CASE(scheduler_pools_finished_threads) {
+    xd::lua::virtual_machine vm;
+    xd::lua::scheduler scheduler(vm);
+    auto& lua = vm.lua_state();
+    lua["counter"] = 0;
+    const int count = 5000;
+    const std::string code = "counter = counter + 1";
+
+    // warm up the pool and the function cache
+    scheduler.start(code, "GLOBAL");
+    BOOST_CHECK_EQUAL(scheduler.pooled_threads(), 1u);
+    lua.collect_garbage();
+
+    int pooled_allocations;
+    {
+        detail::Allocation_Counter counter(lua.lua_state());
+        for (int i = 0; i < count; ++i) {
+            scheduler.start(code, "GLOBAL");
+        }
+        pooled_allocations = counter.allocations;
+    }
+    BOOST_CHECK_EQUAL(lua["counter"].get<int>(), count + 1);
+    BOOST_CHECK_EQUAL(scheduler.pooled_threads(), 1u);
+
+    // what starting a fresh thread from source for every script costs
+    int fresh_allocations;
+    {
+        detail::Allocation_Counter counter(lua.lua_state());
+        for (int i = 0; i < count; ++i) {
+            auto thread = sol::thread::create(lua);
+            auto thread_state = thread.state();
+            auto function = thread_state.load(code);
+            sol::coroutine coroutine = function;
+            thread_state.globals()["SCRIPT_CONTEXT"] = "GLOBAL";
+            coroutine();
+        }
+        fresh_allocations = counter.allocations;
+    }
+    BOOST_TEST_MESSAGE("Allocations for " << count << " scripts: pooled "
+        << pooled_allocations << ", fresh " << fresh_allocations);
+    BOOST_CHECK_LT(pooled_allocations * 10, fresh_allocations);
+    BOOST_CHECK_LT(pooled_allocations, count / 10);
+}
+
+BOOST_AUTO_TEST_CASE(scheduler_reuses_loaded_functions) {
+    xd::lua::virtual_machine vm;
+    xd::lua::scheduler scheduler(vm);
+    auto& cache = xd::lua::chunk_cache::shared();
+    vm.lua_state()["counter"] = 0;
+
+    scheduler.start("counter = counter + 10", "");
+    cache.reset_counters();
+    scheduler.start("counter = counter + 10", "");
+    BOOST_CHECK_EQUAL(cache.hits() + cache.misses(), 0);
+    BOOST_CHECK_EQUAL(vm.lua_state()["counter"].get<int>(), 20);
+
+    // a different chunk name is loaded again for accurate error messages
+    scheduler.start("counter = counter + 10", "", "@other.lua");
+    BOOST_CHECK_EQUAL(cache.hits() + cache.misses(), 1);
+    BOOST_CHECK_EQUAL(vm.lua_state()["counter"].get<int>(), 30);
+}
+
+BOOST_AUTO_TEST_CASE(scheduler_script_context_follows_threads) {
+    xd::lua::virtual_machine vm;
+    xd::lua::scheduler scheduler(vm);
+    auto& lua = vm.lua_state();
+    std::vector<std::string> contexts;
+    bool done = false;
+
+    lua["record"] = [&](const std::string& context) { contexts.push_back(context); };
+    lua["nested"] = [&]() { scheduler.start("record(SCRIPT_CONTEXT)", "MAP"); };
+    scheduler.register_function("wait", [&]() { scheduler.yield([&done]() { return done; }); });
+
+    scheduler.start("record(SCRIPT_CONTEXT) wait() nested() record(SCRIPT_CONTEXT)", "GLOBAL");
+    scheduler.start("record(SCRIPT_CONTEXT) wait() record(SCRIPT_CONTEXT)", "MAP");
+    done = true;
+    scheduler.run();
+
+    std::vector<std::string> expected{ "GLOBAL", "MAP", "MAP", "GLOBAL", "MAP" };
+    BOOST_CHECK_EQUAL_COLLECTIONS(contexts.begin(), contexts.end(), expected.begin(), expected.end());
+    BOOST_CHECK_EQUAL(scheduler.pooled_threads(), 3u);
+}
+
+BOOST_AUTO_TEST_CASE(scheduler_failed_threads_arent_pooled) {
+    xd::lua::virtual_machine vm;
+    xd::lua::scheduler scheduler(vm);
+    vm.lua_state()["counter"] = 0;
+
+    BOOST_CHECK_THROW(scheduler.start("error('failed')", ""), xd::lua::panic_error);
+    BOOST_CHECK_EQUAL(scheduler.pooled_threads(), 0u);
+    scheduler.start("counter = counter + 1", "");
+    BOOST_CHECK_EQUAL(scheduler.pooled_threads(), 1u);
+    BOOST_CHECK_EQUAL(vm.lua_state()["counter"].get<int>(), 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
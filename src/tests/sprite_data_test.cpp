@@ -4,6 +4,8 @@
 #include "../filesystem/user_data_folder.hpp"
 #include "../vendor/rapidxml.hpp"
 #include "../xd/asset_manager.hpp"
+#include "../xd/audio.hpp"
+#include "../xd/audio/detail/recording_audio_handle.hpp"
 #include <boost/test/unit_test.hpp>
 
 BOOST_AUTO_TEST_SUITE(sprite_data_tests)
@@ -22,6 +24,25 @@ BOOST_AUTO_TEST_CASE(sprite_data_load_file) {
     BOOST_CHECK_CLOSE(main_pose.frames[0].magnification.y, 1.0f, epsilon);
 }
 
+BOOST_AUTO_TEST_CASE(sprite_data_load_without_atlas) {
+    User_Data_Folder::parse_default_config();
+    xd::asset_manager manager;
+    auto packed = Sprite_Data::load("sprite.spr", manager, nullptr, channel_group_type::sound);
+    auto standalone = Sprite_Data::load("sprite.spr", manager, nullptr, channel_group_type::sound, false);
+    BOOST_CHECK(packed != standalone);
+    BOOST_CHECK(standalone == Sprite_Data::load("sprite.spr", manager, nullptr, channel_group_type::sound, false));
+    BOOST_CHECK_EQUAL(standalone->filename, "sprite.spr");
+    BOOST_CHECK(!standalone->allow_atlas);
+
+    // The images get their own textures, so frames start at the texture origin
+    BOOST_CHECK(standalone->image);
+    BOOST_CHECK(standalone->image == manager.get<xd::texture>(standalone->image_source));
+    for (auto& frame : standalone->poses[0].frames) {
+        BOOST_CHECK_EQUAL(frame.atlas_offset.x, 0.0f);
+        BOOST_CHECK_EQUAL(frame.atlas_offset.y, 0.0f);
+    }
+}
+
 BOOST_AUTO_TEST_CASE(sprite_data_load) {
     char text[] =
         "<?xml version=\"1.0\"?> \
@@ -182,4 +203,43 @@ BOOST_AUTO_TEST_CASE(sprite_data_load_compact) {
     BOOST_CHECK_EQUAL(circle_pose.frames[0].opacity, 1.0f);
 }
 
+BOOST_AUTO_TEST_CASE(sprite_data_shares_sounds) {
+    char text[] =
+        "<?xml version=\"1.0\"?> \
+        <Sprite Image=\"../data/player.png\"> \
+          <Pose> \
+            <Frame Duration=\"100\" Sound=\"as3sfxr_menu_click.wav\"> \
+              <Rectangle X=\"0\" Y=\"0\" Width=\"8\" Height=\"8\" /> \
+            </Frame> \
+            <Frame Duration=\"100\"> \
+              <Sound Filename=\"as3sfxr_menu_click.wav\" Pitch=\"1.5\" /> \
+              <Rectangle X=\"8\" Y=\"0\" Width=\"8\" Height=\"8\" /> \
+            </Frame> \
+          </Pose> \
+        </Sprite>";
+    auto doc = std::make_unique<rapidxml::xml_document<>>();
+    doc->parse<0>(text);
+    auto node = doc->first_node("Sprite");
+    BOOST_CHECK(node);
+
+    User_Data_Folder::parse_default_config();
+    xd::asset_manager manager;
+    auto handle = std::make_unique<xd::detail::recording_audio_handle>();
+    auto recording = handle.get();
+    xd::audio audio(std::move(handle));
+    auto first = Sprite_Data::load(*node, "first", manager, &audio, channel_group_type::sound);
+    auto second = Sprite_Data::load(*node, "second", manager, &audio, channel_group_type::non_pausable_sound);
+
+    // Every frame uses the same decoded sound, only its own settings differ
+    auto& first_frames = first->poses[0].frames;
+    auto& second_frames = second->poses[0].frames;
+    BOOST_CHECK(first_frames[0].sound_file);
+    BOOST_CHECK(first_frames[0].sound_file == first_frames[1].sound_file);
+    BOOST_CHECK(first_frames[0].sound_file == second_frames[0].sound_file);
+    BOOST_CHECK_EQUAL(recording->count(xd::detail::audio_call::open, "as3sfxr_menu_click.wav"), 1);
+    BOOST_CHECK_CLOSE(first_frames[1].sound_pitch.value_or(1.0f), 1.5f, 0.01f);
+    BOOST_CHECK(first_frames[0].sound_channel_group == channel_group_type::sound);
+    BOOST_CHECK(second_frames[0].sound_channel_group == channel_group_type::non_pausable_sound);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,213 @@
+// Converts maps, tilesets, sprites, Lua scripts and the images they use into an asset bundle.
+// Script bytecode is only used by engines built with the same Lua version as the packer.
+// Run it from the game folder so the bundled file names match the ones the game
+// loads, e.g. octopus_asset_packer assets.bundle data/maps data/sprites
+#include "../asset_bundle.hpp"
+#include "../exceptions.hpp"
+#include "../filesystem/readable_filesystem.hpp"
+#include "../filesystem/writable_filesystem.hpp"
+#include "../map/map.hpp"
+#include "../map/tileset.hpp"
+#include "../sprite_data.hpp"
+#include "../utility/file.hpp"
+#include "../utility/string.hpp"
+#include "../utility/texture.hpp"
+#include "../vendor/rapidxml.hpp"
+#include "../xd/graphics/image.hpp"
+#include "../xd/lua/chunk_cache.hpp"
+#include <iostream>
+#include <memory>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace detail {
+    class Asset_Packer {
+    public:
+        explicit Asset_Packer(Readable_Filesystem& fs) : fs(fs) {}
+
+        // Pack a file, or all maps, tilesets and sprites in a folder
+        void add_path(std::string path) {
+            string_utilities::normalize_slashes(path);
+            if (fs.is_directory(path)) {
+                for (auto& name : fs.directory_content_names(path)) {
+                    add_path(path + "/" + name);
+                }
+                return;
+            }
+
+            auto extension = fs.extension(path);
+            string_utilities::capitalize(extension);
+            if (extension == ".TMX") {
+                add_map(path);
+            } else if (extension == ".TSX") {
+                add_tileset(path);
+            } else if (extension == ".SPR") {
+                add_sprite(path);
+            } else if (extension == ".LUA") {
+                add_script(path);
+            } else if (extension == ".PNG" || extension == ".GIF"
+                    || extension == ".JPG" || extension == ".BMP") {
+                add_image(path);
+            }
+        }
+
+        const Asset_Bundle& get_bundle() const { return bundle; }
+
+    private:
+        using Record_Type = Asset_Bundle::Record_Type;
+
+        // Returns false if the file was already packed
+        bool mark_packed(Record_Type type, std::string filename) {
+            string_utilities::normalize_slashes(filename);
+            return packed.insert(std::make_pair(type, filename)).second;
+        }
+
+        // The content is parsed in place and must outlive the document
+        rapidxml::xml_node<>& parse(rapidxml::xml_document<>& doc, File_Buffer& content,
+                const std::string& filename, const char* root_name) {
+            content = fs.read_file_buffer(filename);
+            doc.parse<0>(content.data());
+            auto root = doc.first_node(root_name);
+            if (!root) {
+                throw xml_exception("Missing " + std::string{root_name} + " node in " + filename);
+            }
+            return *root;
+        }
+
+        void add_image(const std::string& filename) {
+            if (filename.empty() || !mark_packed(Record_Type::IMAGE, filename)) return;
+
+            auto stream = fs.open_binary_ifstream(filename);
+            if (!stream || !*stream) {
+                throw file_loading_exception{ "Failed to load image " + filename };
+            }
+            xd::image image{ filename, *stream };
+            Bundle_Writer writer;
+            texture_utilities::save_image(writer, image);
+            bundle.add(Record_Type::IMAGE, filename, writer.get_data());
+            std::cout << "Image   " << filename << "\n";
+        }
+
+        void add_script(const std::string& filename) {
+            if (!mark_packed(Record_Type::SCRIPT, filename)) return;
+
+            auto content = fs.read_file_buffer(filename);
+            auto chunk_name = "@" + filename;
+            string_utilities::normalize_slashes(chunk_name);
+            Bundle_Writer writer;
+            writer.write(xd::lua::chunk_cache::hash(content.data(), content.size()));
+            writer.write(xd::lua::chunk_cache::compile(content.data(), content.size(), chunk_name));
+            bundle.add(Record_Type::SCRIPT, filename, writer.get_data());
+            std::cout << "Script  " << filename << "\n";
+        }
+
+        void add_sprite(const std::string& filename) {
+            if (filename.empty() || !mark_packed(Record_Type::SPRITE, filename)) return;
+
+            File_Buffer content;
+            rapidxml::xml_document<> doc;
+            Sprite_Data sprite{filename};
+            sprite.read(parse(doc, content, filename, "Sprite"));
+            Bundle_Writer writer;
+            sprite.save(writer);
+            bundle.add(Record_Type::SPRITE, filename, writer.get_data());
+            std::cout << "Sprite  " << filename << "\n";
+
+            add_image(sprite.image_source);
+            for (auto& pose : sprite.poses) {
+                add_image(pose.image_source);
+                for (auto& frame : pose.frames) {
+                    add_image(frame.image_source);
+                }
+            }
+        }
+
+        void add_tileset(const std::string& filename) {
+            if (filename.empty() || !mark_packed(Record_Type::TILESET, filename)) return;
+
+            File_Buffer content;
+            rapidxml::xml_document<> doc;
+            Tileset tileset;
+            tileset.read(parse(doc, content, filename, "tileset"));
+            tileset.filename = filename;
+            string_utilities::normalize_slashes(tileset.filename);
+            Bundle_Writer writer;
+            tileset.save(writer);
+            bundle.add(Record_Type::TILESET, filename, writer.get_data());
+            std::cout << "Tileset " << filename << "\n";
+
+            add_image(tileset.image_source);
+        }
+
+        void add_map(const std::string& filename) {
+            if (!mark_packed(Record_Type::MAP, filename)) return;
+
+            File_Buffer content;
+            rapidxml::xml_document<> doc;
+            auto& map_node = parse(doc, content, filename, "map");
+            add_map_references(map_node);
+            Bundle_Writer writer;
+            Map::save(writer, doc);
+            bundle.add(Record_Type::MAP, filename, writer.get_data());
+            std::cout << "Map     " << filename << "\n";
+        }
+
+        // Pack the tilesets, images and sprites used by a map
+        void add_map_references(rapidxml::xml_node<>& node) {
+            std::string name = node.name();
+            if (name == "tileset") {
+                if (auto source = node.first_attribute("source")) {
+                    add_tileset(source->value());
+                }
+            } else if (name == "image") {
+                if (auto source = node.first_attribute("source")) {
+                    add_image(source->value());
+                }
+            } else if (name == "property") {
+                auto prop_name = node.first_attribute("name");
+                auto value = node.first_attribute("value");
+                if (prop_name && value && prop_name->value() == std::string{"sprite"}) {
+                    add_sprite(value->value());
+                }
+            }
+
+            for (auto child = node.first_node(); child; child = child->next_sibling()) {
+                add_map_references(*child);
+            }
+        }
+
+        Readable_Filesystem& fs;
+        Asset_Bundle bundle;
+        std::set<std::pair<Record_Type, std::string>> packed;
+    };
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << " <output bundle> <files or folders...>\n";
+        return 1;
+    }
+
+    try {
+        auto fs = file_utilities::disk_filesystem();
+        detail::Asset_Packer packer{*fs};
+        for (int i = 2; i < argc; ++i) {
+            packer.add_path(argv[i]);
+        }
+
+        std::string output = argv[1];
+        auto stream = fs->open_ofstream(output, std::ios_base::out | std::ios_base::binary);
+        if (!stream || !*stream) {
+            throw file_loading_exception{ "Failed to open " + output + " for writing" };
+        }
+        packer.get_bundle().save(*stream);
+        std::cout << "Wrote " << packer.get_bundle().size() << " records to " << output << "\n";
+    } catch (std::exception& ex) {
+        std::cerr << "Error: " << ex.what() << "\n";
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,73 @@
+#include "texture.hpp"
+#include "file.hpp"
+#include "../asset_bundle.hpp"
+#include "../configurations.hpp"
+#include "../exceptions.hpp"
+#include "../xd/asset_manager.hpp"
+#include "../xd/graphics/image.hpp"
+#include <cstdint>
+#include <vector>
+
+std::unique_ptr<xd::image> texture_utilities::decode_image(const std::string& filename,
+        xd::vec4 transparent_color) {
+    auto bundle = Asset_Bundle::game_bundle();
+    if (auto record = bundle ? bundle->find(Asset_Bundle::Record_Type::IMAGE, filename) : std::nullopt) {
+        Bundle_Reader reader{*record};
+        auto width = reader.read<std::int32_t>();
+        auto height = reader.read<std::int32_t>();
+        auto pixels = reader.read_vector<std::uint8_t>();
+        if (pixels.size() != static_cast<std::size_t>(width) * height * 4) {
+            throw bundle_exception("Invalid bundled image " + filename);
+        }
+        return std::make_unique<xd::image>(filename, width, height, pixels.data(), transparent_color);
+    }
+
+    auto fs = file_utilities::game_data_filesystem();
+    auto stream = fs->open_binary_ifstream(filename);
+    if (!stream || !*stream) {
+        throw file_loading_exception{ "Failed to load image " + filename };
+    }
+    return std::make_unique<xd::image>(filename, *stream, transparent_color);
+}
+
+void texture_utilities::save_image(Bundle_Writer& writer, const xd::image& image) {
+    auto pixels = static_cast<const std::uint8_t*>(image.data());
+    writer.write(static_cast<std::int32_t>(image.width()));
+    writer.write(static_cast<std::int32_t>(image.height()));
+    writer.write(std::vector<std::uint8_t>(pixels, pixels + image.width() * image.height() * 4));
+}
+
+xd::texture_atlas& texture_utilities::shared_atlas(xd::asset_manager& manager) {
+    const std::string key = "shared";
+    if (!manager.contains_key<xd::texture_atlas>(key)) {
+        auto page_size = Configurations::get<int>("graphics.atlas-page-size");
+        auto max_image_size = Configurations::get<int>("graphics.atlas-max-image-size");
+        return *manager.load<xd::texture_atlas>(key, page_size, max_image_size);
+    }
+    return *manager.get<xd::texture_atlas>(key);
+}
+
+xd::atlas_region texture_utilities::load_image(xd::asset_manager& manager,
+        const std::string& filename, xd::vec4 transparent_color, bool allow_atlas) {
+    auto& atlas = shared_atlas(manager);
+    if (allow_atlas) {
+        if (auto region = atlas.find(filename)) {
+            return region.value();
+        }
+    }
+
+    if (manager.contains_key<xd::texture>(filename)) {
+        auto texture = manager.get<xd::texture>(filename);
+        return xd::atlas_region{ texture, xd::rect(0, 0, texture->width(), texture->height()) };
+    }
+
+    auto image = decode_image(filename, transparent_color);
+    if (allow_atlas) {
+        if (auto region = atlas.add(filename, *image)) {
+            return region.value();
+        }
+    }
+
+    auto texture = manager.load<xd::texture>(filename, *image);
+    return xd::atlas_region{ texture, xd::rect(0, 0, texture->width(), texture->height()) };
+}
@@ -0,0 +1,30 @@
+#ifndef HPP_UTILITY_TEXTURE
+#define HPP_UTILITY_TEXTURE
+
+#include "../xd/glm.hpp"
+#include "../xd/graphics/texture_atlas.hpp"
+#include <memory>
+#include <string>
+
+class Bundle_Writer;
+
+namespace xd {
+    class asset_manager;
+    class image;
+}
+
+namespace texture_utilities {
+    // Decode an image file, or take the pixels from the game's asset bundle if it has them
+    std::unique_ptr<xd::image> decode_image(const std::string& filename, xd::vec4 transparent_color);
+    // Write the decoded pixels as an asset bundle image record
+    void save_image(Bundle_Writer& writer, const xd::image& image);
+    // Get the atlas shared by sprites and image layers, created on first use
+    xd::texture_atlas& shared_atlas(xd::asset_manager& manager);
+    // Load an image file through the asset cache. Small images are packed into
+    // the shared atlas (unless allow_atlas is false), larger ones get their own
+    // texture whose region covers the whole texture
+    xd::atlas_region load_image(xd::asset_manager& manager, const std::string& filename,
+        xd::vec4 transparent_color, bool allow_atlas = true);
+}
+
+#endif
@@ -4,5 +4,6 @@
 #include "audio/audio.hpp"
 #include "audio/music.hpp"
 #include "audio/sound.hpp"
+#include "audio/sound_bank.hpp"
 
 #endif
@@ -1,7 +1,14 @@
 #include "audio.hpp"
+#include "sound_bank.hpp"
 #include "detail/fmod_audio_handle.hpp"
 
-xd::audio::audio() : m_audio_handle(std::make_unique<detail::fmod_audio_handle>()) {}
+xd::audio::audio() :
+    m_audio_handle(std::make_unique<detail::fmod_audio_handle>()),
+    m_sound_bank(std::make_unique<sound_bank>(*this)) {}
+
+xd::audio::audio(std::unique_ptr<detail::audio_handle> handle) :
+    m_audio_handle(std::move(handle)),
+    m_sound_bank(std::make_unique<sound_bank>(*this)) {}
 
 xd::audio::~audio() {}
 
@@ -37,3 +44,15 @@ void xd::audio::resume_sounds() {
 xd::detail::audio_handle* xd::audio::get_handle() {
     return m_audio_handle.get();
 }
+
+std::optional<xd::detail::tag_loop_info> xd::audio::get_cached_loop_info(const std::string& filename) const {
+    std::lock_guard<std::mutex> lock(m_loop_info_mutex);
+    auto i = m_loop_info_cache.find(filename);
+    if (i == m_loop_info_cache.end()) return std::nullopt;
+    return i->second;
+}
+
+void xd::audio::cache_loop_info(const std::string& filename, const detail::tag_loop_info& info) {
+    std::lock_guard<std::mutex> lock(m_loop_info_mutex);
+    m_loop_info_cache[filename] = info;
+}
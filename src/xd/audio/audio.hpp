@@ -1,7 +1,12 @@
 #ifndef H_XD_AUDIO_AUDIO
 #define H_XD_AUDIO_AUDIO
 
+#include "detail/sound_handle.hpp"
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
 
 namespace xd
 {
@@ -10,6 +15,7 @@ namespace xd
         class audio_handle;
         class sound_handle;
     }
+    class sound_bank;
 
     class audio
     {
@@ -17,6 +23,8 @@ namespace xd
         audio(const audio&) = delete;
         audio& operator=(const audio&) = delete;
         audio();
+        // use the given backend instead of FMOD, e.g. a null_audio_handle
+        explicit audio(std::unique_ptr<detail::audio_handle> handle);
         ~audio();
         void update() const;
         void set_music_volume(float volume) const;
@@ -26,8 +34,18 @@ namespace xd
         void pause_sounds();
         void resume_sounds();
         detail::audio_handle* get_handle();
+        // sounds shared by file name and the voices that play them
+        sound_bank& get_sound_bank() { return *m_sound_bank; }
+        // loop points read from music tags, cached so each file is only scanned
+        // once. thread safe, music can be loaded in the background
+        std::optional<detail::tag_loop_info> get_cached_loop_info(const std::string& filename) const;
+        void cache_loop_info(const std::string& filename, const detail::tag_loop_info& info);
     private:
         std::unique_ptr<detail::audio_handle> m_audio_handle;
+        // after the handle, so the shared sounds are released first
+        std::unique_ptr<sound_bank> m_sound_bank;
+        mutable std::mutex m_loop_info_mutex;
+        std::unordered_map<std::string, detail::tag_loop_info> m_loop_info_cache;
     };
 }
 
@@ -15,6 +15,9 @@ namespace xd::detail {
         // Create a sound instance
         virtual std::unique_ptr<sound_handle> create_sound(const std::string& filename,
             std::unique_ptr<std::istream> stream, channel_group_type group_type) = 0;
+        // Create a sound instance sharing the decoded data of another (non-music) sound
+        virtual std::unique_ptr<sound_handle> create_sound_instance(sound_handle& source,
+            channel_group_type group_type) = 0;
         // Set volume for a group
         virtual void set_channel_group_volume(channel_group_type group_type, float volume) = 0;
         // Set volume for a channel group
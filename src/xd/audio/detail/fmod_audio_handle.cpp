@@ -57,6 +57,13 @@ namespace xd::detail {
 
         return *istream ? FMOD_OK : FMOD_ERR_FILE_COULDNOTSEEK;
     }
+
+    static void release_sound(FMOD::Sound* sound) {
+        auto result = sound->release();
+        if (result != FMOD_OK) {
+            LOGGER_W << "Unable to release sound - FMOD result: " << result;
+        }
+    }
 }
 
 xd::detail::fmod_audio_handle::fmod_audio_handle() {
@@ -117,10 +124,23 @@ std::unique_ptr<xd::detail::sound_handle> xd::detail::fmod_audio_handle::create_
         stream.reset();
     }
 
-    return std::make_unique<xd::detail::fmod_sound_handle>(*this, sound, group_type,
+    // Released once the sound and all of its instances are gone
+    std::shared_ptr<FMOD::Sound> shared_sound(sound, detail::release_sound);
+    return std::make_unique<xd::detail::fmod_sound_handle>(*this, shared_sound, group_type,
         filename, std::move(stream));
 }
 
+std::unique_ptr<xd::detail::sound_handle> xd::detail::fmod_audio_handle::create_sound_instance(
+        sound_handle& source, channel_group_type group_type) {
+    auto& fmod_source = dynamic_cast<fmod_sound_handle&>(source);
+    if (fmod_source.get_channel_group_type() == channel_group_type::music) {
+        // Streams can only be read by one channel
+        throw audio_file_load_failed(fmod_source.get_filename(), -1);
+    }
+    return std::make_unique<xd::detail::fmod_sound_handle>(*this, fmod_source.get_shared_sound(),
+        group_type, fmod_source.get_filename(), nullptr);
+}
+
 void xd::detail::fmod_audio_handle::play_sound(sound_handle& sound) {
     auto& fmod_sound = dynamic_cast<fmod_sound_handle&>(sound);
     FMOD::Channel* channel = nullptr;
@@ -19,6 +19,9 @@ namespace xd::detail {
         // Create a sound object (initially paused)
         std::unique_ptr<sound_handle> create_sound(const std::string& filename,
             std::unique_ptr<std::istream> stream, channel_group_type group_type) override;
+        // Create another channel for an already decoded sound
+        std::unique_ptr<sound_handle> create_sound_instance(sound_handle& source,
+            channel_group_type group_type) override;
         // Play a sound
         void play_sound(sound_handle& sound) override;
         // Set volume for a group
@@ -17,16 +17,19 @@ namespace xd::detail {
 }
 
 xd::detail::fmod_sound_handle::fmod_sound_handle(audio_handle& audio_handle,
-        FMOD::Sound* sound, channel_group_type group_type, const std::string& filename,
+        std::shared_ptr<FMOD::Sound> sound, channel_group_type group_type, const std::string& filename,
         std::unique_ptr<std::istream> stream) :
     audio(audio_handle),
     stream(std::move(stream)),
-    sound(sound),
+    sound(std::move(sound)),
     channel(nullptr),
     channel_group(group_type),
     filename(filename),
     volume(1.0f),
-    pitch(1.0f) {}
+    pitch(1.0f),
+    looping(group_type == channel_group_type::music),
+    loop_start(0),
+    loop_end(0) {}
 
 int xd::detail::fmod_sound_handle::get_loop_tag(const char* name) {
     if (!sound)
@@ -103,6 +106,26 @@ void xd::detail::fmod_sound_handle::create_channel() {
     audio.play_sound(*this);
     set_volume(volume);
     set_pitch(pitch);
+    apply_looping();
+}
+
+void xd::detail::fmod_sound_handle::apply_looping() {
+    if (!channel) return;
+
+    auto result = channel->setMode(looping ? FMOD_LOOP_NORMAL : FMOD_LOOP_OFF);
+    if (detail::invalid_result(result)) {
+        LOGGER_W << "Unable to set loop mode of sound " << filename << " - FMOD result: " << result;
+    }
+    result = channel->setLoopCount(looping ? -1 : 0);
+    if (detail::invalid_result(result)) {
+        LOGGER_W << "Unable to set looping of sound " << filename << " to " << looping << " - FMOD result: " << result;
+    }
+    if (loop_end == 0u) return;
+
+    result = channel->setLoopPoints(loop_start, detail::time_unit, loop_end, detail::time_unit);
+    if (detail::invalid_result(result)) {
+        LOGGER_W << "Unable to set loop points of sound " << filename << " to " << loop_start << ", " << loop_end << " - FMOD result: " << result;
+    }
 }
 
 void xd::detail::fmod_sound_handle::play() {
@@ -202,19 +225,12 @@ float xd::detail::fmod_sound_handle::get_pitch() const {
 }
 
 void xd::detail::fmod_sound_handle::set_looping(bool looping) {
-    auto result = sound->setLoopCount(looping ? -1 : 0);
-    if (result != FMOD_OK) {
-        LOGGER_W << "Unable to set looping of sound " << filename << " to " << looping << " - FMOD result: " << result;
-    }
+    this->looping = looping;
+    apply_looping();
 }
 
 bool xd::detail::fmod_sound_handle::is_looping() const {
-    int loop = 0;
-    auto result = sound->getLoopCount(&loop);
-    if (result != FMOD_OK) {
-        LOGGER_W << "Unable to get looping of sound " << filename << " - FMOD result: " << result;
-    }
-    return loop != 0;
+    return looping;
 }
 
 void xd::detail::fmod_sound_handle::set_loop_points(unsigned int start, unsigned int end) {
@@ -225,14 +241,16 @@ void xd::detail::fmod_sound_handle::set_loop_points(unsigned int start, unsigned
         }
         end--;
     }
-    auto result = sound->setLoopPoints(start, detail::time_unit, end, detail::time_unit);
-    if (result != FMOD_OK) {
-        LOGGER_W << "Unable to set loop points of sound " << filename << " to " << start << ", " << end << " - FMOD result: " << result;
-    }
+    loop_start = start;
+    loop_end = end;
+    apply_looping();
 }
 
 std::pair<unsigned int, unsigned int> xd::detail::fmod_sound_handle::get_loop_points() const
 {
+    if (loop_end != 0u) {
+        return std::make_pair(loop_start, loop_end);
+    }
     auto start = 0u, end = 0u;
     auto result = sound->getLoopPoints(&start, detail::time_unit, &end, detail::time_unit);
     if (result != FMOD_OK) {
@@ -240,7 +258,3 @@ std::pair<unsigned int, unsigned int> xd::detail::fmod_sound_handle::get_loop_po
     }
     return std::make_pair(start, end);
 }
-
-xd::detail::fmod_sound_handle::~fmod_sound_handle() {
-    if (sound) sound->release();
-}
@@ -13,7 +13,7 @@ namespace FMOD {
 namespace xd::detail {
     class fmod_sound_handle : public sound_handle {
     public:
-        fmod_sound_handle(audio_handle& audio_handle, FMOD::Sound* sound,
+        fmod_sound_handle(audio_handle& audio_handle, std::shared_ptr<FMOD::Sound> sound,
             channel_group_type group_type, const std::string& filename,
             std::unique_ptr<std::istream> stream);
 
@@ -39,23 +39,29 @@ namespace xd::detail {
         void set_loop_points(unsigned int start, unsigned int end) override;
         std::pair<unsigned int, unsigned int> get_loop_points() const override;
 
-        FMOD::Sound* get_sound() { return sound; }
+        FMOD::Sound* get_sound() { return sound.get(); }
+        // The decoded sound, shared with other instances
+        const std::shared_ptr<FMOD::Sound>& get_shared_sound() const { return sound; }
         void set_channel(FMOD::Channel* new_channel) { channel = new_channel; }
         FMOD::Channel* get_channel() { return channel; }
         channel_group_type get_channel_group_type() const override { return channel_group; }
         const std::string& get_filename() const override { return filename; }
-
-        ~fmod_sound_handle() override;
     private:
         audio_handle& audio;
         std::unique_ptr<std::istream> stream;
-        FMOD::Sound* sound;
+        std::shared_ptr<FMOD::Sound> sound;
         FMOD::Channel* channel;
         channel_group_type channel_group;
         std::string filename;
         float volume;
         float pitch;
+        // Looping is set per channel, the sound is shared with other instances
+        bool looping;
+        // Loop end of 0 keeps the sound's default loop points
+        unsigned int loop_start;
+        unsigned int loop_end;
         void create_channel();
+        void apply_looping();
     };
 }
 
@@ -0,0 +1,269 @@
+#include "null_audio_handle.hpp"
+#include "../exceptions.hpp"
+#include <algorithm>
+#include <cmath>
+#include <istream>
+
+namespace xd::detail {
+    // Bytes read when opening a file, like a decoder reading the header
+    constexpr std::streamsize null_header_size = 4096;
+
+    static unsigned int stream_length(std::istream& stream) {
+        auto start = stream.tellg();
+        stream.seekg(0, std::ios::end);
+        auto end = stream.tellg();
+        stream.clear();
+        stream.seekg(start);
+        if (start == std::streampos(-1) || end == std::streampos(-1)) return 0;
+        return static_cast<unsigned int>(end);
+    }
+}
+
+xd::detail::null_audio_handle::null_audio_handle(float update_seconds) :
+    volumes{1.0f, 1.0f, 1.0f},
+    paused{false, false, false},
+    update_seconds(update_seconds),
+    time(0.0) {}
+
+std::unique_ptr<xd::detail::sound_handle> xd::detail::null_audio_handle::create_sound(const std::string& filename,
+        std::unique_ptr<std::istream> stream, channel_group_type group_type) {
+    if (!stream || !*stream) {
+        throw audio_file_load_failed(filename, -1);
+    }
+
+    auto length = stream_length(*stream);
+    char header[null_header_size];
+    stream->read(header, std::min<std::streamsize>(null_header_size, length));
+    record(audio_call::open, filename, length);
+
+    if (group_type != channel_group_type::music) {
+        // Sounds are decoded up front so they don't need the stream
+        stream.reset();
+    }
+
+    return std::make_unique<null_sound_handle>(*this, group_type, filename, std::move(stream), length);
+}
+
+std::unique_ptr<xd::detail::sound_handle> xd::detail::null_audio_handle::create_sound_instance(
+        sound_handle& source, channel_group_type group_type) {
+    auto& null_source = dynamic_cast<null_sound_handle&>(source);
+    if (null_source.get_channel_group_type() == channel_group_type::music) {
+        throw audio_file_load_failed(null_source.get_filename(), -1);
+    }
+    record(audio_call::share, null_source.get_filename(), null_source.get_length());
+    return std::make_unique<null_sound_handle>(*this, group_type, null_source.get_filename(),
+        nullptr, null_source.get_length());
+}
+
+void xd::detail::null_audio_handle::play_sound(sound_handle& sound) {
+    sound.play();
+}
+
+void xd::detail::null_audio_handle::set_channel_group_volume(channel_group_type group_type, float volume) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        volumes[static_cast<int>(group_type)] = volume;
+    }
+    record(audio_call::set_group_volume, "", static_cast<unsigned int>(group_type), 0, volume);
+}
+
+float xd::detail::null_audio_handle::get_channel_group_volume(channel_group_type group_type) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return volumes[static_cast<int>(group_type)];
+}
+
+void xd::detail::null_audio_handle::pause_channel_group(channel_group_type group_type) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        paused[static_cast<int>(group_type)] = true;
+    }
+    record(audio_call::pause_group, "", static_cast<unsigned int>(group_type));
+}
+
+void xd::detail::null_audio_handle::resume_channel_group(channel_group_type group_type) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        paused[static_cast<int>(group_type)] = false;
+    }
+    record(audio_call::resume_group, "", static_cast<unsigned int>(group_type));
+}
+
+bool xd::detail::null_audio_handle::is_channel_group_paused(channel_group_type group_type) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return paused[static_cast<int>(group_type)];
+}
+
+void xd::detail::null_audio_handle::update() {
+    if (update_seconds > 0.0f) {
+        advance(update_seconds);
+    }
+}
+
+void xd::detail::null_audio_handle::advance(float seconds) {
+    std::lock_guard<std::mutex> lock(mutex);
+    time += seconds;
+    auto samples = static_cast<double>(seconds) * sample_rate;
+    for (auto sound : sounds) {
+        if (paused[static_cast<int>(sound->get_channel_group_type())]) continue;
+        sound->advance(samples);
+    }
+}
+
+double xd::detail::null_audio_handle::get_time() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return time;
+}
+
+std::size_t xd::detail::null_audio_handle::get_sound_count() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return sounds.size();
+}
+
+std::size_t xd::detail::null_audio_handle::get_playing_count(std::optional<channel_group_type> group_type) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return static_cast<std::size_t>(std::count_if(sounds.begin(), sounds.end(),
+        [&](const null_sound_handle* sound) {
+            return sound->is_playing() && !sound->is_paused()
+                && (!group_type || sound->get_channel_group_type() == *group_type);
+        }));
+}
+
+void xd::detail::null_audio_handle::set_loop_tags(const std::string& filename, tag_loop_info info) {
+    std::lock_guard<std::mutex> lock(mutex);
+    loop_tags[filename] = info;
+}
+
+std::optional<xd::detail::tag_loop_info> xd::detail::null_audio_handle::get_loop_tags(const std::string& filename) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto i = loop_tags.find(filename);
+    if (i == loop_tags.end()) return std::nullopt;
+    return i->second;
+}
+
+void xd::detail::null_audio_handle::record(audio_call, const std::string&, unsigned int, unsigned int, float) {}
+
+void xd::detail::null_audio_handle::add_sound(null_sound_handle* sound) {
+    std::lock_guard<std::mutex> lock(mutex);
+    sounds.push_back(sound);
+}
+
+void xd::detail::null_audio_handle::remove_sound(null_sound_handle* sound) {
+    std::lock_guard<std::mutex> lock(mutex);
+    sounds.erase(std::remove(sounds.begin(), sounds.end(), sound), sounds.end());
+}
+
+xd::detail::null_sound_handle::null_sound_handle(null_audio_handle& audio_handle,
+        channel_group_type group_type, const std::string& filename,
+        std::unique_ptr<std::istream> stream, unsigned int length) :
+    audio(audio_handle),
+    stream(std::move(stream)),
+    channel_group(group_type),
+    filename(filename),
+    length(length),
+    position(0.0),
+    volume(1.0f),
+    pitch(1.0f),
+    looping(group_type == channel_group_type::music),
+    loop_points(0, length > 0 ? length - 1 : 0),
+    playing(false),
+    paused(false) {
+    audio.add_sound(this);
+}
+
+xd::detail::null_sound_handle::~null_sound_handle() noexcept {
+    audio.remove_sound(this);
+}
+
+int xd::detail::null_sound_handle::get_loop_tag(const char* name) {
+    auto tags = audio.get_loop_tags(filename);
+    if (!tags) return -1;
+    std::string tag = name;
+    if (tag == "LOOPSTART") return tags->loop_start;
+    if (tag == "LOOPEND") return tags->loop_end;
+    if (tag == "LOOPLENGTH") return tags->loop_end - tags->loop_start;
+    return -1;
+}
+
+xd::detail::tag_loop_info xd::detail::null_sound_handle::read_tagged_loop_points() {
+    audio.record(audio_call::read_loop_tags, filename);
+    auto tags = audio.get_loop_tags(filename);
+    if (tags) return *tags;
+    int int_length = static_cast<int>(length);
+    return { 0, int_length - 1, int_length };
+}
+
+void xd::detail::null_sound_handle::play() {
+    // Like a real channel: resume if paused, restart if it ended
+    if (paused) {
+        paused = false;
+    } else if (!playing) {
+        playing = true;
+        position = 0.0;
+    }
+    audio.record(audio_call::play, filename);
+}
+
+void xd::detail::null_sound_handle::pause() {
+    if (playing) paused = true;
+    audio.record(audio_call::pause, filename);
+}
+
+void xd::detail::null_sound_handle::stop() {
+    playing = false;
+    paused = false;
+    position = 0.0;
+    audio.record(audio_call::stop, filename);
+}
+
+void xd::detail::null_sound_handle::set_offset(unsigned int offset) {
+    position = std::min(offset, length);
+    if (stream) {
+        stream->clear();
+        stream->seekg(std::min(offset, length));
+    }
+    audio.record(audio_call::seek, filename, offset);
+}
+
+void xd::detail::null_sound_handle::set_volume(float new_volume) {
+    volume = new_volume;
+    audio.record(audio_call::set_volume, filename, 0, 0, new_volume);
+}
+
+void xd::detail::null_sound_handle::set_pitch(float new_pitch) {
+    pitch = new_pitch;
+    audio.record(audio_call::set_pitch, filename, 0, 0, new_pitch);
+}
+
+void xd::detail::null_sound_handle::set_looping(bool new_looping) {
+    looping = new_looping;
+    audio.record(audio_call::set_looping, filename, new_looping ? 1 : 0);
+}
+
+void xd::detail::null_sound_handle::set_loop_points(unsigned int start, unsigned int end) {
+    if (end == 0u && length > 0) {
+        end = length - 1;
+    }
+    loop_points = std::make_pair(start, end);
+    audio.record(audio_call::set_loop_points, filename, start, end);
+}
+
+void xd::detail::null_sound_handle::advance(double samples) {
+    if (!playing || paused) return;
+
+    position += samples * pitch;
+    if (!looping) {
+        if (position >= length) {
+            playing = false;
+            position = 0.0;
+        }
+        return;
+    }
+
+    auto [start, end] = loop_points;
+    if (end > start && position > end) {
+        double loop_length = static_cast<double>(end - start) + 1.0;
+        position = start + std::fmod(position - start, loop_length);
+    } else if (end <= start && length > 0 && position >= length) {
+        position = std::fmod(position, static_cast<double>(length));
+    }
+}
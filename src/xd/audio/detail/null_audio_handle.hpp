@@ -0,0 +1,124 @@
+#ifndef H_XD_AUDIO_DETAIL_NULL_AUDIO_HANDLE
+#define H_XD_AUDIO_DETAIL_NULL_AUDIO_HANDLE
+
+#include "audio_handle.hpp"
+#include "sound_handle.hpp"
+#include <cstddef>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace xd::detail {
+    // Operations reported by the null audio handle, see recording_audio_handle
+    enum class audio_call {
+        open, share, play, pause, stop, seek, set_volume, set_pitch, set_looping,
+        set_loop_points, read_loop_tags, set_group_volume, pause_group, resume_group
+    };
+
+    class null_sound_handle;
+
+    // Audio handle that doesn't output anything, for running without a sound
+    // device (headless runs and tests). Playback is simulated: playing sounds
+    // move forward on every update or advance call and stop at their end
+    // unless looping. Each byte of a stream counts as one sample. Thread safe,
+    // music can be opened from a worker thread
+    class null_audio_handle : public audio_handle
+    {
+    public:
+        static constexpr unsigned int sample_rate = 44100;
+
+        // update_seconds is the simulated time that passes on each update
+        explicit null_audio_handle(float update_seconds = 0.0f);
+        std::unique_ptr<sound_handle> create_sound(const std::string& filename,
+            std::unique_ptr<std::istream> stream, channel_group_type group_type) override;
+        std::unique_ptr<sound_handle> create_sound_instance(sound_handle& source,
+            channel_group_type group_type) override;
+        void play_sound(sound_handle& sound) override;
+        void set_channel_group_volume(channel_group_type group_type, float volume) override;
+        float get_channel_group_volume(channel_group_type group_type) const override;
+        void pause_channel_group(channel_group_type group_type) override;
+        void resume_channel_group(channel_group_type group_type) override;
+        bool is_channel_group_paused(channel_group_type group_type) const override;
+        void update() override;
+
+        // Simulate playback for the given number of seconds
+        void advance(float seconds);
+        // Simulated seconds passed so far
+        double get_time() const;
+        // Number of sounds (channels) that currently exist
+        std::size_t get_sound_count() const;
+        // Number of sounds playing and not paused, optionally only in one group
+        std::size_t get_playing_count(std::optional<channel_group_type> group_type = std::nullopt) const;
+        // Loop tags to report for a file, by default files have none
+        void set_loop_tags(const std::string& filename, tag_loop_info info);
+        std::optional<tag_loop_info> get_loop_tags(const std::string& filename) const;
+        // Called for every operation on the handle or its sounds, does nothing here
+        virtual void record(audio_call call, const std::string& filename,
+            unsigned int first = 0, unsigned int second = 0, float value = 0.0f);
+    private:
+        friend class null_sound_handle;
+        mutable std::mutex mutex;
+        // Sounds register themselves so playback can be simulated
+        std::vector<null_sound_handle*> sounds;
+        std::unordered_map<std::string, tag_loop_info> loop_tags;
+        float volumes[3];
+        bool paused[3];
+        float update_seconds;
+        double time;
+        void add_sound(null_sound_handle* sound);
+        void remove_sound(null_sound_handle* sound);
+    };
+
+    class null_sound_handle : public sound_handle {
+    public:
+        null_sound_handle(null_audio_handle& audio_handle, channel_group_type group_type,
+            const std::string& filename, std::unique_ptr<std::istream> stream, unsigned int length);
+        ~null_sound_handle() noexcept override;
+
+        int get_loop_tag(const char* name) override;
+        tag_loop_info read_tagged_loop_points() override;
+        const std::string& get_filename() const override { return filename; }
+
+        void play() override;
+        bool is_playing() const override { return playing; }
+        void pause() override;
+        bool is_paused() const override { return paused; }
+        void stop() override;
+        bool is_stopped() const override { return !playing; }
+
+        void set_offset(unsigned int offset) override;
+        unsigned int get_offset() const override { return static_cast<unsigned int>(position); }
+        void set_volume(float new_volume) override;
+        float get_volume() const override { return volume; }
+        void set_pitch(float new_pitch) override;
+        float get_pitch() const override { return pitch; }
+
+        void set_looping(bool new_looping) override;
+        bool is_looping() const override { return looping; }
+        void set_loop_points(unsigned int start, unsigned int end) override;
+        std::pair<unsigned int, unsigned int> get_loop_points() const override { return loop_points; }
+        channel_group_type get_channel_group_type() const override { return channel_group; }
+        // Length in samples
+        unsigned int get_length() const { return length; }
+        // Move the playback position, called by the audio handle
+        void advance(double samples);
+    private:
+        null_audio_handle& audio;
+        // Music keeps its stream open like it would when streaming
+        std::unique_ptr<std::istream> stream;
+        channel_group_type channel_group;
+        std::string filename;
+        unsigned int length;
+        double position;
+        float volume;
+        float pitch;
+        bool looping;
+        std::pair<unsigned int, unsigned int> loop_points;
+        bool playing;
+        bool paused;
+    };
+}
+
+#endif
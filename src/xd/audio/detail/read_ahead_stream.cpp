@@ -0,0 +1,197 @@
+#include "read_ahead_stream.hpp"
+#include <algorithm>
+
+xd::detail::read_ahead_streambuf::read_ahead_streambuf(std::unique_ptr<std::istream> source,
+        std::size_t chunk_size, std::size_t chunk_count) :
+    m_source(std::move(source)),
+    m_size(-1),
+    m_chunk_size(std::max<std::size_t>(chunk_size, 1)),
+    m_chunk_count(std::max<std::size_t>(chunk_count, 1)),
+    m_current_offset(0),
+    m_read_offset(0),
+    m_generation(0),
+    m_chunks_read(0),
+    m_source_ended(false),
+    m_stop(false) {
+    if (m_source && *m_source) {
+        // The size is needed up front for seeking relative to the end
+        auto start = m_source->tellg();
+        m_source->seekg(0, std::ios::end);
+        auto end = m_source->tellg();
+        m_source->clear();
+        m_source->seekg(start);
+        if (start != std::streampos(-1) && end != std::streampos(-1)) {
+            m_size = static_cast<std::streamoff>(end);
+            m_read_offset = static_cast<std::streamoff>(start);
+            m_current_offset = m_read_offset;
+        }
+    } else {
+        m_source_ended = true;
+    }
+
+    setg(nullptr, nullptr, nullptr);
+    m_worker = std::thread(&read_ahead_streambuf::run, this);
+}
+
+xd::detail::read_ahead_streambuf::~read_ahead_streambuf() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wake_worker.notify_all();
+    m_chunk_ready.notify_all();
+    m_worker.join();
+}
+
+std::uint64_t xd::detail::read_ahead_streambuf::chunks_read() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_chunks_read;
+}
+
+void xd::detail::read_ahead_streambuf::run() {
+    std::vector<char> buffer(m_chunk_size);
+    // Where the source currently is, to avoid seeking between sequential reads
+    std::streamoff source_offset = m_read_offset;
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (!m_stop) {
+        if (m_source_ended || m_chunks.size() >= m_chunk_count) {
+            m_wake_worker.wait(lock);
+            continue;
+        }
+
+        auto offset = m_read_offset;
+        auto generation = m_generation;
+        lock.unlock();
+
+        if (offset != source_offset) {
+            m_source->clear();
+            m_source->seekg(offset);
+        }
+        m_source->read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        auto count = static_cast<std::size_t>(m_source->gcount());
+        source_offset = *m_source ? offset + static_cast<std::streamoff>(count) : -1;
+
+        lock.lock();
+        ++m_chunks_read;
+        // A seek happened while reading, the chunk is for the wrong position
+        if (generation != m_generation) continue;
+
+        if (count > 0) {
+            m_chunks.push_back(chunk{ offset, std::vector<char>(buffer.begin(), buffer.begin() + count) });
+            m_read_offset = offset + static_cast<std::streamoff>(count);
+        }
+        if (count < buffer.size()) {
+            m_source_ended = true;
+        }
+        m_chunk_ready.notify_all();
+    }
+}
+
+xd::detail::read_ahead_streambuf::int_type xd::detail::read_ahead_streambuf::underflow() {
+    if (gptr() < egptr()) return traits_type::to_int_type(*gptr());
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_chunk_ready.wait(lock, [this] { return !m_chunks.empty() || m_source_ended || m_stop; });
+    if (m_chunks.empty()) {
+        // Keep the position at the end of the last chunk
+        m_current_offset += static_cast<std::streamoff>(m_current.size());
+        m_current.clear();
+        setg(nullptr, nullptr, nullptr);
+        return traits_type::eof();
+    }
+
+    m_current = std::move(m_chunks.front().data);
+    m_current_offset = m_chunks.front().offset;
+    m_chunks.pop_front();
+    lock.unlock();
+    m_wake_worker.notify_one();
+
+    setg(m_current.data(), m_current.data(), m_current.data() + m_current.size());
+    return traits_type::to_int_type(*gptr());
+}
+
+std::streamsize xd::detail::read_ahead_streambuf::showmanyc() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::streamsize available = 0;
+    for (auto& queued : m_chunks) {
+        available += static_cast<std::streamsize>(queued.data.size());
+    }
+    if (available == 0 && m_source_ended) return -1;
+    return available;
+}
+
+std::streamoff xd::detail::read_ahead_streambuf::position() const {
+    if (!eback()) return m_current_offset;
+    return m_current_offset + (gptr() - eback());
+}
+
+xd::detail::read_ahead_streambuf::pos_type xd::detail::read_ahead_streambuf::seekoff(
+        off_type offset, std::ios_base::seekdir dir, std::ios_base::openmode which) {
+    if (!(which & std::ios_base::in)) return pos_type(off_type(-1));
+
+    std::streamoff target = offset;
+    if (dir == std::ios_base::cur) {
+        // tellg, nothing to do
+        if (offset == 0) return pos_type(position());
+        target = position() + offset;
+    } else if (dir == std::ios_base::end) {
+        if (m_size < 0) return pos_type(off_type(-1));
+        target = m_size + offset;
+    }
+
+    return seek_to(target);
+}
+
+xd::detail::read_ahead_streambuf::pos_type xd::detail::read_ahead_streambuf::seekpos(
+        pos_type position, std::ios_base::openmode which) {
+    if (!(which & std::ios_base::in)) return pos_type(off_type(-1));
+    return seek_to(static_cast<std::streamoff>(position));
+}
+
+xd::detail::read_ahead_streambuf::pos_type xd::detail::read_ahead_streambuf::seek_to(std::streamoff target) {
+    if (!m_source || target < 0 || (m_size >= 0 && target > m_size)) return pos_type(off_type(-1));
+
+    // Seeking within the current chunk doesn't involve the worker
+    auto current_end = m_current_offset + static_cast<std::streamoff>(m_current.size());
+    if (eback() && target >= m_current_offset && target < current_end) {
+        setg(eback(), eback() + (target - m_current_offset), egptr());
+        return pos_type(target);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        // Skip queued chunks before the target, useful for short forward seeks
+        while (!m_chunks.empty() && m_chunks.front().offset
+                + static_cast<std::streamoff>(m_chunks.front().data.size()) <= target
+                && m_chunks.front().offset >= current_end) {
+            current_end = m_chunks.front().offset + static_cast<std::streamoff>(m_chunks.front().data.size());
+            m_chunks.pop_front();
+        }
+
+        if (!m_chunks.empty() && target >= m_chunks.front().offset) {
+            m_current = std::move(m_chunks.front().data);
+            m_current_offset = m_chunks.front().offset;
+            m_chunks.pop_front();
+            setg(m_current.data(), m_current.data() + (target - m_current_offset),
+                m_current.data() + m_current.size());
+        } else {
+            m_chunks.clear();
+            ++m_generation;
+            m_read_offset = target;
+            m_source_ended = m_size >= 0 && target >= m_size;
+            m_current.clear();
+            m_current_offset = target;
+            setg(nullptr, nullptr, nullptr);
+        }
+    }
+    m_wake_worker.notify_one();
+    return pos_type(target);
+}
+
+xd::detail::read_ahead_stream::read_ahead_stream(std::unique_ptr<std::istream> source,
+        std::size_t chunk_size, std::size_t chunk_count) :
+    std::istream(nullptr),
+    m_buffer(std::move(source), chunk_size, chunk_count) {
+    rdbuf(&m_buffer);
+}
@@ -0,0 +1,87 @@
+#ifndef H_XD_AUDIO_DETAIL_READ_AHEAD_STREAM
+#define H_XD_AUDIO_DETAIL_READ_AHEAD_STREAM
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <istream>
+#include <memory>
+#include <mutex>
+#include <streambuf>
+#include <thread>
+#include <vector>
+
+namespace xd::detail {
+    // Stream buffer that reads a source stream on a worker thread, staying a few
+    // chunks ahead of the reader. Music is streamed while it plays, this keeps
+    // slow reads (e.g. decompressing from an archive) off the decoder's thread
+    class read_ahead_streambuf : public std::streambuf {
+    public:
+        static constexpr std::size_t default_chunk_size = 64 * 1024;
+        static constexpr std::size_t default_chunk_count = 4;
+
+        explicit read_ahead_streambuf(std::unique_ptr<std::istream> source,
+            std::size_t chunk_size = default_chunk_size,
+            std::size_t chunk_count = default_chunk_count);
+        read_ahead_streambuf(const read_ahead_streambuf&) = delete;
+        read_ahead_streambuf& operator=(const read_ahead_streambuf&) = delete;
+        ~read_ahead_streambuf() override;
+        // Size of the source in bytes, or -1 if it couldn't be determined
+        std::streamoff size() const noexcept { return m_size; }
+        // Number of chunks read from the source so far
+        std::uint64_t chunks_read() const;
+    protected:
+        int_type underflow() override;
+        std::streamsize showmanyc() override;
+        pos_type seekoff(off_type offset, std::ios_base::seekdir dir,
+            std::ios_base::openmode which = std::ios_base::in) override;
+        pos_type seekpos(pos_type position,
+            std::ios_base::openmode which = std::ios_base::in) override;
+    private:
+        struct chunk {
+            std::streamoff offset;
+            std::vector<char> data;
+        };
+
+        std::unique_ptr<std::istream> m_source;
+        std::streamoff m_size;
+        std::size_t m_chunk_size;
+        std::size_t m_chunk_count;
+        // Chunk the get area points into and where it starts in the source
+        std::vector<char> m_current;
+        std::streamoff m_current_offset;
+
+        mutable std::mutex m_mutex;
+        // Signaled when a chunk is ready or the source ended
+        std::condition_variable m_chunk_ready;
+        // Signaled when there's room for another chunk, or on seek or stop
+        std::condition_variable m_wake_worker;
+        std::deque<chunk> m_chunks;
+        // Where the worker reads the next chunk from
+        std::streamoff m_read_offset;
+        // Bumped on every seek so chunks read for an old position are dropped
+        std::uint64_t m_generation;
+        std::uint64_t m_chunks_read;
+        bool m_source_ended;
+        bool m_stop;
+        std::thread m_worker;
+
+        void run();
+        std::streamoff position() const;
+        pos_type seek_to(std::streamoff target);
+    };
+
+    // Input stream that owns a read_ahead_streambuf
+    class read_ahead_stream : public std::istream {
+    public:
+        explicit read_ahead_stream(std::unique_ptr<std::istream> source,
+            std::size_t chunk_size = read_ahead_streambuf::default_chunk_size,
+            std::size_t chunk_count = read_ahead_streambuf::default_chunk_count);
+        read_ahead_streambuf& buffer() noexcept { return m_buffer; }
+    private:
+        read_ahead_streambuf m_buffer;
+    };
+}
+
+#endif
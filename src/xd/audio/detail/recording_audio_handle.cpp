@@ -0,0 +1,53 @@
+#include "recording_audio_handle.hpp"
+#include <algorithm>
+
+xd::detail::recording_audio_handle::recording_audio_handle(float update_seconds) :
+    null_audio_handle(update_seconds),
+    peak_playing_count(0) {}
+
+void xd::detail::recording_audio_handle::record(audio_call call, const std::string& filename,
+        unsigned int first, unsigned int second, float value) {
+    // Read before locking, these lock the handle's own mutex
+    auto time = get_time();
+    auto playing_count = get_playing_count();
+
+    std::lock_guard<std::mutex> lock(records_mutex);
+    records.push_back(audio_call_record{ call, filename, first, second, value, time });
+    peak_playing_count = std::max(peak_playing_count, playing_count);
+}
+
+std::vector<xd::detail::audio_call_record> xd::detail::recording_audio_handle::get_records() const {
+    std::lock_guard<std::mutex> lock(records_mutex);
+    return records;
+}
+
+std::vector<xd::detail::audio_call_record> xd::detail::recording_audio_handle::get_records(
+        audio_call call, const std::string& filename) const {
+    std::lock_guard<std::mutex> lock(records_mutex);
+    std::vector<audio_call_record> result;
+    std::copy_if(records.begin(), records.end(), std::back_inserter(result),
+        [&](const audio_call_record& record) {
+            return record.call == call && (filename.empty() || record.filename == filename);
+        });
+    return result;
+}
+
+std::size_t xd::detail::recording_audio_handle::count(audio_call call, const std::string& filename) const {
+    std::lock_guard<std::mutex> lock(records_mutex);
+    return static_cast<std::size_t>(std::count_if(records.begin(), records.end(),
+        [&](const audio_call_record& record) {
+            return record.call == call && (filename.empty() || record.filename == filename);
+        }));
+}
+
+std::size_t xd::detail::recording_audio_handle::get_peak_playing_count() const {
+    std::lock_guard<std::mutex> lock(records_mutex);
+    return peak_playing_count;
+}
+
+void xd::detail::recording_audio_handle::clear_records() {
+    auto playing_count = get_playing_count();
+    std::lock_guard<std::mutex> lock(records_mutex);
+    records.clear();
+    peak_playing_count = playing_count;
+}
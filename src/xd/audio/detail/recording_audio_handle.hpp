@@ -0,0 +1,47 @@
+#ifndef H_XD_AUDIO_DETAIL_RECORDING_AUDIO_HANDLE
+#define H_XD_AUDIO_DETAIL_RECORDING_AUDIO_HANDLE
+
+#include "null_audio_handle.hpp"
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace xd::detail {
+    struct audio_call_record {
+        audio_call call;
+        // Empty for channel group calls
+        std::string filename;
+        // Length for open and share, offset for seek, start and end for loop points,
+        // 1 or 0 for set_looping, the channel group for group calls
+        unsigned int first;
+        unsigned int second;
+        // Volume or pitch
+        float value;
+        // Simulated time of the call, in seconds
+        double time;
+    };
+
+    // Null audio handle that keeps a log of every call so tests can check what
+    // the game asked for, and how many channels played at once
+    class recording_audio_handle : public null_audio_handle
+    {
+    public:
+        explicit recording_audio_handle(float update_seconds = 0.0f);
+        void record(audio_call call, const std::string& filename,
+            unsigned int first = 0, unsigned int second = 0, float value = 0.0f) override;
+        std::vector<audio_call_record> get_records() const;
+        // Calls of the given type, optionally only for one file
+        std::vector<audio_call_record> get_records(audio_call call, const std::string& filename = "") const;
+        std::size_t count(audio_call call, const std::string& filename = "") const;
+        // Most sounds that played at the same time since the last clear
+        std::size_t get_peak_playing_count() const;
+        void clear_records();
+    private:
+        mutable std::mutex records_mutex;
+        std::vector<audio_call_record> records;
+        std::size_t peak_playing_count;
+    };
+}
+
+#endif
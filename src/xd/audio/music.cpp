@@ -1,9 +1,19 @@
 #include "audio.hpp"
 #include "music.hpp"
 #include "sound.hpp"
+#include "detail/read_ahead_stream.hpp"
 #include <istream>
 #include <memory>
 
+namespace xd::detail {
+    // Music is streamed while playing, read ahead of the decoder on a worker
+    static std::unique_ptr<std::istream> read_ahead(std::unique_ptr<std::istream> stream) {
+        // Leave missing files for the audio handle to report
+        if (!stream || !*stream) return stream;
+        return std::make_unique<read_ahead_stream>(std::move(stream));
+    }
+}
+
 xd::music::music(audio& audio, const std::string& filename,
         std::unique_ptr<std::istream> stream)
-    : xd::sound(audio, filename, std::move(stream), channel_group_type::music) {}
+    : xd::sound(audio, filename, detail::read_ahead(std::move(stream)), channel_group_type::music) {}
@@ -14,7 +14,11 @@ xd::sound::sound(audio& audio, const std::string& filename,
     // Set loop points if specified in tags
     if (group_type != channel_group_type::music) return;
 
-    auto tag_info = m_handle->read_tagged_loop_points();
+    auto cached_info = audio.get_cached_loop_info(filename);
+    auto tag_info = cached_info ? *cached_info : m_handle->read_tagged_loop_points();
+    if (!cached_info) {
+        audio.cache_loop_info(filename, tag_info);
+    }
     // Set loop points if needed
     if (!tag_info.has_loop_points()) return;
 
@@ -23,6 +27,9 @@ xd::sound::sound(audio& audio, const std::string& filename,
     set_loop_points(tag_info.loop_start, tag_info.loop_end);
 }
 
+xd::sound::sound(audio& audio, const sound& source, channel_group_type group_type)
+    : m_handle(audio.get_handle()->create_sound_instance(*source.m_handle, group_type)) {}
+
 xd::sound::~sound() {}
 
 void xd::sound::play()
@@ -23,6 +23,9 @@ namespace xd
         sound& operator=(const sound&) = delete;
         sound(audio& audio, const std::string& filename,
             std::unique_ptr<std::istream> stream, channel_group_type group_type);
+        // Another instance of an already loaded (non-music) sound, sharing its
+        // decoded data but playing and taking volume, pitch etc. separately
+        sound(audio& audio, const sound& source, channel_group_type group_type);
         virtual ~sound();
 
         void play();
@@ -0,0 +1,182 @@
+#include "sound_bank.hpp"
+#include "audio.hpp"
+#include "sound.hpp"
+#include <istream>
+
+bool xd::voice_handle::valid() const {
+    return m_bank && m_bank->get_voice(*this);
+}
+
+bool xd::voice_handle::playing() const {
+    if (!m_bank) return false;
+    auto voice = m_bank->get_voice(*this);
+    return voice && voice->instance->playing();
+}
+
+void xd::voice_handle::stop() {
+    if (!m_bank) return;
+    if (auto voice = m_bank->get_voice(*this)) {
+        voice->instance->stop();
+    }
+}
+
+void xd::voice_handle::set_volume(float volume) {
+    if (!m_bank) return;
+    if (auto voice = m_bank->get_voice(*this)) {
+        voice->instance->set_volume(volume);
+    }
+}
+
+void xd::voice_handle::set_priority(float priority) {
+    if (!m_bank) return;
+    if (auto voice = m_bank->get_voice(*this)) {
+        voice->priority = priority;
+    }
+}
+
+xd::sound_bank::sound_bank(audio& audio, std::size_t voice_count) :
+    m_audio(audio),
+    m_voices(voice_count),
+    m_voices_per_sound(default_voices_per_sound) {}
+
+xd::sound_bank::~sound_bank() {}
+
+std::shared_ptr<xd::sound> xd::sound_bank::load(const std::string& filename, const stream_opener& open) {
+    auto i = m_sounds.find(filename);
+    if (i != m_sounds.end()) return i->second;
+
+    // The group doesn't matter, the source is only played through instances
+    auto source = std::make_shared<sound>(m_audio, filename, open(), channel_group_type::sound);
+    m_sounds.emplace(filename, source);
+    return source;
+}
+
+bool xd::sound_bank::is_loaded(const std::string& filename) const {
+    return m_sounds.find(filename) != m_sounds.end();
+}
+
+std::size_t xd::sound_bank::release_unused() {
+    for (auto& voice : m_voices) {
+        if (voice.instance && !voice.instance->playing()) {
+            // Handles to the voice become invalid along with the instance
+            voice.instance.reset();
+            voice.source.reset();
+        }
+    }
+
+    std::size_t released = 0;
+    for (auto i = m_sounds.begin(); i != m_sounds.end();) {
+        if (i->second.use_count() == 1) {
+            i = m_sounds.erase(i);
+            ++released;
+        } else {
+            ++i;
+        }
+    }
+    return released;
+}
+
+xd::voice_handle xd::sound_bank::play(const std::shared_ptr<sound>& source, channel_group_type group_type,
+        float volume, float pitch, float priority) {
+    if (!source || m_voices.empty()) return voice_handle();
+
+    // Prefer an idle voice that already has an instance of the sound
+    voice* idle = nullptr;
+    voice* idle_same_source = nullptr;
+    voice* lowest = nullptr;
+    voice* lowest_same_source = nullptr;
+    std::size_t same_source_playing = 0;
+    for (auto& voice : m_voices) {
+        auto same_source = voice.source == source;
+        if (!voice.instance || !voice.instance->playing()) {
+            if (same_source && !idle_same_source) {
+                idle_same_source = &voice;
+            } else if (!idle) {
+                idle = &voice;
+            }
+            continue;
+        }
+
+        if (!lowest || voice.priority < lowest->priority) {
+            lowest = &voice;
+        }
+        if (same_source) {
+            ++same_source_playing;
+            if (!lowest_same_source || voice.priority < lowest_same_source->priority) {
+                lowest_same_source = &voice;
+            }
+        }
+    }
+
+    voice* target = nullptr;
+    if (m_voices_per_sound > 0 && same_source_playing >= m_voices_per_sound) {
+        target = lowest_same_source;
+    } else if (idle_same_source || idle) {
+        target = idle_same_source ? idle_same_source : idle;
+    } else {
+        target = lowest;
+    }
+
+    if (target->instance && target->instance->playing()) {
+        // Don't cut off a sound that's at least as important
+        if (target->priority >= priority) return voice_handle();
+        target->instance->stop();
+    }
+
+    auto reuse_instance = target->instance
+        && target->source == source
+        && target->instance->get_channel_group_type() == group_type;
+    if (!reuse_instance) {
+        target->instance = std::make_unique<sound>(m_audio, *source, group_type);
+        target->source = source;
+    }
+
+    ++target->generation;
+    target->priority = priority;
+    target->instance->set_pitch(pitch);
+    target->instance->set_volume(volume);
+    target->instance->play();
+
+    auto index = static_cast<std::size_t>(target - m_voices.data());
+    return voice_handle(this, index, target->generation);
+}
+
+void xd::sound_bank::set_voice_count(std::size_t count) {
+    stop_all();
+    // Generations carry over so handles to removed or moved voices stay invalid
+    std::vector<voice> voices(count);
+    for (std::size_t i = 0; i < count && i < m_voices.size(); ++i) {
+        voices[i].generation = m_voices[i].generation + 1;
+    }
+    m_voices = std::move(voices);
+}
+
+std::size_t xd::sound_bank::get_playing_count(const std::string& filename) const {
+    std::size_t count = 0;
+    for (auto& voice : m_voices) {
+        auto playing = voice.instance && voice.instance->playing()
+            && (filename.empty() || voice.instance->get_filename() == filename);
+        if (playing) ++count;
+    }
+    return count;
+}
+
+void xd::sound_bank::stop_all() {
+    for (auto& voice : m_voices) {
+        if (voice.instance) {
+            voice.instance->stop();
+        }
+    }
+}
+
+xd::sound_bank::voice* xd::sound_bank::get_voice(const voice_handle& handle) {
+    if (handle.m_index >= m_voices.size()) return nullptr;
+    auto& voice = m_voices[handle.m_index];
+    return voice.instance && voice.generation == handle.m_generation ? &voice : nullptr;
+}
+
+const xd::sound_bank::voice* xd::sound_bank::get_voice(const voice_handle& handle) const {
+    if (handle.m_index >= m_voices.size()) return nullptr;
+    auto& voice = m_voices[handle.m_index];
+    return voice.instance && voice.generation == handle.m_generation ? &voice : nullptr;
+}
@@ -0,0 +1,102 @@
+#ifndef H_XD_AUDIO_SOUND_BANK
+#define H_XD_AUDIO_SOUND_BANK
+
+#include "channel_group_type.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace xd
+{
+    class audio;
+    class sound;
+    class sound_bank;
+
+    // Refers to a sound played by a sound_bank voice. Voices are reused, once
+    // the voice gets stolen or plays something else the handle does nothing
+    class voice_handle
+    {
+    public:
+        voice_handle() noexcept : m_bank(nullptr), m_index(0), m_generation(0) {}
+        // Is the voice still assigned to this sound?
+        bool valid() const;
+        bool playing() const;
+        void stop();
+        void set_volume(float volume);
+        // Used to pick which voice to steal, see sound_bank::play
+        void set_priority(float priority);
+        explicit operator bool() const { return valid(); }
+    private:
+        friend class sound_bank;
+        voice_handle(sound_bank* bank, std::size_t index, std::uint32_t generation) noexcept
+            : m_bank(bank), m_index(index), m_generation(generation) {}
+        sound_bank* m_bank;
+        std::size_t m_index;
+        std::uint32_t m_generation;
+    };
+
+    // Sounds decoded once per file and shared, played on a fixed number of
+    // voices. Each file can only use a few voices at once; when a file or the
+    // whole bank runs out the playing voice with the lowest priority is stolen
+    class sound_bank
+    {
+    public:
+        typedef std::function<std::unique_ptr<std::istream>()> stream_opener;
+        static constexpr std::size_t default_voice_count = 32;
+        static constexpr std::size_t default_voices_per_sound = 4;
+
+        sound_bank(const sound_bank&) = delete;
+        sound_bank& operator=(const sound_bank&) = delete;
+        explicit sound_bank(audio& audio, std::size_t voice_count = default_voice_count);
+        ~sound_bank();
+        // Get the decoded sound for a file, opening and decoding it on first use.
+        // Use it as the source of sound instances or play it with play()
+        std::shared_ptr<sound> load(const std::string& filename, const stream_opener& open);
+        bool is_loaded(const std::string& filename) const;
+        std::size_t get_loaded_count() const { return m_sounds.size(); }
+        // Free the decoded sounds nothing else refers to anymore (e.g. after
+        // a map change), idle voices let go of their sound first. Returns
+        // the number of sounds freed
+        std::size_t release_unused();
+        // Play a loaded sound on a free voice, or steal the playing voice with
+        // the lowest priority if this one is higher. Returns an invalid handle
+        // if nothing could be stolen
+        voice_handle play(const std::shared_ptr<sound>& source, channel_group_type group_type,
+            float volume = 1.0f, float pitch = 1.0f, float priority = 0.0f);
+        // Change the number of voices, stopping any that are playing
+        void set_voice_count(std::size_t count);
+        std::size_t get_voice_count() const { return m_voices.size(); }
+        // How many voices a single file can play on at once, 0 for no limit
+        void set_voices_per_sound(std::size_t count) { m_voices_per_sound = count; }
+        std::size_t get_voices_per_sound() const { return m_voices_per_sound; }
+        // Number of voices playing, optionally only for one file
+        std::size_t get_playing_count(const std::string& filename = "") const;
+        // Stop all voices
+        void stop_all();
+    private:
+        friend class voice_handle;
+        struct voice {
+            // Instance of the source sound, created when first needed
+            std::unique_ptr<sound> instance;
+            std::shared_ptr<sound> source;
+            float priority;
+            // Bumped every time the voice is played, to invalidate old handles
+            std::uint32_t generation;
+        };
+
+        audio& m_audio;
+        std::unordered_map<std::string, std::shared_ptr<sound>> m_sounds;
+        std::vector<voice> m_voices;
+        std::size_t m_voices_per_sound;
+
+        voice* get_voice(const voice_handle& handle);
+        const voice* get_voice(const voice_handle& handle) const;
+    };
+}
+
+#endif
@@ -0,0 +1,226 @@
+#ifndef H_XD_DETAIL_COMPONENT_STORAGE
+#define H_XD_DETAIL_COMPONENT_STORAGE
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace xd
+{
+    // identifies a component added to an entity, stays valid until the
+    // component is removed no matter what else is added or removed
+    typedef std::uint32_t component_handle;
+    constexpr component_handle invalid_component_handle = 0;
+}
+
+namespace xd { namespace detail {
+
+    // components of one kind (logic or render) stored contiguously, sorted by
+    // priority and then by insertion order. iteration only touches a flat array
+    // of raw pointers, ownership is kept in a parallel array. the components
+    // themselves are still allocated separately, since they're polymorphic and
+    // can be shared between entities. components added or removed while
+    // iterating take effect once the iteration is done
+    template <typename Component>
+    class component_storage
+    {
+    public:
+        typedef std::shared_ptr<Component> pointer;
+
+        component_storage() : m_iterating(0), m_dirty(false) {}
+
+        void add(const pointer& component, int priority, component_handle handle)
+        {
+            if (m_iterating > 0) {
+                m_pending.push_back(pending_entry{entry{priority, handle, component.get()}, component});
+                return;
+            }
+            insert(entry{priority, handle, component.get()}, component);
+        }
+
+        // remove by handle, returns whether the component was found
+        bool remove(component_handle handle)
+        {
+            return remove_if([handle](const entry& e) { return e.handle == handle; });
+        }
+
+        // remove every occurrence of the component
+        bool remove(const Component* component)
+        {
+            return remove_if([component](const entry& e) { return e.component == component; });
+        }
+
+        // remove the component if it was added with the given priority
+        bool remove(const Component* component, int priority)
+        {
+            return remove_if([component, priority](const entry& e) {
+                return e.component == component && e.priority == priority;
+            });
+        }
+
+        void clear()
+        {
+            m_pending.clear();
+            if (m_iterating > 0) {
+                for (auto& e : m_entries) {
+                    e.component = nullptr;
+                }
+                m_dirty = true;
+                return;
+            }
+            m_entries.clear();
+            m_owners.clear();
+        }
+
+        bool contains(component_handle handle) const
+        {
+            auto found = [handle](const entry& e) { return e.handle == handle && e.component; };
+            return std::any_of(m_entries.begin(), m_entries.end(), found)
+                || std::any_of(m_pending.begin(), m_pending.end(),
+                    [handle](const pending_entry& p) { return p.value.handle == handle; });
+        }
+
+        std::size_t size() const noexcept
+        {
+            std::size_t count = m_pending.size();
+            for (auto& e : m_entries) {
+                count += e.component != nullptr;
+            }
+            return count;
+        }
+
+        // call func for each component in priority order
+        template <typename Func>
+        void for_each(Func&& func)
+        {
+            ++m_iterating;
+            // indexing instead of iterators, the array doesn't change size while
+            // iterating but func may still remove entries, which nulls them
+            for (std::size_t i = 0; i < m_entries.size(); ++i) {
+                if (auto component = m_entries[i].component) {
+                    func(*component);
+                }
+            }
+            if (--m_iterating == 0) {
+                flush();
+            }
+        }
+
+    private:
+        struct entry
+        {
+            int priority;
+            component_handle handle;
+            Component* component;
+        };
+
+        struct pending_entry
+        {
+            entry value;
+            pointer owner;
+        };
+
+        std::vector<entry> m_entries;
+        std::vector<pointer> m_owners;
+        std::vector<pending_entry> m_pending;
+        int m_iterating;
+        bool m_dirty;
+
+        void insert(const entry& value, const pointer& owner)
+        {
+            auto position = std::upper_bound(m_entries.begin(), m_entries.end(), value.priority,
+                [](int priority, const entry& e) { return priority < e.priority; });
+            auto index = position - m_entries.begin();
+            m_entries.insert(position, value);
+            m_owners.insert(m_owners.begin() + index, owner);
+        }
+
+        template <typename Pred>
+        bool remove_if(Pred pred)
+        {
+            bool removed = false;
+            for (auto& e : m_entries) {
+                if (e.component && pred(e)) {
+                    e.component = nullptr;
+                    removed = true;
+                }
+            }
+
+            auto pending_end = std::remove_if(m_pending.begin(), m_pending.end(),
+                [&pred](const pending_entry& p) { return pred(p.value); });
+            removed = removed || pending_end != m_pending.end();
+            m_pending.erase(pending_end, m_pending.end());
+
+            if (removed) {
+                m_dirty = true;
+                if (m_iterating == 0) {
+                    flush();
+                }
+            }
+            return removed;
+        }
+
+        // compact removed entries and insert the ones added while iterating
+        void flush()
+        {
+            if (m_dirty) {
+                std::size_t kept = 0;
+                for (std::size_t i = 0; i < m_entries.size(); ++i) {
+                    if (!m_entries[i].component) continue;
+                    if (kept != i) {
+                        m_entries[kept] = m_entries[i];
+                        m_owners[kept] = std::move(m_owners[i]);
+                    }
+                    ++kept;
+                }
+                m_entries.resize(kept);
+                m_owners.resize(kept);
+                m_dirty = false;
+            }
+
+            if (!m_pending.empty()) {
+                auto pending = std::move(m_pending);
+                m_pending.clear();
+                for (auto& p : pending) {
+                    insert(p.value, p.owner);
+                }
+            }
+        }
+    };
+
+    // index of a per-entity data slot, assigned once per type the first time
+    // it's used so lookups are a plain array access
+    inline std::size_t next_data_slot()
+    {
+        static std::atomic<std::size_t> next{0};
+        return next++;
+    }
+
+    template <typename T>
+    std::size_t data_slot()
+    {
+        static const std::size_t slot = next_data_slot();
+        return slot;
+    }
+
+    class data_holder_base
+    {
+    public:
+        virtual ~data_holder_base() {}
+    };
+
+    template <typename T>
+    class data_holder : public data_holder_base
+    {
+    public:
+        T value;
+        data_holder() : value() {}
+    };
+
+} }
+
+#endif
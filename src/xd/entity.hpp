@@ -1,17 +1,17 @@
 #ifndef H_XD_ENTITY
 #define H_XD_ENTITY
 
+#include "detail/component_storage.hpp"
 #include "detail/entity.hpp"
 #include "detail/identity.hpp"
 #include "event_bus.hpp"
 #include <algorithm>
 #include <any>
 #include <functional>
-#include <list>
-#include <map>
 #include <memory>
 #include <type_traits>
 #include <unordered_map>
+#include <vector>
 
 namespace xd
 {
@@ -53,11 +53,13 @@ namespace xd
         template <typename T>
         T& get()
         {
-            std::size_t hash = typeid(T).hash_code();
-            auto i = m_type_to_data.find(hash);
-            if (i == m_type_to_data.end())
-                i = m_type_to_data.emplace(hash, T()).first;
-            return *std::any_cast<T>(&i->second);
+            auto slot = detail::data_slot<T>();
+            if (slot >= m_type_to_data.size())
+                m_type_to_data.resize(slot + 1);
+            auto& data = m_type_to_data[slot];
+            if (!data)
+                data = std::make_unique<detail::data_holder<T>>();
+            return static_cast<detail::data_holder<T>&>(*data).value;
         }
 
         template <typename T>
@@ -72,8 +74,8 @@ namespace xd
         template <typename T>
         bool has()
         {
-            std::size_t hash = typeid(T).hash_code();
-            return m_type_to_data.find(hash) != m_type_to_data.end();
+            auto slot = detail::data_slot<T>();
+            return slot < m_type_to_data.size() && m_type_to_data[slot];
         }
 
         template <typename T>
@@ -85,25 +87,25 @@ namespace xd
         template <typename T>
         void on(const std::string& name, std::function<bool (const T&)> callback, std::function<bool (const T&)> filter = nullptr)
         {
-            get_event_bus<T>()[name].add(callback);
+            get_event_bus<T>()[name].add(callback, filter);
         }
 
         template <typename T>
         void on(const std::string& name, bool (*callback)(const T&), std::function<bool (const typename detail::identity<T>::type&)> filter = nullptr)
         {
-            get_event_bus<T>()[name].add(callback);
+            get_event_bus<T>()[name].add(callback, filter);
         }
 
         template <typename T, typename C>
         void on(const std::string& name, bool (C::*callback)(const T&), C *obj, std::function<bool (const typename detail::identity<T>::type&)> filter = nullptr)
         {
-            get_event_bus<T>()[name].add(std::bind(callback, obj, std::placeholders::_1));
+            get_event_bus<T>()[name].add(std::bind(callback, obj, std::placeholders::_1), filter);
         }
 
         template <typename T, typename C>
         void on(const std::string& name, bool (C::*callback)(const T&) const, C *obj, std::function<bool (const typename detail::identity<T>::type&)> filter = nullptr)
         {
-            get_event_bus<T>()[name].add(std::bind(callback, obj, std::placeholders::_1));
+            get_event_bus<T>()[name].add(std::bind(callback, obj, std::placeholders::_1), filter);
         }
 
         template <typename T>
@@ -126,148 +128,149 @@ namespace xd
             get_event_bus<T>()[name](args);
         }
 
-        void add_component(const logic_component_ptr& component, int priority = 0)
+        // ID of the named event for the given argument type, triggering by ID
+        // skips looking up the name
+        template <typename T>
+        event_id get_event_id(const std::string& name)
+        {
+            return get_event_bus<T>().id(name);
+        }
+
+        template <typename T>
+        void trigger(event_id id, const T& args)
         {
-            m_components[priority].logic_components.push_back(component);
+            get_event_bus<T>()[id](args);
+        }
+
+        component_handle add_component(const logic_component_ptr& component, int priority = 0)
+        {
+            auto handle = next_component_handle();
+            m_logic_components.add(component, priority, handle);
             component->init(*static_cast<Class*>(this));
+            return handle;
         }
 
-        void add_component(const render_component_ptr& component, int priority = 0)
+        component_handle add_component(const render_component_ptr& component, int priority = 0)
         {
-            m_components[priority].render_components.push_back(component);
+            auto handle = next_component_handle();
+            m_render_components.add(component, priority, handle);
             component->init(*static_cast<Class*>(this));
+            return handle;
         }
 
-        void add_component(const component_ptr& component, int priority = 0)
+        component_handle add_component(const component_ptr& component, int priority = 0)
         {
-            m_components[priority].logic_components.push_back(component);
-            m_components[priority].render_components.push_back(component);
+            auto handle = next_component_handle();
+            m_logic_components.add(component, priority, handle);
+            m_render_components.add(component, priority, handle);
             component->init(*static_cast<Class*>(this));
+            return handle;
         }
 
         void del_component(const logic_component_ptr& component, int priority)
         {
-            logic_component_list_t& components = m_components[priority].logic_components;
-            auto i = std::find(components.begin(), components.end(), component);
-            if (i != components.end()) {
-                components.erase(i);
-            }
+            m_logic_components.remove(component.get(), priority);
         }
 
         void del_component(const logic_component_ptr& component)
         {
-            for (auto i = m_components.begin(); i != m_components.end(); ++i) {
-                del_component(component, i->first);
-            }
+            m_logic_components.remove(component.get());
         }
 
         void del_component(const render_component_ptr& component, int priority)
         {
-            logic_component_list_t& components = m_components[priority].logic_components;
-            auto i = std::find(components.begin(), components.end(), component);
-            if (i != components.end()) {
-                components.erase(i);
-            }
+            m_render_components.remove(component.get(), priority);
         }
 
         void del_component(const render_component_ptr& component)
         {
-            for (auto i = m_components.begin(); i != m_components.end(); ++i) {
-                del_component(component, i->first);
-            }
+            m_render_components.remove(component.get());
         }
 
         void del_component(const component_ptr& component, int priority)
         {
-            components_set& components = m_components[priority];
-            {
-                auto i = std::find(components.logic_components.begin(), components.logic_components.end(), component);
-                if (i != components.logic_components.end()) {
-                    components.logic_components.erase(i);
-                }
-            }
-            {
-                auto i = std::find(components.render_components.begin(), components.render_components.end(), component);
-                if (i != components.render_components.end()) {
-                    components.render_components.erase(i);
-                }
-            }
+            m_logic_components.remove(component.get(), priority);
+            m_render_components.remove(component.get(), priority);
         }
 
         void del_component(const component_ptr& component)
         {
-            for (auto i = m_components.begin(); i != m_components.end(); ++i) {
-                del_component(component, i->first);
-            }
+            m_logic_components.remove(component.get());
+            m_render_components.remove(component.get());
+        }
+
+        // remove the component added with the given handle
+        bool del_component(component_handle handle)
+        {
+            bool logic_removed = m_logic_components.remove(handle);
+            bool render_removed = m_render_components.remove(handle);
+            return logic_removed || render_removed;
+        }
+
+        bool has_component(component_handle handle) const
+        {
+            return m_logic_components.contains(handle) || m_render_components.contains(handle);
         }
 
         void clear_components()
         {
-            m_components.clear();
+            m_logic_components.clear();
+            m_render_components.clear();
         }
 
+        // components are called in priority order, then in the order they were
+        // added. changes made to the components while updating or rendering
+        // take effect on the next update or render
         void update()
         {
-            for (auto i = m_components.begin(); i != m_components.end(); ++i) {
-                auto& logic_components = i->second.logic_components;
-                for (auto j = logic_components.begin(); j != logic_components.end(); ++j) {
-                    (*j)->update(*static_cast<Class*>(this));
-                }
-            }
+            m_logic_components.for_each([this](detail::logic_component<Class>& component) {
+                component.update(*static_cast<Class*>(this));
+            });
         }
 
         void render()
         {
-            for (auto i = m_components.begin(); i != m_components.end(); ++i) {
-                auto& render_components = i->second.render_components;
-                for (auto j = render_components.begin(); j != render_components.end(); ++j) {
-                    (*j)->render(*static_cast<Class*>(this));
-                }
-            }
+            m_render_components.for_each([this](detail::render_component<Class>& component) {
+                component.render(*static_cast<Class*>(this));
+            });
         }
 
     protected:
         // you should always construct entity using the derived class
         // hence constructor is protected to prevent mistakes
-        entity()
+        entity() : m_last_component_handle(invalid_component_handle)
         {
         }
 
     private:
-        typedef std::list<std::shared_ptr<detail::logic_component<Class>>> logic_component_list_t;
-        typedef std::list<std::shared_ptr<detail::render_component<Class>>> render_component_list_t;
-
-        // data
-        std::unordered_map<std::size_t, std::any> m_type_to_data;
+        // data, typed data is indexed by its slot
+        std::vector<std::unique_ptr<detail::data_holder_base>> m_type_to_data;
         std::unordered_map<std::string, std::any> m_key_to_data;
 
-        // internal struct to hold component lists per priority
-        struct components_set
-        {
-            logic_component_list_t logic_components;
-            render_component_list_t render_components;
-        };
-
-        // we have a list of logic and render components per priority
-        std::map<int, components_set> m_components;
+        // logic and render components, each stored contiguously in priority order
+        detail::component_storage<detail::logic_component<Class>> m_logic_components;
+        detail::component_storage<detail::render_component<Class>> m_render_components;
+        component_handle m_last_component_handle;
 
-        // the bound events
-        std::unordered_map<std::size_t, std::any> m_events;
+        // the bound events, indexed by the slot of the event bus type
+        std::vector<std::unique_ptr<detail::data_holder_base>> m_events;
 
         // utility function to return event_bus for given arg type
         template <typename T>
         event_bus<T>& get_event_bus()
         {
-            // calculate hash of the argument type
-            std::size_t hash = typeid(T).hash_code();
-            // find from the events
-            auto i = m_events.find(hash);
-            if (i == m_events.end()) {
-                // not found, insert an empty event_bus
-                m_events[hash] = event_bus<T>();
-            }
-            // return the event bus
-            return *std::any_cast<event_bus<T>>(&m_events[hash]);
+            auto slot = detail::data_slot<event_bus<T>>();
+            if (slot >= m_events.size())
+                m_events.resize(slot + 1);
+            auto& events = m_events[slot];
+            if (!events)
+                events = std::make_unique<detail::data_holder<event_bus<T>>>();
+            return static_cast<detail::data_holder<event_bus<T>>&>(*events).value;
+        }
+
+        component_handle next_component_handle()
+        {
+            return ++m_last_component_handle;
         }
     };
 }
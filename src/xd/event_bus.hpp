@@ -1,11 +1,14 @@
 #ifndef H_XD_EVENT_BUS
 #define H_XD_EVENT_BUS
 
-#include <list>
+#include <algorithm>
+#include <deque>
+#include <functional>
 #include <string>
 #include <stdexcept>
 #include <unordered_map>
-#include <functional>
+#include <utility>
+#include <vector>
 
 namespace xd
 {
@@ -51,7 +54,9 @@ namespace xd
         filter_t m_filter;
     };
 
-    // event info class, holds list of callbacks for an event
+    // event info class, holds the callbacks for an event. callbacks are stored
+    // contiguously and can be added or removed while the event is dispatched,
+    // such changes take effect once the dispatch is over
     template <typename Args>
     class event_info
     {
@@ -60,34 +65,33 @@ namespace xd
 
         event_info() noexcept
             : m_counter(0)
+            , m_dispatching(0)
+            , m_dirty(false)
         {
         }
 
         event_link add(typename event_callback_t::callback_t callback, event_placement placement = event_placement::EVENT_PREPEND)
         {
-            std::size_t link = m_counter++;
-            if (placement == event_placement::EVENT_PREPEND)
-                m_callbacks.emplace_front(link, event_callback_t(callback));
-            else
-                m_callbacks.emplace_back(link, event_callback_t(callback));
-            return link;
+            return insert(event_callback_t(std::move(callback)), placement);
         }
 
         event_link add(typename event_callback_t::callback_t callback, typename event_callback_t::filter_t filter, event_placement placement = event_placement::EVENT_PREPEND)
         {
-            std::size_t link = m_counter++;
-            if (placement == event_placement::EVENT_PREPEND)
-                m_callbacks.emplace_front(link, event_callback_t(callback, filter));
-            else
-                m_callbacks.emplace_back(link, event_callback_t(callback, filter));
-            return link;
+            return insert(event_callback_t(std::move(callback), filter), placement);
         }
 
         void remove(event_link link)
         {
-            for (auto i = m_callbacks.begin(); i != m_callbacks.end(); ++i) {
-                if (i->first == link) {
-                    m_callbacks.erase(i);
+            for (auto& entry : m_callbacks) {
+                if (entry.link == link && !entry.removed) {
+                    erase(entry);
+                    return;
+                }
+            }
+
+            for (auto i = m_pending.begin(); i != m_pending.end(); ++i) {
+                if (i->first.link == link) {
+                    m_pending.erase(i);
                     return;
                 }
             }
@@ -96,23 +100,89 @@ namespace xd
             throw std::invalid_argument("link");
         }
 
-        void operator()(const Args& args) const
+        void operator()(const Args& args)
         {
-            // iterate through all callbacks
-            for (auto i = m_callbacks.begin(); i != m_callbacks.end(); ++i) {
-                bool status = (i->second)(args); // call the callback
+            ++m_dispatching;
+            // indexing instead of iterators: the array doesn't change size while
+            // dispatching, removed callbacks are only flagged
+            for (std::size_t i = 0; i < m_callbacks.size(); ++i) {
+                auto& entry = m_callbacks[i];
+                if (entry.removed)
+                    continue;
+                bool status = entry.callback(args); // call the callback
                 if (!status)
                     break;
             }
+            if (--m_dispatching == 0)
+                flush();
         }
     protected:
-        typedef std::list<std::pair<event_link, event_callback_t> > callback_list_t;
-
-        callback_list_t m_callbacks;
+        struct callback_entry
+        {
+            event_link link;
+            event_callback_t callback;
+            bool removed;
+        };
+
+        std::vector<callback_entry> m_callbacks;
+        // callbacks added while dispatching
+        std::vector<std::pair<callback_entry, event_placement>> m_pending;
         std::size_t m_counter;
+        int m_dispatching;
+        bool m_dirty;
+
+    private:
+        event_link insert(event_callback_t callback, event_placement placement)
+        {
+            event_link link = m_counter++;
+            callback_entry entry{link, std::move(callback), false};
+            if (m_dispatching > 0)
+                m_pending.emplace_back(std::move(entry), placement);
+            else
+                place(std::move(entry), placement);
+            return link;
+        }
+
+        void place(callback_entry entry, event_placement placement)
+        {
+            if (placement == event_placement::EVENT_PREPEND)
+                m_callbacks.insert(m_callbacks.begin(), std::move(entry));
+            else
+                m_callbacks.push_back(std::move(entry));
+        }
+
+        void erase(callback_entry& entry)
+        {
+            if (m_dispatching > 0) {
+                entry.removed = true;
+                m_dirty = true;
+                return;
+            }
+            m_callbacks.erase(m_callbacks.begin() + (&entry - m_callbacks.data()));
+        }
+
+        void flush()
+        {
+            if (m_dirty) {
+                m_callbacks.erase(std::remove_if(m_callbacks.begin(), m_callbacks.end(),
+                    [](const callback_entry& entry) { return entry.removed; }), m_callbacks.end());
+                m_dirty = false;
+            }
+            if (!m_pending.empty()) {
+                auto pending = std::move(m_pending);
+                m_pending.clear();
+                for (auto& [entry, placement] : pending) {
+                    place(std::move(entry), placement);
+                }
+            }
+        }
     };
 
-    // event bus class, holds list of events
+    // identifies an event of an event bus, see event_bus::id
+    typedef std::size_t event_id;
+
+    // event bus class, holds list of events. event names are interned to IDs
+    // the first time they're seen, looking events up by ID skips the hashing
     template <typename Args>
     class event_bus
     {
@@ -124,28 +194,42 @@ namespace xd
         {
         }
 
+        // ID of the named event, registering it if needed
+        event_id id(const std::string& key)
+        {
+            auto i = m_ids.find(key);
+            if (i != m_ids.end())
+                return i->second;
+            event_id id = m_events.size();
+            m_ids.emplace(key, id);
+            m_events.emplace_back();
+            return id;
+        }
+
         event_info_t& operator[](const std::string& key)
         {
-            return m_events[key];
+            return m_events[id(key)];
         }
 
-        const event_info_t& operator[](const std::string& key) const
+        event_info_t& operator[](event_id id)
         {
-            return m_events[key];
+            return m_events.at(id);
         }
 
         event_info_t& get(const std::string& key)
         {
-            return m_events[key];
+            return m_events[id(key)];
         }
 
-        const event_info_t& get(const std::string& key) const
+        event_info_t& get(event_id id)
         {
-            return m_events[key];
+            return m_events.at(id);
         }
 
     private:
-        std::unordered_map<std::string, event_info<Args>> m_events;
+        std::unordered_map<std::string, event_id> m_ids;
+        // deque so registering an event doesn't move the others
+        std::deque<event_info<Args>> m_events;
     };
 }
 
@@ -0,0 +1,127 @@
+#ifndef H_XD_GRAPHICS_DETAIL_ATLAS
+#define H_XD_GRAPHICS_DETAIL_ATLAS
+
+#include "../../glm.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace xd { namespace detail {
+
+    // packs rectangles into fixed size square pages, row by row (shelf packing).
+    // every rectangle is surrounded by a padding border that's also reserved
+    class atlas_packer
+    {
+    public:
+        struct placement
+        {
+            int page;
+            // top left corner of the rectangle, not including the padding
+            int x;
+            int y;
+        };
+
+        atlas_packer(int page_size, int padding) noexcept
+            : m_page_size(page_size), m_padding(padding) {}
+
+        int page_size() const noexcept { return m_page_size; }
+        int padding() const noexcept { return m_padding; }
+        int page_count() const noexcept { return static_cast<int>(m_pages.size()); }
+
+        // find a place for the rectangle, opening a new page if needed.
+        // returns nullopt if it doesn't fit in an empty page
+        std::optional<placement> insert(int width, int height)
+        {
+            int padded_width = width + m_padding * 2;
+            int padded_height = height + m_padding * 2;
+            if (width <= 0 || height <= 0
+                    || padded_width > m_page_size || padded_height > m_page_size) {
+                return std::nullopt;
+            }
+
+            for (int page = 0; page < page_count(); ++page) {
+                if (auto pos = insert_into(m_pages[page], padded_width, padded_height)) {
+                    return placement{ page, pos->x + m_padding, pos->y + m_padding };
+                }
+            }
+
+            m_pages.emplace_back();
+            auto pos = insert_into(m_pages.back(), padded_width, padded_height);
+            return placement{ page_count() - 1, pos->x + m_padding, pos->y + m_padding };
+        }
+
+    private:
+        struct shelf
+        {
+            int y;
+            int height;
+            int used_width;
+        };
+        typedef std::vector<shelf> page;
+
+        std::optional<ivec2> insert_into(page& shelves, int width, int height)
+        {
+            // best fit: the lowest shelf that's tall enough and has room left
+            shelf* best = nullptr;
+            for (auto& shelf : shelves) {
+                bool fits = height <= shelf.height
+                    && shelf.used_width + width <= m_page_size;
+                if (fits && (!best || shelf.height < best->height)) {
+                    best = &shelf;
+                }
+            }
+
+            if (!best) {
+                int top = shelves.empty() ? 0 : shelves.back().y + shelves.back().height;
+                if (top + height > m_page_size) return std::nullopt;
+                shelves.push_back(shelf{ top, height, 0 });
+                best = &shelves.back();
+            }
+
+            ivec2 pos(best->used_width, best->y);
+            best->used_width += width;
+            return pos;
+        }
+
+        int m_page_size;
+        int m_padding;
+        std::vector<page> m_pages;
+    };
+
+    // copy RGBA pixels into a buffer with a padding border, making color keyed
+    // texels transparent and extruding the edge texels into the border so
+    // filtering at the edges never samples a neighbouring image
+    inline std::vector<std::uint8_t> pad_image(const std::uint8_t* pixels,
+        int width, int height, int padding, vec4 color_key)
+    {
+        int padded_width = width + padding * 2;
+        int padded_height = height + padding * 2;
+        std::vector<std::uint8_t> result(padded_width * padded_height * 4);
+
+        bool has_key = color_key.a > 0.0f;
+        std::uint8_t key[4];
+        for (int i = 0; i < 4; ++i) {
+            key[i] = static_cast<std::uint8_t>(std::lround(color_key[i] * 255.0f));
+        }
+
+        for (int y = 0; y < padded_height; ++y) {
+            int src_y = std::clamp(y - padding, 0, height - 1);
+            for (int x = 0; x < padded_width; ++x) {
+                int src_x = std::clamp(x - padding, 0, width - 1);
+                auto src = pixels + (src_y * width + src_x) * 4;
+                auto dest = &result[(y * padded_width + x) * 4];
+                std::copy(src, src + 4, dest);
+                if (has_key && std::equal(src, src + 4, key)) {
+                    dest[3] = 0;
+                }
+            }
+        }
+
+        return result;
+    }
+
+} }
+
+#endif
@@ -0,0 +1,156 @@
+#ifndef H_XD_GRAPHICS_DETAIL_GL_STATE_CACHE
+#define H_XD_GRAPHICS_DETAIL_GL_STATE_CACHE
+
+#include "../../vendor/glew/glew.h"
+#include "../../glm.hpp"
+#include <array>
+#include <optional>
+#include <unordered_map>
+
+namespace xd
+{
+    // number of issued and skipped GL state changes
+    struct gl_state_stats
+    {
+        int issued = 0;
+        int elided = 0;
+        // glUniform calls, unchanged values are already skipped by the programs
+        int uniform_uploads = 0;
+    };
+
+    namespace detail
+    {
+        // shadows the GL state set through xd::gl_state, every setter
+        // returns true if the GL call needs to be made
+        class gl_state_cache
+        {
+        public:
+            static constexpr int max_texture_units = 32;
+
+            gl_state_cache() { invalidate(); }
+
+            // forget everything, state is unknown until set again
+            void invalidate()
+            {
+                m_program.reset();
+                m_active_texture.reset();
+                for (auto& texture : m_textures) {
+                    texture.reset();
+                }
+                m_array_buffer.reset();
+                m_element_buffer.reset();
+                m_blend_func.reset();
+                m_scissor.reset();
+                m_viewport.reset();
+                m_capabilities.clear();
+            }
+
+            bool use_program(GLuint program)
+            {
+                return update(m_program, program);
+            }
+
+            bool active_texture(GLenum unit)
+            {
+                return update(m_active_texture, unit);
+            }
+
+            // bind a texture to the currently active unit
+            bool bind_texture(GLuint texture)
+            {
+                int unit = m_active_texture ? static_cast<int>(*m_active_texture - GL_TEXTURE0) : -1;
+                if (unit < 0 || unit >= max_texture_units) {
+                    // active unit is unknown, always bind
+                    ++m_stats.issued;
+                    return true;
+                }
+                return update(m_textures[unit], texture);
+            }
+
+            bool bind_buffer(GLenum target, GLuint buffer)
+            {
+                if (target == GL_ARRAY_BUFFER)
+                    return update(m_array_buffer, buffer);
+                if (target == GL_ELEMENT_ARRAY_BUFFER)
+                    return update(m_element_buffer, buffer);
+                ++m_stats.issued;
+                return true;
+            }
+
+            bool blend_func(GLenum src_rgb, GLenum dst_rgb, GLenum src_alpha, GLenum dst_alpha)
+            {
+                return update(m_blend_func, glm::uvec4(src_rgb, dst_rgb, src_alpha, dst_alpha));
+            }
+
+            bool set_capability(GLenum capability, bool enabled)
+            {
+                auto it = m_capabilities.find(capability);
+                if (it != m_capabilities.end() && it->second == enabled) {
+                    ++m_stats.elided;
+                    return false;
+                }
+                m_capabilities[capability] = enabled;
+                ++m_stats.issued;
+                return true;
+            }
+
+            bool scissor(const glm::ivec4& box)
+            {
+                return update(m_scissor, box);
+            }
+
+            bool viewport(const glm::ivec4& box)
+            {
+                return update(m_viewport, box);
+            }
+
+            // deleted objects get unbound by GL, and their names may be reused
+            void forget_texture(GLuint texture)
+            {
+                for (auto& bound : m_textures) {
+                    if (bound && *bound == texture) bound = 0;
+                }
+            }
+            void forget_program(GLuint program)
+            {
+                if (m_program && *m_program == program) m_program.reset();
+            }
+            void forget_buffer(GLuint buffer)
+            {
+                if (m_array_buffer && *m_array_buffer == buffer) m_array_buffer = 0;
+                if (m_element_buffer && *m_element_buffer == buffer) m_element_buffer = 0;
+            }
+
+            void count_uniform_upload() noexcept { ++m_stats.uniform_uploads; }
+
+            const gl_state_stats& stats() const noexcept { return m_stats; }
+            void reset_stats() noexcept { m_stats = gl_state_stats{}; }
+
+        private:
+            template <typename T>
+            bool update(std::optional<T>& cached, const T& value)
+            {
+                if (cached && *cached == value) {
+                    ++m_stats.elided;
+                    return false;
+                }
+                cached = value;
+                ++m_stats.issued;
+                return true;
+            }
+
+            std::optional<GLuint> m_program;
+            std::optional<GLenum> m_active_texture;
+            std::array<std::optional<GLuint>, max_texture_units> m_textures;
+            std::optional<GLuint> m_array_buffer;
+            std::optional<GLuint> m_element_buffer;
+            std::optional<glm::uvec4> m_blend_func;
+            std::optional<glm::ivec4> m_scissor;
+            std::optional<glm::ivec4> m_viewport;
+            std::unordered_map<GLenum, bool> m_capabilities;
+            gl_state_stats m_stats;
+        };
+    }
+}
+
+#endif
@@ -0,0 +1,67 @@
+#ifndef H_XD_GRAPHICS_DETAIL_UNIFORM_CACHE
+#define H_XD_GRAPHICS_DETAIL_UNIFORM_CACHE
+
+#include "../../glm.hpp"
+#include <cstddef>
+#include <variant>
+#include <vector>
+
+namespace xd { namespace detail {
+
+    // shadows the current uniform values of a program, used to skip
+    // glUniform calls that wouldn't change anything
+    class uniform_cache
+    {
+    public:
+        typedef std::variant<std::monostate, int, float, vec2, vec3, vec4,
+            mat2, mat3, mat4> value_type;
+
+        uniform_cache() noexcept : m_issued(0), m_elided(0) {}
+
+        // forget all cached values, e.g. after relinking
+        void reset(std::size_t size)
+        {
+            m_values.assign(size, std::monostate{});
+        }
+
+        // add slots, keeping the cached values
+        void resize(std::size_t size)
+        {
+            m_values.resize(size, std::monostate{});
+        }
+
+        std::size_t size() const noexcept { return m_values.size(); }
+
+        // store the value, returns false if the slot already held it
+        template <typename T>
+        bool update(std::size_t slot, const T& value)
+        {
+            auto& cached = m_values[slot];
+            auto current = std::get_if<T>(&cached);
+            if (current && *current == value) {
+                ++m_elided;
+                return false;
+            }
+            cached = value;
+            ++m_issued;
+            return true;
+        }
+
+        // counters of issued versus skipped uniform updates
+        int issued() const noexcept { return m_issued; }
+        int elided() const noexcept { return m_elided; }
+        void reset_counters() noexcept
+        {
+            m_issued = 0;
+            m_elided = 0;
+        }
+
+    private:
+        std::vector<value_type> m_values;
+        int m_issued;
+        int m_elided;
+    };
+
+} }
+
+#endif
@@ -1,5 +1,6 @@
 #include "font.hpp"
 #include "exceptions.hpp"
+#include "gl_state.hpp"
 #include "detail/font_details.hpp"
 #include "../vendor/utf8.h"
 #include <ft2build.h>
@@ -28,7 +29,7 @@ xd::font::~font()
 {
     // free all textures
     for (auto i = m_glyph_map.begin(); i != m_glyph_map.end(); ++i) {
-        glDeleteTextures(1, &i->second->texture_id);
+        gl_state::delete_texture(i->second->texture_id);
     }
 }
 
@@ -102,15 +103,18 @@ const xd::detail::font::glyph& xd::font::load_glyph(utf8::uint32_t char_index, i
 
     // get the handle to the bitmap
     FT_Bitmap bitmap = m_face->handle->glyph->bitmap;
-    glGenTextures(1, &glyph.texture_id);
-    glBindTexture(GL_TEXTURE_2D, glyph.texture_id);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, bitmap.width, bitmap.rows,
-        0, GL_LUMINANCE, GL_UNSIGNED_BYTE, bitmap.buffer);
+    glyph.texture_id = 0;
+    if (!gl_state::is_headless()) {
+        glGenTextures(1, &glyph.texture_id);
+        gl_state::bind_texture(glyph.texture_id);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, bitmap.width, bitmap.rows,
+            0, GL_LUMINANCE, GL_UNSIGNED_BYTE, bitmap.buffer);
+    }
 
     // create quad for it
     vertex data[4];
@@ -203,7 +207,7 @@ glm::vec2 xd::font::render(const std::string& text, const font_style& style,
             const glyph& glyph = load_glyph(codepoint, style.m_size, load_flags);
 
             // bind the texture
-            glBindTexture(GL_TEXTURE_2D, glyph.texture_id);
+            gl_state::bind_texture(glyph.texture_id);
 
             // calculate exact offset
             glm::vec2 glyph_pos = text_pos;
@@ -283,40 +287,40 @@ float xd::font::get_width(const std::string& text, const font_style& style)
 
 const std::string& xd::font::get_mvp_uniform()
 {
-    return m_mvp_uniform;
+    return m_mvp_uniform.name();
 }
 
 void xd::font::set_mvp_uniform(const std::string& uniform_name)
 {
-    m_mvp_uniform = uniform_name;
+    m_mvp_uniform = uniform<glm::mat4>(uniform_name);
 }
 
 const std::string& xd::font::get_pos_uniform()
 {
-    return m_position_uniform;
+    return m_position_uniform.name();
 }
 
 void xd::font::set_pos_uniform(const std::string& uniform_name)
 {
-    m_position_uniform = uniform_name;
+    m_position_uniform = uniform<glm::vec2>(uniform_name);
 }
 
 const std::string& xd::font::get_color_uniform()
 {
-    return m_color_uniform;
+    return m_color_uniform.name();
 }
 
 void xd::font::set_color_uniform(const std::string& uniform_name)
 {
-    m_color_uniform = uniform_name;
+    m_color_uniform = uniform<glm::vec4>(uniform_name);
 }
 
 const std::string& xd::font::get_texture_uniform()
 {
-    return m_texture_uniform;
+    return m_texture_uniform.name();
 }
 
 void xd::font::set_texture_uniform(const std::string& uniform_name)
 {
-    m_texture_uniform = uniform_name;
+    m_texture_uniform = uniform<int>(uniform_name);
 }
@@ -5,6 +5,7 @@
 #include "../vendor/utf8.h"
 #include "font_style.hpp"
 #include "shader_program.hpp"
+#include "uniform.hpp"
 #include <iosfwd>
 #include <memory>
 #include <optional>
@@ -66,10 +67,10 @@ namespace xd
         std::string m_filename;
         glyph_map_t m_glyph_map;
         font_map_t m_linked_fonts;
-        std::string m_mvp_uniform;
-        std::string m_position_uniform;
-        std::string m_color_uniform;
-        std::string m_texture_uniform;
+        uniform<glm::mat4> m_mvp_uniform;
+        uniform<glm::vec2> m_position_uniform;
+        uniform<glm::vec4> m_color_uniform;
+        uniform<int> m_texture_uniform;
     };
 }
 
@@ -0,0 +1,188 @@
+#include "gl_state.hpp"
+
+namespace xd { namespace detail { namespace gl_state {
+
+    static gl_state_cache& cache()
+    {
+        static gl_state_cache instance;
+        return instance;
+    }
+
+    static gl_state_stats last_frame_stats;
+
+    // no GL context, nothing may reach the driver
+    static bool headless = false;
+
+} } }
+
+using xd::detail::gl_state::cache;
+using xd::detail::gl_state::headless;
+
+void xd::gl_state::set_headless(bool enabled)
+{
+    headless = enabled;
+}
+
+bool xd::gl_state::is_headless()
+{
+    return headless;
+}
+
+void xd::gl_state::use_program(GLuint program)
+{
+    if (cache().use_program(program) && !headless)
+        glUseProgram(program);
+}
+
+void xd::gl_state::active_texture(GLenum unit)
+{
+    if (cache().active_texture(unit) && !headless)
+        glActiveTexture(unit);
+}
+
+void xd::gl_state::bind_texture(GLuint texture)
+{
+    if (cache().bind_texture(texture) && !headless)
+        glBindTexture(GL_TEXTURE_2D, texture);
+}
+
+void xd::gl_state::bind_texture(GLuint texture, GLenum unit)
+{
+    active_texture(unit);
+    bind_texture(texture);
+}
+
+void xd::gl_state::bind_buffer(GLenum target, GLuint buffer)
+{
+    if (cache().bind_buffer(target, buffer) && !headless)
+        glBindBuffer(target, buffer);
+}
+
+void xd::gl_state::blend_func(GLenum src, GLenum dst)
+{
+    if (cache().blend_func(src, dst, src, dst) && !headless)
+        glBlendFunc(src, dst);
+}
+
+void xd::gl_state::blend_func_separate(GLenum src_rgb, GLenum dst_rgb, GLenum src_alpha, GLenum dst_alpha)
+{
+    if (cache().blend_func(src_rgb, dst_rgb, src_alpha, dst_alpha) && !headless)
+        glBlendFuncSeparate(src_rgb, dst_rgb, src_alpha, dst_alpha);
+}
+
+void xd::gl_state::enable(GLenum capability)
+{
+    if (cache().set_capability(capability, true) && !headless)
+        glEnable(capability);
+}
+
+void xd::gl_state::disable(GLenum capability)
+{
+    if (cache().set_capability(capability, false) && !headless)
+        glDisable(capability);
+}
+
+void xd::gl_state::scissor(int x, int y, int width, int height)
+{
+    if (cache().scissor(glm::ivec4(x, y, width, height)) && !headless)
+        glScissor(x, y, width, height);
+}
+
+void xd::gl_state::viewport(int x, int y, int width, int height)
+{
+    if (cache().viewport(glm::ivec4(x, y, width, height)) && !headless)
+        glViewport(x, y, width, height);
+}
+
+void xd::gl_state::uniform(GLint location, int val)
+{
+    cache().count_uniform_upload();
+    if (!headless)
+        glUniform1i(location, val);
+}
+
+void xd::gl_state::uniform(GLint location, float val)
+{
+    cache().count_uniform_upload();
+    if (!headless)
+        glUniform1f(location, val);
+}
+
+void xd::gl_state::uniform(GLint location, const glm::vec2& val)
+{
+    cache().count_uniform_upload();
+    if (!headless)
+        glUniform2fv(location, 1, &val[0]);
+}
+
+void xd::gl_state::uniform(GLint location, const glm::vec3& val)
+{
+    cache().count_uniform_upload();
+    if (!headless)
+        glUniform3fv(location, 1, &val[0]);
+}
+
+void xd::gl_state::uniform(GLint location, const glm::vec4& val)
+{
+    cache().count_uniform_upload();
+    if (!headless)
+        glUniform4fv(location, 1, &val[0]);
+}
+
+void xd::gl_state::uniform(GLint location, const glm::mat2& val)
+{
+    cache().count_uniform_upload();
+    if (!headless)
+        glUniformMatrix2fv(location, 1, GL_FALSE, glm::value_ptr(val));
+}
+
+void xd::gl_state::uniform(GLint location, const glm::mat3& val)
+{
+    cache().count_uniform_upload();
+    if (!headless)
+        glUniformMatrix3fv(location, 1, GL_FALSE, glm::value_ptr(val));
+}
+
+void xd::gl_state::uniform(GLint location, const glm::mat4& val)
+{
+    cache().count_uniform_upload();
+    if (!headless)
+        glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(val));
+}
+
+void xd::gl_state::delete_texture(GLuint texture)
+{
+    cache().forget_texture(texture);
+    if (headless) return;
+    glDeleteTextures(1, &texture);
+}
+
+void xd::gl_state::delete_program(GLuint program)
+{
+    cache().forget_program(program);
+    if (headless) return;
+    glDeleteProgram(program);
+}
+
+void xd::gl_state::delete_buffer(GLuint buffer)
+{
+    cache().forget_buffer(buffer);
+    if (headless) return;
+    glDeleteBuffers(1, &buffer);
+}
+
+void xd::gl_state::invalidate()
+{
+    cache().invalidate();
+}
+
+void xd::gl_state::begin_frame()
+{
+    detail::gl_state::last_frame_stats = cache().stats();
+    cache().reset_stats();
+}
+
+xd::gl_state_stats xd::gl_state::frame_stats()
+{
+    return detail::gl_state::last_frame_stats;
+}
@@ -0,0 +1,56 @@
+#ifndef H_XD_GRAPHICS_GL_STATE
+#define H_XD_GRAPHICS_GL_STATE
+
+#include "../vendor/glew/glew.h"
+#include "detail/gl_state_cache.hpp"
+
+namespace xd
+{
+    // all xd graphics state changes go through here so that
+    // setting already current state doesn't reach the driver
+    namespace gl_state
+    {
+        void use_program(GLuint program);
+        void active_texture(GLenum unit);
+        // bind to the active unit, or activate the unit first
+        void bind_texture(GLuint texture);
+        void bind_texture(GLuint texture, GLenum unit);
+        void bind_buffer(GLenum target, GLuint buffer);
+        void blend_func(GLenum src, GLenum dst);
+        void blend_func_separate(GLenum src_rgb, GLenum dst_rgb, GLenum src_alpha, GLenum dst_alpha);
+        void enable(GLenum capability);
+        void disable(GLenum capability);
+        void scissor(int x, int y, int width, int height);
+        void viewport(int x, int y, int width, int height);
+
+        // upload a uniform of the program in use, counted in the frame stats
+        void uniform(GLint location, int val);
+        void uniform(GLint location, float val);
+        void uniform(GLint location, const glm::vec2& val);
+        void uniform(GLint location, const glm::vec3& val);
+        void uniform(GLint location, const glm::vec4& val);
+        void uniform(GLint location, const glm::mat2& val);
+        void uniform(GLint location, const glm::mat3& val);
+        void uniform(GLint location, const glm::mat4& val);
+
+        // delete GL objects, keeping the cache in sync
+        void delete_texture(GLuint texture);
+        void delete_program(GLuint program);
+        void delete_buffer(GLuint buffer);
+
+        // without a GL context (headless mode) GL objects are never created
+        // and state changes are only tracked, never sent to the driver
+        void set_headless(bool enabled);
+        bool is_headless();
+
+        // forget the cached state, e.g. when someone else touched the context
+        void invalidate();
+
+        // start counting state changes for a new frame
+        void begin_frame();
+        // state changes issued and elided during the last complete frame
+        gl_state_stats frame_stats();
+    }
+}
+
+#endif
@@ -9,13 +9,26 @@
 #define STBI_NO_PNM
 #define STBI_FAILURE_USERMSG // readable error messages
 #include "../vendor/stb/stb_image.h"
+#include <cstring>
 #include <fstream>
+#include <vector>
 
 namespace xd { namespace detail { namespace image {
 
     struct handle
     {
         void* data = nullptr;
+        // owns the pixels when they weren't decoded by stb
+        std::vector<unsigned char> pixels;
+
+        void release()
+        {
+            if (pixels.empty()) {
+                stbi_image_free(data);
+            }
+            pixels.clear();
+            data = nullptr;
+        }
     };
 
     static int stream_read(void* user, char* data, int size) {
@@ -56,16 +69,31 @@ xd::image::image(const std::string& filename, std::istream& stream, xd::vec4 col
     load(filename, stream);
 }
 
+xd::image::image(const std::string& filename, int width, int height,
+    const void* pixels, xd::vec4 color_key)
+    : m_image(std::make_shared<detail::image::handle>())
+    , m_width(width)
+    , m_height(height)
+    , m_filename(filename)
+    , m_color_key(color_key)
+{
+    if (width <= 0 || height <= 0)
+        throw failed_to_load_image(filename, "invalid image size");
+
+    auto size = static_cast<std::size_t>(width) * height * 4;
+    m_image->pixels.resize(size);
+    std::memcpy(m_image->pixels.data(), pixels, size);
+    m_image->data = m_image->pixels.data();
+}
+
 xd::image::~image()
 {
-    stbi_image_free(m_image->data);
+    m_image->release();
 }
 
 void xd::image::load(const std::string& filename, std::istream& stream)
 {
-    if (m_image->data) {
-        stbi_image_free(m_image->data);
-    }
+    m_image->release();
 
     int channels;
     m_image->data = stbi_load_from_callbacks(&detail::image::stream_callbacks,
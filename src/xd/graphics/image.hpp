@@ -15,6 +15,9 @@ namespace xd
 
         image(const std::string& filename, std::istream& stream);
         image(const std::string& filename, std::istream& stream, xd::vec4 color_key);
+        // copy already decoded RGBA pixels
+        image(const std::string& filename, int width, int height, const void* pixels,
+            xd::vec4 color_key = xd::vec4(0));
         virtual ~image();
         image(const image&) = delete;
         image& operator=(const image&) = delete;
@@ -1,19 +1,24 @@
 #include "shader_program.hpp"
 #include "exceptions.hpp"
+#include "gl_state.hpp"
 #include "../glm.hpp"
+#include <vector>
 
 xd::shader_program::shader_program()
 {
-    m_program = glCreateProgram();
+    m_program = gl_state::is_headless() ? 0 : glCreateProgram();
 }
 
 xd::shader_program::~shader_program()
 {
-    glDeleteProgram(m_program);
+    gl_state::delete_program(m_program);
 }
 
 void xd::shader_program::attach(GLuint type, const std::string& src)
 {
+    if (!m_program)
+        return;
+
     // compile the shader
     const char *srcp = src.c_str();
     GLuint shader = glCreateShader(type);
@@ -45,6 +50,9 @@ void xd::shader_program::attach(GLuint type, const std::string& src)
 
 void xd::shader_program::link()
 {
+    if (!m_program)
+        return;
+
     // link the program
     glLinkProgram(m_program);
 
@@ -62,11 +70,14 @@ void xd::shader_program::link()
         // throw the exception
         throw xd::shader_build_failed(message);
     }
+
+    // resolve the active uniforms once
+    load_uniforms();
 }
 
 void xd::shader_program::use()
 {
-    glUseProgram(m_program);
+    gl_state::use_program(m_program);
 }
 
 void xd::shader_program::setup()
@@ -76,54 +87,101 @@ void xd::shader_program::setup()
 
 void xd::shader_program::bind_attribute(const std::string& name, GLuint attr)
 {
+    if (!m_program)
+        return;
     glBindAttribLocation(m_program, attr, name.c_str());
 }
 
 void xd::shader_program::bind_uniform(const std::string& name, int val)
 {
-    glUniform1i(get_uniform_location(name), val);
+    bind_uniform(uniform<int>(name), val);
 }
 
 void xd::shader_program::bind_uniform(const std::string& name, float val)
 {
-    glUniform1f(get_uniform_location(name), val);
+    bind_uniform(uniform<float>(name), val);
 }
 
 void xd::shader_program::bind_uniform(const std::string& name, const glm::vec2& val)
 {
-    glUniform2fv(get_uniform_location(name), 1, &val[0]);
+    bind_uniform(uniform<glm::vec2>(name), val);
 }
 
 void xd::shader_program::bind_uniform(const std::string& name, const glm::vec3& val)
 {
-    glUniform3fv(get_uniform_location(name), 1, &val[0]);
+    bind_uniform(uniform<glm::vec3>(name), val);
 }
 
 void xd::shader_program::bind_uniform(const std::string& name, const glm::vec4& val)
 {
-    glUniform4fv(get_uniform_location(name), 1, &val[0]);
+    bind_uniform(uniform<glm::vec4>(name), val);
 }
 
 void xd::shader_program::bind_uniform(const std::string& name, const glm::mat2& val)
 {
-    glUniformMatrix2fv(get_uniform_location(name), 1, GL_FALSE, glm::value_ptr(val));
+    bind_uniform(uniform<glm::mat2>(name), val);
 }
 
 void xd::shader_program::bind_uniform(const std::string& name, const glm::mat3& val)
 {
-    glUniformMatrix3fv(get_uniform_location(name), 1, GL_FALSE, glm::value_ptr(val));
+    bind_uniform(uniform<glm::mat3>(name), val);
 }
 
 void xd::shader_program::bind_uniform(const std::string& name, const glm::mat4& val)
 {
-    glUniformMatrix4fv(get_uniform_location(name), 1, GL_FALSE, glm::value_ptr(val));
+    bind_uniform(uniform<glm::mat4>(name), val);
 }
 
-GLint xd::shader_program::get_uniform_location(const std::string& name)
+GLint xd::shader_program::get_uniform_location(const std::string& name) const
 {
-    if (m_uniform_map.find(name) == m_uniform_map.end()) {
-        m_uniform_map[name] = glGetUniformLocation(m_program, name.c_str());
+    return get_uniform_location(uniform<int>(name));
+}
+
+void xd::shader_program::load_uniforms()
+{
+    m_uniform_slots.clear();
+    m_uniform_locations.clear();
+
+    GLint count = 0, max_length = 0;
+    glGetProgramiv(m_program, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(m_program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &max_length);
+
+    std::vector<GLchar> buf(max_length + 1);
+    for (GLint i = 0; i < count; ++i) {
+        GLsizei length = 0;
+        GLint size = 0;
+        GLenum type = 0;
+        glGetActiveUniform(m_program, i, static_cast<GLsizei>(buf.size()),
+            &length, &size, &type, buf.data());
+        std::string name(buf.data(), length);
+        GLint location = glGetUniformLocation(m_program, name.c_str());
+        if (location == -1) continue;
+
+        // arrays are reported as "name[0]", allow binding them by plain name
+        auto bracket = name.find('[');
+        if (bracket != std::string::npos) {
+            name.erase(bracket);
+        }
+
+        int id = detail::intern_uniform(name);
+        if (id >= static_cast<int>(m_uniform_slots.size())) {
+            m_uniform_slots.resize(id + 1, -1);
+        }
+        m_uniform_slots[id] = static_cast<int>(m_uniform_locations.size());
+        m_uniform_locations.push_back(location);
     }
 
-    return m_uniform_map[name];
+    m_uniform_cache.reset(m_uniform_locations.size());
+}
+
+int xd::shader_program::add_headless_uniform(int id)
+{
+    if (id < 0) return -1;
+    if (id >= static_cast<int>(m_uniform_slots.size())) {
+        m_uniform_slots.resize(id + 1, -1);
+    }
+    m_uniform_slots[id] = static_cast<int>(m_uniform_locations.size());
+    m_uniform_locations.push_back(-1);
+    m_uniform_cache.resize(m_uniform_locations.size());
+    return m_uniform_slots[id];
 }
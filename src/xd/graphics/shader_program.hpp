@@ -3,8 +3,11 @@
 
 #include "../glm.hpp"
 #include "../vendor/glew/glew.h"
+#include "detail/uniform_cache.hpp"
+#include "gl_state.hpp"
+#include "uniform.hpp"
 #include <string>
-#include <unordered_map>
+#include <vector>
 
 namespace xd
 {
@@ -39,12 +42,49 @@ namespace xd
         virtual void bind_uniform(const std::string& name, const glm::mat3& val);
         virtual void bind_uniform(const std::string& name, const glm::mat4& val);
 
+        // bind uniforms through resolved handles, unchanged values are skipped
+        template <typename T>
+        void bind_uniform(const uniform<T>& handle, const typename uniform<T>::value_type& val)
+        {
+            int slot = get_uniform_slot(handle.id());
+            if (slot == -1 && !m_program) {
+                // headless programs can't be queried, every uniform is active
+                slot = add_headless_uniform(handle.id());
+            }
+            if (slot == -1 || !m_uniform_cache.update(slot, val)) return;
+            gl_state::uniform(m_uniform_locations[slot], val);
+        }
+
         // get uniform location
-        GLint get_uniform_location(const std::string& name);
+        GLint get_uniform_location(const std::string& name) const;
+        template <typename T>
+        GLint get_uniform_location(const uniform<T>& handle) const
+        {
+            int slot = get_uniform_slot(handle.id());
+            return slot == -1 ? -1 : m_uniform_locations[slot];
+        }
+
+        // number of glUniform calls made and skipped by the value cache
+        int issued_uniform_updates() const noexcept { return m_uniform_cache.issued(); }
+        int elided_uniform_updates() const noexcept { return m_uniform_cache.elided(); }
+        void reset_uniform_counters() noexcept { m_uniform_cache.reset_counters(); }
     protected:
         // shader program and attrib list
         GLuint m_program;
-        std::unordered_map<std::string, GLint> m_uniform_map;
+    private:
+        // active uniforms, resolved once after linking
+        std::vector<int> m_uniform_slots;
+        std::vector<GLint> m_uniform_locations;
+        detail::uniform_cache m_uniform_cache;
+
+        void load_uniforms();
+        int add_headless_uniform(int id);
+        int get_uniform_slot(int id) const noexcept
+        {
+            if (id < 0 || id >= static_cast<int>(m_uniform_slots.size())) return -1;
+            return m_uniform_slots[id];
+        }
+
     };
 }
 
@@ -1,5 +1,13 @@
 #include "shaders.hpp"
 #include "vertex_traits.hpp"
+#include "uniform.hpp"
+
+namespace xd { namespace detail { namespace shaders {
+
+    static const uniform<glm::mat4> mvp_matrix("mvpMatrix");
+    static const uniform<glm::vec4> color("vColor");
+
+} } }
 
 xd::flat_shader::flat_shader()
 {
@@ -29,8 +37,8 @@ xd::flat_shader::flat_shader()
 void xd::flat_shader::setup(const glm::mat4& mvp, const glm::vec4& color)
 {
     use();
-    bind_uniform("mvpMatrix", mvp);
-    bind_uniform("vColor", color);
+    bind_uniform(detail::shaders::mvp_matrix, mvp);
+    bind_uniform(detail::shaders::color, color);
 }
 
 xd::text_shader::text_shader()
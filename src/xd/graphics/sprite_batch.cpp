@@ -2,11 +2,22 @@
 #include "shader_program.hpp"
 #include "shaders.hpp"
 #include "texture.hpp"
+#include "uniform.hpp"
 #include "vertex_batch.hpp"
 #include <deque>
+#include <type_traits>
 
 namespace xd { namespace detail {
 
+    namespace sprite_uniforms {
+        static const uniform<mat4> mvp_matrix("mvpMatrix");
+        static const uniform<vec4> outline_color("vOutlineColor");
+        static const uniform<vec4> position("vPosition");
+        static const uniform<vec4> color("vColor");
+        static const uniform<vec4> color_key("vColorKey");
+        static const uniform<vec2> tex_size("vTexSize");
+    }
+
     struct sprite
     {
         std::shared_ptr<texture> tex;
@@ -149,24 +160,21 @@ void xd::sprite_batch::draw(xd::shader_program& shader, const mat4& mvp_matrix,
     assert(m_data->sprites.size() == batches.size());
     // setup the shader
     shader.use();
-    shader.bind_uniform("mvpMatrix", mvp_matrix);
-    shader.bind_uniform("vOutlineColor", m_outline_color);
-    for (const auto& [name, value] : m_uniforms) {
-        bind_uniform(name, value);
-    }
+    bind_uniforms(shader, mvp_matrix);
 
     // iterate through all sprites
     for (unsigned int i = 0; i < m_data->sprites.size(); ++i) {
         auto& sprite = m_data->sprites[i];
         auto& batch = batches[i];
         // give required params to shader
-        shader.bind_uniform("vPosition", vec4(sprite.x, sprite.y, 0, 0));
-        shader.bind_uniform("vColor", sprite.color);
-        shader.bind_uniform("vColorKey", sprite.tex->color_key());
+        shader.bind_uniform(detail::sprite_uniforms::position, vec4(sprite.x, sprite.y, 0, 0));
+        shader.bind_uniform(detail::sprite_uniforms::color, sprite.color);
+        shader.bind_uniform(detail::sprite_uniforms::color_key, sprite.tex->color_key());
 
         // bind the texture
         sprite.tex->bind(GL_TEXTURE0);
-        shader.bind_uniform("vTexSize", vec2(sprite.tex->width(), sprite.tex->height()));
+        shader.bind_uniform(detail::sprite_uniforms::tex_size,
+            vec2(sprite.tex->width(), sprite.tex->height()));
 
         // draw it
         batch->render();
@@ -184,11 +192,7 @@ void xd::sprite_batch::draw(xd::shader_program& shader, const mat4& mvp_matrix)
 
     // setup the shader
     shader.use();
-    shader.bind_uniform("mvpMatrix", mvp_matrix);
-    shader.bind_uniform("vOutlineColor", m_outline_color);
-    for (const auto& [name, value] : m_uniforms) {
-        bind_uniform(name, value);
-    }
+    bind_uniforms(shader, mvp_matrix);
 
     // create a quad for rendering sprites
     detail::sprite_vertex quad[4];
@@ -208,13 +212,13 @@ void xd::sprite_batch::draw(xd::shader_program& shader, const mat4& mvp_matrix)
         m_batch->load(&quad[0], 4);
 
         // give required params to shader
-        shader.bind_uniform("vPosition", vec4(i->x, i->y, 0, 0));
-        shader.bind_uniform("vColor", i->color);
-        shader.bind_uniform("vColorKey", tex.color_key());
+        shader.bind_uniform(detail::sprite_uniforms::position, vec4(i->x, i->y, 0, 0));
+        shader.bind_uniform(detail::sprite_uniforms::color, i->color);
+        shader.bind_uniform(detail::sprite_uniforms::color_key, tex.color_key());
 
         // bind the texture
         i->tex->bind(GL_TEXTURE0);
-        shader.bind_uniform("vTexSize", vec2(tw, th));
+        shader.bind_uniform(detail::sprite_uniforms::tex_size, vec2(tw, th));
 
         // draw it
         m_batch->render();
@@ -230,14 +234,21 @@ void xd::sprite_batch::reset_shader() {
 }
 
 void xd::sprite_batch::set_uniform(const std::string& name, uniform_types val) {
-    m_uniforms[name] = val;
+    m_uniforms[detail::intern_uniform(name)] = val;
 }
 
-void xd::sprite_batch::bind_uniform(const std::string& name, const uniform_types& variant) {
-    auto visitor = [&](auto&& typed_value) {
-        m_data->shader->bind_uniform(name, typed_value);
-    };
-    std::visit(visitor, variant);
+void xd::sprite_batch::bind_uniforms(xd::shader_program& shader, const mat4& mvp_matrix) {
+    shader.bind_uniform(detail::sprite_uniforms::mvp_matrix, mvp_matrix);
+    shader.bind_uniform(detail::sprite_uniforms::outline_color, m_outline_color);
+
+    // custom uniforms go to the shader being drawn with
+    for (const auto& [id, value] : m_uniforms) {
+        auto visitor = [&shader, id = id](auto&& typed_value) {
+            typedef std::decay_t<decltype(typed_value)> value_type;
+            shader.bind_uniform(uniform<value_type>(id), typed_value);
+        };
+        std::visit(visitor, value);
+    }
 }
 
 void xd::sprite_batch::add(const std::shared_ptr<xd::texture>& texture, float x, float y,
@@ -4,10 +4,12 @@
 #include "detail/sprite_batch.hpp"
 #include "vertex_batch.hpp"
 #include "types.hpp"
+#include "uniform.hpp"
 #include "../glm.hpp"
 #include <vector>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <variant>
 
 namespace xd
@@ -47,6 +49,11 @@ namespace xd
         typedef std::variant<int, float, xd::vec2, xd::vec3, xd::vec4,
             xd::mat2, xd::mat3, xd::mat4> uniform_types;
         void set_uniform(const std::string& name, uniform_types val);
+        template <typename T>
+        void set_uniform(const uniform<T>& handle, const typename uniform<T>::value_type& val)
+        {
+            m_uniforms[handle.id()] = val;
+        }
 
         void add(const std::shared_ptr<texture>& texture, float x, float y,
             const vec4& color = vec4(1), const vec2& origin = vec2(0, 0));
@@ -66,10 +73,10 @@ namespace xd
     private:
         std::unique_ptr<detail::sprite_batch_data> m_data;
         std::unique_ptr<xd::vertex_batch<detail::sprite_vertex_traits>> m_batch;
-        std::unordered_map<std::string, uniform_types> m_uniforms;
+        std::unordered_map<int, uniform_types> m_uniforms;
         float m_scale;
         vec4 m_outline_color;
-        void bind_uniform(const std::string& name, const uniform_types& variant);
+        void bind_uniforms(xd::shader_program& shader, const mat4& mvp_matrix);
     };
 }
 
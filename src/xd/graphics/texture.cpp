@@ -1,4 +1,5 @@
 #include "texture.hpp"
+#include "gl_state.hpp"
 #include <stdexcept>
 
 namespace xd { namespace detail { namespace texture {
@@ -43,29 +44,27 @@ void xd::texture::init()
     m_width = 0;
     m_height = 0;
     m_color_key = xd::vec4(0);
-    m_unit = GL_TEXTURE0;
+    m_texture_id = 0;
+    if (gl_state::is_headless())
+        return;
 
     glGenTextures(1, &m_texture_id);
-    glBindTexture(GL_TEXTURE_2D, m_texture_id);
+    gl_state::bind_texture(m_texture_id);
 }
 
 xd::texture::~texture()
 {
-    glDeleteTextures(1, &m_texture_id);
+    gl_state::delete_texture(m_texture_id);
 }
 
 void xd::texture::bind() const noexcept
 {
-    glBindTexture(GL_TEXTURE_2D, m_texture_id);
+    gl_state::bind_texture(m_texture_id);
 }
 
 void xd::texture::bind(int unit) const noexcept
 {
-    if (unit != m_unit) {
-        glActiveTexture(unit);
-        m_unit = unit;
-    }
-    glBindTexture(GL_TEXTURE_2D, m_texture_id);
+    gl_state::bind_texture(m_texture_id, unit);
 }
 
 void xd::texture::load(const std::string& filename, std::istream& stream, xd::vec4 color_key)
@@ -90,6 +89,8 @@ void xd::texture::load(int width, int height, const void *data, xd::vec4 color_k
     m_width = width;
     m_height = height;
     m_color_key = color_key;
+    if (gl_state::is_headless())
+        return;
 
     // create storage for texture
     bind();
@@ -104,7 +105,7 @@ void xd::texture::load(int width, int height, const void *data, xd::vec4 color_k
 
 void xd::texture::load(const void *data) const
 {
-    if (!data) return;
+    if (!data || gl_state::is_headless()) return;
 
     // load the pixel data
     bind();
@@ -112,16 +113,29 @@ void xd::texture::load(const void *data) const
     glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, m_width, m_height, GL_RGBA, GL_UNSIGNED_BYTE, data);
 }
 
-void xd::texture::copy_read_buffer(int x, int y, int width, int height)
+void xd::texture::load_region(int x, int y, int width, int height, const void *data) const
 {
+    if (!data || gl_state::is_headless()) return;
+
     bind();
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, width, height, GL_RGBA, GL_UNSIGNED_BYTE, data);
+}
+
+void xd::texture::copy_read_buffer(int x, int y, int width, int height)
+{
     m_width = width;
     m_height = height;
+    if (gl_state::is_headless())
+        return;
+    bind();
     glCopyTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, x, y, m_width, m_height);
 }
 
 void xd::texture::set_wrap(GLint wrap_s, GLint wrap_t) const
 {
+    if (gl_state::is_headless())
+        return;
     bind();
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, wrap_s);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, wrap_t);
@@ -129,6 +143,8 @@ void xd::texture::set_wrap(GLint wrap_s, GLint wrap_t) const
 
 void xd::texture::set_filter(GLint mag_filter, GLint min_filter) const
 {
+    if (gl_state::is_headless())
+        return;
     bind();
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, mag_filter);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, min_filter);
@@ -34,6 +34,7 @@ namespace xd
         void load(const xd::image& image);
         void load(int width, int height, const void *data, vec4 color_key = vec4(0));
         void load(const void *data) const;
+        void load_region(int x, int y, int width, int height, const void *data) const;
         void copy_read_buffer(int x, int y, int width, int height);
 
         GLuint texture_id() const noexcept { return m_texture_id; }
@@ -51,7 +52,6 @@ namespace xd
         int m_width;
         int m_height;
         vec4 m_color_key;
-        mutable int m_unit;
 
         void init();
     };
@@ -0,0 +1,51 @@
+#include "texture_atlas.hpp"
+#include "image.hpp"
+#include <algorithm>
+#include <cstdint>
+
+xd::texture_atlas::texture_atlas(int page_size, int max_image_size, int padding)
+    : m_packer(page_size, padding)
+    , m_max_image_size(max_image_size)
+{
+}
+
+bool xd::texture_atlas::accepts(int width, int height) const noexcept
+{
+    int padded_limit = page_size() - m_packer.padding() * 2;
+    int limit = std::min(m_max_image_size, padded_limit);
+    return width > 0 && height > 0 && width <= limit && height <= limit;
+}
+
+std::optional<xd::atlas_region> xd::texture_atlas::add(const std::string& key, const xd::image& image)
+{
+    if (auto region = find(key)) return region;
+    if (!accepts(image.width(), image.height())) return std::nullopt;
+
+    auto placement = m_packer.insert(image.width(), image.height());
+    if (!placement) return std::nullopt;
+
+    if (placement->page == page_count()) {
+        // start with a transparent page so unused space never shows up
+        std::vector<std::uint8_t> empty(page_size() * page_size() * 4, 0);
+        m_pages.push_back(std::make_shared<xd::texture>(page_size(), page_size(), empty.data()));
+    }
+
+    int padding = m_packer.padding();
+    auto pixels = detail::pad_image(static_cast<const std::uint8_t*>(image.data()),
+        image.width(), image.height(), padding, image.color_key());
+    auto& page = m_pages[placement->page];
+    page->load_region(placement->x - padding, placement->y - padding,
+        image.width() + padding * 2, image.height() + padding * 2, pixels.data());
+
+    atlas_region region{ page,
+        rect(placement->x, placement->y, image.width(), image.height()) };
+    m_regions.emplace(key, region);
+    return region;
+}
+
+std::optional<xd::atlas_region> xd::texture_atlas::find(const std::string& key) const
+{
+    auto it = m_regions.find(key);
+    if (it == m_regions.end()) return std::nullopt;
+    return it->second;
+}
@@ -0,0 +1,55 @@
+#ifndef H_XD_GRAPHICS_TEXTURE_ATLAS
+#define H_XD_GRAPHICS_TEXTURE_ATLAS
+
+#include "detail/atlas.hpp"
+#include "texture.hpp"
+#include "types.hpp"
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace xd
+{
+    class image;
+
+    // part of an atlas page holding one image
+    struct atlas_region
+    {
+        std::shared_ptr<xd::texture> texture;
+        // position and size of the image inside the page, in pixels
+        rect rectangle;
+    };
+
+    // packs images into shared texture pages so they can be drawn
+    // without switching textures. color keys are baked into the alpha
+    // channel, so pages don't have a color key of their own
+    class texture_atlas
+    {
+    public:
+        texture_atlas(const texture_atlas&) = delete;
+        texture_atlas& operator=(const texture_atlas&) = delete;
+        // images wider or taller than max_image_size are not packed
+        texture_atlas(int page_size = 1024, int max_image_size = 256, int padding = 1);
+
+        // pack the image under the given key, returns nullopt if the image
+        // is too large, in which case it should get its own texture
+        std::optional<atlas_region> add(const std::string& key, const xd::image& image);
+        std::optional<atlas_region> find(const std::string& key) const;
+        bool accepts(int width, int height) const noexcept;
+
+        int page_size() const noexcept { return m_packer.page_size(); }
+        int max_image_size() const noexcept { return m_max_image_size; }
+        int page_count() const noexcept { return static_cast<int>(m_pages.size()); }
+        int image_count() const noexcept { return static_cast<int>(m_regions.size()); }
+
+    private:
+        detail::atlas_packer m_packer;
+        int m_max_image_size;
+        std::vector<std::shared_ptr<xd::texture>> m_pages;
+        std::unordered_map<std::string, atlas_region> m_regions;
+    };
+}
+
+#endif
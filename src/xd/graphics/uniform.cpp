@@ -0,0 +1,37 @@
+#include "uniform.hpp"
+#include <deque>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace xd::detail::uniform {
+    struct registry {
+        std::unordered_map<std::string, int> ids;
+        // deque so references returned by uniform_name stay valid
+        std::deque<std::string> names;
+    };
+
+    static registry& get_registry() {
+        static registry instance;
+        return instance;
+    }
+}
+
+int xd::detail::intern_uniform(const std::string& name)
+{
+    auto& registry = uniform::get_registry();
+    auto it = registry.ids.find(name);
+    if (it != registry.ids.end()) return it->second;
+
+    auto id = static_cast<int>(registry.names.size());
+    registry.names.push_back(name);
+    registry.ids.emplace(name, id);
+    return id;
+}
+
+const std::string& xd::detail::uniform_name(int id)
+{
+    auto& registry = uniform::get_registry();
+    if (id < 0 || id >= static_cast<int>(registry.names.size()))
+        throw std::out_of_range("invalid uniform id: " + std::to_string(id));
+    return registry.names[id];
+}
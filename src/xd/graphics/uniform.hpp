@@ -0,0 +1,37 @@
+#ifndef H_XD_GRAPHICS_UNIFORM
+#define H_XD_GRAPHICS_UNIFORM
+
+#include "../glm.hpp"
+#include <string>
+
+namespace xd
+{
+    namespace detail
+    {
+        // map uniform names to dense process-wide ids (and back)
+        int intern_uniform(const std::string& name);
+        const std::string& uniform_name(int id);
+    }
+
+    // a typed uniform handle, the name is resolved once and the handle
+    // can then be bound on any shader program without string lookups
+    template <typename T>
+    class uniform
+    {
+    public:
+        typedef T value_type;
+
+        uniform() noexcept : m_id(-1) {}
+        explicit uniform(const std::string& name) : m_id(detail::intern_uniform(name)) {}
+        explicit uniform(int id) noexcept : m_id(id) {}
+
+        int id() const noexcept { return m_id; }
+        bool valid() const noexcept { return m_id != -1; }
+        const std::string& name() const { return detail::uniform_name(m_id); }
+
+    private:
+        int m_id;
+    };
+}
+
+#endif
@@ -2,6 +2,7 @@
 #define H_XD_GRAPHICS_VERTEX_BATCH
 
 #include "../vendor/glew/glew.h"
+#include "gl_state.hpp"
 
 namespace xd
 {
@@ -31,7 +32,7 @@ namespace xd
 
         ~vertex_batch()
         {
-            glDeleteBuffers(1, &m_vbo);
+            gl_state::delete_buffer(m_vbo);
         }
 
         Traits get_traits()
@@ -51,17 +52,17 @@ namespace xd
 
         void load(const void *data, int count)
         {
+            m_count = count;
+            if (!m_vbo)
+                return;
+
             // bind the buffer
-            glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+            gl_state::bind_buffer(GL_ARRAY_BUFFER, m_vbo);
 
             // allocate the buffer and load the data
             size_t size = count * m_traits.vertex_size;
             glBufferData(GL_ARRAY_BUFFER, size, NULL, GL_STATIC_DRAW);
             glBufferSubData(GL_ARRAY_BUFFER, 0, size, data);
-            m_count = count;
-
-            // unbind the buffer
-            glBindBuffer(GL_ARRAY_BUFFER, 0);
         }
 
         void render() const
@@ -71,8 +72,11 @@ namespace xd
 
         void render(int begin, int count) const
         {
-            // bind the buffer
-            glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+            if (!m_vbo)
+                return;
+
+            // bind the buffer, it stays bound for the next draw of this batch
+            gl_state::bind_buffer(GL_ARRAY_BUFFER, m_vbo);
 
             // enable used vertex attribs
             for (auto i = m_traits.m_attribs.begin(); i != m_traits.m_attribs.end(); ++i) {
@@ -87,9 +91,6 @@ namespace xd
             for (auto i = m_traits.m_attribs.begin(); i != m_traits.m_attribs.end(); ++i) {
                 glDisableVertexAttribArray(i->first);
             }
-
-            // unbind the buffer
-            glBindBuffer(GL_ARRAY_BUFFER, 0);
         }
 
     private:
@@ -101,7 +102,9 @@ namespace xd
         void init()
         {
             // generate a VBO
-            glGenBuffers(1, &m_vbo);
+            m_vbo = 0;
+            if (!gl_state::is_headless())
+                glGenBuffers(1, &m_vbo);
         }
     };
 }
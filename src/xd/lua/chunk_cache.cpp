@@ -0,0 +1,146 @@
+#include "chunk_cache.hpp"
+#include "exceptions.hpp"
+#include <algorithm>
+#include <memory>
+
+namespace xd { namespace lua { namespace detail {
+
+    static int write_chunk(lua_State*, const void* data, std::size_t size, void* output)
+    {
+        static_cast<std::string*>(output)->append(static_cast<const char*>(data), size);
+        return 0;
+    }
+
+    // dump the function on top of the stack, keeping debug info
+    // so error messages and tracebacks match the source chunk
+    static bool dump_chunk(lua_State* state, std::string& bytecode)
+    {
+#if LUA_VERSION_NUM >= 503
+        return lua_dump(state, write_chunk, &bytecode, 0) == 0;
+#else
+        return lua_dump(state, write_chunk, &bytecode) == 0;
+#endif
+    }
+
+} } }
+
+xd::lua::chunk_cache::chunk_cache()
+    : m_hits(0)
+    , m_misses(0)
+{
+}
+
+xd::lua::chunk_cache& xd::lua::chunk_cache::shared()
+{
+    static chunk_cache cache;
+    return cache;
+}
+
+std::uint64_t xd::lua::chunk_cache::hash(const char* code, std::size_t size)
+{
+    std::uint64_t result = 14695981039346656037ull;
+    for (std::size_t i = 0; i < size; ++i) {
+        result ^= static_cast<unsigned char>(code[i]);
+        result *= 1099511628211ull;
+    }
+    return result;
+}
+
+int xd::lua::chunk_cache::load(lua_State* state, const char* code, std::size_t size, const std::string& chunk_name)
+{
+    // same default name sol uses, so error messages don't change
+    sol::detail::typical_chunk_name_t base_chunk_name = {};
+    auto name = sol::detail::make_chunk_name(sol::string_view(code, size), chunk_name, base_chunk_name);
+    auto source_hash = hash(code, size);
+    auto key = normalize(chunk_name);
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        entry* cached = nullptr;
+        if (chunk_name.empty()) {
+            auto it = m_unnamed_chunks.find(source_hash);
+            if (it != m_unnamed_chunks.end()) cached = &it->second;
+        } else {
+            auto it = m_named_chunks.find(key);
+            if (it != m_named_chunks.end()) cached = &it->second;
+        }
+
+        if (cached && cached->source_hash == source_hash) {
+            auto status = luaL_loadbufferx(state, cached->bytecode.data(), cached->bytecode.size(), name, "b");
+            if (status == LUA_OK) {
+                ++m_hits;
+                return status;
+            }
+            // bytecode from an incompatible lua build, fall back to the source
+            lua_pop(state, 1);
+        }
+        ++m_misses;
+    }
+
+    auto status = luaL_loadbuffer(state, code, size, name);
+    if (status != LUA_OK) return status;
+
+    std::string bytecode;
+    if (!detail::dump_chunk(state, bytecode)) return status;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (chunk_name.empty()) {
+        if (m_unnamed_chunks.size() >= max_unnamed_chunks) {
+            m_unnamed_chunks.clear();
+        }
+        m_unnamed_chunks[source_hash] = entry{ source_hash, std::move(bytecode) };
+    } else {
+        m_named_chunks[key] = entry{ source_hash, std::move(bytecode) };
+    }
+    return status;
+}
+
+void xd::lua::chunk_cache::add(const std::string& chunk_name, std::uint64_t source_hash, std::string bytecode)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (chunk_name.empty()) {
+        m_unnamed_chunks[source_hash] = entry{ source_hash, std::move(bytecode) };
+    } else {
+        m_named_chunks[normalize(chunk_name)] = entry{ source_hash, std::move(bytecode) };
+    }
+}
+
+std::string xd::lua::chunk_cache::compile(const char* code, std::size_t size, const std::string& chunk_name)
+{
+    std::unique_ptr<lua_State, decltype(&lua_close)> state(luaL_newstate(), &lua_close);
+    if (!state) {
+        throw script_load_failed("couldn't create a lua state for " + chunk_name);
+    }
+
+    sol::detail::typical_chunk_name_t base_chunk_name = {};
+    auto name = sol::detail::make_chunk_name(sol::string_view(code, size), chunk_name, base_chunk_name);
+    if (luaL_loadbuffer(state.get(), code, size, name) != LUA_OK) {
+        throw script_load_failed(lua_tostring(state.get(), -1));
+    }
+
+    std::string bytecode;
+    if (!detail::dump_chunk(state.get(), bytecode)) {
+        throw script_load_failed("couldn't dump bytecode for " + chunk_name);
+    }
+    return bytecode;
+}
+
+void xd::lua::chunk_cache::clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_named_chunks.clear();
+    m_unnamed_chunks.clear();
+}
+
+std::size_t xd::lua::chunk_cache::size() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_named_chunks.size() + m_unnamed_chunks.size();
+}
+
+std::string xd::lua::chunk_cache::normalize(const std::string& chunk_name)
+{
+    auto normalized = chunk_name;
+    std::replace(normalized.begin(), normalized.end(), '\\', '/');
+    return normalized;
+}
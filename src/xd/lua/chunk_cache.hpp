@@ -0,0 +1,68 @@
+#ifndef H_XD_LUA_CHUNK_CACHE
+#define H_XD_LUA_CHUNK_CACHE
+
+#include "../vendor/sol/sol.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace xd
+{
+    namespace lua
+    {
+        // process-wide cache of compiled lua chunks. chunks are keyed by their
+        // chunk name and a hash of their source, so editing a script simply
+        // misses the cache and replaces the stale bytecode
+        class chunk_cache
+        {
+        public:
+            chunk_cache(const chunk_cache&) = delete;
+            chunk_cache& operator=(const chunk_cache&) = delete;
+            chunk_cache();
+
+            // the cache shared by all lua states
+            static chunk_cache& shared();
+            // FNV-1a hash of the source code
+            static std::uint64_t hash(const char* code, std::size_t size);
+
+            // compile the code (or reuse its cached bytecode) and push the
+            // resulting function, or an error message, like luaL_loadbuffer does
+            int load(lua_State* state, const char* code, std::size_t size, const std::string& chunk_name = "");
+            int load(lua_State* state, const std::string& code, const std::string& chunk_name = "")
+            {
+                return load(state, code.data(), code.size(), chunk_name);
+            }
+            // add precompiled bytecode, e.g. from a cache shipped with the game
+            void add(const std::string& chunk_name, std::uint64_t source_hash, std::string bytecode);
+            // compile the code and return its bytecode, throws script_load_failed on syntax errors
+            static std::string compile(const char* code, std::size_t size, const std::string& chunk_name);
+
+            void clear();
+            std::size_t size() const;
+            int hits() const { return m_hits; }
+            int misses() const { return m_misses; }
+            void reset_counters() { m_hits = 0; m_misses = 0; }
+
+            // chunks without a name are cached by source hash only, up to this many
+            static constexpr std::size_t max_unnamed_chunks = 512;
+        private:
+            struct entry
+            {
+                std::uint64_t source_hash;
+                std::string bytecode;
+            };
+            static std::string normalize(const std::string& chunk_name);
+
+            mutable std::mutex m_mutex;
+            // named chunks are keyed by name, unnamed ones by their source hash
+            std::unordered_map<std::string, entry> m_named_chunks;
+            std::unordered_map<std::uint64_t, entry> m_unnamed_chunks;
+            int m_hits;
+            int m_misses;
+        };
+    }
+}
+
+#endif
@@ -1,114 +1,347 @@
 #include "scheduler.hpp"
+#include "chunk_cache.hpp"
 #include "scheduler_task.hpp"
 #include "virtual_machine.hpp"
 #include "exceptions.hpp"
+#include <algorithm>
+
+namespace xd { namespace lua { namespace detail {
+
+    // std heaps keep the largest element on top, so compare by
+    // later deadline to keep the earliest timer there instead
+    template <typename T>
+    bool later_deadline(const T& a, const T& b)
+    {
+        return a.deadline != b.deadline ? a.deadline > b.deadline : a.sequence > b.sequence;
+    }
+
+} } }
 
 xd::lua::scheduler::scheduler(virtual_machine& vm)
     : state(vm.lua_state())
     , m_current_thread(0)
+    , m_running(false)
+    , m_next_sequence(0)
     , m_paused(false)
 {
 }
 
 void xd::lua::scheduler::start(const std::string& code, const std::string& context, const std::string& chunk_name)
 {
-    start(std::make_shared<scheduler_cothread>(state, code, chunk_name, context));
+    start(load_function(code, chunk_name), context_id(context));
 }
 
 void xd::lua::scheduler::start(const sol::protected_function& function, const std::string& context) {
-    start(std::make_shared<scheduler_cothread>(state, function, context));
+    start(function, context_id(context));
 }
 
 void xd::lua::scheduler::run()
 {
     if (m_paused) return;
 
-    // iterate through all pending tasks
-    for (auto i = m_tasks.begin(); i != m_tasks.end();) {
-        // Stop processing threads if paused
-        if (m_paused) break;
-
-        // if the thread is dead, remove it
-        if (i->thread->coroutine.status() != sol::call_status::yielded) {
-            i = m_tasks.erase(i);
-            continue;
+    // gather the threads that might resume: due timers, signaled threads
+    // and polled tasks, resuming them in the order they yielded
+    std::vector<waiting_task> candidates;
+    for (auto& clock : m_clocks) {
+        auto now = clock.now();
+        while (!clock.timers.empty() && clock.timers.front().deadline <= now) {
+            std::pop_heap(clock.timers.begin(), clock.timers.end(), detail::later_deadline<scheduler_thread_task>);
+            candidates.emplace_back(std::move(clock.timers.back()), wait_type::timer);
+            clock.timers.pop_back();
         }
+    }
+    for (auto& thread_task : m_ready_tasks) {
+        candidates.emplace_back(std::move(thread_task), wait_type::ready);
+    }
+    m_ready_tasks.clear();
+    for (auto& thread_task : m_polled_tasks) {
+        candidates.emplace_back(std::move(thread_task), wait_type::polled);
+    }
+    m_polled_tasks.clear();
+    std::sort(candidates.begin(), candidates.end(), [](const waiting_task& a, const waiting_task& b) {
+        return a.first.sequence < b.first.sequence;
+    });
 
-        // is this task complete?
-        if (i->task->is_complete()) {
-            // get the thread task
-            scheduler_thread_task thread_task = *i;
-            // remove it from the pending list
-            i = m_tasks.erase(i);
-            // set the current thread
-            m_thread_stack.push(thread_task.thread);
-            m_current_thread = thread_task.thread;
-            // resume the thread
-            m_current_thread->thread.state().globals()["SCRIPT_CONTEXT"] = m_current_thread->context;
-            auto result = thread_task.thread->coroutine();
-            if (!result.valid()) {
-                sol::error err = result;
-                throw panic_error(err.what());
+    m_running = true;
+    std::size_t next = 0;
+    try {
+        while (true) {
+            for (; next < candidates.size() && !m_paused; ++next) {
+                try_resume(candidates[next]);
             }
-            // reset current thread
-            m_thread_stack.pop();
-            if (m_thread_stack.empty())
-                m_current_thread = nullptr;
-            else
-                m_current_thread = m_thread_stack.top();
-        }
-        else {
-            ++i;
+            if (m_paused || m_new_tasks.empty()) break;
+            // threads that yielded during this run are checked right away,
+            // after everything that yielded before them
+            candidates.clear();
+            candidates.swap(m_new_tasks);
+            next = 0;
         }
+    } catch (...) {
+        // the thread that failed is dropped
+        finish_run(candidates, next + 1);
+        throw;
     }
+    finish_run(candidates, next);
 }
 
 void xd::lua::scheduler::yield(std::shared_ptr<scheduler_task> task)
 {
-    scheduler_thread_task thread_task;
-    thread_task.thread = m_current_thread;
-    thread_task.task = task;
-    m_tasks.push_back(thread_task);
+    add_waiting(make_thread_task(task), wait_type::polled);
 }
 
 int xd::lua::scheduler::pending_tasks()
 {
-    return m_tasks.size();
+    auto count = m_polled_tasks.size() + m_ready_tasks.size() + m_new_tasks.size();
+    for (auto& clock : m_clocks) {
+        count += clock.timers.size();
+    }
+    for (auto& [key, tasks] : m_signal_tasks) {
+        count += tasks.size();
+    }
+    return static_cast<int>(count);
+}
+
+int xd::lua::scheduler::add_clock(std::function<int()> clock)
+{
+    m_clocks.push_back(timer_clock{ std::move(clock), {} });
+    return static_cast<int>(m_clocks.size()) - 1;
+}
+
+void xd::lua::scheduler::yield_until(int clock_id, int deadline)
+{
+    auto thread_task = make_thread_task(nullptr);
+    thread_task.clock_id = clock_id;
+    thread_task.deadline = deadline;
+    add_waiting(std::move(thread_task), wait_type::timer);
+}
+
+void xd::lua::scheduler::yield_for_signal(const void* key, std::shared_ptr<scheduler_task> task)
+{
+    auto thread_task = make_thread_task(task);
+    thread_task.signal = key;
+    add_waiting(std::move(thread_task), wait_type::signal);
+}
+
+void xd::lua::scheduler::notify(const void* key)
+{
+    auto it = m_signal_tasks.find(key);
+    if (it == m_signal_tasks.end()) return;
+    for (auto& thread_task : it->second) {
+        m_ready_tasks.push_back(std::move(thread_task));
+    }
+    m_signal_tasks.erase(it);
+}
+
+void xd::lua::scheduler::start(const sol::protected_function& function, int context)
+{
+    call(std::make_shared<scheduler_cothread>(acquire_thread(), function, context));
+}
+
+void xd::lua::scheduler::resume(const scheduler_thread_task& thread_task)
+{
+    call(thread_task.thread);
 }
 
-void xd::lua::scheduler::start(const std::shared_ptr<xd::lua::scheduler::scheduler_cothread>& cothread) {
+void xd::lua::scheduler::call(const std::shared_ptr<scheduler_cothread>& cothread)
+{
     // set the current thread
     m_thread_stack.push(cothread);
-    m_current_thread = m_thread_stack.top();
-    m_current_thread->thread.state().globals()["SCRIPT_CONTEXT"] = m_current_thread->context;
-    // start the thread
-    auto result = m_current_thread->coroutine();
-    if (!result.valid()) {
-        sol::error err = result;
-        throw panic_error(err.what());
+    m_current_thread = cothread;
+    activate_context(*cothread);
+    // start or resume the thread
+    bool error, finished;
+    std::string message;
+    {
+        auto result = cothread->coroutine();
+        error = !result.valid();
+        finished = !error && result.status() == sol::call_status::ok;
+        if (error) {
+            sol::error err = result;
+            message = err.what();
+        }
+    }
+    if (finished) {
+        recycle(*cothread);
     }
     // reset current thread
     m_thread_stack.pop();
-    if (m_thread_stack.empty())
+    if (m_thread_stack.empty()) {
         m_current_thread = nullptr;
-    else
+    } else {
         m_current_thread = m_thread_stack.top();
+        activate_context(*m_current_thread);
+    }
+    if (error) {
+        throw panic_error(message);
+    }
+}
+
+sol::protected_function xd::lua::scheduler::load_function(const std::string& code, const std::string& chunk_name)
+{
+    // scripts such as NPC interactions are started over and over,
+    // so keep the loaded main function around and call it directly
+    auto it = m_functions.find(code);
+    if (it != m_functions.end() && it->second.chunk_name == chunk_name) {
+        return it->second.function;
+    }
+
+    auto lua_state = state.lua_state();
+    if (chunk_cache::shared().load(lua_state, code, chunk_name) != LUA_OK) {
+        auto message = sol::stack::pop<std::string>(lua_state);
+        throw panic_error(message);
+    }
+    auto function = sol::stack::pop<sol::protected_function>(lua_state);
+    if (it != m_functions.end()) {
+        it->second = cached_function{ chunk_name, function };
+    } else {
+        if (m_functions.size() >= max_cached_functions) {
+            m_functions.clear();
+        }
+        m_functions.emplace(code, cached_function{ chunk_name, function });
+    }
+    return function;
+}
+
+sol::thread xd::lua::scheduler::acquire_thread()
+{
+    if (m_thread_pool.empty()) {
+        return sol::thread::create(state);
+    }
+    auto thread = std::move(m_thread_pool.back());
+    m_thread_pool.pop_back();
+    return thread;
+}
+
+void xd::lua::scheduler::recycle(scheduler_cothread& cothread)
+{
+    // only threads that returned normally can run another function,
+    // ones that raised an error are left for the garbage collector
+    cothread.finished = true;
+    cothread.coroutine = sol::coroutine();
+    if (m_thread_pool.size() >= max_pooled_threads) return;
+    lua_settop(cothread.thread.state().lua_state(), 0);
+    m_thread_pool.push_back(std::move(cothread.thread));
+}
+
+int xd::lua::scheduler::context_id(const std::string& context)
+{
+    auto it = m_context_ids.find(context);
+    if (it != m_context_ids.end()) return it->second;
+
+    auto lua_state = state.lua_state();
+    sol::stack::push(lua_state, context);
+    m_contexts.push_back(script_context{ context, sol::reference(lua_state, -1) });
+    lua_pop(lua_state, 1);
+    auto id = static_cast<int>(m_contexts.size()) - 1;
+    m_context_ids.emplace(context, id);
+    return id;
+}
+
+void xd::lua::scheduler::activate_context(const scheduler_cothread& cothread)
+{
+    // SCRIPT_CONTEXT is shared by every scheduler using the lua state,
+    // so compare against the global itself and only write it on a change
+    auto lua_state = cothread.thread.state().lua_state();
+    auto top = lua_gettop(lua_state);
+    lua_getglobal(lua_state, "SCRIPT_CONTEXT");
+    m_contexts[cothread.context].value.push(lua_state);
+    if (!lua_rawequal(lua_state, -1, -2)) {
+        lua_setglobal(lua_state, "SCRIPT_CONTEXT");
+    }
+    lua_settop(lua_state, top);
+}
+
+void xd::lua::scheduler::try_resume(waiting_task& waiting)
+{
+    auto& [thread_task, type] = waiting;
+    // if the thread is dead, drop it
+    auto& cothread = *thread_task.thread;
+    if (cothread.finished || cothread.coroutine.status() != sol::call_status::yielded) return;
+
+    bool can_resume = false;
+    switch (type) {
+    case wait_type::timer:
+        can_resume = m_clocks[thread_task.clock_id].now() >= thread_task.deadline;
+        break;
+    case wait_type::signal:
+        // only resumes once notified
+        break;
+    case wait_type::polled:
+    case wait_type::ready:
+        can_resume = thread_task.task->is_complete();
+        break;
+    }
+
+    if (!can_resume) {
+        // a signaled task that isn't complete yet falls back to polling
+        place(std::move(thread_task), type == wait_type::ready ? wait_type::polled : type);
+        return;
+    }
+
+    resume(thread_task);
+}
+
+void xd::lua::scheduler::finish_run(std::vector<waiting_task>& candidates, std::size_t next)
+{
+    m_running = false;
+    for (; next < candidates.size(); ++next) {
+        place(std::move(candidates[next].first), candidates[next].second);
+    }
+    for (auto& [thread_task, type] : m_new_tasks) {
+        place(std::move(thread_task), type);
+    }
+    m_new_tasks.clear();
+}
+
+xd::lua::scheduler::scheduler_thread_task xd::lua::scheduler::make_thread_task(std::shared_ptr<scheduler_task> task)
+{
+    scheduler_thread_task thread_task;
+    thread_task.thread = m_current_thread;
+    thread_task.task = task;
+    thread_task.sequence = m_next_sequence++;
+    thread_task.clock_id = -1;
+    thread_task.deadline = 0;
+    thread_task.signal = nullptr;
+    return thread_task;
 }
 
-xd::lua::scheduler::scheduler_cothread::scheduler_cothread(sol::state& state, const std::string& code,
-        const std::string& chunk_name, const std::string& context) {
-    thread = sol::thread::create(state);
-    auto load_result = thread.state().load(code, chunk_name);
-    if (!load_result.valid()) {
-        sol::error err = load_result;
-        throw panic_error(err.what());
+void xd::lua::scheduler::add_waiting(scheduler_thread_task thread_task, wait_type type)
+{
+    if (m_running) {
+        m_new_tasks.emplace_back(std::move(thread_task), type);
+    } else {
+        place(std::move(thread_task), type);
     }
-    coroutine = load_result;
-    this->context = context;
 }
 
-xd::lua::scheduler::scheduler_cothread::scheduler_cothread(sol::state& state, const sol::protected_function& function, const std::string& context) {
-    thread = sol::thread::create(state);
-    coroutine = { thread.state(), function };
-    this->context = context;
+void xd::lua::scheduler::place(scheduler_thread_task thread_task, wait_type type)
+{
+    switch (type) {
+    case wait_type::timer: {
+        auto& timers = m_clocks[thread_task.clock_id].timers;
+        timers.push_back(std::move(thread_task));
+        std::push_heap(timers.begin(), timers.end(), detail::later_deadline<scheduler_thread_task>);
+        break;
+    }
+    case wait_type::signal: {
+        auto key = thread_task.signal;
+        m_signal_tasks[key].push_back(std::move(thread_task));
+        break;
+    }
+    case wait_type::ready:
+        m_ready_tasks.push_back(std::move(thread_task));
+        break;
+    case wait_type::polled:
+        m_polled_tasks.push_back(std::move(thread_task));
+        break;
+    }
+}
+
+xd::lua::scheduler::scheduler_cothread::scheduler_cothread(sol::thread thread,
+        const sol::protected_function& function, int context)
+    : thread(std::move(thread))
+    , context(context)
+    , finished(false)
+{
+    coroutine = { this->thread.state(), function };
 }
@@ -3,12 +3,16 @@
 
 #include "../vendor/sol/sol.hpp"
 #include "scheduler_task.hpp"
-#include <list>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <memory>
 #include <stack>
 #include <string>
 #include <type_traits>
+#include <unordered_map>
 #include <utility>
+#include <vector>
 
 namespace xd
 {
@@ -17,7 +21,10 @@ namespace xd
         class virtual_machine;
 
         // the lua scheduler, supports yielding threads
-        // from both C++ and lua's side
+        // from both C++ and lua's side. threads waiting on a timer or a
+        // signal aren't checked until they can resume, only plain tasks
+        // are polled every run. finished lua threads are pooled and reused
+        // by later scripts, and loaded code is kept as ready-to-call functions
         class scheduler
         {
         public:
@@ -33,6 +40,18 @@ namespace xd
             bool paused() const { return m_paused; }
             void yield(std::shared_ptr<scheduler_task> task);
             int pending_tasks();
+            // number of finished lua threads waiting to be reused
+            std::size_t pooled_threads() const { return m_thread_pool.size(); }
+
+            // register a clock (e.g. game ticks) that timers can wait on, returns its id
+            int add_clock(std::function<int()> clock);
+            // yield the current thread until the clock reaches the deadline
+            void yield_until(int clock_id, int deadline);
+            // yield the current thread until notify is called with the key,
+            // after which the task is polled until it completes
+            void yield_for_signal(const void* key, std::shared_ptr<scheduler_task> task);
+            // wake the threads waiting for the key
+            void notify(const void* key);
 
             // yields a thread; copies the passed scheduler_task
             template <typename T>
@@ -85,24 +104,79 @@ namespace xd
                 state[name] = sol::yielding(f);
             }
 
+            static constexpr std::size_t max_pooled_threads = 64;
+            static constexpr std::size_t max_cached_functions = 256;
         private:
             sol::state& state;
             struct scheduler_cothread {
                 sol::thread thread;
                 sol::coroutine coroutine;
-                std::string context;
-                scheduler_cothread(sol::state& state, const std::string& code, const std::string& chunk_name, const std::string& context);
-                scheduler_cothread(sol::state& state, const sol::protected_function& function, const std::string& context);
+                // index in m_contexts
+                int context;
+                // set once the thread went back to the pool
+                bool finished;
+                scheduler_cothread(sol::thread thread, const sol::protected_function& function, int context);
+            };
+            struct script_context
+            {
+                std::string name;
+                // the name as a lua string, so switching doesn't create one
+                sol::reference value;
+            };
+            struct cached_function
+            {
+                std::string chunk_name;
+                sol::protected_function function;
             };
             struct scheduler_thread_task
             {
                 std::shared_ptr<scheduler_cothread> thread;
                 std::shared_ptr<scheduler_task> task;
+                // yield order, threads that can resume in the same run resume in this order
+                std::uint64_t sequence;
+                // for timers
+                int clock_id;
+                int deadline;
+                // for signals
+                const void* signal;
+            };
+            struct timer_clock
+            {
+                std::function<int()> now;
+                // min-heap on the deadline (then sequence)
+                std::vector<scheduler_thread_task> timers;
             };
-            void start(const std::shared_ptr<scheduler_cothread>& cothread);
+            // where a yielded thread waits
+            enum class wait_type { polled, timer, signal, ready };
+            void start(const sol::protected_function& function, int context);
+            void call(const std::shared_ptr<scheduler_cothread>& cothread);
+            sol::protected_function load_function(const std::string& code, const std::string& chunk_name);
+            sol::thread acquire_thread();
+            void recycle(scheduler_cothread& cothread);
+            int context_id(const std::string& context);
+            void activate_context(const scheduler_cothread& cothread);
+            typedef std::pair<scheduler_thread_task, wait_type> waiting_task;
+            void resume(const scheduler_thread_task& thread_task);
+            void try_resume(waiting_task& waiting);
+            void finish_run(std::vector<waiting_task>& candidates, std::size_t next);
+            scheduler_thread_task make_thread_task(std::shared_ptr<scheduler_task> task);
+            void add_waiting(scheduler_thread_task thread_task, wait_type type);
+            void place(scheduler_thread_task thread_task, wait_type type);
             std::shared_ptr<scheduler_cothread> m_current_thread;
             std::stack<std::shared_ptr<scheduler_cothread>> m_thread_stack;
-            std::list<scheduler_thread_task> m_tasks;
+            std::vector<scheduler_thread_task> m_polled_tasks;
+            std::vector<scheduler_thread_task> m_ready_tasks;
+            std::vector<timer_clock> m_clocks;
+            std::unordered_map<const void*, std::vector<scheduler_thread_task>> m_signal_tasks;
+            // threads that yielded during the current run
+            std::vector<waiting_task> m_new_tasks;
+            std::vector<sol::thread> m_thread_pool;
+            std::vector<script_context> m_contexts;
+            std::unordered_map<std::string, int> m_context_ids;
+            // keyed by source code
+            std::unordered_map<std::string, cached_function> m_functions;
+            bool m_running;
+            std::uint64_t m_next_sequence;
             bool m_paused;
         };
     }
@@ -1,7 +1,12 @@
 #include "virtual_machine.hpp"
 #include "../../vendor/lutf8lib.hpp"
+#include <chrono>
 
 xd::lua::virtual_machine::virtual_machine()
+    : m_gc_mode(gc_mode::incremental)
+    , m_gc_paced(false)
+    , m_gc_cycle_done(true)
+    , m_gc_live_memory(0)
 {
     // open some common libraries
     m_lua_state.open_libraries(sol::lib::base,
@@ -16,3 +21,77 @@ xd::lua::virtual_machine::virtual_machine()
     luaopen_utf8(m_lua_state.lua_state());
 }
 
+
+bool xd::lua::virtual_machine::set_gc_mode(gc_mode mode)
+{
+    // lua 5.2 and 5.4 have a generational mode, 5.3 doesn't
+#ifdef LUA_GCGEN
+    auto option = mode == gc_mode::generational ? LUA_GCGEN : LUA_GCINC;
+#if LUA_VERSION_NUM >= 504
+    // 0 keeps the default parameters
+    lua_gc(m_lua_state.lua_state(), option, 0, 0);
+#else
+    lua_gc(m_lua_state.lua_state(), option, 0);
+#endif
+    m_gc_mode = mode;
+    return true;
+#else
+    return mode == gc_mode::incremental;
+#endif
+}
+
+void xd::lua::virtual_machine::set_gc_paced(bool paced)
+{
+    lua_gc(m_lua_state.lua_state(), paced ? LUA_GCSTOP : LUA_GCRESTART, 0);
+    m_gc_paced = paced;
+    if (paced && m_gc_live_memory == 0) {
+        m_gc_live_memory = memory_usage();
+    }
+}
+
+void xd::lua::virtual_machine::step_gc(double budget_ms)
+{
+    auto state = m_lua_state.lua_state();
+    auto memory = memory_usage();
+    if (m_gc_mode == gc_mode::generational) {
+        // every step is a whole young (or when needed, major) collection that
+        // can't be split up, so only collect once enough young objects piled up
+        if (memory < m_gc_live_memory * gc_generational_pause) return;
+        lua_gc(state, LUA_GCSTEP, 0);
+        gc_cycle_finished();
+        return;
+    }
+
+    auto over_limit = memory > m_gc_live_memory * gc_limit;
+    if (m_gc_cycle_done && memory < m_gc_live_memory * gc_pause && !over_limit) return;
+
+    auto start = std::chrono::steady_clock::now();
+    auto budget = std::chrono::duration<double, std::milli>(budget_ms);
+    m_gc_cycle_done = false;
+    do {
+        // returns 1 when the step finished a cycle
+        if (lua_gc(state, LUA_GCSTEP, gc_step_size)) {
+            gc_cycle_finished();
+            return;
+        }
+    } while (over_limit || std::chrono::steady_clock::now() - start < budget);
+}
+
+void xd::lua::virtual_machine::full_gc()
+{
+    lua_gc(m_lua_state.lua_state(), LUA_GCCOLLECT, 0);
+    gc_cycle_finished();
+}
+
+std::size_t xd::lua::virtual_machine::memory_usage()
+{
+    auto state = m_lua_state.lua_state();
+    return static_cast<std::size_t>(lua_gc(state, LUA_GCCOUNT, 0)) * 1024
+        + static_cast<std::size_t>(lua_gc(state, LUA_GCCOUNTB, 0));
+}
+
+void xd::lua::virtual_machine::gc_cycle_finished()
+{
+    m_gc_cycle_done = true;
+    m_gc_live_memory = memory_usage();
+}
@@ -2,11 +2,14 @@
 #define H_XD_LUA_VIRTUAL_MACHINE
 
 #include "../vendor/sol/sol.hpp"
+#include <cstddef>
 
 namespace xd
 {
     namespace lua
     {
+        enum class gc_mode { incremental, generational };
+
         class virtual_machine
         {
         public:
@@ -14,6 +17,24 @@ namespace xd
             virtual_machine& operator=(const virtual_machine&) = delete;
             virtual_machine();
 
+            // switch the collector mode, returns false if the lua version doesn't support it
+            bool set_gc_mode(gc_mode mode);
+            gc_mode get_gc_mode() const noexcept { return m_gc_mode; }
+            // when paced, the collector no longer runs as a side effect of
+            // allocations and only collects in step_gc and full_gc
+            void set_gc_paced(bool paced);
+            bool is_gc_paced() const noexcept { return m_gc_paced; }
+            // do collection work for at most budget_ms milliseconds. if memory
+            // grew past the limit the current cycle is finished regardless.
+            // generational collections can't be split, so in that mode the
+            // budget is ignored and a collection only runs once memory grew
+            // by gc_generational_pause since the last one
+            void step_gc(double budget_ms);
+            // run a whole collection, e.g. during map transitions
+            void full_gc();
+            // memory used by lua in bytes
+            std::size_t memory_usage();
+
             sol::state& lua_state() noexcept { return m_lua_state; }
 
             sol::table globals() const
@@ -38,8 +59,23 @@ namespace xd
                 return m_lua_state.registry()[key];
             }
 
+            // a finished cycle waits until memory grows by this factor
+            static constexpr double gc_pause = 2.0;
+            // past this factor of the live memory, cycles ignore the budget
+            static constexpr double gc_limit = 4.0;
+            // work done by each incremental step, in KB
+            static constexpr int gc_step_size = 16;
+            // growth of the memory that triggers a generational collection
+            static constexpr double gc_generational_pause = 1.2;
         private:
+            void gc_cycle_finished();
+
             sol::state m_lua_state;
+            gc_mode m_gc_mode;
+            bool m_gc_paced;
+            bool m_gc_cycle_done;
+            // memory in use after the last finished cycle
+            std::size_t m_gc_live_memory;
         };
     }
 }
@@ -0,0 +1,71 @@
+#ifndef H_XD_SYSTEM_FIXED_STEP_TIMER
+#define H_XD_SYSTEM_FIXED_STEP_TIMER
+
+#include <cstdint>
+
+namespace xd
+{
+    // splits elapsed time into fixed steps running at a whole number of steps
+    // per second. time is accumulated in nanoseconds scaled by the step rate,
+    // so steps like 1/60 s are exact and never drift
+    class fixed_step_timer
+    {
+    public:
+        static constexpr std::int64_t nanoseconds_per_second = 1000000000;
+
+        fixed_step_timer(int steps_per_second = 60, int max_steps = 5) noexcept
+            : m_steps_per_second(steps_per_second > 0 ? steps_per_second : 1)
+            , m_max_steps(max_steps)
+            , m_accumulator(0)
+            , m_dropped_steps(0) {}
+
+        int steps_per_second() const noexcept { return m_steps_per_second; }
+        void set_steps_per_second(int steps_per_second) noexcept
+        {
+            // the accumulator stays the same fraction of a step
+            m_steps_per_second = steps_per_second > 0 ? steps_per_second : 1;
+        }
+        // maximum steps returned by a single advance, 0 or less means no limit
+        int max_steps() const noexcept { return m_max_steps; }
+        void set_max_steps(int max_steps) noexcept { m_max_steps = max_steps; }
+
+        // add the elapsed time and return the number of steps to run. when more
+        // than max_steps are due the extra time is dropped instead of catching up
+        int advance(std::int64_t elapsed_nanoseconds) noexcept
+        {
+            if (elapsed_nanoseconds > 0) {
+                m_accumulator += elapsed_nanoseconds * m_steps_per_second;
+            }
+            auto steps = m_accumulator / nanoseconds_per_second;
+            m_accumulator -= steps * nanoseconds_per_second;
+            if (m_max_steps > 0 && steps > m_max_steps) {
+                m_dropped_steps += steps - m_max_steps;
+                steps = m_max_steps;
+            }
+            return static_cast<int>(steps);
+        }
+
+        // shortest time to advance by so that the next step becomes due
+        std::int64_t time_to_next_step() const noexcept
+        {
+            auto remaining = nanoseconds_per_second - m_accumulator;
+            return (remaining + m_steps_per_second - 1) / m_steps_per_second;
+        }
+        // fraction of the next step that has already elapsed, in [0, 1)
+        double alpha() const noexcept
+        {
+            return static_cast<double>(m_accumulator) / nanoseconds_per_second;
+        }
+        // total number of steps skipped because of the cap
+        std::uint64_t dropped_steps() const noexcept { return m_dropped_steps; }
+        void reset() noexcept { m_accumulator = 0; }
+    private:
+        int m_steps_per_second;
+        int m_max_steps;
+        // elapsed nanoseconds multiplied by the step rate
+        std::int64_t m_accumulator;
+        std::uint64_t m_dropped_steps;
+    };
+}
+
+#endif
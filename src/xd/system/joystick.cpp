@@ -0,0 +1,152 @@
+#include "joystick.hpp"
+#include "input.hpp"
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+namespace
+{
+    // indices of the gamepad layout, matching GLFW's
+    constexpr int gamepad_button_count = 15;
+    constexpr int dpad_up = 11;
+    constexpr int dpad_right = 12;
+    constexpr int dpad_down = 13;
+    constexpr int dpad_left = 14;
+    constexpr int axis_left_x = 0;
+    constexpr int axis_left_y = 1;
+    constexpr int axis_left_trigger = 4;
+    constexpr int axis_right_trigger = 5;
+
+    constexpr std::int64_t never_used = std::numeric_limits<std::int64_t>::min() / 2;
+}
+
+xd::joystick_poller::joystick_poller(std::unique_ptr<joystick_source> source)
+        : m_source(std::move(source))
+        , m_slots{}
+        , m_gamepad_detection(true)
+        , m_axis_as_dpad(false)
+        , m_stick_sensitivity(0.5f)
+        , m_trigger_sensitivity(0.5f)
+        , m_poll_count(0)
+        , m_next_idle(0)
+        , m_last_poll_time(0) {
+    for (auto& slot : m_slots) {
+        slot.last_used = never_used;
+    }
+}
+
+void xd::joystick_poller::set_source(std::unique_ptr<joystick_source> source) {
+    m_source = std::move(source);
+}
+
+bool xd::joystick_poller::connect(int id) {
+    if (id < 0 || id >= max_joysticks || !m_source || !m_source->present(id)) return false;
+
+    auto& slot = m_slots[id];
+    slot.connected = true;
+    slot.is_virtual = false;
+    slot.state = joystick_state{};
+    slot.reads = 0;
+    // a joystick that was just plugged in is probably about to be used
+    slot.last_used = m_last_poll_time;
+    slot.guid = m_source->guid(id);
+    return true;
+}
+
+void xd::joystick_poller::connect_virtual(int id) {
+    if (id < 0 || id >= max_joysticks || m_slots[id].connected) return;
+
+    auto& slot = m_slots[id];
+    slot.connected = true;
+    slot.is_virtual = true;
+    slot.state = joystick_state{};
+    slot.reads = 0;
+    slot.last_used = never_used;
+    slot.guid.clear();
+}
+
+void xd::joystick_poller::disconnect(int id) {
+    if (id < 0 || id >= max_joysticks) return;
+    m_slots[id].connected = false;
+    m_slots[id].guid.clear();
+}
+
+bool xd::joystick_poller::is_gamepad(int id) const {
+    if (!connected(id)) return false;
+    // injected joysticks always use the gamepad layout
+    return m_slots[id].is_virtual || (m_source && m_source->is_gamepad(id));
+}
+
+std::string xd::joystick_poller::guid(int id) const {
+    return connected(id) ? m_slots[id].guid : "";
+}
+
+std::string xd::joystick_poller::name(int id) const {
+    if (!connected(id) || m_slots[id].is_virtual || !m_source) return "";
+    return m_source->name(id);
+}
+
+void xd::joystick_poller::poll(int active_id, std::int64_t now, const button_callback_t& callback) {
+    m_last_poll_time = now;
+    bool scan_idle = ++m_poll_count >= idle_poll_interval;
+    if (scan_idle) {
+        m_poll_count = 0;
+    }
+
+    int idle_to_read = -1;
+    for (int offset = 0; offset < max_joysticks; ++offset) {
+        int id = (m_next_idle + offset) % max_joysticks;
+        auto& slot = m_slots[id];
+        if (!slot.connected || slot.is_virtual) continue;
+
+        auto recently_used = now - slot.last_used <= recent_use_duration;
+        if (id == active_id || recently_used) {
+            read(id, now, callback);
+        } else if (scan_idle && idle_to_read == -1) {
+            idle_to_read = id;
+        }
+    }
+
+    // round robin through the idle joysticks
+    if (idle_to_read != -1) {
+        read(idle_to_read, now, callback);
+        m_next_idle = (idle_to_read + 1) % max_joysticks;
+    }
+}
+
+void xd::joystick_poller::read(int id, std::int64_t now, const button_callback_t& callback) {
+    auto& slot = m_slots[id];
+    auto& state = slot.state;
+    auto& buttons = state.buttons;
+    auto& axes = state.axes;
+
+    std::fill(buttons, buttons + gamepad_button_count, static_cast<unsigned char>(0));
+    std::fill(axes, axes + joystick_axis_count, 0.0f);
+    m_source->read(id, m_gamepad_detection, state);
+    ++slot.reads;
+
+    for (int button = 0; button < gamepad_button_count; ++button) {
+        buttons[button] = buttons[button] ? 1 : 0;
+    }
+
+    if (m_axis_as_dpad) {
+        buttons[dpad_up] |= static_cast<unsigned char>(axes[axis_left_y] <= -m_stick_sensitivity);
+        buttons[dpad_right] |= static_cast<unsigned char>(axes[axis_left_x] >= m_stick_sensitivity);
+        buttons[dpad_down] |= static_cast<unsigned char>(axes[axis_left_y] >= m_stick_sensitivity);
+        buttons[dpad_left] |= static_cast<unsigned char>(axes[axis_left_x] <= -m_stick_sensitivity);
+    }
+
+    // triggers as buttons
+    buttons[GAMEPAD_BUTTON_LEFT_TRIGGER_INDEX] =
+        static_cast<unsigned char>(axes[axis_left_trigger] >= m_trigger_sensitivity);
+    buttons[GAMEPAD_BUTTON_RIGHT_TRIGGER_INDEX] =
+        static_cast<unsigned char>(axes[axis_right_trigger] >= m_trigger_sensitivity);
+
+    for (int button = 0; button < joystick_button_count; ++button) {
+        if (buttons[button] != state.prev_buttons[button]) {
+            state.prev_buttons[button] = buttons[button];
+            slot.last_used = now;
+            callback(id, button, buttons[button] != 0);
+        }
+    }
+}
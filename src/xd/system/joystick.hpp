@@ -0,0 +1,113 @@
+#ifndef H_XD_SYSTEM_JOYSTICK
+#define H_XD_SYSTEM_JOYSTICK
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+
+namespace xd
+{
+    // GLFW supports 16 joysticks
+    constexpr int max_joysticks = 16;
+    // 15 gamepad buttons plus two pseudo-buttons for the triggers
+    constexpr int joystick_button_count = 17;
+    constexpr int joystick_axis_count = 6;
+
+    struct joystick_state
+    {
+        float axes[joystick_axis_count];
+        unsigned char buttons[joystick_button_count];
+        // buttons as of the last generated events
+        unsigned char prev_buttons[joystick_button_count];
+    };
+
+    // where joystick state comes from: GLFW for a real window, fakes in tests
+    class joystick_source
+    {
+    public:
+        virtual ~joystick_source() = default;
+        virtual bool present(int id) const = 0;
+        virtual bool is_gamepad(int id) const = 0;
+        virtual std::string guid(int id) const = 0;
+        virtual std::string name(int id) const = 0;
+        // read the current gamepad buttons and axes into the state, using the
+        // gamepad mapping if requested and available. the trigger pseudo-buttons
+        // and prev_buttons are left alone
+        virtual void read(int id, bool gamepad_mapping, joystick_state& state) const = 0;
+    };
+
+    // keeps the state of every connected joystick in fixed slots and turns button
+    // changes into events. only the active joystick and the recently used ones are
+    // read on every poll, idle joysticks are read one at a time every
+    // idle_poll_interval polls so they can still become active
+    class joystick_poller
+    {
+    public:
+        typedef std::function<void (int id, int button, bool pressed)> button_callback_t;
+
+        static constexpr int idle_poll_interval = 4;
+        // nanoseconds a joystick stays recently used after its last button change
+        static constexpr std::int64_t recent_use_duration = 2000000000;
+
+        explicit joystick_poller(std::unique_ptr<joystick_source> source = nullptr);
+
+        joystick_source* source() const noexcept { return m_source.get(); }
+        void set_source(std::unique_ptr<joystick_source> source);
+
+        void set_gamepad_detection(bool detection) noexcept { m_gamepad_detection = detection; }
+        void set_axis_as_dpad(bool axis_as_dpad) noexcept { m_axis_as_dpad = axis_as_dpad; }
+        void set_stick_sensitivity(float sensitivity) noexcept { m_stick_sensitivity = sensitivity; }
+        void set_trigger_sensitivity(float sensitivity) noexcept { m_trigger_sensitivity = sensitivity; }
+
+        // start tracking a joystick reported by the source, returns whether it's present
+        bool connect(int id);
+        // track a joystick that only gets injected input and is never read
+        void connect_virtual(int id);
+        void disconnect(int id);
+        bool connected(int id) const noexcept
+        {
+            return id >= 0 && id < max_joysticks && m_slots[id].connected;
+        }
+        bool is_gamepad(int id) const;
+        std::string guid(int id) const;
+        std::string name(int id) const;
+        // state of a connected joystick
+        joystick_state& state(int id) { return m_slots[id].state; }
+        const joystick_state& state(int id) const { return m_slots[id].state; }
+
+        // read the joysticks that are due and call the callback for each changed
+        // button. now is in nanoseconds and only used to track recent use
+        void poll(int active_id, std::int64_t now, const button_callback_t& callback);
+        // number of times a joystick was read since it was connected
+        std::uint64_t read_count(int id) const noexcept
+        {
+            return id >= 0 && id < max_joysticks ? m_slots[id].reads : 0;
+        }
+    private:
+        struct slot
+        {
+            bool connected;
+            bool is_virtual;
+            joystick_state state;
+            std::int64_t last_used;
+            std::uint64_t reads;
+            std::string guid;
+        };
+
+        std::unique_ptr<joystick_source> m_source;
+        std::array<slot, max_joysticks> m_slots;
+        bool m_gamepad_detection;
+        bool m_axis_as_dpad;
+        float m_stick_sensitivity;
+        float m_trigger_sensitivity;
+        int m_poll_count;
+        int m_next_idle;
+        std::int64_t m_last_poll_time;
+
+        void read(int id, std::int64_t now, const button_callback_t& callback);
+    };
+}
+
+#endif
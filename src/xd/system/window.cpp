@@ -1,5 +1,6 @@
 #include "window.hpp"
 #include "exceptions.hpp"
+#include "../graphics/gl_state.hpp"
 #include "../vendor/glm/gtx/hash.hpp"
 #include "../vendor/utf8.h"
 #include <GL/glew.h>
@@ -8,6 +9,7 @@
 #else
     #include <GLFW/glfw3.h>
 #endif
+#include <algorithm>
 #include <cstdlib>
 
 // detail stuff, hidden from user
@@ -38,6 +40,65 @@ namespace
     void on_error(int error, const char* description) {
         window_instance->on_error(error, description);
     }
+
+    class glfw_joystick_source : public xd::joystick_source {
+    public:
+        bool present(int id) const override {
+            return glfwJoystickPresent(id) == GLFW_TRUE;
+        }
+        bool is_gamepad(int id) const override {
+            return glfwJoystickIsGamepad(id) == GLFW_TRUE;
+        }
+        std::string guid(int id) const override {
+            auto guid = glfwGetJoystickGUID(id);
+            return guid ? guid : "";
+        }
+        std::string name(int id) const override {
+            auto name = is_gamepad(id) ? glfwGetGamepadName(id) : glfwGetJoystickName(id);
+            return name ? name : "";
+        }
+        void read(int id, bool gamepad_mapping, xd::joystick_state& state) const override {
+            auto& buttons = state.buttons;
+            auto& axes = state.axes;
+
+            if (gamepad_mapping && glfwJoystickIsGamepad(id)) {
+                GLFWgamepadstate gamepad_state;
+                if (glfwGetGamepadState(id, &gamepad_state) == GLFW_TRUE) {
+                    for (int button = 0; button < GLFW_GAMEPAD_BUTTON_LAST + 1; ++button) {
+                        buttons[button] = gamepad_state.buttons[button];
+                    }
+                    for (int axis = 0; axis < GLFW_GAMEPAD_AXIS_LAST + 1; ++axis) {
+                        axes[axis] = gamepad_state.axes[axis];
+                    }
+                    return;
+                }
+            }
+
+            int button_count = 0;
+            int axes_count = 0;
+            auto button_state = glfwGetJoystickButtons(id, &button_count);
+            auto axis_state = glfwGetJoystickAxes(id, &axes_count);
+            button_count = std::min(button_count, GLFW_GAMEPAD_BUTTON_LAST + 1);
+            axes_count = std::min(axes_count, GLFW_GAMEPAD_AXIS_LAST + 1);
+
+            for (int button = 0; button < button_count; button++) {
+                buttons[button] = button_state[button];
+            }
+
+            int hat_count;
+            auto hat_state = glfwGetJoystickHats(id, &hat_count);
+            if (hat_count > 0) {
+                buttons[GLFW_GAMEPAD_BUTTON_DPAD_UP] = hat_state[0] & GLFW_HAT_UP;
+                buttons[GLFW_GAMEPAD_BUTTON_DPAD_RIGHT] = hat_state[0] & GLFW_HAT_RIGHT;
+                buttons[GLFW_GAMEPAD_BUTTON_DPAD_DOWN] = hat_state[0] & GLFW_HAT_DOWN;
+                buttons[GLFW_GAMEPAD_BUTTON_DPAD_LEFT] = hat_state[0] & GLFW_HAT_LEFT;
+            }
+
+            for (int axis = 0; axis < axes_count; axis++) {
+                axes[axis] = axis_state[axis];
+            }
+        }
+    };
 };
 
 xd::window::window(const std::string& title, int width, int height, const window_options& options)
@@ -45,15 +106,10 @@ xd::window::window(const std::string& title, int width, int height, const window
         , m_width(width)
         , m_height(height)
         , m_joystick_enabled(true)
-        , m_gamepad_detection(true)
-        , m_axis_as_dpad(false)
-        , m_stick_sensitivity(0.5f)
-        , m_trigger_sensitivity(0.5f)
         , m_last_input_type(input_type::INPUT_KEYBOARD)
-        , m_current_ticks(0)
-        , m_last_ticks(0)
-        , m_tick_handler_counter(0)
-        , m_tick_handler_interval(0)
+        , m_timer_start(0)
+        , m_current_time(0)
+        , m_last_time(0)
         , m_fps(0)
         , m_frame_count(0)
         , m_last_fps_update(0)
@@ -66,6 +122,28 @@ xd::window::window(const std::string& title, int width, int height, const window
         throw xd::window_creation_failed();
     }
 
+    m_joystick_enabled = options.enable_joystick;
+    m_key_down_event = m_input_events.id("key_down");
+    m_key_up_event = m_input_events.id("key_up");
+    m_joysticks.set_gamepad_detection(options.gamepad_detection);
+    m_joysticks.set_axis_as_dpad(options.axis_as_dpad);
+    m_joysticks.set_stick_sensitivity(options.stick_sensitivity);
+    m_joysticks.set_trigger_sensitivity(options.trigger_sensitivity);
+    m_preferred_joystick_guid = options.preferred_joystick_guid;
+
+    if (options.headless) {
+        // no GLFW at all, input only comes from inject_input
+        if (m_width == -1 || m_height == -1) {
+            m_width = options.game_width;
+            m_height = options.game_height;
+        }
+        m_windowed_size = xd::ivec2(m_width, m_height);
+        m_windowed_pos = xd::ivec2(0, 0);
+        gl_state::set_headless(true);
+        window_instance = this;
+        return;
+    }
+
 #ifdef __linux__
     glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_X11);
 #endif
@@ -163,7 +241,8 @@ xd::window::window(const std::string& title, int width, int height, const window
     glClearDepth(1.0f);
 
     // initialize ticks
-    m_current_ticks = m_last_ticks = m_last_fps_update = static_cast<std::uint32_t>(glfwGetTime() * 1000);
+    m_timer_start = glfwGetTimerValue();
+    m_current_time = m_last_time = m_last_fps_update = 0;
 
     // register input callbacks
     glfwSetKeyCallback(m_window, &on_key_proxy);
@@ -174,56 +253,32 @@ xd::window::window(const std::string& title, int width, int height, const window
 
     window_instance = this;
 
-    m_joystick_enabled = options.enable_joystick;
-    m_gamepad_detection = options.gamepad_detection;
-    m_axis_as_dpad = options.axis_as_dpad;
-    m_stick_sensitivity = options.stick_sensitivity;
-    m_trigger_sensitivity = options.trigger_sensitivity;
-    m_preferred_joystick_guid = options.preferred_joystick_guid;
-
-    for (int joystick = GLFW_JOYSTICK_1; joystick < GLFW_JOYSTICK_LAST + 1; ++joystick) {
+    m_joysticks.set_source(std::make_unique<glfw_joystick_source>());
+    for (int joystick = 0; joystick < max_joysticks; ++joystick) {
         add_joystick(joystick);
     }
 }
 
 xd::window::~window() {
-    glfwDestroyWindow(m_window);
-    glfwTerminate();
+    if (m_window) {
+        glfwDestroyWindow(m_window);
+        glfwTerminate();
+    } else {
+        gl_state::set_headless(false);
+    }
     window_instance = nullptr;
 }
 
 bool xd::window::joystick_is_gamepad(int id) const {
-    return glfwJoystickIsGamepad(id) != 0;
+    return m_joysticks.is_gamepad(id);
 }
 
 void xd::window::add_joystick(int id) {
-    if (!glfwJoystickPresent(id)) return;
-
-    // + 3 because we add two pseudo-buttons for the triggers
-    for (int button = 0; button < GLFW_GAMEPAD_BUTTON_LAST + 3; ++button) {
-        m_joystick_states[id].buttons[button] = GLFW_RELEASE;
-    }
-
-    for (int axis = 0; axis < GLFW_GAMEPAD_AXIS_LAST + 1; ++axis) {
-        m_joystick_states[id].axes[axis] = 0.0f;
-    }
-
-    auto guid = glfwGetJoystickGUID(id);
-    if (guid) {
-        m_joystick_guid_for_id[id] = guid;
-    } else {
-        m_joystick_guid_for_id.erase(id);
-    }
+    m_joysticks.connect(id);
 }
 
 void xd::window::remove_joystick(int id) {
-    if (joystick_present(id)) {
-        m_joystick_states.erase(id);
-    }
-
-    if (m_joystick_guid_for_id.find(id) != m_joystick_guid_for_id.end()) {
-        m_joystick_guid_for_id.erase(id);
-    }
+    m_joysticks.disconnect(id);
 
     if (id == m_active_joystick_id) {
         m_joystick_was_disconnected = true;
@@ -236,12 +291,6 @@ void xd::window::on_input(input_type type, int key, int action, int device_id) {
 
     input_args args;
 
-    // find associated virtual key
-    xd::window::key_table_t::iterator i = m_key_to_virtual.find(args.physical_key);
-    if (i != m_key_to_virtual.end()) {
-        args.virtual_key = i->second;
-    }
-
     if (type == input_type::INPUT_KEYBOARD) {
         args.physical_key = KEY(key);
     } else if (type == input_type::INPUT_GAMEPAD) {
@@ -253,20 +302,65 @@ void xd::window::on_input(input_type type, int key, int action, int device_id) {
         args.physical_key = MOUSE(key);
     }
 
+    // find associated virtual key
+    auto bound = bound_action(args.physical_key);
+    if (bound != -1) {
+        args.virtual_key = m_action_names[bound];
+    }
+
     args.modifiers = 0;
 
     // add to triggered keys if key down event and launch the event
     if (action == GLFW_PRESS) {
         m_triggered_keys.insert(args.physical_key);
         m_tick_handler_triggered_keys.insert(args.physical_key);
-        m_input_events["key_down"](args);
+        m_input_events[m_key_down_event](args);
     } else {
-        m_input_events["key_up"](args);
+        m_input_events[m_key_up_event](args);
     }
 
     m_last_input_type = type;
 }
 
+void xd::window::inject_input(const key& key, bool pressed) {
+    auto action = pressed ? GLFW_PRESS : GLFW_RELEASE;
+    if (key.type != input_type::INPUT_GAMEPAD) {
+        auto device_key = key;
+        device_key.device_id = -1;
+        if (pressed) {
+            m_injected_keys.insert(device_key);
+        } else {
+            m_injected_keys.erase(device_key);
+        }
+        on_input(key.type, key.code, action);
+        update_action_states();
+        return;
+    }
+
+    if (key.device_id < 0 || key.device_id >= max_joysticks
+        || key.code < 0 || key.code >= joystick_button_count) return;
+
+    // a joystick that was never connected gets a blank state
+    m_joysticks.connect_virtual(key.device_id);
+    auto& state = m_joysticks.state(key.device_id);
+    state.buttons[key.code] = static_cast<unsigned char>(action);
+    state.prev_buttons[key.code] = static_cast<unsigned char>(action);
+    on_input(input_type::INPUT_GAMEPAD, key.code, action, key.device_id);
+    update_action_states();
+}
+
+void xd::window::inject_axis(int joystick_id, int axis, float value) {
+    if (joystick_id < 0 || joystick_id >= max_joysticks || axis < 0 || axis >= joystick_axis_count) return;
+
+    m_joysticks.connect_virtual(joystick_id);
+    auto& state = m_joysticks.state(joystick_id);
+    state.axes[axis] = value;
+    if (m_active_joystick_id == -1) {
+        m_active_joystick_id = joystick_id;
+        update_action_states();
+    }
+}
+
 void xd::window::on_character_input(unsigned int codepoint) {
     utf8::append(codepoint, std::back_inserter(m_character_buffer));
 }
@@ -286,30 +380,43 @@ void xd::window::update() {
     // clear the triggered keys
     m_triggered_keys.clear();
 
-    // trigger input callbacks
-    glfwPollEvents();
+    m_last_time = m_current_time;
+    if (m_window) {
+        // trigger input callbacks
+        glfwPollEvents();
+
+        update_joysticks();
 
-    update_joysticks();
+        // update ticks, using the monotonic timer counter directly
+        auto counter = glfwGetTimerValue() - m_timer_start;
+        auto frequency = glfwGetTimerFrequency();
+        m_current_time = static_cast<std::int64_t>(counter / frequency) * fixed_step_timer::nanoseconds_per_second
+            + static_cast<std::int64_t>(counter % frequency * fixed_step_timer::nanoseconds_per_second / frequency);
+    } else {
+        // virtual clock, every update runs exactly one tick
+        m_current_time += m_tick_handler
+            ? m_tick_timer.time_to_next_step()
+            : fixed_step_timer::nanoseconds_per_second / 60;
+    }
 
-    // update ticks
-    m_last_ticks = m_current_ticks;
-    m_current_ticks = static_cast<std::uint32_t>(glfwGetTime() * 1000);
+    // device state only changes when polled, refresh the actions once
+    update_action_states();
 
     // invoke tick handler if necessary
     if (m_tick_handler) {
-        m_tick_handler_counter += delta_ticks();
-        while (m_tick_handler_counter >= m_tick_handler_interval) {
+        int steps = m_tick_timer.advance(m_current_time - m_last_time);
+        for (int i = 0; i < steps; ++i) {
             m_tick_handler();
-            m_tick_handler_counter -= m_tick_handler_interval;
             m_tick_handler_triggered_keys.clear();
+            std::fill(m_tick_handler_triggered_actions.begin(), m_tick_handler_triggered_actions.end(), false);
         }
     }
 
     // calculate fps
-    while (m_current_ticks >= (m_last_fps_update + 1000)) {
+    while (m_current_time >= m_last_fps_update + fixed_step_timer::nanoseconds_per_second) {
         m_fps = m_frame_count;
         m_frame_count = 0;
-        m_last_fps_update += 1000;
+        m_last_fps_update += fixed_step_timer::nanoseconds_per_second;
     }
 
     // increase frame count
@@ -334,129 +441,55 @@ void xd::window::update_joysticks() {
 
     if (!m_joystick_enabled) return;
 
-    for (auto& pair : m_joystick_states) {
-        int joystick_id = pair.first;
-        auto& joystick_state = pair.second;
-
-        auto& buttons = joystick_state.buttons;
-        auto& axes = joystick_state.axes;
-
-        int button_count = 0;
-        int axes_count = 0;
-
-        int gamepad_success = GLFW_FALSE;
-        if (m_gamepad_detection && glfwJoystickIsGamepad(joystick_id)) {
-            GLFWgamepadstate state;
-            gamepad_success = glfwGetGamepadState(joystick_id, &state);
-            if (gamepad_success == GLFW_TRUE) {
-                button_count = GLFW_GAMEPAD_BUTTON_LAST + 1;
-                axes_count = GLFW_GAMEPAD_AXIS_LAST + 1;
-                for (int button = 0; button < button_count; ++button) {
-                    buttons[button] = state.buttons[button];
-                }
-                for (int axis = 0; axis < axes_count; ++axis) {
-                    axes[axis] = state.axes[axis];
-                }
-            }
-        }
-
-        if (gamepad_success == GLFW_FALSE) {
-            auto button_state = glfwGetJoystickButtons(0, &button_count);
-            auto axis_state = glfwGetJoystickAxes(0, &axes_count);
-
-            if (button_count > GLFW_GAMEPAD_BUTTON_LAST + 1) {
-                button_count = GLFW_GAMEPAD_BUTTON_LAST + 1;
-            }
-
-            for (int button = 0; button < button_count; button++)
-            {
-                buttons[button] = button_state[button];
-            }
-
-            int hat_count;
-            auto hat_state = glfwGetJoystickHats(joystick_id, &hat_count);
-            if (hat_count > 0) {
-               buttons[GLFW_GAMEPAD_BUTTON_DPAD_UP] = hat_state[0] & GLFW_HAT_UP;
-               buttons[GLFW_GAMEPAD_BUTTON_DPAD_RIGHT] = hat_state[0] & GLFW_HAT_RIGHT;
-               buttons[GLFW_GAMEPAD_BUTTON_DPAD_DOWN] = hat_state[0] & GLFW_HAT_DOWN;
-               buttons[GLFW_GAMEPAD_BUTTON_DPAD_LEFT] = hat_state[0] & GLFW_HAT_LEFT;
-            }
-
-            for (int axis = 0; axis < axes_count; axis++) {
-                axes[axis] = axis_state[axis];
-            }
-        }
-
-        if (m_axis_as_dpad) {
-            buttons[GLFW_GAMEPAD_BUTTON_DPAD_UP] |=
-                static_cast<unsigned char>(axes[GLFW_GAMEPAD_AXIS_LEFT_Y] <= -m_stick_sensitivity);
-            buttons[GLFW_GAMEPAD_BUTTON_DPAD_RIGHT] |=
-                static_cast<unsigned char>(axes[GLFW_GAMEPAD_AXIS_LEFT_X] >= m_stick_sensitivity);
-            buttons[GLFW_GAMEPAD_BUTTON_DPAD_DOWN] |=
-                static_cast<unsigned char>(axes[GLFW_GAMEPAD_AXIS_LEFT_Y] >= m_stick_sensitivity);
-            buttons[GLFW_GAMEPAD_BUTTON_DPAD_LEFT] |=
-                static_cast<unsigned char>(axes[GLFW_GAMEPAD_AXIS_LEFT_X] <= -m_stick_sensitivity);
-        }
-
-        for (int button = 0; button < button_count; button++) {
-            if (buttons[button] != joystick_state.prev_buttons[button]) {
-                on_input(input_type::INPUT_GAMEPAD, button, buttons[button], joystick_id);
-                joystick_state.prev_buttons[button] = buttons[button];
-            }
-        }
-
-        // Triggers as buttons
-        process_trigger(GLFW_GAMEPAD_AXIS_LEFT_TRIGGER, joystick_state, joystick_id);
-        process_trigger(GLFW_GAMEPAD_AXIS_RIGHT_TRIGGER, joystick_state, joystick_id);
-    }
-}
-
-void xd::window::process_trigger(int axis, xd::window::joystick_state& state, int joystick_id) {
-    int index = axis == GLFW_GAMEPAD_AXIS_LEFT_TRIGGER
-        ? GAMEPAD_BUTTON_LEFT_TRIGGER_INDEX
-        : GAMEPAD_BUTTON_RIGHT_TRIGGER_INDEX;
-    state.buttons[index] = static_cast<unsigned char>(state.axes[axis] >= m_trigger_sensitivity);
-    if (state.buttons[index] != state.prev_buttons[index]) {
-        on_input(input_type::INPUT_GAMEPAD, index, state.buttons[index], joystick_id);
-        state.prev_buttons[index] = state.buttons[index];
-    }
+    // only changed buttons generate events
+    m_joysticks.poll(m_active_joystick_id, m_current_time, [this](int id, int button, bool pressed) {
+        on_input(input_type::INPUT_GAMEPAD, button, pressed ? GLFW_PRESS : GLFW_RELEASE, id);
+    });
 }
 
 void xd::window::clear() {
+    if (!m_window) return;
     glClear(GL_COLOR_BUFFER_BIT|GL_DEPTH_BUFFER_BIT);
 }
 
 void xd::window::swap() {
+    if (!m_window) return;
     glfwSwapBuffers(m_window);
 }
 
 bool xd::window::focused() const {
+    if (!m_window) return true;
     return glfwGetWindowAttrib(m_window, GLFW_FOCUSED) == GL_TRUE;
 }
 
 bool xd::window::closed() const {
+    if (!m_window) return false;
     return glfwWindowShouldClose(m_window) != 0;
 }
 
 int xd::window::width() const {
+    if (!m_window) return m_width;
     int width;
     glfwGetWindowSize(m_window, &width, nullptr);
     return width;
 }
 
 int xd::window::height() const {
+    if (!m_window) return m_height;
     int height;
     glfwGetWindowSize(m_window, nullptr, &height);
     return height;
 }
 
 int xd::window::framebuffer_width() const {
+    if (!m_window) return m_width;
     int width;
     glfwGetFramebufferSize(m_window, &width, nullptr);
     return width;
 }
 
 int xd::window::framebuffer_height() const {
+    if (!m_window) return m_height;
     int height;
     glfwGetFramebufferSize(m_window, nullptr, &height);
     return height;
@@ -486,10 +519,13 @@ void xd::window::set_window_size(int width, int height, bool via_callback) {
 
     m_width = width;
     m_height = height;
-    glfwSetWindowSize(m_window, width, height);
+    if (m_window) {
+        glfwSetWindowSize(m_window, width, height);
+    }
 }
 
 xd::vec2 xd::window::current_resolution() const {
+    if (!m_window) return xd::vec2{m_width, m_height};
     auto mode = glfwGetVideoMode(glfwGetPrimaryMonitor());
     return mode ? xd::vec2{mode->width, mode->height} : xd::vec2{0.0f, 0.0f};
 }
@@ -497,6 +533,7 @@ xd::vec2 xd::window::current_resolution() const {
 std::vector<xd::vec2> xd::window::monitor_resolutions() const {
     std::vector<xd::vec2> sizes;
     std::unordered_set<xd::vec2> size_map;
+    if (!m_window) return sizes;
 
     int count;
     const auto modes = glfwGetVideoModes(glfwGetPrimaryMonitor(), &count);
@@ -514,12 +551,13 @@ std::vector<xd::vec2> xd::window::monitor_resolutions() const {
 }
 
 bool xd::window::is_fullscreen() const {
+    if (!m_window) return false;
     auto monitor = glfwGetWindowMonitor(m_window);
     return monitor != nullptr;
 }
 
 void xd::window::set_fullscreen(bool fullscreen) {
-    if (is_fullscreen() == fullscreen) return;
+    if (!m_window || is_fullscreen() == fullscreen) return;
 
     if (fullscreen) {
         glfwGetWindowPos(m_window, &m_windowed_pos.x, &m_windowed_pos.y);
@@ -534,10 +572,12 @@ void xd::window::set_fullscreen(bool fullscreen) {
 }
 
 bool xd::window::is_maximized() const {
+    if (!m_window) return false;
     return glfwGetWindowAttrib(m_window, GLFW_MAXIMIZED) != GLFW_FALSE;
 }
 
 void xd::window::set_maximized(bool maximized) {
+    if (!m_window) return;
     if (maximized) {
         glfwMaximizeWindow(m_window);
     } else {
@@ -546,16 +586,18 @@ void xd::window::set_maximized(bool maximized) {
 }
 
 void xd::window::set_vsync(bool vsync) const {
+    if (!m_window) return;
     glfwSwapInterval(vsync ? 1 : 0);
 }
 
 void xd::window::set_gamma(float gamma) const {
+    if (!m_window) return;
     if (gamma < 0.01f) gamma = 0.01f;
     glfwSetGamma(glfwGetPrimaryMonitor(), gamma);
 }
 
 void xd::window::set_icons(std::vector<std::shared_ptr<xd::image>> icon_images) const {
-    if (icon_images.empty()) return;
+    if (!m_window || icon_images.empty()) return;
 
     std::vector<GLFWimage> glfw_images;
     for (auto& icon : icon_images) {
@@ -569,41 +611,65 @@ void xd::window::set_icons(std::vector<std::shared_ptr<xd::image>> icon_images)
     glfwSetWindowIcon(m_window, glfw_images.size(), glfw_images.data());
 }
 
+int xd::window::action_id(const std::string& virtual_key) {
+    auto i = m_action_ids.find(virtual_key);
+    if (i != m_action_ids.end()) return i->second;
+
+    int action = static_cast<int>(m_action_names.size());
+    m_action_ids.emplace(virtual_key, action);
+    m_action_names.push_back(virtual_key);
+    m_action_keys.emplace_back();
+    m_pressed_actions.push_back(false);
+    m_triggered_actions.push_back(false);
+    m_tick_handler_triggered_actions.push_back(false);
+    return action;
+}
+
+std::string xd::window::action_name(int action) const {
+    if (action < 0 || action >= static_cast<int>(m_action_names.size())) return "";
+    return m_action_names[action];
+}
+
 void xd::window::bind_key(const xd::key& physical_key, const std::string& virtual_key) {
     // find if the physical key is bound
-    xd::window::key_table_t::iterator i = m_key_to_virtual.find(physical_key);
-    if (i == m_key_to_virtual.end()) {
+    xd::window::key_table_t::iterator i = m_key_to_action.find(physical_key);
+    if (i == m_key_to_action.end()) {
         // if it's not found, add it to the tables
-        m_key_to_virtual[physical_key] = virtual_key;
-        m_virtual_to_key[virtual_key].insert(physical_key);
+        auto action = action_id(virtual_key);
+        m_key_to_action[physical_key] = action;
+        m_action_keys[action].insert(physical_key);
+        update_action_state(action);
     }
 }
 
 void xd::window::unbind_key(const xd::key& physical_key) {
     // find if the physical key is bound
-    xd::window::key_table_t::iterator i = m_key_to_virtual.find(physical_key);
-    if (i != m_key_to_virtual.end()) {
+    xd::window::key_table_t::iterator i = m_key_to_action.find(physical_key);
+    if (i != m_key_to_action.end()) {
         // erase physical key from the virtual key's list
-        m_virtual_to_key[i->second].erase(physical_key);
+        auto action = i->second;
+        m_action_keys[action].erase(physical_key);
         // erase the physical key itself
-        m_key_to_virtual.erase(i);
+        m_key_to_action.erase(i);
+        update_action_state(action);
     }
 }
 
 void xd::window::unbind_key(const std::string& virtual_key) {
-    // find if the virtual key is bound
-    xd::window::virtual_table_t::iterator i = m_virtual_to_key.find(virtual_key);
-    if (i != m_virtual_to_key.end()) {
+    // find if the virtual key is bound, its ID stays valid for rebinding
+    auto action = find_action(virtual_key);
+    if (action != -1) {
         // erase all the keys associated to this virtual key
-        for (xd::window::key_set_t::iterator j = i->second.begin(); j != i->second.end(); ++j) {
-            m_key_to_virtual.erase(*j);
+        for (auto& physical_key : m_action_keys[action]) {
+            m_key_to_action.erase(physical_key);
         }
-        // erase the virtual key itself
-        m_virtual_to_key.erase(i);
+        m_action_keys[action].clear();
+        update_action_state(action);
     }
 }
 
 std::string xd::window::key_name(const key& physical_key) {
+    if (!m_window) return "";
     const char* name = glfwGetKeyName(physical_key.code, 0);
     return name ? name : "";
 }
@@ -611,60 +677,59 @@ std::string xd::window::key_name(const key& physical_key) {
 bool xd::window::pressed(const xd::key& key, int joystick_id) const {
     switch (key.type) {
     case xd::input_type::INPUT_KEYBOARD:
-        return glfwGetKey(m_window, key.code) == GLFW_PRESS;
+        if (!m_injected_keys.empty() && m_injected_keys.find(KEY(key.code)) != m_injected_keys.end())
+            return true;
+        return m_window && glfwGetKey(m_window, key.code) == GLFW_PRESS;
     case xd::input_type::INPUT_MOUSE:
-        return  glfwGetMouseButton(m_window, key.code) == GLFW_PRESS;
+        if (!m_injected_keys.empty() && m_injected_keys.find(MOUSE(key.code)) != m_injected_keys.end())
+            return true;
+        return m_window && glfwGetMouseButton(m_window, key.code) == GLFW_PRESS;
     case xd::input_type::INPUT_GAMEPAD:
         if (joystick_id == -1) {
             joystick_id = m_active_joystick_id;
         }
 
         return joystick_present(joystick_id) &&
-            m_joystick_states.at(joystick_id).buttons[key.code] == GLFW_PRESS;
+            m_joysticks.state(joystick_id).buttons[key.code] == GLFW_PRESS;
     default:
         return false;
     }
 }
 
 bool xd::window::pressed(const std::string& key, int joystick_id) const {
-    // find if this virtual key is bound
-    xd::window::virtual_table_t::const_iterator i = m_virtual_to_key.find(key);
-    if (i != m_virtual_to_key.end()) {
-        // iterate through each physical key
-        for (xd::window::key_set_t::const_iterator j = i->second.begin(); j != i->second.end(); ++j) {
-            if (pressed(*j, joystick_id)) return true;
-        }
+    return pressed(find_action(key), joystick_id);
+}
+
+bool xd::window::pressed(int action, int joystick_id) const {
+    if (action < 0 || action >= static_cast<int>(m_action_keys.size())) return false;
+    if (joystick_id == -1 || joystick_id == m_active_joystick_id) {
+        return m_pressed_actions[action];
+    }
+
+    // other joysticks aren't cached, check each physical key
+    for (auto& key : m_action_keys[action]) {
+        if (pressed(key, joystick_id)) return true;
     }
     return false;
 }
 
 bool xd::window::triggered(const xd::key& key, int joystick_id) const {
     auto& key_set = m_in_update ? m_tick_handler_triggered_keys : m_triggered_keys;
-    if (key_set.empty()) return false;
-
-    xd::key key_copy = key;
-    if (key_copy.type == input_type::INPUT_GAMEPAD) {
-        if (joystick_id == -1) {
-            joystick_id = m_active_joystick_id;
-        }
+    return key_triggered(key_set, key, joystick_id);
+}
 
-        if (joystick_id == -1) return false;
+bool xd::window::triggered(const std::string& key, int joystick_id) const {
+    return triggered(find_action(key), joystick_id);
+}
 
-        key_copy.device_id = joystick_id;
+bool xd::window::triggered(int action, int joystick_id) const {
+    if (action < 0 || action >= static_cast<int>(m_action_keys.size())) return false;
+    if (joystick_id == -1 || joystick_id == m_active_joystick_id) {
+        return m_in_update ? m_tick_handler_triggered_actions[action] : m_triggered_actions[action];
     }
 
-    return key_set.find(key_copy) != key_set.end();
-}
-
-bool xd::window::triggered(const std::string& key, int joystick_id) const {
-    // find if this virtual key is bound
-    xd::window::virtual_table_t::const_iterator i = m_virtual_to_key.find(key);
-    if (i != m_virtual_to_key.end()) {
-        // iterate through each physical key
-        for (xd::window::key_set_t::const_iterator j = i->second.begin(); j != i->second.end(); ++j) {
-            if (triggered(*j, joystick_id))
-                return true;
-        }
+    for (auto& key : m_action_keys[action]) {
+        if (triggered(key, joystick_id)) return true;
     }
     return false;
 }
@@ -687,26 +752,37 @@ bool xd::window::triggered_once(const xd::key& key, int joystick_id) {
     if (!triggered(key, joystick_id)) return false;
 
     key_set.erase(key_copy);
+    auto action = bound_action(key);
+    if (action != -1) {
+        update_action_state(action);
+    }
     return true;
 }
 
 bool xd::window::triggered_once(const std::string& key, int joystick_id) {
-    auto i = m_virtual_to_key.find(key);
-    if (i != m_virtual_to_key.end()) {
-        for (auto j = i->second.begin(); j != i->second.end(); ++j) {
-            if (triggered_once(*j, joystick_id))
-                return true;
-        }
+    return triggered_once(find_action(key), joystick_id);
+}
+
+bool xd::window::triggered_once(int action, int joystick_id) {
+    if (!triggered(action, joystick_id)) return false;
+
+    // only the first triggered key is consumed, like separate presses
+    for (auto& key : m_action_keys[action]) {
+        if (triggered_once(key, joystick_id))
+            return true;
     }
     return false;
 }
 
 void xd::window::begin_character_input() const {
+    if (!m_window) return;
     glfwSetCharCallback(m_window, ::on_character_input);
 }
 
 std::string xd::window::end_character_input() {
-    glfwSetCharCallback(m_window, nullptr);
+    if (m_window) {
+        glfwSetCharCallback(m_window, nullptr);
+    }
     std::string input_copy{m_character_buffer};
     m_character_buffer = "";
     return input_copy;
@@ -720,15 +796,15 @@ float xd::window::axis_value(const xd::key& key, int joystick_id) {
 
     if (!joystick_present(joystick_id)) return 0.0f;
 
-    return m_joystick_states[joystick_id].axes[key.code];
+    return m_joysticks.state(joystick_id).axes[key.code];
 }
 
 float xd::window::axis_value(const std::string& key, int joystick_id) {
     // find if this virtual key is bound
-    xd::window::virtual_table_t::const_iterator i = m_virtual_to_key.find(key);
-    if (i != m_virtual_to_key.end() && !i->second.empty()) {
+    auto action = find_action(key);
+    if (action != -1 && !m_action_keys[action].empty()) {
         // Return value for first matching physical key
-        return axis_value(*i->second.begin(), joystick_id);
+        return axis_value(*m_action_keys[action].begin(), joystick_id);
     }
 
     return 0.0f;
@@ -738,9 +814,7 @@ bool xd::window::is_preferred_joystick(int id) const {
     const auto& preferred_guid = m_preferred_joystick_guid;
     if (preferred_guid.empty() || !joystick_present(id)) return false;
 
-    auto i = m_joystick_guid_for_id.find(id);
-    return i != m_joystick_guid_for_id.end()
-        && m_joystick_guid_for_id.at(id) == preferred_guid;
+    return m_joysticks.guid(id) == preferred_guid;
 }
 
 std::string xd::window::joystick_name(int id) const {
@@ -749,28 +823,14 @@ std::string xd::window::joystick_name(int id) const {
     } else if (id == -1) {
         return "";
     }
-
-    const char* name = nullptr;
-    if (joystick_is_gamepad(id)) {
-        name = glfwGetGamepadName(id);
-    } else {
-        name = glfwGetJoystickName(id);
-    }
-
-    return name ? name : "";
+    return m_joysticks.name(id);
 }
 
 std::unordered_map<int, std::string> xd::window::joystick_names() const {
     std::unordered_map<int, std::string> names;
-
-    for (auto& [id, state] : m_joystick_states) {
-        const char* name = nullptr;
-        if (joystick_is_gamepad(id)) {
-            name = glfwGetGamepadName(id);
-        } else {
-            name = glfwGetJoystickName(id);
-        }
-        if (name) {
+    for (int id = 0; id < max_joysticks; ++id) {
+        auto name = m_joysticks.name(id);
+        if (!name.empty()) {
             names[id] = name;
         }
     }
@@ -779,11 +839,70 @@ std::unordered_map<int, std::string> xd::window::joystick_names() const {
 }
 
 void xd::window::reset_joystick_states() {
-    for (int joystick = GLFW_JOYSTICK_1; joystick < GLFW_JOYSTICK_LAST + 1; ++joystick) {
-        if (glfwJoystickPresent(joystick)) {
+    auto source = m_joysticks.source();
+    if (!source) return;
+    for (int joystick = 0; joystick < max_joysticks; ++joystick) {
+        if (source->present(joystick)) {
             add_joystick(joystick);
         } else {
             remove_joystick(joystick);
         }
     }
 }
+
+void xd::window::set_joystick_source(std::unique_ptr<joystick_source> source) {
+    m_joysticks.set_source(std::move(source));
+    reset_joystick_states();
+    update_action_states();
+}
+
+int xd::window::find_action(const std::string& virtual_key) const {
+    auto i = m_action_ids.find(virtual_key);
+    return i != m_action_ids.end() ? i->second : -1;
+}
+
+int xd::window::bound_action(key physical_key) const {
+    // gamepad keys are bound for any joystick
+    if (physical_key.type == input_type::INPUT_GAMEPAD) {
+        physical_key.device_id = -1;
+    }
+    auto i = m_key_to_action.find(physical_key);
+    return i != m_key_to_action.end() ? i->second : -1;
+}
+
+bool xd::window::key_triggered(const trigger_keys_t& key_set, const xd::key& key, int joystick_id) const {
+    if (key_set.empty()) return false;
+
+    xd::key key_copy = key;
+    if (key_copy.type == input_type::INPUT_GAMEPAD) {
+        if (joystick_id == -1) {
+            joystick_id = m_active_joystick_id;
+        }
+
+        if (joystick_id == -1) return false;
+
+        key_copy.device_id = joystick_id;
+    }
+
+    return key_set.find(key_copy) != key_set.end();
+}
+
+void xd::window::update_action_state(int action) {
+    bool pressed_state = false;
+    bool triggered_state = false;
+    bool tick_triggered_state = false;
+    for (auto& key : m_action_keys[action]) {
+        pressed_state = pressed_state || pressed(key);
+        triggered_state = triggered_state || key_triggered(m_triggered_keys, key, -1);
+        tick_triggered_state = tick_triggered_state || key_triggered(m_tick_handler_triggered_keys, key, -1);
+    }
+    m_pressed_actions[action] = pressed_state;
+    m_triggered_actions[action] = triggered_state;
+    m_tick_handler_triggered_actions[action] = tick_triggered_state;
+}
+
+void xd::window::update_action_states() {
+    for (int action = 0; action < static_cast<int>(m_action_keys.size()); ++action) {
+        update_action_state(action);
+    }
+}
@@ -4,7 +4,9 @@
 #include "../event_bus.hpp"
 #include "../glm.hpp"
 #include "../graphics/image.hpp"
+#include "fixed_step_timer.hpp"
 #include "input.hpp"
+#include "joystick.hpp"
 #include "window_options.hpp"
 #include <cstdint>
 #include <functional>
@@ -54,19 +56,25 @@ namespace xd
         void set_icons(std::vector<std::shared_ptr<xd::image>> icon_images) const;
 
         // ticks stuff
-        int ticks() const noexcept { return m_current_ticks; }
-        int delta_ticks() const noexcept { return m_current_ticks - m_last_ticks; }
+        int ticks() const noexcept { return static_cast<int>(m_current_time / 1000000); }
+        int delta_ticks() const noexcept { return ticks() - static_cast<int>(m_last_time / 1000000); }
+        // high resolution time in seconds since the window was created
+        double time() const noexcept {
+            return static_cast<double>(m_current_time) / fixed_step_timer::nanoseconds_per_second;
+        }
         float delta_time() const noexcept {
-            return static_cast<float>(delta_ticks()) / 1000.0f;
+            return static_cast<float>(m_current_time - m_last_time) / fixed_step_timer::nanoseconds_per_second;
         }
-        void register_tick_handler(tick_callback_t callback, std::uint32_t interval) {
+        // call the handler steps_per_second times per second, running at most
+        // max_steps times per update (0 for no limit)
+        void register_tick_handler(tick_callback_t callback, int steps_per_second, int max_steps = 5) {
             m_tick_handler = callback;
-            m_tick_handler_interval = interval;
-            m_tick_handler_counter = 0;
+            m_tick_timer = fixed_step_timer(steps_per_second, max_steps);
         }
         void unregister_tick_handler() noexcept {
             m_tick_handler = nullptr;
         }
+        const fixed_step_timer& tick_timer() const noexcept { return m_tick_timer; }
         int fps() const noexcept { return m_fps; }
         int frame_count() const noexcept { return m_frame_count; }
 
@@ -75,8 +83,15 @@ namespace xd
         void unbind_key(const std::string& key);
         std::string key_name(const key& physical_key);
 
+        // virtual keys (actions) get a dense ID the first time they're seen. their
+        // pressed and triggered state for the active joystick is kept in per-action
+        // bits refreshed once per poll, so checking an ID is a single lookup
+        int action_id(const std::string& virtual_key);
+        std::string action_name(int action) const;
+
         bool pressed(const key& key, int joystick_id = -1) const;
         bool pressed(const std::string& key, int joystick_id = -1) const;
+        bool pressed(int action, int joystick_id = -1) const;
 
         bool triggered() const noexcept {
             auto& key_set = m_in_update ? m_tick_handler_triggered_keys : m_triggered_keys;
@@ -84,8 +99,10 @@ namespace xd
         }
         bool triggered(const key& key, int joystick_id = -1) const;
         bool triggered(const std::string& key, int joystick_id = -1) const;
+        bool triggered(int action, int joystick_id = -1) const;
         bool triggered_once(const key& key, int joystick_id = -1);
         bool triggered_once(const std::string& key, int joystick_id = -1);
+        bool triggered_once(int action, int joystick_id = -1);
         std::unordered_set<xd::key> triggered_keys() const {
             return m_in_update ? m_tick_handler_triggered_keys : m_triggered_keys;
         }
@@ -104,10 +121,10 @@ namespace xd
             m_joystick_enabled = enabled;
             reset_joystick_states();
             m_active_joystick_id = -1;
+            update_action_states();
         }
         bool joystick_present(int id) const {
-            return id < 0 ? false
-                : m_joystick_states.find(id) != m_joystick_states.end();
+            return m_joysticks.connected(id);
         }
         bool joystick_is_gamepad(int id) const;
         void add_joystick(int id);
@@ -136,11 +153,12 @@ namespace xd
                 return "";
             }
 
-            auto iter = m_joystick_guid_for_id.find(id);
-            return iter != m_joystick_guid_for_id.end() ? iter->second : "";
+            return m_joysticks.guid(id);
         }
         std::unordered_map<int, std::string> joystick_names() const;
         void reset_joystick_states();
+        // replace where joystick state is read from, e.g. with a fake in tests
+        void set_joystick_source(std::unique_ptr<joystick_source> source);
         input_type last_input_type() const { return m_last_input_type; }
 
         event_link bind_input_event(const std::string& event_name, input_event_callback_t callback,
@@ -158,6 +176,13 @@ namespace xd
             return bind_input_event(event_name, std::bind(callback, instance, std::placeholders::_1), filter, place);
         }
 
+        // feed input that didn't come from a device, e.g. when replaying recorded
+        // input. injected keys stay pressed until they're injected as released
+        void inject_input(const key& key, bool pressed);
+        void inject_axis(int joystick_id, int axis, float value);
+        // is there no real window (see window_options::headless)
+        bool is_headless() const noexcept { return m_window == nullptr; }
+
         // input event handler, for internal use
         void on_input(input_type type, int key, int action, int device_id = 0);
         // character input event handler, for internal use
@@ -187,67 +212,69 @@ namespace xd
         xd::ivec2 m_windowed_size;
         // joystick options
         bool m_joystick_enabled;
-        bool m_gamepad_detection;
-        bool m_axis_as_dpad;
-        float m_stick_sensitivity;
-        float m_trigger_sensitivity;
         // stored character input
         std::string m_character_buffer;
         input_type m_last_input_type;
         // error callback
         error_callback_t m_error_handler;
 
-        // keep track of ticks
-        std::uint32_t m_current_ticks;
-        std::uint32_t m_last_ticks;
-        std::uint32_t m_tick_handler_counter;
-        std::uint32_t m_tick_handler_interval;
+        // keep track of time (in nanoseconds since the window was created)
+        std::uint64_t m_timer_start;
+        std::int64_t m_current_time;
+        std::int64_t m_last_time;
+        fixed_step_timer m_tick_timer;
         tick_callback_t m_tick_handler;
 
         // fps stuff
         int m_fps;
         int m_frame_count;
-        std::uint32_t m_last_fps_update;
+        std::int64_t m_last_fps_update;
 
         // internal typedefs
         typedef std::unordered_set<key> key_set_t;
-        typedef std::unordered_map<key, std::string> key_table_t;
-        typedef std::unordered_map<std::string, key_set_t> virtual_table_t;
+        typedef std::unordered_map<key, int> key_table_t;
         typedef std::unordered_set<key> trigger_keys_t;
 
-        // virtual key conversions
-        key_table_t m_key_to_virtual;
-        virtual_table_t m_virtual_to_key;
+        // virtual key conversions, indexed by action ID
+        std::unordered_map<std::string, int> m_action_ids;
+        std::vector<std::string> m_action_names;
+        std::vector<key_set_t> m_action_keys;
+        key_table_t m_key_to_action;
+        // per action state of the active joystick, mirrors the key sets below
+        std::vector<bool> m_pressed_actions;
+        std::vector<bool> m_triggered_actions;
+        std::vector<bool> m_tick_handler_triggered_actions;
 
         // key triggers
         trigger_keys_t m_triggered_keys;
         trigger_keys_t m_tick_handler_triggered_keys;
+        // keyboard and mouse keys held down through inject_input
+        key_set_t m_injected_keys;
 
         // joystick/gamepad state
-        struct joystick_state {
-            float axes[6];
-            unsigned char buttons[17];
-            unsigned char prev_buttons[17];
-        };
-
-        std::unordered_map<int, joystick_state> m_joystick_states;
+        joystick_poller m_joysticks;
         std::vector<int> m_joysticks_to_add;
         std::vector<int> m_joysticks_to_remove;
 
         std::string m_preferred_joystick_guid;
         int m_active_joystick_id;
         bool m_joystick_was_disconnected;
-        std::unordered_map<int, std::string> m_joystick_guid_for_id;
 
         // to keep track whether we're in update or not
         bool m_in_update;
 
         // event buses
         event_bus<input_args> m_input_events;
+        event_id m_key_down_event;
+        event_id m_key_up_event;
 
         // private functions
+        int find_action(const std::string& virtual_key) const;
+        int bound_action(key physical_key) const;
+        bool key_triggered(const trigger_keys_t& key_set, const key& key, int joystick_id) const;
+        void update_action_state(int action);
+        void update_action_states();
         void update_joysticks();
-        void process_trigger(int axis, joystick_state& state, int joystick_id);
     };
 }
 
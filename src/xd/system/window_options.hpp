@@ -28,6 +28,7 @@ namespace xd
             , antialiasing_level(0)
             , major_version(2)
             , minor_version(0)
+            , headless(false)
         {}
 
         window_options(bool fullscreen, int game_width, int game_height,
@@ -38,7 +39,7 @@ namespace xd
             bool gamepad_detection, bool axis_as_dpad,
             float stick_sensitivity, float trigger_sensitivity,
             int depth_bits, int stencil_bits, int antialiasing_level,
-            int major_version, int minor_version) noexcept
+            int major_version, int minor_version, bool headless = false) noexcept
             : fullscreen(fullscreen)
             , game_width(game_width)
             , game_height(game_height)
@@ -60,6 +61,7 @@ namespace xd
             , antialiasing_level(antialiasing_level)
             , major_version(major_version)
             , minor_version(minor_version)
+            , headless(headless)
         {}
 
         bool fullscreen;
@@ -83,6 +85,8 @@ namespace xd
         int antialiasing_level;
         int major_version;
         int minor_version;
+        // no window or GL context, time advances one tick per update
+        bool headless;
     };
 }
 